@@ -19,5 +19,11 @@ namespace myoddweb.directorywatcher.interfaces
     /// The various refresh rates
     /// </summary>
     IRates Rates { get; }
+
+    /// <summary>
+    /// If the events are pulled from the watcher rather than given to us at the events rate.
+    /// The events that are not pulled are kept for the events rate.
+    /// </summary>
+    bool PullEvents { get; }
   }
 }
\ No newline at end of file
@@ -36,6 +36,21 @@ namespace myoddweb.directorywatcher.test
       Assert.AreEqual(recursive, request.Recursive);
     }
 
+    [Test]
+    public void EventsAreNotPulledByDefault()
+    {
+      var request = new Request("c:\\", false);
+      Assert.IsFalse(request.PullEvents);
+    }
+
+    [TestCase(true)]
+    [TestCase(false)]
+    public void PullEventsIsSaved(bool pullEvents)
+    {
+      var request = new Request("c:\\", false, new Rates(50), pullEvents);
+      Assert.AreEqual(pullEvents, request.PullEvents);
+    }
+
     [Test]
     public void CannotCreateWithNullPath()
     {
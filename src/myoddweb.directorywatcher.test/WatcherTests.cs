@@ -1,5 +1,6 @@
 using myoddweb.directorywatcher.interfaces;
 using NUnit.Framework;
+using System.Collections.Concurrent;
 using System.Diagnostics;
 using System.IO;
 using System.Threading;
@@ -79,6 +80,38 @@ namespace myoddweb.directorywatcher.test
       return Task.CompletedTask;
     }
 
+    [TestCase(true)]
+    [TestCase(false)]
+    public void GetNotificationsWhenPullingEvents(bool recursive)
+    {
+      using var helper = new HelperTest();
+
+      using var watcher = new Watcher();
+      watcher.Add(new Request(helper.Folder, recursive, new Rates(100), true));
+
+      var names = new ConcurrentBag<string>();
+      watcher.OnAddedAsync += (ft, t) =>
+      {
+        names.Add(ft.Name);
+        return Task.CompletedTask;
+      };
+
+      // start 
+      watcher.Start();
+      Assert.IsTrue(SpinWait.SpinUntil(() => watcher.Ready(), 1000));
+
+      // the names are copied to our buffer, they must not be mangled on the way.
+      const string name = "pulled.\u00e9\u6f22\u5b57.txt";
+      using (File.Create(Path.Combine(helper.Folder, name))) { }
+
+      // wait a bit
+      SpinWait.SpinUntil(() => names.Contains(name), 1000);
+
+      watcher.Stop();
+
+      Assert.Contains(name, names.ToArray());
+    }
+
     [TestCase(1, true)]
     [TestCase(5, true)]
     [TestCase(42, true)]
@@ -0,0 +1,38 @@
+﻿// Licensed to Florent Guelfucci under one or more agreements.
+// Florent Guelfucci licenses this file to you under the MIT license.
+// See the LICENSE file in the project root for more information.
+using System.Reflection;
+using System.Runtime.InteropServices;
+using myoddweb.directorywatcher.utils.Helper;
+using NUnit.Framework;
+
+namespace myoddweb.directorywatcher.test.utils
+{
+  internal class WatcherManagerNativeLibraryTests
+  {
+    [Test]
+    public void PulledNamesAreWideCharacters()
+    {
+      // the names are copied as wchar_t, the default would marshal them as ansi.
+      var attribute = typeof(Delegates.GetEvents).GetCustomAttribute<UnmanagedFunctionPointerAttribute>();
+      Assert.IsNotNull(attribute);
+      Assert.AreEqual(CharSet.Unicode, attribute.CharSet);
+    }
+
+    [Test]
+    public void NamesAreReadUpToTheirNullTerminator()
+    {
+      var names = "c:\\\u00e9\u6f22.txt\0\0c:\\old.txt\0".ToCharArray();
+      Assert.AreEqual("c:\\\u00e9\u6f22.txt", WatcherManagerNativeLibrary.GetName(names, 0));
+      Assert.AreEqual("", WatcherManagerNativeLibrary.GetName(names, 10));
+      Assert.AreEqual("c:\\old.txt", WatcherManagerNativeLibrary.GetName(names, 11));
+    }
+
+    [Test]
+    public void NameWithoutNullTerminatorStopsAtTheEnd()
+    {
+      var names = "c:\\file.txt".ToCharArray();
+      Assert.AreEqual("file.txt", WatcherManagerNativeLibrary.GetName(names, 3));
+    }
+  }
+}
@@ -0,0 +1,88 @@
+#include "pch.h"
+#include <thread>
+#include <vector>
+
+#include "../myoddweb.directorywatcher.win/utils/Arena.h"
+
+using myoddweb::directorywatcher::Arena;
+
+TEST(Arena, EmptyArenaHasNoCapacity) {
+  const Arena arena(1024);
+  EXPECT_EQ(0, arena.Capacity());
+}
+
+TEST(Arena, AllocationsAreAligned) {
+  Arena arena(1024);
+  for (auto i = 1; i < 20; ++i)
+  {
+    const auto memory = arena.Allocate(i);
+    EXPECT_EQ(0, reinterpret_cast<uintptr_t>(memory) % 8);
+  }
+}
+
+TEST(Arena, CopyAddsNullTerminator) {
+  Arena arena(1024);
+  const auto copy = arena.Copy(L"c:\\foo.txt", 6);
+  EXPECT_STREQ(L"c:\\foo", copy);
+}
+
+TEST(Arena, LargeAllocationsGetTheirOwnBlock) {
+  Arena arena(64);
+  const auto memory = static_cast<char*>(arena.Allocate(1000));
+  memory[999] = 'a';
+  EXPECT_LE(1000, arena.Capacity());
+}
+
+TEST(Arena, ResetReusesTheSameBlocks) {
+  Arena arena(1024);
+  for (auto i = 0; i < 100; ++i)
+  {
+    arena.Allocate(100);
+  }
+  const auto capacity = arena.Capacity();
+
+  // after a reset we should not need any more memory for the same allocations.
+  for (auto window = 0; window < 10; ++window)
+  {
+    arena.Reset();
+    for (auto i = 0; i < 100; ++i)
+    {
+      arena.Allocate(100);
+    }
+    EXPECT_EQ(capacity, arena.Capacity());
+  }
+}
+
+TEST(Arena, MultipleThreadsGetDifferentMemory) {
+  Arena arena(256);
+  constexpr auto numberOfThreads = 4;
+  constexpr auto numberOfAllocations = 1000;
+
+  std::vector<std::vector<long long*>> allocations(numberOfThreads);
+  std::vector<std::thread> threads;
+  for (auto t = 0; t < numberOfThreads; ++t)
+  {
+    threads.emplace_back([&arena, &allocations, t]()
+    {
+      for (auto i = 0; i < numberOfAllocations; ++i)
+      {
+        const auto memory = static_cast<long long*>(arena.Allocate(sizeof(long long)));
+        *memory = t * numberOfAllocations + i;
+        allocations[t].push_back(memory);
+      }
+    });
+  }
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+
+  // nobody overwrote anybody else's memory.
+  for (auto t = 0; t < numberOfThreads; ++t)
+  {
+    for (auto i = 0; i < numberOfAllocations; ++i)
+    {
+      EXPECT_EQ(t * numberOfAllocations + i, *allocations[t][i]);
+    }
+  }
+}
@@ -1,4 +1,9 @@
 #include "pch.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
 
 #include "../myoddweb.directorywatcher.win/utils/Collector.h"
 #include "../myoddweb.directorywatcher.win/utils/Event.h"
@@ -9,6 +14,7 @@ using myoddweb::directorywatcher::Collector;
 using myoddweb::directorywatcher::Event;
 using myoddweb::directorywatcher::EventError;
 using myoddweb::directorywatcher::EventAction;
+using myoddweb::directorywatcher::OverflowPolicy;
 
 constexpr auto MaxCleanupAgeMilliseconds = 100;
 
@@ -35,7 +41,6 @@ TEST(Collector, PathIsValidWithTwoBackSlash) {
   EXPECT_EQ(1, events.size() );
 
   EXPECT_TRUE(wcscmp(L"c:\\foo\\bar.txt", events[0]->Name) == 0);
-  delete events[0];
 }
 
 TEST(Collector, PathIsValidWithOneBackSlashOnPath) {
@@ -50,7 +55,6 @@ TEST(Collector, PathIsValidWithOneBackSlashOnPath) {
   EXPECT_EQ(1, events.size() );
 
   EXPECT_TRUE(wcscmp(L"c:\\foo\\bar.txt", events[0]->Name) == 0);
-  delete events[0];
 }
 
 TEST(Collector, PathIsValidWithOneBackSlashOnFileName) {
@@ -65,5 +69,555 @@ TEST(Collector, PathIsValidWithOneBackSlashOnFileName) {
   EXPECT_EQ(1, events.size() );
 
   EXPECT_TRUE(wcscmp(L"c:\\foo\\bar.txt", events[0]->Name)==0);
-  delete events[0];
-}
\ No newline at end of file
+}
+
+TEST(Collector, OlderDuplicatesAreRemoved) {
+
+  // create new one.
+  Collector c(MaxCleanupAgeMilliseconds);
+  c.Add(EventAction::Touched, L"c:\\", L"foo.txt", true, EventError::None);
+  c.Add(EventAction::Touched, L"c:\\", L"bar.txt", true, EventError::None);
+  c.Add(EventAction::Touched, L"c:\\", L"foo.txt", true, EventError::None);
+
+  // not the same action, so not a duplicate
+  c.Add(EventAction::Removed, L"c:\\", L"foo.txt", true, EventError::None);
+
+  // not the same type, so not a duplicate
+  c.Add(EventAction::Touched, L"c:\\", L"foo.txt", false, EventError::None);
+
+  // get it.
+  std::vector<Event*> events;
+  c.GetEvents(events);
+  ASSERT_EQ(4, events.size());
+
+  // the newest of the duplicates is kept, in the order they were added.
+  EXPECT_TRUE(wcscmp(L"c:\\bar.txt", events[0]->Name) == 0);
+  EXPECT_TRUE(wcscmp(L"c:\\foo.txt", events[1]->Name) == 0);
+  EXPECT_EQ(static_cast<int>(EventAction::Touched), events[1]->Action);
+  EXPECT_TRUE(events[1]->IsFile);
+  EXPECT_EQ(static_cast<int>(EventAction::Removed), events[2]->Action);
+  EXPECT_FALSE(events[3]->IsFile);
+}
+
+TEST(Collector, EventsAlreadyGivenToTheCallerAreDuplicates) {
+
+  // the caller already has the events of another collector.
+  Collector other(MaxCleanupAgeMilliseconds);
+  other.Add(EventAction::Touched, L"c:\\", L"foo.txt", true, EventError::None);
+  std::vector<Event*> events;
+  other.GetEvents(events);
+  ASSERT_EQ(1, events.size());
+
+  Collector c(MaxCleanupAgeMilliseconds);
+  c.Add(EventAction::Touched, L"c:\\", L"foo.txt", true, EventError::None);
+  c.Add(EventAction::Touched, L"c:\\", L"bar.txt", true, EventError::None);
+  c.GetEvents(events);
+  ASSERT_EQ(2, events.size());
+  EXPECT_TRUE(wcscmp(L"c:\\foo.txt", events[0]->Name) == 0);
+  EXPECT_TRUE(wcscmp(L"c:\\bar.txt", events[1]->Name) == 0);
+}
+
+TEST(Collector, EventsAreReturnedInTheOrderTheyWereAdded) {
+
+  // create new one.
+  Collector c(MaxCleanupAgeMilliseconds);
+  constexpr auto numberOfEvents = 100;
+  for (auto i = 0; i < numberOfEvents; ++i)
+  {
+    c.Add(EventAction::Added, L"c:\\", std::to_wstring(i), true, EventError::None);
+  }
+
+  // get it.
+  std::vector<Event*> events;
+  c.GetEvents(events);
+  ASSERT_EQ(numberOfEvents, events.size());
+
+  for (auto i = 0; i < numberOfEvents; ++i)
+  {
+    EXPECT_EQ(L"c:\\" + std::to_wstring(i), std::wstring(events[i]->Name));
+  }
+}
+
+/**
+ * \brief benchmark of GetEvents with a large number of events
+ *        run with --gtest_also_run_disabled_tests
+ *        the time should grow linearly with the number of events.
+ */
+TEST(Collector, DISABLED_BenchmarkGetEventsWithManyEvents) {
+
+  for (auto numberOfEvents : { 250000, 500000, 1000000 })
+  {
+    // make sure that nothing is cleaned up while we are adding.
+    Collector c(60000);
+    for (auto i = 0; i < numberOfEvents; ++i)
+    {
+      // every 10th event is a duplicate
+      c.Add(EventAction::Touched, L"c:\\", std::to_wstring(i % 10 == 0 ? 0 : i), true, EventError::None);
+    }
+
+    const auto start = std::chrono::high_resolution_clock::now();
+    std::vector<Event*> events;
+    c.GetEvents(events);
+    const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start).count();
+
+    std::cout << "[          ] " << numberOfEvents << " events, " << events.size() << " unique, in " << elapsed << "ms" << std::endl;
+  }
+}
+
+TEST(Collector, MoreEventsThanTheRingCanHoldAreNotLost) {
+
+  // create new one.
+  Collector c(MaxCleanupAgeMilliseconds);
+  constexpr auto numberOfEvents = myoddweb::directorywatcher::MYODDWEB_EVENTS_RING_CAPACITY * 3;
+  for (auto i = 0; i < numberOfEvents; ++i)
+  {
+    c.Add(EventAction::Added, L"c:\\", std::to_wstring(i), true, EventError::None);
+  }
+
+  // get it.
+  std::vector<Event*> events;
+  c.GetEvents(events);
+  ASSERT_EQ(numberOfEvents, events.size());
+  EXPECT_LT(0, c.FullRingCount());
+
+  for (auto i = 0; i < numberOfEvents; ++i)
+  {
+    EXPECT_EQ(L"c:\\" + std::to_wstring(i), std::wstring(events[i]->Name));
+  }
+}
+
+TEST(Collector, EventsAreValidUntilTheNextGetEvents) {
+
+  // create new one.
+  Collector c(MaxCleanupAgeMilliseconds);
+  c.Add(EventAction::Added, L"c:\\", L"foo.txt", true, EventError::None);
+
+  std::vector<Event*> first;
+  c.GetEvents(first);
+  ASSERT_EQ(1, first.size());
+
+  // add more events, the first ones must still be valid.
+  c.Add(EventAction::Added, L"c:\\", L"bar.txt", true, EventError::None);
+  EXPECT_TRUE(wcscmp(L"c:\\foo.txt", first[0]->Name) == 0);
+
+  std::vector<Event*> second;
+  c.GetEvents(second);
+  ASSERT_EQ(1, second.size());
+  EXPECT_TRUE(wcscmp(L"c:\\bar.txt", second[0]->Name) == 0);
+}
+
+TEST(Collector, RenameKeepsBothNames) {
+
+  // create new one.
+  Collector c(MaxCleanupAgeMilliseconds);
+  c.AddRename(L"c:\\", L"new.txt", L"old.txt", true, EventError::None);
+
+  std::vector<Event*> events;
+  c.GetEvents(events);
+  ASSERT_EQ(1, events.size());
+  EXPECT_TRUE(wcscmp(L"c:\\new.txt", events[0]->Name) == 0);
+  EXPECT_TRUE(wcscmp(L"c:\\old.txt", events[0]->OldName) == 0);
+}
+
+TEST(Collector, OldestEventsAreDroppedWhenWeHaveTooManyEvents) {
+
+  // create new one.
+  Collector c(MaxCleanupAgeMilliseconds, L"c:\\", 10, 0, OverflowPolicy::DropOldest, 1, 0);
+  for (auto i = 0; i < 15; ++i)
+  {
+    c.Add(EventAction::Added, L"c:\\", L"file" + std::to_wstring(i) + L".txt", true, EventError::None);
+  }
+
+  std::vector<Event*> events;
+  c.GetEvents(events);
+  ASSERT_LE(events.size(), 11);
+  EXPECT_LT(0, c.DroppedCount());
+
+  // the newest event is still there but not the oldest
+  EXPECT_TRUE(wcscmp(L"c:\\file14.txt", events[events.size() - 2]->Name) == 0);
+  for (const auto& e : events)
+  {
+    EXPECT_FALSE(wcscmp(L"c:\\file0.txt", e->Name) == 0);
+  }
+
+  // and the last event tells us that we dropped some events.
+  const auto& overflow = events.back();
+  EXPECT_EQ(static_cast<int>(EventAction::Unknown), overflow->Action);
+  EXPECT_EQ(static_cast<int>(EventError::Overflow), overflow->Error);
+  EXPECT_TRUE(wcscmp(L"c:\\", overflow->Name) == 0);
+}
+
+TEST(Collector, TouchedEventsAreDroppedFirst) {
+
+  // create new one.
+  Collector c(MaxCleanupAgeMilliseconds, L"c:\\", 10, 0, OverflowPolicy::DropTouchedFirst, 1, 0);
+  for (auto i = 0; i < 5; ++i)
+  {
+    c.Add(EventAction::Added, L"c:\\", L"added" + std::to_wstring(i) + L".txt", true, EventError::None);
+  }
+  for (auto i = 0; i < 10; ++i)
+  {
+    c.Add(EventAction::Touched, L"c:\\", L"touched" + std::to_wstring(i) + L".txt", true, EventError::None);
+  }
+
+  std::vector<Event*> events;
+  c.GetEvents(events);
+  ASSERT_LE(events.size(), 11);
+
+  // all the added events are still there.
+  auto added = 0;
+  for (const auto& e : events)
+  {
+    if (e->Action == static_cast<int>(EventAction::Added))
+    {
+      ++added;
+    }
+  }
+  EXPECT_EQ(5, added);
+  EXPECT_EQ(static_cast<int>(EventError::Overflow), events.back()->Error);
+}
+
+TEST(Collector, EventsAreCollapsedToTheirFolder) {
+
+  // create new one.
+  Collector c(MaxCleanupAgeMilliseconds, L"c:\\", 10, 0, OverflowPolicy::CollapseToDirectory, 1, 0);
+  for (auto i = 0; i < 11; ++i)
+  {
+    c.Add(EventAction::Added, L"c:\\", L"foo\\file" + std::to_wstring(i) + L".txt", true, EventError::None);
+  }
+
+  std::vector<Event*> events;
+  c.GetEvents(events);
+
+  // a single event for the folder and the overflow event.
+  ASSERT_EQ(2, events.size());
+  EXPECT_TRUE(wcscmp(L"c:\\foo", events[0]->Name) == 0);
+  EXPECT_EQ(static_cast<int>(EventAction::Touched), events[0]->Action);
+  EXPECT_FALSE(events[0]->IsFile);
+  EXPECT_EQ(static_cast<int>(EventError::Overflow), events[1]->Error);
+}
+
+TEST(Collector, NumberOfBytesIsLimited) {
+
+  // create new one.
+  Collector c(MaxCleanupAgeMilliseconds, L"c:\\", 0, 4096, OverflowPolicy::DropOldest, 1, 0);
+  for (auto i = 0; i < 1000; ++i)
+  {
+    c.Add(EventAction::Added, L"c:\\", L"file" + std::to_wstring(i) + L".txt", true, EventError::None);
+  }
+
+  std::vector<Event*> events;
+  c.GetEvents(events);
+  ASSERT_LT(events.size(), 100);
+  EXPECT_EQ(static_cast<int>(EventError::Overflow), events.back()->Error);
+}
+
+TEST(Collector, EventsAreAddedAgainAfterAnOverflow) {
+
+  // create new one.
+  Collector c(MaxCleanupAgeMilliseconds, L"c:\\", 10, 0, OverflowPolicy::DropOldest, 1, 0);
+  for (auto i = 0; i < 100; ++i)
+  {
+    c.Add(EventAction::Added, L"c:\\", L"file" + std::to_wstring(i) + L".txt", true, EventError::None);
+  }
+
+  std::vector<Event*> events;
+  c.GetEvents(events);
+  ASSERT_LE(events.size(), 11);
+  EXPECT_EQ(static_cast<int>(EventError::Overflow), events.back()->Error);
+
+  // we are in a new window, so we can add events again.
+  c.Add(EventAction::Added, L"c:\\", L"new.txt", true, EventError::None);
+
+  events.clear();
+  c.GetEvents(events);
+  ASSERT_EQ(1, events.size());
+  EXPECT_TRUE(wcscmp(L"c:\\new.txt", events[0]->Name) == 0);
+}
+
+TEST(Collector, RemovedEventsDoNotKeepTheirMemory) {
+
+  // create new one, we never get the events so they are only ever removed because of the limit.
+  constexpr auto maxNumberOfBytes = 64 * 1024;
+  Collector c(MaxCleanupAgeMilliseconds, L"c:\\", 0, maxNumberOfBytes, OverflowPolicy::DropOldest, 1, 0);
+  constexpr auto numberOfEvents = 100000;
+  for (auto i = 0; i < numberOfEvents; ++i)
+  {
+    c.Add(EventAction::Added, L"c:\\", L"file" + std::to_wstring(i) + L".txt", true, EventError::None);
+  }
+
+  // the memory of the removed events was reused.
+  EXPECT_LT(c.ArenasCapacity(), static_cast<size_t>(16 * maxNumberOfBytes));
+
+  // and we are still adding the new events.
+  std::vector<Event*> events;
+  c.GetEvents(events);
+  ASSERT_LE(2, events.size());
+  EXPECT_TRUE(wcscmp((L"c:\\file" + std::to_wstring(numberOfEvents - 1) + L".txt").c_str(), events[events.size() - 2]->Name) == 0);
+  EXPECT_EQ(static_cast<int>(EventError::Overflow), events.back()->Error);
+}
+
+TEST(Collector, EventsFromDifferentRootsAreNotDuplicates) {
+
+  // create new one.
+  Collector c(MaxCleanupAgeMilliseconds);
+  c.Add(EventAction::Touched, L"c:\\foo", L"bar.txt", true, EventError::None);
+  c.Add(EventAction::Touched, L"c:\\baz", L"bar.txt", true, EventError::None);
+  c.Add(EventAction::Touched, L"c:\\foo", L"\\bar.txt", true, EventError::None);
+
+  std::vector<Event*> events;
+  c.GetEvents(events);
+  ASSERT_EQ(2, events.size());
+  EXPECT_TRUE(wcscmp(L"c:\\baz\\bar.txt", events[0]->Name) == 0);
+  EXPECT_TRUE(wcscmp(L"c:\\foo\\bar.txt", events[1]->Name) == 0);
+}
+
+TEST(Collector, FolderWithoutNameIsTheRoot) {
+
+  // create new one.
+  Collector c(MaxCleanupAgeMilliseconds);
+  c.Add(EventAction::Unknown, L"c:\\foo\\", L"", false, EventError::Overflow);
+  c.Add(EventAction::Touched, L"c:\\foo\\", L"", true, EventError::None);
+
+  std::vector<Event*> events;
+  c.GetEvents(events);
+  ASSERT_EQ(2, events.size());
+  EXPECT_TRUE(wcscmp(L"c:\\foo\\", events[0]->Name) == 0);
+  EXPECT_TRUE(wcscmp(L"", events[1]->Name) == 0);
+}
+
+TEST(Collector, ShardedEventsAreMergedInTimeOrder) {
+
+  // create new one.
+  Collector c(60000, L"c:\\", 0, 0, OverflowPolicy::DropOldest, 4, 0);
+  ASSERT_EQ(4, c.NumberOfShards());
+
+  std::vector<std::thread> threads;
+  for (auto t = 0; t < 4; ++t)
+  {
+    threads.emplace_back([&c, t]()
+    {
+      for (auto i = 0; i < 500; ++i)
+      {
+        c.Add(EventAction::Added, L"c:\\", std::to_wstring(t) + L"-" + std::to_wstring(i), true, EventError::None);
+      }
+    });
+  }
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+
+  std::vector<Event*> events;
+  c.GetEvents(events);
+  ASSERT_EQ(2000, events.size());
+  for (size_t i = 1; i < events.size(); ++i)
+  {
+    EXPECT_LE(events[i - 1]->TimeMillisecondsUtc, events[i]->TimeMillisecondsUtc);
+  }
+}
+
+TEST(Collector, NumberOfShardsIsAlwaysValid) {
+  EXPECT_EQ(1, Collector(MaxCleanupAgeMilliseconds).NumberOfShards());
+  EXPECT_EQ(1, Collector(MaxCleanupAgeMilliseconds, L"c:\\", 0, 0, OverflowPolicy::DropOldest, 0, 0).NumberOfShards());
+  EXPECT_EQ(1, Collector(MaxCleanupAgeMilliseconds, L"c:\\", 0, 0, OverflowPolicy::DropOldest, -1, 0).NumberOfShards());
+  EXPECT_EQ(64, Collector(MaxCleanupAgeMilliseconds, L"c:\\", 0, 0, OverflowPolicy::DropOldest, 1000, 0).NumberOfShards());
+}
+
+TEST(Collector, DISABLED_BenchmarkIngestionWithManyProducers) {
+
+  const auto maxThreads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+  constexpr auto numberOfEventsPerThread = 200000;
+  for (auto numberOfThreads = 1; numberOfThreads <= maxThreads; numberOfThreads *= 2)
+  {
+    // one shard for all the threads, then one shard per thread.
+    std::vector<int> shards = { 1 };
+    if (numberOfThreads > 1)
+    {
+      shards.push_back(numberOfThreads);
+    }
+    for (auto numberOfShards : shards)
+    {
+      // make sure that nothing is cleaned up while we are adding.
+      Collector c(600000, L"c:\\", 0, 0, OverflowPolicy::DropOldest, numberOfShards, 0);
+
+      const auto start = std::chrono::high_resolution_clock::now();
+      std::vector<std::thread> threads;
+      for (auto t = 0; t < numberOfThreads; ++t)
+      {
+        threads.emplace_back([&c]()
+        {
+          for (auto i = 0; i < numberOfEventsPerThread; ++i)
+          {
+            c.Add(EventAction::Touched, L"c:\\", L"foo.txt", true, EventError::None);
+          }
+        });
+      }
+      for (auto& thread : threads)
+      {
+        thread.join();
+      }
+      const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start).count();
+
+      std::vector<Event*> events;
+      c.GetEvents(events);
+
+      const auto total = static_cast<long long>(numberOfThreads) * numberOfEventsPerThread;
+      std::cout << "[          ] " << numberOfThreads << " threads, " << numberOfShards << " shards, " << total << " events in " << elapsed << "ms, "
+        << (elapsed == 0 ? total : total * 1000 / elapsed) << " events/s, contention " << c.ContentionCount() << std::endl;
+    }
+  }
+}
+
+TEST(Collector, HalfRenamesArePairedAcrossDrains) {
+
+  // create new one.
+  Collector c(60000, L"c:\\", 0, 0, OverflowPolicy::DropOldest, 1, 60000);
+  c.AddRename(L"c:\\", L"", L"old.txt", true, EventError::None);
+
+  // the other half has not arrived yet.
+  std::vector<Event*> events;
+  c.GetEvents(events);
+  ASSERT_EQ(0, events.size());
+
+  c.AddRename(L"c:\\", L"new.txt", L"", true, EventError::None);
+  c.GetEvents(events);
+  ASSERT_EQ(1, events.size());
+  EXPECT_EQ(static_cast<int>(EventAction::Renamed), events[0]->Action);
+  EXPECT_TRUE(wcscmp(L"c:\\new.txt", events[0]->Name) == 0);
+  EXPECT_TRUE(wcscmp(L"c:\\old.txt", events[0]->OldName) == 0);
+  EXPECT_EQ(1, c.RenamesMatchedCount());
+  EXPECT_EQ(0, c.RenamesTimedOutCount());
+}
+
+TEST(Collector, HalfRenamesOfDifferentRootsAreNotPaired) {
+
+  // create new one.
+  Collector c(60000, L"c:\\", 0, 0, OverflowPolicy::DropOldest, 1, 60000);
+  c.AddRename(L"c:\\foo", L"", L"old.txt", true, EventError::None);
+  c.AddRename(L"c:\\bar", L"new.txt", L"", true, EventError::None);
+  EXPECT_EQ(0, c.RenamesMatchedCount());
+}
+
+TEST(Collector, HalfRenamesThatAreNotPairedAreAddedOrRemoved) {
+
+  // create new one.
+  Collector c(60000, L"c:\\", 0, 0, OverflowPolicy::DropOldest, 1, 1);
+  c.AddRename(L"c:\\", L"", L"old.txt", true, EventError::None);
+  c.AddRename(L"c:\\foo", L"new.txt", L"", true, EventError::None);
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+  std::vector<Event*> events;
+  c.GetEvents(events);
+  ASSERT_EQ(2, events.size());
+  EXPECT_EQ(static_cast<int>(EventAction::Removed), events[0]->Action);
+  EXPECT_TRUE(wcscmp(L"c:\\old.txt", events[0]->Name) == 0);
+  EXPECT_EQ(static_cast<int>(EventAction::Added), events[1]->Action);
+  EXPECT_TRUE(wcscmp(L"c:\\foo\\new.txt", events[1]->Name) == 0);
+  EXPECT_EQ(0, c.RenamesMatchedCount());
+  EXPECT_EQ(2, c.RenamesTimedOutCount());
+  EXPECT_LE(2, c.RenamesLatencyMilliseconds());
+}
+
+TEST(Collector, PendingRenamesExpireAfterThePairingTime) {
+
+  // create new one.
+  Collector c(60000, L"c:\\", 0, 0, OverflowPolicy::DropOldest, 1, 60000);
+  EXPECT_EQ(-1, c.PendingRenamesMilliseconds());
+
+  c.AddRename(L"c:\\", L"new.txt", L"", true, EventError::None);
+  EXPECT_LT(0, c.PendingRenamesMilliseconds());
+  EXPECT_GE(60000, c.PendingRenamesMilliseconds());
+
+  // the other half pairs it, nothing is pending anymore.
+  c.AddRename(L"c:\\", L"", L"old.txt", true, EventError::None);
+  EXPECT_EQ(-1, c.PendingRenamesMilliseconds());
+}
+
+TEST(Collector, HalfRenamesAreNotHeldIfWeDoNotPairThem) {
+
+  // create new one.
+  Collector c(MaxCleanupAgeMilliseconds);
+  c.AddRename(L"c:\\", L"", L"old.txt", true, EventError::None);
+
+  std::vector<Event*> events;
+  c.GetEvents(events);
+  ASSERT_EQ(1, events.size());
+  EXPECT_EQ(static_cast<int>(EventAction::Removed), events[0]->Action);
+}
+
+TEST(Collector, EventNamesArePackedWithTheEvent) {
+
+  // create new one.
+  Collector c(MaxCleanupAgeMilliseconds);
+  c.AddRename(L"c:\\", L"new.txt", L"old.txt", true, EventError::None);
+
+  std::vector<Event*> events;
+  c.GetEvents(events);
+  ASSERT_EQ(1, events.size());
+
+  // the names are right after the event, in the same allocation.
+  const auto name = reinterpret_cast<const wchar_t*>(events[0] + 1);
+  EXPECT_EQ(name, events[0]->Name);
+  EXPECT_EQ(name + wcslen(name) + 1, events[0]->OldName);
+  EXPECT_TRUE(wcscmp(L"c:\\new.txt", events[0]->Name) == 0);
+  EXPECT_TRUE(wcscmp(L"c:\\old.txt", events[0]->OldName) == 0);
+}
+
+TEST(Collector, EventsSignalIsNotifiedWhenEventsAreAdded) {
+
+  // create new one.
+  myoddweb::directorywatcher::EventsSignal signal;
+  Collector c(MaxCleanupAgeMilliseconds);
+  c.SetEventsSignal(&signal);
+  c.Add(EventAction::Added, L"c:\\", L"foo.txt", true, EventError::None);
+  c.Add(EventAction::Added, L"c:\\", L"bar.txt", true, EventError::None);
+  EXPECT_EQ(2, signal.Reset());
+
+  // getting the events does not change the signal.
+  std::vector<Event*> events;
+  c.GetEvents(events);
+  EXPECT_EQ(0, signal.Reset());
+}
+
+TEST(Collector, MergedEventsAreInTimeOrder) {
+  Event a1(L"a1", L"", static_cast<int>(EventAction::Added), static_cast<int>(EventError::None), 10, true);
+  Event a2(L"a2", L"", static_cast<int>(EventAction::Added), static_cast<int>(EventError::None), 30, true);
+  Event b1(L"b1", L"", static_cast<int>(EventAction::Added), static_cast<int>(EventError::None), 20, true);
+  Event b2(L"b2", L"", static_cast<int>(EventAction::Added), static_cast<int>(EventError::None), 40, true);
+  Event c1(L"c1", L"", static_cast<int>(EventAction::Added), static_cast<int>(EventError::None), 5, true);
+
+  std::vector<std::vector<Event*>> sources = { { &a1, &a2 }, { &b1, &b2 }, { &c1 } };
+  std::vector<Event*> events;
+  Collector::MergeByTimeMillisecondsUtc(sources, sources.size(), events);
+
+  const std::vector<Event*> expected = { &c1, &a1, &b1, &a2, &b2 };
+  EXPECT_EQ(expected, events);
+}
+
+TEST(Collector, MergeKeepsTheOrderOfTheListsWhenTheTimesAreTheSame) {
+  Event a1(L"a1", L"", static_cast<int>(EventAction::Added), static_cast<int>(EventError::None), 10, true);
+  Event a2(L"a2", L"", static_cast<int>(EventAction::Removed), static_cast<int>(EventError::None), 10, true);
+  Event b1(L"b1", L"", static_cast<int>(EventAction::Added), static_cast<int>(EventError::None), 10, true);
+
+  std::vector<std::vector<Event*>> sources = { { &a1, &a2 }, { &b1 } };
+  std::vector<Event*> events;
+  Collector::MergeByTimeMillisecondsUtc(sources, sources.size(), events);
+
+  const std::vector<Event*> expected = { &a1, &a2, &b1 };
+  EXPECT_EQ(expected, events);
+}
+
+TEST(Collector, MergeOnlyUsesTheGivenNumberOfListsAndSortsTheOnesOutOfOrder) {
+  Event a1(L"a1", L"", static_cast<int>(EventAction::Added), static_cast<int>(EventError::None), 30, true);
+  Event a2(L"a2", L"", static_cast<int>(EventAction::Added), static_cast<int>(EventError::None), 10, true);
+  Event b1(L"b1", L"", static_cast<int>(EventAction::Added), static_cast<int>(EventError::None), 20, true);
+
+  // the last list is not used.
+  std::vector<std::vector<Event*>> sources = { { &a1, &a2 }, { }, { &b1 } };
+  std::vector<Event*> events;
+  Collector::MergeByTimeMillisecondsUtc(sources, 2, events);
+
+  const std::vector<Event*> expected = { &a2, &a1 };
+  EXPECT_EQ(expected, events);
+}
@@ -0,0 +1,156 @@
+#include "pch.h"
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../myoddweb.directorywatcher.win/utils/EventsBatch.h"
+
+using myoddweb::directorywatcher::EventsBatch;
+using myoddweb::directorywatcher::Event;
+using myoddweb::directorywatcher::sEvent;
+using myoddweb::directorywatcher::EventCallback;
+using myoddweb::directorywatcher::EventsBatchCallback;
+
+/**
+ * \brief create events with the time going from 0 to names.size()-1
+ */
+static std::vector<Event*> CreateEvents(const std::vector<std::wstring>& names)
+{
+  std::vector<Event*> events;
+  for (size_t i = 0; i < names.size(); ++i)
+  {
+    events.push_back(new Event(names[i].c_str(), L"", 1, 0, static_cast<long long>(i), true));
+  }
+  return events;
+}
+
+static void DeleteEvents(std::vector<Event*>& events)
+{
+  for (const auto& event : events)
+  {
+    delete event;
+  }
+  events.clear();
+}
+
+TEST(EventsBatch, EmptyBatchHasNoEvents) {
+  EventsBatch batch;
+  batch.Assign({});
+  EXPECT_EQ(0, batch.NumberOfEvents());
+  EXPECT_EQ(0, batch.NumberOfCharacters());
+}
+
+TEST(EventsBatch, EventsArePackedInOrder) {
+  const std::vector<std::wstring> names = { L"c:\\foo.txt", L"c:\\bar.txt" };
+  auto events = CreateEvents(names);
+  events.push_back(new Event(L"c:\\new.txt", L"c:\\old.txt", 4, 0, 2, false));
+
+  EventsBatch batch;
+  batch.Assign(events);
+  ASSERT_EQ(3, batch.NumberOfEvents());
+
+  const auto packed = batch.Events();
+  const auto packedNames = batch.Names();
+  for (auto i = 0; i < 3; ++i)
+  {
+    EXPECT_EQ(i, packed[i].DateTimeUtc);
+    EXPECT_TRUE(wcscmp(events[i]->Name, packedNames + packed[i].Name) == 0);
+    EXPECT_TRUE(wcscmp(events[i]->OldName, packedNames + packed[i].OldName) == 0);
+    EXPECT_EQ(events[i]->Action, packed[i].Action);
+    EXPECT_EQ(events[i]->IsFile ? 1 : 0, packed[i].IsFile);
+  }
+
+  // every name is null terminated, even the empty ones.
+  EXPECT_EQ(11 + 1 + 11 + 1 + 11 + 11, batch.NumberOfCharacters());
+  DeleteEvents(events);
+}
+
+TEST(EventsBatch, AssignReplacesThePreviousEvents) {
+  const std::vector<std::wstring> firstNames = { L"c:\\foo.txt", L"c:\\bar.txt" };
+  const std::vector<std::wstring> secondNames = { L"c:\\baz.txt" };
+  auto first = CreateEvents(firstNames);
+  auto second = CreateEvents(secondNames);
+
+  EventsBatch batch;
+  batch.Assign(first);
+  batch.Assign(second);
+  ASSERT_EQ(1, batch.NumberOfEvents());
+  EXPECT_TRUE(wcscmp(L"c:\\baz.txt", batch.Names() + batch.Events()[0].Name) == 0);
+  EXPECT_EQ(11 + 1, batch.NumberOfCharacters());
+
+  DeleteEvents(first);
+  DeleteEvents(second);
+}
+
+TEST(EventsBatch, PackDoesNothingIfTheNamesDoNotFit) {
+  const std::vector<std::wstring> names = { L"c:\\foo.txt", L"c:\\bar.txt" };
+  auto events = CreateEvents(names);
+
+  // room for the first event only.
+  sEvent packed[2] = {};
+  wchar_t buffer[20] = {};
+  size_t numberOfCharacters = 0;
+  EXPECT_TRUE(EventsBatch::Pack(*events[0], packed[0], buffer, 20, numberOfCharacters));
+  EXPECT_EQ(11 + 1, numberOfCharacters);
+  EXPECT_FALSE(EventsBatch::Pack(*events[1], packed[1], buffer, 20, numberOfCharacters));
+  EXPECT_EQ(11 + 1, numberOfCharacters);
+  EXPECT_TRUE(wcscmp(L"c:\\foo.txt", buffer + packed[0].Name) == 0);
+
+  DeleteEvents(events);
+}
+
+static long long _numberOfCalls = 0;
+static long long _numberOfEvents = 0;
+
+static void __stdcall OnEvent(long long, bool, const wchar_t*, const wchar_t*, int, int, long long)
+{
+  ++_numberOfCalls;
+  ++_numberOfEvents;
+}
+
+static void __stdcall OnEventsBatch(long long, const sEvent*, const int numberOfEvents, const wchar_t*, int)
+{
+  ++_numberOfCalls;
+  _numberOfEvents += numberOfEvents;
+}
+
+TEST(EventsBatch, DISABLED_BenchmarkPerEventAndBatchedDelivery) {
+
+  // this only measures the native side of the calls
+  // each call to a managed callback adds the cost of a reverse P/Invoke transition.
+  for (auto numberOfEvents : { 10000, 50000, 250000 })
+  {
+    std::vector<std::wstring> names;
+    for (auto i = 0; i < numberOfEvents; ++i)
+    {
+      names.push_back(L"c:\\some\\folder\\" + std::to_wstring(i) + L".txt");
+    }
+    auto events = CreateEvents(names);
+
+    // volatile so the calls are not inlined away.
+    volatile EventCallback eventCallback = &OnEvent;
+    _numberOfCalls = _numberOfEvents = 0;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (const auto& event : events)
+    {
+      eventCallback(0, event->IsFile, event->Name, event->OldName, event->Action, event->Error, event->TimeMillisecondsUtc);
+    }
+    const auto perEvent = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start).count();
+    const auto perEventCalls = _numberOfCalls;
+
+    volatile EventsBatchCallback batchCallback = &OnEventsBatch;
+    // the batch keeps its memory between publish, so we measure it once it has grown.
+    EventsBatch batch;
+    batch.Assign(events);
+    _numberOfCalls = _numberOfEvents = 0;
+    start = std::chrono::high_resolution_clock::now();
+    batch.Assign(events);
+    batchCallback(0, batch.Events(), batch.NumberOfEvents(), batch.Names(), batch.NumberOfCharacters());
+    const auto batched = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start).count();
+    EXPECT_EQ(numberOfEvents, _numberOfEvents);
+
+    std::cout << "[          ] " << numberOfEvents << " events, per event: " << perEventCalls << " calls in " << perEvent << "us, batched: " << _numberOfCalls << " call in " << batched << "us" << std::endl;
+    DeleteEvents(events);
+  }
+}
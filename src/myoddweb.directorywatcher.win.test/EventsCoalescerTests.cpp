@@ -0,0 +1,142 @@
+#include "pch.h"
+#include <vector>
+
+#include "../myoddweb.directorywatcher.win/utils/EventsCoalescer.h"
+#include "../myoddweb.directorywatcher.win/utils/Event.h"
+#include "../myoddweb.directorywatcher.win/utils/EventAction.h"
+#include "../myoddweb.directorywatcher.win/utils/EventError.h"
+
+using myoddweb::directorywatcher::EventsCoalescer;
+using myoddweb::directorywatcher::Event;
+using myoddweb::directorywatcher::EventAction;
+using myoddweb::directorywatcher::EventError;
+
+/**
+ * \brief helper class to create the events and clean them up.
+ */
+class CoalescerEvents
+{
+public:
+  CoalescerEvents() = default;
+  ~CoalescerEvents()
+  {
+    for (const auto& e : _all)
+    {
+      delete e;
+    }
+  }
+
+  void Add(const EventAction action, const wchar_t* name, const wchar_t* oldName = L"", const EventError error = EventError::None)
+  {
+    const auto e = new Event(name, oldName, static_cast<int>(action), static_cast<int>(error), static_cast<long long>(_all.size()), true);
+    _all.push_back(e);
+    Events.push_back(e);
+  }
+
+  std::vector<Event*> Events;
+
+private:
+  std::vector<Event*> _all;
+};
+
+TEST(EventsCoalescer, AddedThenRemovedCancelEachOther) {
+  CoalescerEvents e;
+  e.Add(EventAction::Added, L"c:\\foo.txt");
+  e.Add(EventAction::Touched, L"c:\\foo.txt");
+  e.Add(EventAction::Removed, L"c:\\foo.txt");
+
+  EventsCoalescer::Coalesce(e.Events);
+  EXPECT_EQ(0, e.Events.size());
+}
+
+TEST(EventsCoalescer, TouchesAreFoldedIntoTheAdd) {
+  CoalescerEvents e;
+  e.Add(EventAction::Added, L"c:\\foo.txt");
+  e.Add(EventAction::Touched, L"c:\\foo.txt");
+  e.Add(EventAction::Touched, L"c:\\foo.txt");
+
+  EventsCoalescer::Coalesce(e.Events);
+  ASSERT_EQ(1, e.Events.size());
+  EXPECT_EQ(static_cast<int>(EventAction::Added), e.Events[0]->Action);
+}
+
+TEST(EventsCoalescer, TouchesBeforeARemoveAreDropped) {
+  CoalescerEvents e;
+  e.Add(EventAction::Touched, L"c:\\foo.txt");
+  e.Add(EventAction::Touched, L"c:\\bar.txt");
+  e.Add(EventAction::Removed, L"c:\\foo.txt");
+
+  EventsCoalescer::Coalesce(e.Events);
+  ASSERT_EQ(2, e.Events.size());
+  EXPECT_STREQ(L"c:\\bar.txt", e.Events[0]->Name);
+  EXPECT_EQ(static_cast<int>(EventAction::Removed), e.Events[1]->Action);
+  EXPECT_STREQ(L"c:\\foo.txt", e.Events[1]->Name);
+}
+
+TEST(EventsCoalescer, RenameChainsAreCollapsed) {
+  CoalescerEvents e;
+  e.Add(EventAction::Renamed, L"c:\\b.txt", L"c:\\a.txt");
+  e.Add(EventAction::Renamed, L"c:\\c.txt", L"c:\\b.txt");
+  e.Add(EventAction::Renamed, L"c:\\d.txt", L"c:\\c.txt");
+
+  EventsCoalescer::Coalesce(e.Events);
+  ASSERT_EQ(1, e.Events.size());
+  EXPECT_EQ(static_cast<int>(EventAction::Renamed), e.Events[0]->Action);
+  EXPECT_STREQ(L"c:\\d.txt", e.Events[0]->Name);
+  EXPECT_STREQ(L"c:\\a.txt", e.Events[0]->OldName);
+}
+
+TEST(EventsCoalescer, RenamedBackToTheOriginalNameIsDropped) {
+  CoalescerEvents e;
+  e.Add(EventAction::Renamed, L"c:\\b.txt", L"c:\\a.txt");
+  e.Add(EventAction::Renamed, L"c:\\a.txt", L"c:\\b.txt");
+
+  EventsCoalescer::Coalesce(e.Events);
+  EXPECT_EQ(0, e.Events.size());
+}
+
+TEST(EventsCoalescer, AddedThenRenamedIsAddedWithTheNewName) {
+  CoalescerEvents e;
+  e.Add(EventAction::Added, L"c:\\a.txt");
+  e.Add(EventAction::Touched, L"c:\\a.txt");
+  e.Add(EventAction::Renamed, L"c:\\b.txt", L"c:\\a.txt");
+
+  EventsCoalescer::Coalesce(e.Events);
+  ASSERT_EQ(1, e.Events.size());
+  EXPECT_EQ(static_cast<int>(EventAction::Added), e.Events[0]->Action);
+  EXPECT_STREQ(L"c:\\b.txt", e.Events[0]->Name);
+}
+
+TEST(EventsCoalescer, RenamedThenRemovedIsARemoveOfTheOriginalName) {
+  CoalescerEvents e;
+  e.Add(EventAction::Renamed, L"c:\\b.txt", L"c:\\a.txt");
+  e.Add(EventAction::Touched, L"c:\\b.txt");
+  e.Add(EventAction::Removed, L"c:\\b.txt");
+
+  EventsCoalescer::Coalesce(e.Events);
+  ASSERT_EQ(1, e.Events.size());
+  EXPECT_EQ(static_cast<int>(EventAction::Removed), e.Events[0]->Action);
+  EXPECT_STREQ(L"c:\\a.txt", e.Events[0]->Name);
+}
+
+TEST(EventsCoalescer, RemovedThenAddedAreBothKept) {
+  CoalescerEvents e;
+  e.Add(EventAction::Removed, L"c:\\a.txt");
+  e.Add(EventAction::Added, L"c:\\a.txt");
+
+  EventsCoalescer::Coalesce(e.Events);
+  ASSERT_EQ(2, e.Events.size());
+  EXPECT_EQ(static_cast<int>(EventAction::Removed), e.Events[0]->Action);
+  EXPECT_EQ(static_cast<int>(EventAction::Added), e.Events[1]->Action);
+}
+
+TEST(EventsCoalescer, ErrorsAreNeverCoalesced) {
+  CoalescerEvents e;
+  e.Add(EventAction::Added, L"c:\\a.txt");
+  e.Add(EventAction::Unknown, L"c:\\a.txt", L"", EventError::Overflow);
+  e.Add(EventAction::Removed, L"c:\\a.txt");
+
+  EventsCoalescer::Coalesce(e.Events);
+  ASSERT_EQ(1, e.Events.size());
+  EXPECT_EQ(static_cast<int>(EventError::Overflow), e.Events[0]->Error);
+}
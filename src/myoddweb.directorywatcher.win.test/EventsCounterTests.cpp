@@ -0,0 +1,72 @@
+#include "pch.h"
+#include <thread>
+#include <vector>
+
+#include "../myoddweb.directorywatcher.win/utils/EventsCounter.h"
+
+using myoddweb::directorywatcher::EventsCounter;
+using myoddweb::directorywatcher::EventAction;
+using myoddweb::directorywatcher::EventError;
+
+TEST(EventsCounter, ActionsAreCountedSeparately) {
+  EventsCounter counter;
+  counter.Add(EventAction::Added);
+  counter.Add(EventAction::Added);
+  counter.Add(EventAction::Removed);
+  counter.Add(EventAction::Touched);
+  counter.Add(EventAction::Renamed);
+  counter.Add(EventAction::Unknown);
+
+  const auto counts = counter.Reset();
+  EXPECT_EQ(6, counts.numberOfEvents);
+  EXPECT_EQ(2, counts.numberOfAdded);
+  EXPECT_EQ(1, counts.numberOfRemoved);
+  EXPECT_EQ(1, counts.numberOfTouched);
+  EXPECT_EQ(1, counts.numberOfRenamed);
+  EXPECT_EQ(0, counts.numberOfErrors);
+}
+
+TEST(EventsCounter, ErrorsAreCounted) {
+  EventsCounter counter;
+  counter.AddError(EventError::Overflow);
+  counter.AddError(EventError::Memory);
+
+  const auto counts = counter.Reset();
+  EXPECT_EQ(2, counts.numberOfEvents);
+  EXPECT_EQ(2, counts.numberOfErrors);
+  EXPECT_EQ(1, counts.numberOfOverflows);
+}
+
+TEST(EventsCounter, ResetStartsAgainFromZero) {
+  EventsCounter counter;
+  counter.Add(EventAction::Touched);
+  EXPECT_EQ(1, counter.Reset().numberOfTouched);
+
+  const auto counts = counter.Reset();
+  EXPECT_EQ(0, counts.numberOfEvents);
+  EXPECT_EQ(0, counts.numberOfTouched);
+}
+
+TEST(EventsCounter, EventsFromMoreThanOneThreadAreAllCounted) {
+  EventsCounter counter;
+  const auto numberOfThreads = 4;
+  const auto numberOfEvents = 10000;
+  std::vector<std::thread> threads;
+  for (auto i = 0; i < numberOfThreads; ++i)
+  {
+    threads.emplace_back([&] {
+      for (auto j = 0; j < numberOfEvents; ++j)
+      {
+        counter.Add(EventAction::Touched);
+      }
+    });
+  }
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+
+  const auto counts = counter.Reset();
+  EXPECT_EQ(numberOfThreads * numberOfEvents, counts.numberOfEvents);
+  EXPECT_EQ(numberOfThreads * numberOfEvents, counts.numberOfTouched);
+}
@@ -0,0 +1,123 @@
+#include "pch.h"
+#include <vector>
+
+#include "../myoddweb.directorywatcher.win/utils/EventsDeque.h"
+#include "../myoddweb.directorywatcher.win/utils/EventInformation.h"
+
+using myoddweb::directorywatcher::EventsDeque;
+using myoddweb::directorywatcher::EventInformation;
+using myoddweb::directorywatcher::EventAction;
+using myoddweb::directorywatcher::EventError;
+
+/**
+ * \brief create events with the time going from 0 to count-1
+ */
+static std::vector<EventInformation*> CreateEvents(const int count)
+{
+  std::vector<EventInformation*> events;
+  for (auto i = 0; i < count; ++i)
+  {
+    events.push_back(new EventInformation(i, EventAction::Added, EventError::None, 0, L"foo.txt", L"", true));
+  }
+  return events;
+}
+
+static void DeleteEvents(std::vector<EventInformation*>& events)
+{
+  for (const auto& e : events)
+  {
+    delete e;
+  }
+  events.clear();
+}
+
+TEST(EventsDeque, EmptyDequeHasNoEvents) {
+  const EventsDeque deque(4);
+  EXPECT_TRUE(deque.Empty());
+  EXPECT_EQ(0, deque.Size());
+  EXPECT_EQ(0, deque.CountNotNewerThan(100));
+}
+
+TEST(EventsDeque, EventsAreKeptInOrderAcrossSegments) {
+  auto events = CreateEvents(10);
+  EventsDeque deque(4);
+  for (const auto& e : events)
+  {
+    deque.PushBack(e);
+  }
+
+  ASSERT_EQ(10, deque.Size());
+  EXPECT_EQ(events[0], deque.Front());
+  for (size_t i = 0; i < events.size(); ++i)
+  {
+    EXPECT_EQ(events[i], deque[i]);
+  }
+  DeleteEvents(events);
+}
+
+TEST(EventsDeque, PopFrontKeepsTheOtherEvents) {
+  auto events = CreateEvents(10);
+  EventsDeque deque(4);
+  for (const auto& e : events)
+  {
+    deque.PushBack(e);
+  }
+
+  // remove more than a segment.
+  deque.PopFront(5);
+  ASSERT_EQ(5, deque.Size());
+  EXPECT_EQ(events[5], deque.Front());
+  for (size_t i = 0; i < 5; ++i)
+  {
+    EXPECT_EQ(events[i + 5], deque[i]);
+  }
+
+  // and we can still add more.
+  deque.PushBack(events[0]);
+  ASSERT_EQ(6, deque.Size());
+  EXPECT_EQ(events[0], deque[5]);
+
+  // removing everything leaves the deque empty.
+  deque.PopFront(100);
+  EXPECT_TRUE(deque.Empty());
+  DeleteEvents(events);
+}
+
+TEST(EventsDeque, CountNotNewerThanUsesTheTime) {
+  auto events = CreateEvents(10);
+  EventsDeque deque(4);
+  for (const auto& e : events)
+  {
+    deque.PushBack(e);
+  }
+
+  EXPECT_EQ(0, deque.CountNotNewerThan(-1));
+  EXPECT_EQ(1, deque.CountNotNewerThan(0));
+  EXPECT_EQ(6, deque.CountNotNewerThan(5));
+  EXPECT_EQ(10, deque.CountNotNewerThan(100));
+
+  // after removing some events.
+  deque.PopFront(3);
+  EXPECT_EQ(3, deque.CountNotNewerThan(5));
+  DeleteEvents(events);
+}
+
+TEST(EventsDeque, CopyToKeepsTheOrder) {
+  auto events = CreateEvents(10);
+  EventsDeque deque(4);
+  std::vector<const EventInformation*> source(events.begin(), events.end());
+  deque.Append(source);
+  deque.PopFront(2);
+
+  std::vector<const EventInformation*> copy;
+  deque.CopyTo(copy);
+  ASSERT_EQ(8, copy.size());
+  for (size_t i = 0; i < copy.size(); ++i)
+  {
+    EXPECT_EQ(events[i + 2], copy[i]);
+  }
+
+  deque.Clear();
+  EXPECT_TRUE(deque.Empty());
+  DeleteEvents(events);
+}
@@ -0,0 +1,120 @@
+#include "pch.h"
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../myoddweb.directorywatcher.win/utils/EventsDispatcher.h"
+
+using myoddweb::directorywatcher::EventsBatch;
+using myoddweb::directorywatcher::EventsDispatcher;
+using myoddweb::directorywatcher::Event;
+
+/**
+ * \brief create a single event with the given time.
+ */
+static std::vector<Event*> CreateEvents(const long long time)
+{
+  return { new Event(L"c:\\foo.txt", L"", 1, 0, time, true) };
+}
+
+static void DeleteEvents(std::vector<Event*>& events)
+{
+  for (const auto& event : events)
+  {
+    delete event;
+  }
+  events.clear();
+}
+
+TEST(EventsDispatcher, BatchesAreDispatchedInOrder) {
+  std::vector<long long> times;
+  {
+    EventsDispatcher dispatcher(4, [&](const EventsBatch& batch)
+      {
+        times.push_back(batch.Events()[0].DateTimeUtc);
+      });
+    for (auto i = 0; i < 100; ++i)
+    {
+      auto events = CreateEvents(i);
+      dispatcher.Enqueue(events);
+
+      // the events are copied, so we can delete them right away.
+      DeleteEvents(events);
+    }
+  }
+
+  // the dispatcher waits for all the batches before it is deleted.
+  ASSERT_EQ(100, times.size());
+  for (auto i = 0; i < 100; ++i)
+  {
+    EXPECT_EQ(i, times[i]);
+  }
+}
+
+TEST(EventsDispatcher, SlowDispatchDoesNotBlockUntilTheQueueIsFull) {
+  std::atomic<bool> release = false;
+  std::atomic<int> numberOfBatches = 0;
+  EventsDispatcher dispatcher(2, [&](const EventsBatch&)
+    {
+      while (!release)
+      {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+      ++numberOfBatches;
+    });
+
+  // the batch being dispatched keeps its place in the queue until the dispatch is complete.
+  auto events = CreateEvents(0);
+  EXPECT_EQ(0, dispatcher.Enqueue(events));
+  EXPECT_EQ(0, dispatcher.Enqueue(events));
+  EXPECT_EQ(2, dispatcher.NumberOfQueuedBatches());
+
+  // the queue is full, so we have to wait for the dispatcher.
+  auto releaser = std::thread([&]
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(50));
+      release = true;
+    });
+  EXPECT_LE(20000, dispatcher.Enqueue(events));
+  EXPECT_LE(1, numberOfBatches);
+  releaser.join();
+  DeleteEvents(events);
+}
+
+TEST(EventsDispatcher, WaitUntilDispatchedWaitsForAllTheQueuedBatches) {
+  std::atomic<int> numberOfBatches = 0;
+  EventsDispatcher dispatcher(4, [&](const EventsBatch&)
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+      ++numberOfBatches;
+    });
+
+  // nothing was queued, so there is nothing to wait for.
+  EXPECT_EQ(0, dispatcher.WaitUntilDispatched());
+
+  for (auto i = 0; i < 3; ++i)
+  {
+    auto events = CreateEvents(i);
+    dispatcher.Enqueue(events);
+    DeleteEvents(events);
+  }
+  EXPECT_LT(0, dispatcher.WaitUntilDispatched());
+  EXPECT_EQ(3, numberOfBatches);
+  EXPECT_EQ(0, dispatcher.NumberOfQueuedBatches());
+}
+
+TEST(EventsDispatcher, NamesAreCopiedToTheBatch) {
+  std::wstring name;
+  {
+    EventsDispatcher dispatcher(1, [&](const EventsBatch& batch)
+      {
+        name = batch.Names() + batch.Events()[0].Name;
+      });
+    auto events = CreateEvents(0);
+    dispatcher.Enqueue(events);
+    DeleteEvents(events);
+  }
+  EXPECT_EQ(L"c:\\foo.txt", name);
+}
@@ -0,0 +1,102 @@
+#include "pch.h"
+#include <thread>
+#include <vector>
+
+#include "../myoddweb.directorywatcher.win/utils/EventsRing.h"
+#include "../myoddweb.directorywatcher.win/utils/EventInformation.h"
+
+using myoddweb::directorywatcher::EventsRing;
+using myoddweb::directorywatcher::EventInformation;
+using myoddweb::directorywatcher::EventAction;
+using myoddweb::directorywatcher::EventError;
+
+static const EventInformation* CreateEventInformation(const long long time)
+{
+  return new EventInformation(time, EventAction::Added, EventError::None, 0, L"c:\\foo.txt", L"", true);
+}
+
+TEST(EventsRing, EmptyRingDrainsNothing) {
+  EventsRing ring(16);
+
+  std::vector<const EventInformation*> events;
+  EXPECT_EQ(0, ring.Drain(events));
+  EXPECT_EQ(0, events.size());
+}
+
+TEST(EventsRing, EventsAreDrainedInTheOrderTheyWereAdded) {
+  EventsRing ring(16);
+  for (auto i = 0; i < 10; ++i)
+  {
+    EXPECT_TRUE(ring.Push(CreateEventInformation(i)));
+  }
+
+  std::vector<const EventInformation*> events;
+  EXPECT_EQ(10, ring.Drain(events));
+  ASSERT_EQ(10, events.size());
+  for (auto i = 0; i < 10; ++i)
+  {
+    EXPECT_EQ(i, events[i]->TimeMillisecondsUtc);
+    delete events[i];
+  }
+}
+
+TEST(EventsRing, PushFailsWhenTheRingIsFull) {
+  EventsRing ring(16);
+  for (auto i = 0; i < 16; ++i)
+  {
+    EXPECT_TRUE(ring.Push(CreateEventInformation(i)));
+  }
+
+  // we are full
+  const auto extra = CreateEventInformation(16);
+  EXPECT_FALSE(ring.Push(extra));
+
+  // once drained, we can add it again.
+  std::vector<const EventInformation*> events;
+  EXPECT_EQ(16, ring.Drain(events));
+  EXPECT_TRUE(ring.Push(extra));
+  EXPECT_EQ(1, ring.Drain(events));
+  for (const auto& e : events)
+  {
+    delete e;
+  }
+}
+
+TEST(EventsRing, MultipleProducersDoNotLoseEvents) {
+  EventsRing ring(64);
+  constexpr auto numberOfThreads = 4;
+  constexpr auto numberOfEvents = 1000;
+
+  std::vector<std::thread> producers;
+  for (auto t = 0; t < numberOfThreads; ++t)
+  {
+    producers.emplace_back([&ring]()
+    {
+      for (auto i = 0; i < numberOfEvents; ++i)
+      {
+        const auto e = CreateEventInformation(i);
+        while (!ring.Push(e))
+        {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+
+  // drain until we have everything.
+  std::vector<const EventInformation*> events;
+  while (events.size() < numberOfThreads * numberOfEvents)
+  {
+    ring.Drain(events);
+  }
+  for (auto& producer : producers)
+  {
+    producer.join();
+  }
+
+  EXPECT_EQ(numberOfThreads * numberOfEvents, events.size());
+  for (const auto& e : events)
+  {
+    delete e;
+  }
+}
@@ -0,0 +1,101 @@
+#include "pch.h"
+#include <chrono>
+#include <thread>
+
+#include "../myoddweb.directorywatcher.win/utils/EventsSignal.h"
+
+using myoddweb::directorywatcher::EventsSignal;
+
+TEST(EventsSignal, WaitTimesOutIfThereAreNoEvents) {
+  EventsSignal signal;
+  EXPECT_EQ(0, signal.Wait(1, 10));
+}
+
+TEST(EventsSignal, WaitReturnsRightAwayIfWeAlreadyHaveTheEvents) {
+  EventsSignal signal;
+  signal.Notify();
+  signal.Notify();
+
+  const auto start = std::chrono::steady_clock::now();
+  EXPECT_EQ(2, signal.Wait(2, 10000));
+  EXPECT_GT(std::chrono::seconds(5), std::chrono::steady_clock::now() - start);
+}
+
+TEST(EventsSignal, ResetReturnsTheNumberOfEvents) {
+  EventsSignal signal;
+  signal.Notify();
+  signal.Notify();
+  signal.Notify();
+  EXPECT_EQ(3, signal.Reset());
+  EXPECT_EQ(0, signal.Reset());
+}
+
+TEST(EventsSignal, NumberOfEventsDoesNotResetTheEvents) {
+  EventsSignal signal;
+  EXPECT_EQ(0, signal.NumberOfEvents());
+  signal.Notify();
+  signal.Notify();
+  EXPECT_EQ(2, signal.NumberOfEvents());
+  EXPECT_EQ(2, signal.NumberOfEvents());
+  EXPECT_EQ(2, signal.Reset());
+  EXPECT_EQ(0, signal.NumberOfEvents());
+}
+
+TEST(EventsSignal, NotifyWakesUpTheWaitingThread) {
+  EventsSignal signal;
+  auto numberOfEvents = 0LL;
+  std::thread waiter([&] { numberOfEvents = signal.Wait(1, 10000); });
+
+  // give the thread a chance to wait.
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  const auto start = std::chrono::steady_clock::now();
+  signal.Notify();
+  waiter.join();
+  EXPECT_EQ(1, numberOfEvents);
+  EXPECT_GT(std::chrono::seconds(5), std::chrono::steady_clock::now() - start);
+}
+
+TEST(EventsSignal, WaitForMoreEventsOnlyWakesUpWhenWeHaveThemAll) {
+  EventsSignal signal;
+  auto numberOfEvents = 0LL;
+  std::thread waiter([&] { numberOfEvents = signal.Wait(100, 10000); });
+  for (auto i = 0; i < 100; ++i)
+  {
+    signal.Notify();
+  }
+  waiter.join();
+  EXPECT_EQ(100, numberOfEvents);
+}
+
+TEST(EventsSignal, CancelWakesUpTheWaitingThreadUntilRestarted) {
+  EventsSignal signal;
+  std::thread waiter([&] { signal.Wait(1, 10000); });
+
+  // give the thread a chance to wait.
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  const auto start = std::chrono::steady_clock::now();
+  signal.Cancel();
+  waiter.join();
+  EXPECT_GT(std::chrono::seconds(5), std::chrono::steady_clock::now() - start);
+  EXPECT_TRUE(signal.Cancelled());
+
+  // we do not wait at all once cancelled.
+  EXPECT_EQ(0, signal.Wait(1, 10000));
+
+  signal.Restart();
+  EXPECT_FALSE(signal.Cancelled());
+  EXPECT_EQ(0, signal.Wait(1, 10));
+}
+
+TEST(EventsSignal, FirstEventIsOnlyCalledOnceUntilReset) {
+  EventsSignal signal;
+  auto numberOfFirstEvents = 0;
+  signal.OnFirstEvent([&] { ++numberOfFirstEvents; });
+  signal.Notify();
+  signal.Notify();
+  EXPECT_EQ(1, numberOfFirstEvents);
+
+  signal.Reset();
+  signal.Notify();
+  EXPECT_EQ(2, numberOfFirstEvents);
+}
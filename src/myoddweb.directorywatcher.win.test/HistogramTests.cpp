@@ -0,0 +1,83 @@
+#include "pch.h"
+#include <limits>
+#include <memory>
+
+#include "../myoddweb.directorywatcher.win/utils/Histogram.h"
+
+using myoddweb::directorywatcher::Histogram;
+
+TEST(Histogram, EmptyHistogramHasNoValues) {
+  const auto histogram = std::make_unique<Histogram>();
+  EXPECT_EQ(0, histogram->Count());
+  EXPECT_EQ(0, histogram->Max());
+  EXPECT_EQ(0, histogram->ValueAtPercentile(50));
+  EXPECT_EQ(0, histogram->ValueAtPercentile(100));
+}
+
+TEST(Histogram, SmallValuesAreExact) {
+  const auto histogram = std::make_unique<Histogram>();
+  for (auto i = 1; i <= 10; ++i)
+  {
+    histogram->Record(i);
+  }
+  EXPECT_EQ(10, histogram->Count());
+  EXPECT_EQ(10, histogram->Max());
+  EXPECT_EQ(5, histogram->ValueAtPercentile(50));
+  EXPECT_EQ(9, histogram->ValueAtPercentile(90));
+  EXPECT_EQ(10, histogram->ValueAtPercentile(100));
+}
+
+TEST(Histogram, LargeValuesAreWithinTheBucketPrecision) {
+  const auto histogram = std::make_unique<Histogram>();
+  for (auto i = 1; i <= 1000; ++i)
+  {
+    histogram->Record(i * 1000LL);
+  }
+  EXPECT_EQ(1000000, histogram->Max());
+
+  // each bucket is 1/16 of its power of 2, so we are within ~6%
+  const auto p50 = histogram->ValueAtPercentile(50);
+  EXPECT_LE(500000, p50);
+  EXPECT_GE(500000 * 1.07, p50);
+
+  const auto p99 = histogram->ValueAtPercentile(99);
+  EXPECT_LE(990000, p99);
+  EXPECT_GE(990000 * 1.07, p99);
+}
+
+TEST(Histogram, PercentileIsNeverMoreThanTheMax) {
+  const auto histogram = std::make_unique<Histogram>();
+  histogram->Record(1000001);
+  EXPECT_EQ(1000001, histogram->ValueAtPercentile(100));
+  EXPECT_EQ(1000001, histogram->ValueAtPercentile(50));
+}
+
+TEST(Histogram, VeryLargeValuesCanBeRecorded) {
+  const auto histogram = std::make_unique<Histogram>();
+  histogram->Record(std::numeric_limits<long long>::max());
+  EXPECT_EQ(1, histogram->Count());
+  EXPECT_EQ(std::numeric_limits<long long>::max(), histogram->Max());
+  EXPECT_EQ(std::numeric_limits<long long>::max(), histogram->ValueAtPercentile(99));
+}
+
+TEST(Histogram, NegativeValuesAreRecordedAsZero) {
+  const auto histogram = std::make_unique<Histogram>();
+  histogram->Record(-10);
+  EXPECT_EQ(1, histogram->Count());
+  EXPECT_EQ(0, histogram->Max());
+  EXPECT_EQ(0, histogram->ValueAtPercentile(50));
+}
+
+TEST(Histogram, ResetRemovesAllTheValues) {
+  const auto histogram = std::make_unique<Histogram>();
+  histogram->Record(10);
+  histogram->Record(20);
+  histogram->Reset();
+  EXPECT_EQ(0, histogram->Count());
+  EXPECT_EQ(0, histogram->Max());
+  EXPECT_EQ(0, histogram->ValueAtPercentile(50));
+
+  histogram->Record(3);
+  EXPECT_EQ(1, histogram->Count());
+  EXPECT_EQ(3, histogram->ValueAtPercentile(50));
+}
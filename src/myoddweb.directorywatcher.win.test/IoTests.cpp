@@ -1,4 +1,5 @@
 ﻿#include "pch.h"
+#include <vector>
 
 #include "../myoddweb.directorywatcher.win/utils/Io.h"
 using myoddweb::directorywatcher::Io;
@@ -278,3 +279,29 @@ TEST(Io, FoldersWithLhsHasMultipleForwardSlash) {
   const auto rhs = L"c:\\foo";
   ASSERT_TRUE(::Io::AreSameFolders(lhs, rhs));
 }
+
+TEST(Io, CombineIntoBufferIsTheSameAsCombine) {
+  const std::vector<std::pair<std::wstring, std::wstring>> paths = {
+    { L"", L"" },
+    { L"c:\\foo", L"" },
+    { L"c:\\foo\\", L"" },
+    { L"", L"bar" },
+    { L"", L"\\bar" },
+    { L"c:\\foo", L"bar" },
+    { L"c:\\foo\\", L"bar" },
+    { L"c:\\foo", L"\\bar" },
+    { L"c:\\foo\\\\", L"//bar" },
+    { L"\\", L"" },
+    { L"\\", L"bar" },
+  };
+  for (const auto& path : paths)
+  {
+    const auto expected = ::Io::Combine(path.first, path.second);
+    const auto length = ::Io::Combine(path.first, path.second, nullptr);
+    ASSERT_EQ(expected.length(), length);
+
+    std::vector<wchar_t> buffer(length + 1, L'x');
+    EXPECT_EQ(length, ::Io::Combine(path.first, path.second, buffer.data()));
+    ASSERT_STREQ(expected.c_str(), buffer.data());
+  }
+}
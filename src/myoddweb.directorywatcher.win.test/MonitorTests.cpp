@@ -0,0 +1,345 @@
+#include "pch.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "../myoddweb.directorywatcher.win/monitors/Monitor.h"
+#include "../myoddweb.directorywatcher.win/utils/Threads/WorkerPool.h"
+#include "../myoddweb.directorywatcher.win/utils/Wait.h"
+#include "MonitorsManagerTestHelper.h"
+
+using myoddweb::directorywatcher::Monitor;
+using myoddweb::directorywatcher::Event;
+using myoddweb::directorywatcher::EventAction;
+using myoddweb::directorywatcher::MYODDWEB_LOW_LATENCY_IDLE_WAIT;
+using myoddweb::directorywatcher::Request;
+using myoddweb::directorywatcher::sEvent;
+using myoddweb::directorywatcher::threads::WorkerPool;
+using myoddweb::directorywatcher::Wait;
+
+/**
+ * \brief a monitor that does not watch anything, the events are added by the test.
+ */
+class TestMonitor : public Monitor
+{
+  const long long _parentId;
+
+public:
+  TestMonitor(const long long id, ::WorkerPool& workerPool, const Request& request) :
+    Monitor(id, workerPool, request),
+    _parentId(id)
+  {
+  }
+
+protected:
+  void OnGetEvents(std::vector<Event*>& events) override
+  {
+  }
+
+  const long long& ParentId() const override
+  {
+    return _parentId;
+  }
+};
+
+/**
+ * \brief a monitor that collects the events of a child, like the multiple monitor does.
+ */
+class TestParentMonitor : public TestMonitor
+{
+  Monitor& _child;
+  std::atomic<int> _numberOfFolderEvents;
+
+public:
+  TestParentMonitor(const long long id, ::WorkerPool& workerPool, const Request& request, Monitor& child) :
+    TestMonitor(id, workerPool, request),
+    _child(child),
+    _numberOfFolderEvents(0)
+  {
+    _child.UseEventsSignal(Signal());
+    _child.UseEventsCounter(Counter());
+  }
+
+  int NumberOfFolderEvents() const
+  {
+    return _numberOfFolderEvents.load();
+  }
+
+protected:
+  void OnGetEvents(std::vector<Event*>& events) override
+  {
+    auto childEvents = std::vector<Event*>();
+    _child.GetEvents(childEvents);
+    for (const auto& event : childEvents)
+    {
+      if (!event->IsFile)
+      {
+        ++_numberOfFolderEvents;
+      }
+    }
+  }
+};
+
+/**
+ * \brief the events given to OnDispatchedEvent( ... ) in the order they were given.
+ */
+static std::mutex _dispatchedLock;
+static std::vector<std::pair<std::wstring, int>> _dispatched;
+
+static void __stdcall OnDispatchedEvent(long long id, bool isFile, const wchar_t* name, const wchar_t* oldName, int action, int error, long long dateTimeUtc)
+{
+  // the added events are slow so the events after them have a chance to overtake them.
+  if (action == static_cast<int>(EventAction::Added))
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+  }
+  std::lock_guard<std::mutex> lock(_dispatchedLock);
+  _dispatched.emplace_back(name, action);
+}
+
+/**
+ * \brief where an event was given to OnDispatchedEvent( ... ), -1 if it was not.
+ */
+static int DispatchedPosition(const std::wstring& name, const EventAction action)
+{
+  std::lock_guard<std::mutex> lock(_dispatchedLock);
+  const auto it = std::find(_dispatched.begin(), _dispatched.end(), std::make_pair(name, static_cast<int>(action)));
+  return it == _dispatched.end() ? -1 : static_cast<int>(it - _dispatched.begin());
+}
+
+TEST(Monitor, RenamesAndCaseChangesAreDispatchedInOrder)
+{
+  {
+    std::lock_guard<std::mutex> lock(_dispatchedLock);
+    _dispatched.clear();
+  }
+
+  myoddweb::directorywatcher::sRequest s = {};
+  s.Path = const_cast<wchar_t*>(L"c:\\");
+  s.EventsCallback = OnDispatchedEvent;
+  s.EventsCallbackRateMs = 20;
+  s.DispatchThreads = 4;
+
+  auto pool = ::WorkerPool(10);
+  auto monitor = TestMonitor(1, pool, ::Request(s));
+  pool.Add(monitor);
+  ASSERT_TRUE(Wait::SpinUntil([&] { return monitor.Started(); }, TEST_TIMEOUT_WAIT));
+
+  // the same file with another case and the new name of a file are the same paths as far as the callback knows.
+  const auto numberOfFiles = 20;
+  for (auto i = 0; i < numberOfFiles; ++i)
+  {
+    const auto number = std::to_wstring(i);
+    monitor.AddEvent(EventAction::Added, L"file" + number + L".txt", true);
+    monitor.AddEvent(EventAction::Touched, L"FILE" + number + L".TXT", true);
+    monitor.AddRenameEvent(L"new" + number + L".txt", L"file" + number + L".txt", true);
+    monitor.AddEvent(EventAction::Touched, L"NEW" + number + L".TXT", true);
+  }
+
+  // let the pool know that we have something to publish, like the file system monitors do.
+  monitor.SignalReady();
+  EXPECT_TRUE(Wait::SpinUntil([&]
+    {
+      std::lock_guard<std::mutex> lock(_dispatchedLock);
+      return _dispatched.size() == static_cast<size_t>(4 * numberOfFiles);
+    }, TEST_TIMEOUT_WAIT * 5));
+
+  for (auto i = 0; i < numberOfFiles; ++i)
+  {
+    const auto number = std::to_wstring(i);
+    const auto added = DispatchedPosition(L"c:\\file" + number + L".txt", EventAction::Added);
+    const auto touched = DispatchedPosition(L"c:\\FILE" + number + L".TXT", EventAction::Touched);
+    const auto renamed = DispatchedPosition(L"c:\\new" + number + L".txt", EventAction::Renamed);
+    const auto touchedNew = DispatchedPosition(L"c:\\NEW" + number + L".TXT", EventAction::Touched);
+    EXPECT_LE(0, added);
+    EXPECT_LT(added, touched);
+    EXPECT_LT(touched, renamed);
+    EXPECT_LT(renamed, touchedNew);
+  }
+
+  pool.StopAndWait(TEST_TIMEOUT_WAIT);
+}
+
+/**
+ * \brief the number of times OnStatistics( ... ) was called.
+ */
+static std::atomic<int> _numberOfStatistics;
+
+static void __stdcall OnStatistics(long long id, double elapsedTime, long long numberOfEvents)
+{
+  ++_numberOfStatistics;
+}
+
+static void __stdcall OnIgnoredEvent(long long id, bool isFile, const wchar_t* name, const wchar_t* oldName, int action, int error, long long dateTimeUtc)
+{
+}
+
+TEST(Monitor, LowLatencyStatisticsArePublishedAtTheirRate)
+{
+  _numberOfStatistics = 0;
+
+  myoddweb::directorywatcher::sRequest s = {};
+  s.Path = const_cast<wchar_t*>(L"c:\\");
+  s.EventsCallback = OnIgnoredEvent;
+  s.EventsCallbackRateMs = 20;
+  s.StatisticsCallback = OnStatistics;
+  s.StatisticsCallbackRateMs = 20;
+  s.LowLatencyEvents = true;
+
+  auto pool = ::WorkerPool(10);
+  auto monitor = TestMonitor(1, pool, ::Request(s));
+  pool.Add(monitor);
+  ASSERT_TRUE(Wait::SpinUntil([&] { return monitor.Started(); }, TEST_TIMEOUT_WAIT));
+
+  // the low latency thread is idle, but it must not wait past the time the statistics are due.
+  const auto start = std::chrono::steady_clock::now();
+  std::this_thread::sleep_for(std::chrono::milliseconds(500));
+  const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+  EXPECT_LT(elapsed / MYODDWEB_LOW_LATENCY_IDLE_WAIT + 2, static_cast<long long>(_numberOfStatistics.load()));
+
+  pool.StopAndWait(TEST_TIMEOUT_WAIT);
+}
+
+TEST(Monitor, LowLatencyHalfRenamesArePublishedWhenTheyExpire)
+{
+  {
+    std::lock_guard<std::mutex> lock(_dispatchedLock);
+    _dispatched.clear();
+  }
+
+  myoddweb::directorywatcher::sRequest s = {};
+  s.Path = const_cast<wchar_t*>(L"c:\\");
+  s.EventsCallback = OnDispatchedEvent;
+  s.EventsCallbackRateMs = 20;
+  s.LowLatencyEvents = true;
+  s.RenamePairingMs = 100;
+
+  auto pool = ::WorkerPool(10);
+  auto monitor = TestMonitor(1, pool, ::Request(s));
+  pool.Add(monitor);
+  ASSERT_TRUE(Wait::SpinUntil([&] { return monitor.Started(); }, TEST_TIMEOUT_WAIT));
+
+  // the other half never comes and nothing else happens in the tree.
+  monitor.AddRenameEvent(L"new.txt", L"", true);
+  EXPECT_TRUE(Wait::SpinUntil([&] { return DispatchedPosition(L"c:\\new.txt", EventAction::Added) >= 0; }, TEST_TIMEOUT_WAIT));
+  EXPECT_EQ(-1, monitor.PendingRenamesMilliseconds());
+
+  pool.StopAndWait(TEST_TIMEOUT_WAIT);
+}
+
+TEST(Monitor, KeptFolderEventsAreProcessedAtTheEventsRateWhenCounting)
+{
+  myoddweb::directorywatcher::sRequest s = {};
+  s.Path = const_cast<wchar_t*>(L"c:\\");
+  s.Recursive = true;
+  s.EventsCallbackRateMs = 20;
+  s.StatisticsCallback = OnStatistics;
+  s.StatisticsCallbackRateMs = 60000;
+  const auto request = ::Request(s);
+  ASSERT_TRUE(request.IsCountingEvents());
+
+  // a non recursive child keeps the folder events, even if we only count them.
+  auto pool = ::WorkerPool(10);
+  auto child = TestMonitor(2, pool, ::Request(request, L"c:\\", false));
+  auto parent = TestParentMonitor(1, pool, request, child);
+  pool.Add(child);
+  pool.Add(parent);
+  ASSERT_TRUE(Wait::SpinUntil([&] { return child.Started() && parent.Started(); }, TEST_TIMEOUT_WAIT));
+
+  child.AddEvent(EventAction::Added, L"folder", false);
+  child.AddEvent(EventAction::Added, L"file.txt", true);
+
+  // the statistics are not due for a long time, but the folder events must still be processed.
+  EXPECT_TRUE(Wait::SpinUntil([&] { return parent.NumberOfFolderEvents() == 1; }, TEST_TIMEOUT_WAIT));
+
+  pool.StopAndWait(TEST_TIMEOUT_WAIT);
+}
+
+TEST(Monitor, EventsThatAreNotPulledStayWithinTheLimits)
+{
+  const long long maxBytes = 64 * 1024;
+  myoddweb::directorywatcher::sRequest s = {};
+  s.Path = const_cast<wchar_t*>(L"c:\\");
+  s.EventsCallbackRateMs = 60000;
+  s.MaxNumberOfBytes = maxBytes;
+  s.PullEvents = true;
+
+  auto pool = ::WorkerPool(10);
+  auto monitor = TestMonitor(1, pool, ::Request(s));
+  pool.Add(monitor);
+  ASSERT_TRUE(Wait::SpinUntil([&] { return monitor.Started(); }, TEST_TIMEOUT_WAIT));
+
+  // nobody is pulling the events, so the oldest ones are dropped.
+  for (auto i = 0; i < 100000; ++i)
+  {
+    monitor.AddEvent(EventAction::Added, L"file" + std::to_wstring(i) + L".txt", true);
+  }
+  EXPECT_LT(monitor.EventsCollector().ArenasCapacity(), static_cast<size_t>(16 * maxBytes));
+
+  // only pull one event, the others are kept until they are all pulled.
+  sEvent events[1];
+  wchar_t names[1024];
+  auto numberOfEvents = 0;
+  auto numberOfCharacters = 0;
+  const auto pending = monitor.PullEvents(events, 1, names, 1024, numberOfEvents, numberOfCharacters);
+  EXPECT_EQ(1, numberOfEvents);
+  EXPECT_LT(0, pending);
+
+  // the new events cannot use the memory of the events we are still holding.
+  for (auto i = 0; i < 100000; ++i)
+  {
+    monitor.AddEvent(EventAction::Added, L"file" + std::to_wstring(i) + L".txt", true);
+  }
+  EXPECT_LT(monitor.EventsCollector().ArenasCapacity(), static_cast<size_t>(16 * maxBytes));
+
+  // the events we kept are still valid.
+  auto pulled = 1;
+  do
+  {
+    numberOfEvents = 0;
+    monitor.PullEvents(events, 1, names, 1024, numberOfEvents, numberOfCharacters);
+    pulled += numberOfEvents;
+  } while (numberOfEvents > 0 && pulled <= pending);
+  EXPECT_EQ(pending + 1, pulled);
+
+  pool.StopAndWait(TEST_TIMEOUT_WAIT);
+}
+
+TEST(Monitor, EventsArePulledOnlyIfTheMonitorIsPullingThem)
+{
+  {
+    std::lock_guard<std::mutex> lock(_dispatchedLock);
+    _dispatched.clear();
+  }
+
+  myoddweb::directorywatcher::sRequest s = {};
+  s.Path = const_cast<wchar_t*>(L"c:\\");
+  s.EventsCallback = OnDispatchedEvent;
+  s.EventsCallbackRateMs = 20;
+
+  auto pool = ::WorkerPool(10);
+  auto monitor = TestMonitor(1, pool, ::Request(s));
+  pool.Add(monitor);
+  ASSERT_TRUE(Wait::SpinUntil([&] { return monitor.Started(); }, TEST_TIMEOUT_WAIT));
+
+  // the events belong to the callback, we cannot take them.
+  monitor.AddEvent(EventAction::Touched, L"file.txt", true);
+  sEvent events[1];
+  wchar_t names[1024];
+  auto numberOfEvents = -1;
+  auto numberOfCharacters = -1;
+  EXPECT_GT(0, monitor.PullEvents(events, 1, names, 1024, numberOfEvents, numberOfCharacters));
+  EXPECT_EQ(0, numberOfEvents);
+  EXPECT_EQ(0, numberOfCharacters);
+
+  // and the callback still gets them.
+  monitor.SignalReady();
+  EXPECT_TRUE(Wait::SpinUntil([&] { return DispatchedPosition(L"c:\\file.txt", EventAction::Touched) == 0; }, TEST_TIMEOUT_WAIT));
+
+  pool.StopAndWait(TEST_TIMEOUT_WAIT);
+}
@@ -114,6 +114,56 @@ TEST(MonitorsManagerAdd, StartStopThenAddFileToFolder) {
     _ = helper->AddFile();
 }
 
+TEST(MonitorsManagerAdd, EventsOfACallbackMonitorCannotBePulled) {
+  // create the helper.
+  auto helper = new MonitorsManagerTestHelper();
+
+  // use the test request to create the Request
+  // the events are given to the callback, so nobody else can take them.
+  const auto r = RequestHelper(
+    helper->Folder(),
+    false,
+    nullptr,
+    eventFunction,
+    nullptr,
+    50,
+    0);
+
+  const auto request = ::Request(r);
+  const auto id = ::MonitorsManager::Start(request);
+  Add(id, helper);
+
+  // wait for the pool to start
+  if (!Wait::SpinUntil([&]
+    {
+      return ::MonitorsManager::Ready();
+    }, TEST_TIMEOUT_WAIT))
+  {
+    GTEST_FATAL_FAILURE_("Unable to start pool");
+  }
+
+  // add a file and try to take its event.
+  auto _ = helper->AddFile();
+  myoddweb::directorywatcher::sEvent events[16];
+  wchar_t names[1024];
+  auto numberOfEvents = -1;
+  auto numberOfCharacters = -1;
+  EXPECT_GT(0, ::MonitorsManager::GetEvents(id, events, 16, names, 1024, numberOfEvents, numberOfCharacters));
+  EXPECT_EQ(0, numberOfEvents);
+  EXPECT_EQ(0, numberOfCharacters);
+
+  // the callback still gets it.
+  EXPECT_TRUE(Wait::SpinUntil([&]
+    {
+      return 1 == helper->Added(true);
+    }, TEST_TIMEOUT_WAIT));
+
+  EXPECT_NO_THROW(::MonitorsManager::Stop(id));
+
+  EXPECT_TRUE(Remove(id));
+  delete helper;
+}
+
 TEST(MonitorsManagerAdd, InvalidPathDoesNOtThrow) {
 
   // use the test request to create the Request
@@ -0,0 +1,151 @@
+#include "pch.h"
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../myoddweb.directorywatcher.win/utils/PathFilter.h"
+
+using myoddweb::directorywatcher::PathFilter;
+
+TEST(PathFilter, NoPatternsIncludesEverything) {
+  const PathFilter filter(L"", L"", L"c:\\", L"c:\\");
+  EXPECT_TRUE(filter.IsEmpty());
+  EXPECT_TRUE(filter.IsIncluded(L"foo.txt"));
+  EXPECT_FALSE(filter.IsExcluded(L"foo.txt"));
+}
+
+TEST(PathFilter, SuffixPatternsMatchTheFileName) {
+  const PathFilter filter(L"", L"*.tmp|*.obj", L"c:\\", L"c:\\");
+  EXPECT_FALSE(filter.IsEmpty());
+  EXPECT_TRUE(filter.IsExcluded(L"foo.tmp"));
+  EXPECT_TRUE(filter.IsExcluded(L"src\\foo.OBJ"));
+  EXPECT_FALSE(filter.IsExcluded(L"foo.txt"));
+  EXPECT_FALSE(filter.IsExcluded(L"foo.tmp.txt"));
+}
+
+TEST(PathFilter, SegmentPatternsMatchTheContentOfFolders) {
+  const PathFilter filter(L"", L".git|node_modules/", L"c:\\", L"c:\\");
+  EXPECT_TRUE(filter.IsExcluded(L".git"));
+  EXPECT_TRUE(filter.IsExcluded(L".git\\objects\\ab\\cdef"));
+  EXPECT_TRUE(filter.IsExcluded(L"web\\node_modules\\foo\\index.js"));
+  EXPECT_FALSE(filter.IsExcluded(L"src\\.gitignore"));
+}
+
+TEST(PathFilter, PrefixPatternsMatchTheStartOfTheName) {
+  const PathFilter filter(L"", L"~$*", L"c:\\", L"c:\\");
+  EXPECT_TRUE(filter.IsExcluded(L"docs\\~$report.docx"));
+  EXPECT_FALSE(filter.IsExcluded(L"docs\\report.docx"));
+}
+
+TEST(PathFilter, PathPatternsMatchFromTheRoot) {
+  const PathFilter filter(L"", L"bin/**|/obj|src/*.g.cs", L"c:\\", L"c:\\");
+  EXPECT_TRUE(filter.IsExcluded(L"bin\\Debug\\app.exe"));
+  EXPECT_TRUE(filter.IsExcluded(L"obj\\project.assets.json"));
+  EXPECT_TRUE(filter.IsExcluded(L"src\\Form.g.cs"));
+  EXPECT_FALSE(filter.IsExcluded(L"src\\sub\\Form.g.cs"));
+  EXPECT_FALSE(filter.IsExcluded(L"src\\bin\\app.exe"));
+  EXPECT_FALSE(filter.IsExcluded(L"src\\obj"));
+}
+
+TEST(PathFilter, DoubleStarMatchesAnyNumberOfFolders) {
+  const PathFilter filter(L"src/**/*.cs", L"", L"c:\\", L"c:\\");
+  EXPECT_TRUE(filter.IsIncluded(L"src\\a.cs"));
+  EXPECT_TRUE(filter.IsIncluded(L"src\\a\\b\\c.cs"));
+  EXPECT_FALSE(filter.IsIncluded(L"test\\a.cs"));
+  EXPECT_FALSE(filter.IsIncluded(L"src\\a.txt"));
+}
+
+TEST(PathFilter, GenericPatterns) {
+  const PathFilter filter(L"", L"foo*bar.txt|file?.log", L"c:\\", L"c:\\");
+  EXPECT_TRUE(filter.IsExcluded(L"foobar.txt"));
+  EXPECT_TRUE(filter.IsExcluded(L"a\\foo123bar.txt"));
+  EXPECT_TRUE(filter.IsExcluded(L"file1.log"));
+  EXPECT_FALSE(filter.IsExcluded(L"file12.log"));
+  EXPECT_FALSE(filter.IsExcluded(L"foobar.txt.bak"));
+}
+
+TEST(PathFilter, PatternsAreRelativeToTheRootForSubFolders) {
+  // a sub folder of the root, the paths we are given are relative to that sub folder.
+  const PathFilter filter(L"", L"bin/**|src/*.g.cs", L"c:\\project", L"c:\\project\\src");
+  EXPECT_TRUE(filter.IsExcluded(L"Form.g.cs"));
+  EXPECT_FALSE(filter.IsExcluded(L"bin\\app.exe"));
+
+  const PathFilter excludedFolder(L"", L"bin/**", L"c:\\project", L"c:\\project\\bin");
+  EXPECT_TRUE(excludedFolder.IsExcluded(L"Debug\\app.exe"));
+
+  const PathFilter includedFolder(L"src", L"", L"c:\\project", L"c:\\project\\src");
+  EXPECT_TRUE(includedFolder.IsIncluded(L"Debug\\app.exe"));
+}
+
+TEST(PathFilter, EmptyPatternsAreIgnored) {
+  const PathFilter filter(L" | |", L"||", L"c:\\", L"c:\\");
+  EXPECT_TRUE(filter.IsEmpty());
+}
+
+TEST(PathFilter, DISABLED_BenchmarkThousandsOfPatterns) {
+  // a corpus that looks like a source tree with its build outputs.
+  std::vector<std::wstring> paths;
+  for (auto i = 0; i < 20000; ++i)
+  {
+    switch (i % 5)
+    {
+    case 0:
+      paths.push_back(L"src\\module" + std::to_wstring(i % 97) + L"\\sub\\file" + std::to_wstring(i) + L".cs");
+      break;
+    case 1:
+      paths.push_back(L"src\\module" + std::to_wstring(i % 97) + L"\\bin\\Debug\\file" + std::to_wstring(i) + L".dll");
+      break;
+    case 2:
+      paths.push_back(L".git\\objects\\" + std::to_wstring(i % 256) + L"\\" + std::to_wstring(i * 7919));
+      break;
+    case 3:
+      paths.push_back(L"web\\node_modules\\package" + std::to_wstring(i % 500) + L"\\lib\\index.js");
+      break;
+    default:
+      paths.push_back(L"docs\\notes\\~$draft" + std::to_wstring(i) + L".tmp");
+      break;
+    }
+  }
+
+  for (auto numberOfPatterns : { 10, 1000, 5000 })
+  {
+    std::wstring patterns = L".git|node_modules|bin|*.tmp|~$*";
+    for (auto i = 5; i < numberOfPatterns; ++i)
+    {
+      switch (i % 5)
+      {
+      case 0:
+        patterns += L"|*.ext" + std::to_wstring(i);
+        break;
+      case 1:
+        patterns += L"|folder" + std::to_wstring(i);
+        break;
+      case 2:
+        patterns += L"|prefix" + std::to_wstring(i) + L"*";
+        break;
+      case 3:
+        patterns += L"|out" + std::to_wstring(i) + L"/**";
+        break;
+      default:
+        patterns += L"|name" + std::to_wstring(i) + L"*.log";
+        break;
+      }
+    }
+
+    const PathFilter filter(L"", patterns, L"c:\\", L"c:\\");
+    auto excluded = 0;
+    const auto start = std::chrono::high_resolution_clock::now();
+    for (const auto& path : paths)
+    {
+      if (filter.IsExcluded(path))
+      {
+        ++excluded;
+      }
+    }
+    const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now() - start).count();
+    EXPECT_EQ(16000, excluded);
+
+    std::cout << "[          ] " << numberOfPatterns << " patterns, " << paths.size() << " paths in " << elapsed / 1000 << "us, (" << elapsed / static_cast<long long>(paths.size()) << "ns per path)" << std::endl;
+  }
+}
@@ -70,3 +70,348 @@ TEST(Request, RecursiveIsSaved) {
     EXPECT_FALSE(request.Recursive());
   }
 }
+
+TEST(Request, CoalesceEventsIsSaved) {
+  {
+    myoddweb::directorywatcher::sRequest s = {};
+    s.Path = const_cast<wchar_t*>(L"c:\\");
+    s.CoalesceEvents = true;
+
+    // make a copy to make sure copy is not broken
+    const auto r = ::Request(s);
+    const auto request = ::Request(r);
+    EXPECT_TRUE(request.CoalesceEvents());
+  }
+  {
+    // it is off by default
+    const auto r = RequestHelper(
+      L"c:\\",
+      false,
+      nullptr,
+      nullptr,
+      nullptr,
+      0,
+      0);
+    const auto request = ::Request(r);
+    EXPECT_FALSE(request.CoalesceEvents());
+  }
+}
+
+TEST(Request, LimitsAreSaved) {
+  {
+    myoddweb::directorywatcher::sRequest s = {};
+    s.Path = const_cast<wchar_t*>(L"c:\\");
+    s.MaxNumberOfEvents = 10;
+    s.MaxNumberOfBytes = 1024;
+    s.OverflowPolicy = static_cast<int>(myoddweb::directorywatcher::OverflowPolicy::CollapseToDirectory);
+
+    // make a copy to make sure copy is not broken
+    const auto r = ::Request(s);
+    const auto request = ::Request(r);
+    EXPECT_EQ(10, request.MaxNumberOfEvents());
+    EXPECT_EQ(1024, request.MaxNumberOfBytes());
+    EXPECT_EQ(myoddweb::directorywatcher::OverflowPolicy::CollapseToDirectory, request.OverflowPolicy());
+
+    // the child requests have the same limits.
+    const auto child = ::Request(request, L"c:\\foo", true);
+    EXPECT_EQ(10, child.MaxNumberOfEvents());
+    EXPECT_EQ(1024, child.MaxNumberOfBytes());
+    EXPECT_EQ(myoddweb::directorywatcher::OverflowPolicy::CollapseToDirectory, child.OverflowPolicy());
+  }
+  {
+    // invalid values are not used.
+    myoddweb::directorywatcher::sRequest s = {};
+    s.Path = const_cast<wchar_t*>(L"c:\\");
+    s.MaxNumberOfEvents = -1;
+    s.MaxNumberOfBytes = -1;
+    s.OverflowPolicy = 42;
+
+    const auto request = ::Request(s);
+    EXPECT_EQ(0, request.MaxNumberOfEvents());
+    EXPECT_EQ(0, request.MaxNumberOfBytes());
+    EXPECT_EQ(myoddweb::directorywatcher::OverflowPolicy::DropOldest, request.OverflowPolicy());
+  }
+}
+
+TEST(Request, CollectorShardsIsSaved) {
+  {
+    myoddweb::directorywatcher::sRequest s = {};
+    s.Path = const_cast<wchar_t*>(L"c:\\");
+    s.CollectorShards = 4;
+
+    // make a copy to make sure copy is not broken
+    const auto r = ::Request(s);
+    const auto request = ::Request(r);
+    EXPECT_EQ(4, request.CollectorShards());
+
+    // the child requests have the same number of shards.
+    const auto child = ::Request(request, L"c:\\foo", true);
+    EXPECT_EQ(4, child.CollectorShards());
+  }
+  {
+    // a single shard by default.
+    myoddweb::directorywatcher::sRequest s = {};
+    s.Path = const_cast<wchar_t*>(L"c:\\");
+    const auto request = ::Request(s);
+    EXPECT_EQ(1, request.CollectorShards());
+  }
+}
+
+TEST(Request, RenamePairingIsSaved) {
+  {
+    myoddweb::directorywatcher::sRequest s = {};
+    s.Path = const_cast<wchar_t*>(L"c:\\");
+    s.RenamePairingMs = 250;
+
+    // make a copy to make sure copy is not broken
+    const auto r = ::Request(s);
+    const auto request = ::Request(r);
+    EXPECT_EQ(250, request.RenamePairingMilliseconds());
+
+    // the child requests pair their renames as well.
+    const auto child = ::Request(request, L"c:\\foo", true);
+    EXPECT_EQ(250, child.RenamePairingMilliseconds());
+  }
+  {
+    // we do not wait by default.
+    myoddweb::directorywatcher::sRequest s = {};
+    s.Path = const_cast<wchar_t*>(L"c:\\");
+    const auto request = ::Request(s);
+    EXPECT_EQ(0, request.RenamePairingMilliseconds());
+  }
+}
+
+static void __stdcall OnEventsBatch(long long, const myoddweb::directorywatcher::sEvent*, int, const wchar_t*, int)
+{
+}
+
+TEST(Request, EventsBatchCallbackIsSaved) {
+  {
+    myoddweb::directorywatcher::sRequest s = {};
+    s.Path = const_cast<wchar_t*>(L"c:\\");
+    s.EventsCallbackRateMs = 100;
+    s.EventsBatchCallback = &OnEventsBatch;
+
+    // make a copy to make sure copy is not broken
+    const auto r = ::Request(s);
+    const auto request = ::Request(r);
+    EXPECT_EQ(&OnEventsBatch, request.CallbackEventsBatch());
+
+    // we do not need the per event callback.
+    EXPECT_TRUE(request.IsUsingEvents());
+  }
+  {
+    myoddweb::directorywatcher::sRequest s = {};
+    s.Path = const_cast<wchar_t*>(L"c:\\");
+    s.EventsCallbackRateMs = 100;
+    const auto request = ::Request(s);
+    EXPECT_EQ(nullptr, request.CallbackEventsBatch());
+    EXPECT_FALSE(request.IsUsingEvents());
+  }
+}
+
+TEST(Request, PullEventsIsSaved) {
+  {
+    myoddweb::directorywatcher::sRequest s = {};
+    s.Path = const_cast<wchar_t*>(L"c:\\");
+    s.EventsCallbackRateMs = 100;
+    s.PullEvents = true;
+
+    // make a copy to make sure copy is not broken
+    const auto r = ::Request(s);
+    const auto request = ::Request(r);
+    EXPECT_TRUE(request.PullEvents());
+  }
+  {
+    // we publish by default.
+    myoddweb::directorywatcher::sRequest s = {};
+    s.Path = const_cast<wchar_t*>(L"c:\\");
+    const auto request = ::Request(s);
+    EXPECT_FALSE(request.PullEvents());
+  }
+}
+
+TEST(Request, LowLatencyEventsAreSaved) {
+  {
+    myoddweb::directorywatcher::sRequest s = {};
+    s.Path = const_cast<wchar_t*>(L"c:\\");
+    s.LowLatencyEvents = true;
+    s.MaxBatchDelayMs = 5;
+    s.MaxBatchSize = 1000;
+
+    // make a copy to make sure copy is not broken
+    const auto r = ::Request(s);
+    const auto request = ::Request(r);
+    EXPECT_TRUE(request.LowLatencyEvents());
+    EXPECT_EQ(5, request.MaxBatchDelayMilliseconds());
+    EXPECT_EQ(1000, request.MaxBatchSize());
+  }
+  {
+    // negative values are not allowed.
+    myoddweb::directorywatcher::sRequest s = {};
+    s.Path = const_cast<wchar_t*>(L"c:\\");
+    s.MaxBatchDelayMs = -1;
+    s.MaxBatchSize = -1;
+    const auto request = ::Request(s);
+    EXPECT_FALSE(request.LowLatencyEvents());
+    EXPECT_EQ(0, request.MaxBatchDelayMilliseconds());
+    EXPECT_EQ(0, request.MaxBatchSize());
+  }
+}
+
+TEST(Request, StatisticsExCallbackIsSaved) {
+  const auto callback = [](long long, const myoddweb::directorywatcher::sStatistics*) {};
+  {
+    myoddweb::directorywatcher::sRequest s = {};
+    s.Path = const_cast<wchar_t*>(L"c:\\");
+    s.StatisticsExCallback = callback;
+    s.StatisticsCallbackRateMs = 1000;
+
+    // make a copy to make sure copy is not broken
+    const auto r = ::Request(s);
+    const auto request = ::Request(r);
+    EXPECT_NE(nullptr, request.CallbackStatisticsEx());
+    EXPECT_EQ(nullptr, request.CallbackStatistics());
+    EXPECT_TRUE(request.IsUsingStatistics());
+  }
+  {
+    // we need a rate to use the statistics.
+    myoddweb::directorywatcher::sRequest s = {};
+    s.Path = const_cast<wchar_t*>(L"c:\\");
+    s.StatisticsExCallback = callback;
+    const auto request = ::Request(s);
+    EXPECT_FALSE(request.IsUsingStatistics());
+  }
+}
+
+TEST(Request, DispatchQueueSizeIsSaved) {
+  {
+    myoddweb::directorywatcher::sRequest s = {};
+    s.Path = const_cast<wchar_t*>(L"c:\\");
+    s.DispatchQueueSize = 16;
+
+    // make a copy to make sure copy is not broken
+    const auto r = ::Request(s);
+    const auto request = ::Request(r);
+    EXPECT_EQ(16, request.DispatchQueueSize());
+  }
+  {
+    // negative values are not allowed.
+    myoddweb::directorywatcher::sRequest s = {};
+    s.Path = const_cast<wchar_t*>(L"c:\\");
+    s.DispatchQueueSize = -1;
+    const auto request = ::Request(s);
+    EXPECT_EQ(0, request.DispatchQueueSize());
+  }
+}
+
+TEST(Request, DispatchThreadsAreSaved) {
+  {
+    myoddweb::directorywatcher::sRequest s = {};
+    s.Path = const_cast<wchar_t*>(L"c:\\");
+    s.DispatchThreads = 4;
+
+    // make a copy to make sure copy is not broken
+    const auto r = ::Request(s);
+    const auto request = ::Request(r);
+    EXPECT_EQ(4, request.DispatchThreads());
+  }
+  {
+    // we always have at least one thread.
+    myoddweb::directorywatcher::sRequest s = {};
+    s.Path = const_cast<wchar_t*>(L"c:\\");
+    const auto request = ::Request(s);
+    EXPECT_EQ(1, request.DispatchThreads());
+  }
+}
+
+TEST(Request, PatternsAreSaved) {
+  myoddweb::directorywatcher::sRequest s = {};
+  s.Path = const_cast<wchar_t*>(L"c:\\project");
+  s.IncludePatterns = const_cast<wchar_t*>(L"*.cs");
+  s.ExcludePatterns = const_cast<wchar_t*>(L"bin|obj");
+
+  // make a copy to make sure copy is not broken
+  const auto r = ::Request(s);
+  const auto request = ::Request(r);
+  EXPECT_EQ(std::wstring(L"*.cs"), request.IncludePatterns());
+  EXPECT_EQ(std::wstring(L"bin|obj"), request.ExcludePatterns());
+  EXPECT_EQ(std::wstring(L"c:\\project"), request.PatternsRoot());
+
+  // the children keep the patterns and the root of the parent.
+  const auto child = ::Request(request, L"c:\\project\\src", true);
+  EXPECT_EQ(std::wstring(L"*.cs"), child.IncludePatterns());
+  EXPECT_EQ(std::wstring(L"bin|obj"), child.ExcludePatterns());
+  EXPECT_EQ(std::wstring(L"c:\\project"), child.PatternsRoot());
+}
+
+TEST(Request, MasksAreSaved) {
+  myoddweb::directorywatcher::sRequest s = {};
+  s.Path = const_cast<wchar_t*>(L"c:\\");
+  s.ActionsMask = static_cast<int>(myoddweb::directorywatcher::ActionsMask::Added) | static_cast<int>(myoddweb::directorywatcher::ActionsMask::Removed);
+  s.ChangesMask = static_cast<int>(myoddweb::directorywatcher::ChangesMask::Size) | static_cast<int>(myoddweb::directorywatcher::ChangesMask::LastWrite);
+
+  // make a copy to make sure copy is not broken
+  const auto r = ::Request(s);
+  const auto request = ::Request(r);
+  EXPECT_EQ(s.ActionsMask, request.ActionsMask());
+  EXPECT_EQ(s.ChangesMask, request.ChangesMask());
+  EXPECT_TRUE(request.IsActionWanted(myoddweb::directorywatcher::EventAction::Added));
+  EXPECT_TRUE(request.IsActionWanted(myoddweb::directorywatcher::EventAction::Removed));
+  EXPECT_FALSE(request.IsActionWanted(myoddweb::directorywatcher::EventAction::Touched));
+  EXPECT_FALSE(request.IsActionWanted(myoddweb::directorywatcher::EventAction::Renamed));
+  EXPECT_FALSE(request.IsErrorWanted());
+  EXPECT_FALSE(request.KeepFolderEvents());
+
+  // the children keep the masks, the non recursive ones keep the folders events.
+  const auto child = ::Request(request, L"c:\\src", true);
+  EXPECT_EQ(s.ActionsMask, child.ActionsMask());
+  EXPECT_FALSE(child.KeepFolderEvents());
+  const auto parent = ::Request(request, L"c:\\", false);
+  EXPECT_EQ(s.ChangesMask, parent.ChangesMask());
+  EXPECT_TRUE(parent.KeepFolderEvents());
+}
+
+TEST(Request, NoMasksMeansEverything) {
+  myoddweb::directorywatcher::sRequest s = {};
+  s.Path = const_cast<wchar_t*>(L"c:\\");
+  const auto request = ::Request(s);
+  EXPECT_EQ(static_cast<int>(myoddweb::directorywatcher::ActionsMask::All), request.ActionsMask());
+  EXPECT_EQ(static_cast<int>(myoddweb::directorywatcher::ChangesMask::All), request.ChangesMask());
+  EXPECT_TRUE(request.IsActionWanted(myoddweb::directorywatcher::EventAction::Touched));
+  EXPECT_TRUE(request.IsErrorWanted());
+}
+
+TEST(Request, EventsAreOnlyCountedIfNobodyWantsThem) {
+  const auto statisticsCallback = [](long long, const myoddweb::directorywatcher::sStatistics*) {};
+  const auto eventsCallback = [](long long, bool, const wchar_t*, const wchar_t*, int, int, long long) {};
+  {
+    myoddweb::directorywatcher::sRequest s = {};
+    s.Path = const_cast<wchar_t*>(L"c:\\");
+    s.StatisticsExCallback = statisticsCallback;
+    s.StatisticsCallbackRateMs = 1000;
+    const auto request = ::Request(s);
+    EXPECT_TRUE(request.IsCountingEvents());
+  }
+  {
+    // the events callback needs the events.
+    myoddweb::directorywatcher::sRequest s = {};
+    s.Path = const_cast<wchar_t*>(L"c:\\");
+    s.StatisticsExCallback = statisticsCallback;
+    s.StatisticsCallbackRateMs = 1000;
+    s.EventsCallback = eventsCallback;
+    s.EventsCallbackRateMs = 1000;
+    const auto request = ::Request(s);
+    EXPECT_FALSE(request.IsCountingEvents());
+  }
+  {
+    // and so does the caller pulling them.
+    myoddweb::directorywatcher::sRequest s = {};
+    s.Path = const_cast<wchar_t*>(L"c:\\");
+    s.StatisticsExCallback = statisticsCallback;
+    s.StatisticsCallbackRateMs = 1000;
+    s.PullEvents = true;
+    const auto request = ::Request(s);
+    EXPECT_FALSE(request.IsCountingEvents());
+  }
+}
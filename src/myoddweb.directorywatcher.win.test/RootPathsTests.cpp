@@ -0,0 +1,59 @@
+#include "pch.h"
+#include <thread>
+#include <vector>
+
+#include "../myoddweb.directorywatcher.win/utils/RootPaths.h"
+
+using myoddweb::directorywatcher::RootPaths;
+
+TEST(RootPaths, EmptyRootPathsHaveNoPaths) {
+  const RootPaths roots;
+  EXPECT_EQ(0, roots.Count());
+  EXPECT_TRUE(roots.Get(0).empty());
+}
+
+TEST(RootPaths, SamePathHasTheSameId) {
+  RootPaths roots;
+  const auto foo = roots.Intern(L"c:\\foo");
+  const auto bar = roots.Intern(L"c:\\bar");
+  EXPECT_NE(foo, bar);
+  EXPECT_EQ(foo, roots.Intern(L"c:\\foo"));
+  EXPECT_EQ(bar, roots.Intern(L"c:\\bar"));
+  EXPECT_EQ(2, roots.Count());
+}
+
+TEST(RootPaths, PathsCanBeRetrievedById) {
+  RootPaths roots;
+  const auto foo = roots.Intern(L"c:\\foo");
+  const auto bar = roots.Intern(L"c:\\bar");
+  EXPECT_EQ(L"c:\\foo", roots.Get(foo));
+  EXPECT_EQ(L"c:\\bar", roots.Get(bar));
+  EXPECT_TRUE(roots.Get(42).empty());
+}
+
+TEST(RootPaths, NullPathIsEmpty) {
+  RootPaths roots;
+  const auto id = roots.Intern(nullptr);
+  EXPECT_EQ(id, roots.Intern(L""));
+  EXPECT_TRUE(roots.Get(id).empty());
+}
+
+TEST(RootPaths, PathsAreOnlyAddedOnceByManyThreads) {
+  RootPaths roots;
+  std::vector<std::thread> threads;
+  for (auto t = 0; t < 4; ++t)
+  {
+    threads.emplace_back([&roots]()
+    {
+      for (auto i = 0; i < 1000; ++i)
+      {
+        roots.Intern(i % 2 == 0 ? L"c:\\foo" : L"c:\\bar");
+      }
+    });
+  }
+  for (auto& thread : threads)
+  {
+    thread.join();
+  }
+  EXPECT_EQ(2, roots.Count());
+}
@@ -0,0 +1,246 @@
+#include "pch.h"
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "../myoddweb.directorywatcher.win/utils/Threads/TaskPool.h"
+
+using myoddweb::directorywatcher::threads::TaskPool;
+
+TEST(TaskPool, RunReturnsTheResultOfTheTask) {
+  TaskPool pool(2);
+  auto future = pool.Run<int>([]
+  {
+    return 42;
+  });
+  EXPECT_EQ(42, future.get());
+}
+
+TEST(TaskPool, ZeroThreadsUsesTheNumberOfHardwareThreads) {
+  const TaskPool pool(0);
+  const auto expected = std::thread::hardware_concurrency() == 0 ? 1 : std::thread::hardware_concurrency();
+  EXPECT_EQ(expected, pool.NumberOfThreads());
+}
+
+TEST(TaskPool, AllTheTasksAreRun) {
+  std::atomic<int> count(0);
+  std::vector<std::future<void>> futures;
+  {
+    TaskPool pool(4);
+    for (auto i = 0; i < 10000; ++i)
+    {
+      futures.push_back(pool.Run<void>([&count]
+      {
+        ++count;
+      }));
+    }
+    for (auto& future : futures)
+    {
+      future.get();
+    }
+  }
+  EXPECT_EQ(10000, count);
+}
+
+TEST(TaskPool, PendingTasksAreRunBeforeThePoolIsDeleted) {
+  std::atomic<int> count(0);
+  {
+    TaskPool pool(1);
+    for (auto i = 0; i < 100; ++i)
+    {
+      pool.Run<void>([&count]
+      {
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+        ++count;
+      });
+    }
+  }
+  EXPECT_EQ(100, count);
+}
+
+TEST(TaskPool, IdleThreadsStealTheTasksOfBusyThreads) {
+  constexpr auto numberOfTasks = 50;
+  TaskPool pool(4);
+
+  std::atomic<int> count(0);
+  std::mutex lock;
+  std::set<std::thread::id> threads;
+  std::thread::id owner;
+
+  // all the tasks are added to the queue of the thread running this one
+  // and, as that thread does not run them, they can only complete if they are stolen.
+  auto future = pool.Run<bool>([&]
+  {
+    owner = std::this_thread::get_id();
+    for (auto i = 0; i < numberOfTasks; ++i)
+    {
+      pool.Run<void>([&]
+      {
+        {
+          std::lock_guard<std::mutex> guard(lock);
+          threads.insert(std::this_thread::get_id());
+        }
+        ++count;
+      });
+    }
+
+    const auto until = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (count < numberOfTasks && std::chrono::steady_clock::now() < until)
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return count == numberOfTasks;
+  });
+
+  EXPECT_TRUE(future.get());
+  EXPECT_TRUE(threads.find(owner) == threads.end());
+}
+
+TEST(TaskPool, WaitingTasksCanHelpWithThePendingTasks) {
+  // with one thread, a task waiting for another would wait forever if it did not help.
+  TaskPool pool(1);
+  auto future = pool.Run<int>([&pool]
+  {
+    auto inner = pool.Run<int>([]
+    {
+      return 21;
+    });
+    while (inner.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+    {
+      pool.RunPendingTask();
+    }
+    return inner.get() * 2;
+  });
+  EXPECT_EQ(42, future.get());
+}
+
+TEST(TaskPool, WaitingTasksAreWokenWhenATaskIsQueued) {
+  // with one thread, the queued task cannot complete until the waiting task helps with it.
+  TaskPool pool(1);
+  std::atomic<bool> waiting(false);
+  auto future = pool.Run<bool>([&pool, &waiting]
+  {
+    const auto numberOfCompletedTasks = pool.NumberOfCompletedTasks();
+    waiting = true;
+    if (!pool.WaitForCompletedTask(numberOfCompletedTasks, 10000))
+    {
+      return false;
+    }
+    return pool.RunPendingTask();
+  });
+  while (!waiting)
+  {
+    std::this_thread::yield();
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+  auto inner = pool.Run<int>([]
+  {
+    return 42;
+  });
+  EXPECT_TRUE(future.get());
+  EXPECT_EQ(42, inner.get());
+  EXPECT_GT(std::chrono::milliseconds(5000), std::chrono::steady_clock::now() - start);
+}
+
+TEST(TaskPool, OtherThreadsCannotRunThePendingTasks) {
+  TaskPool pool(1);
+  EXPECT_FALSE(pool.RunPendingTask());
+}
+
+TEST(TaskPool, ATemporaryThreadIsAddedWhenAllTheThreadsAreBlocked) {
+  TaskPool pool(1);
+
+  // block our only thread.
+  std::atomic<bool> started(false);
+  std::atomic<bool> stop(false);
+  std::atomic<bool> blockingIsTemporary(true);
+  auto blocking = pool.Run<void>([&pool, &started, &stop, &blockingIsTemporary]
+  {
+    blockingIsTemporary = pool.IsTemporaryThread();
+    started = true;
+    while (!stop)
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  });
+  while (!started)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  auto blocked = pool.Run<bool>([&pool]
+  {
+    return pool.IsTemporaryThread();
+  });
+
+  // it will not run until we notice that we are starved.
+  EXPECT_EQ(std::future_status::timeout, blocked.wait_for(std::chrono::milliseconds(20)));
+  const auto until = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (!pool.AddThreadIfStarved() && std::chrono::steady_clock::now() < until)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+
+  EXPECT_EQ(std::future_status::ready, blocked.wait_for(std::chrono::seconds(5)));
+  EXPECT_EQ(1u, pool.NumberOfThreads());
+
+  // only the thread we added is temporary, it must not start any IO.
+  EXPECT_TRUE(blocked.get());
+  EXPECT_FALSE(blockingIsTemporary);
+  EXPECT_FALSE(pool.IsTemporaryThread());
+
+  stop = true;
+  blocking.get();
+}
+
+TEST(TaskPool, NoThreadIsAddedWhenTheTasksAreCompleting) {
+  TaskPool pool(1);
+  for (auto i = 0; i < 20; ++i)
+  {
+    pool.Run<void>([]
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    });
+    EXPECT_FALSE(pool.AddThreadIfStarved());
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+}
+
+TEST(TaskPool, DISABLED_BenchmarkScalingWithTheNumberOfThreads) {
+  constexpr auto numberOfTasks = 200000;
+
+  for (auto numberOfThreads : { 1u, 2u, 4u, 8u, 16u, 32u, 64u })
+  {
+    TaskPool pool(numberOfThreads);
+    std::atomic<long long> total(0);
+    std::vector<std::future<void>> futures;
+    futures.reserve(numberOfTasks);
+
+    const auto start = std::chrono::steady_clock::now();
+    for (auto i = 0; i < numberOfTasks; ++i)
+    {
+      // a little bit of work, more for some tasks than others so the threads need to steal.
+      futures.push_back(pool.Run<void>([i, &total]
+      {
+        auto value = 0LL;
+        const auto work = i % 10 == 0 ? 20000 : 500;
+        for (auto j = 0; j < work; ++j)
+        {
+          value += j ^ i;
+        }
+        total += value;
+      }));
+    }
+    for (auto& future : futures)
+    {
+      future.get();
+    }
+    const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "[          ] " << numberOfThreads << " threads: " << numberOfTasks << " tasks in " << elapsed << "ms" << std::endl;
+  }
+}
@@ -0,0 +1,241 @@
+#include "pch.h"
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "../myoddweb.directorywatcher.win/utils/Threads/TimerWheel.h"
+
+using myoddweb::directorywatcher::threads::TimerWheel;
+
+/**
+ * \brief advance the wheel until the condition is true or until the timeout.
+ */
+static bool AdvanceUntil(TimerWheel& wheel, const std::function<bool()>& condition, const long long timeout)
+{
+  const auto until = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout);
+  while (std::chrono::steady_clock::now() < until)
+  {
+    wheel.Advance();
+    if (condition())
+    {
+      return true;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return false;
+}
+
+TEST(TimerWheel, AnEmptyWheelHasNothingDue) {
+  TimerWheel wheel;
+  EXPECT_EQ(-1, wheel.Advance());
+  EXPECT_EQ(0, wheel.NumberOfTimers());
+}
+
+TEST(TimerWheel, ATimerIsCalledOnceWhenItIsDue) {
+  TimerWheel wheel;
+  auto count = 0;
+  TimerWheel::Timer timer([&count] { ++count; });
+
+  const auto start = std::chrono::steady_clock::now();
+  wheel.Schedule(timer, 30);
+  EXPECT_EQ(1, wheel.NumberOfTimers());
+
+  wheel.Advance();
+  EXPECT_EQ(0, count);
+
+  EXPECT_TRUE(AdvanceUntil(wheel, [&count] { return count > 0; }, 5000));
+  EXPECT_GE(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count(), 30);
+
+  // it is no longer scheduled.
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  EXPECT_EQ(-1, wheel.Advance());
+  EXPECT_EQ(1, count);
+  EXPECT_EQ(0, wheel.NumberOfTimers());
+}
+
+TEST(TimerWheel, ACancelledTimerIsNotCalled) {
+  TimerWheel wheel;
+  auto count = 0;
+  TimerWheel::Timer timer([&count] { ++count; });
+
+  wheel.Schedule(timer, 5);
+  wheel.Cancel(timer);
+  EXPECT_EQ(0, wheel.NumberOfTimers());
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  EXPECT_EQ(-1, wheel.Advance());
+  EXPECT_EQ(0, count);
+
+  // cancelling again does nothing.
+  wheel.Cancel(timer);
+  EXPECT_EQ(0, wheel.NumberOfTimers());
+}
+
+TEST(TimerWheel, SchedulingAgainReplacesTheDueTime) {
+  TimerWheel wheel;
+  auto count = 0;
+  TimerWheel::Timer timer([&count] { ++count; });
+
+  wheel.Schedule(timer, 5);
+  wheel.Schedule(timer, 10000);
+  EXPECT_EQ(1, wheel.NumberOfTimers());
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  wheel.Advance();
+  EXPECT_EQ(0, count);
+}
+
+TEST(TimerWheel, DeletingATimerRemovesItFromTheWheel) {
+  TimerWheel wheel;
+  auto count = 0;
+  auto timer = std::make_unique<TimerWheel::Timer>([&count] { ++count; });
+
+  wheel.Schedule(*timer, 5);
+  timer.reset();
+  EXPECT_EQ(0, wheel.NumberOfTimers());
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  EXPECT_EQ(-1, wheel.Advance());
+  EXPECT_EQ(0, count);
+}
+
+TEST(TimerWheel, AdvanceReturnsWhenTheNextTimerMightBeDue) {
+  TimerWheel wheel;
+  TimerWheel::Timer soon([] {});
+  TimerWheel::Timer later([] {});
+
+  wheel.Schedule(later, 5000);
+  const auto laterDue = wheel.Advance();
+  EXPECT_GT(laterDue, 0);
+  EXPECT_LE(laterDue, 5000);
+
+  // the due time is rounded up to the next full ms.
+  wheel.Schedule(soon, 20);
+  const auto soonDue = wheel.Advance();
+  EXPECT_GE(soonDue, 0);
+  EXPECT_LE(soonDue, 21);
+}
+
+TEST(TimerWheel, TimersInTheUpperLevelsAreMovedDownAndCalledOnTime) {
+  TimerWheel wheel;
+  std::chrono::steady_clock::time_point called;
+  TimerWheel::Timer timer([&called] { called = std::chrono::steady_clock::now(); });
+
+  // more than the 64ms of the first level.
+  const auto start = std::chrono::steady_clock::now();
+  wheel.Schedule(timer, 150);
+  EXPECT_TRUE(AdvanceUntil(wheel, [&wheel] { return wheel.NumberOfTimers() == 0; }, 5000));
+  EXPECT_GE(std::chrono::duration_cast<std::chrono::milliseconds>(called - start).count(), 150);
+}
+
+TEST(TimerWheel, ManyTimersAreAllCalledOnceAndNeverEarly) {
+  constexpr auto numberOfTimers = 1000;
+  TimerWheel wheel;
+
+  struct Due
+  {
+    std::chrono::steady_clock::time_point due;
+    std::chrono::steady_clock::time_point called;
+    int count = 0;
+  };
+  std::vector<Due> dues(numberOfTimers);
+  std::vector<std::unique_ptr<TimerWheel::Timer>> timers;
+  const auto start = std::chrono::steady_clock::now();
+  for (auto i = 0; i < numberOfTimers; ++i)
+  {
+    auto& due = dues[i];
+    timers.push_back(std::make_unique<TimerWheel::Timer>([&due]
+    {
+      due.called = std::chrono::steady_clock::now();
+      ++due.count;
+    }));
+
+    // spread them over all the slots of the first two levels.
+    const auto milliseconds = static_cast<long long>((i * 7) % 300);
+    due.due = start + std::chrono::milliseconds(milliseconds);
+    wheel.Schedule(*timers.back(), milliseconds);
+  }
+
+  EXPECT_TRUE(AdvanceUntil(wheel, [&wheel] { return wheel.NumberOfTimers() == 0; }, 5000));
+  for (const auto& due : dues)
+  {
+    EXPECT_EQ(1, due.count);
+    EXPECT_GE(due.called, due.due);
+  }
+}
+
+TEST(TimerWheel, DISABLED_BenchmarkAdvanceWithManyTimers) {
+  constexpr auto numberOfTimers = 100000;
+  constexpr auto durationMilliseconds = 2000;
+
+  // every timer has its own rate, between 100ms and 10s.
+  std::vector<long long> rates;
+  for (auto i = 0; i < numberOfTimers; ++i)
+  {
+    rates.push_back(100 + (i * 97) % 9900);
+  }
+
+  // what we used to do, add the elapsed time to every counter at every tick.
+  {
+    std::vector<float> elapsed(numberOfTimers, 0);
+    long long fired = 0;
+    long long ticks = 0;
+    std::chrono::steady_clock::duration busy{};
+    const auto start = std::chrono::steady_clock::now();
+    auto last = start;
+    while (std::chrono::steady_clock::now() - start < std::chrono::milliseconds(durationMilliseconds))
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      const auto now = std::chrono::steady_clock::now();
+      const auto tick = std::chrono::duration<float, std::milli>(now - last).count();
+      last = now;
+      for (auto i = 0; i < numberOfTimers; ++i)
+      {
+        elapsed[i] += tick;
+        if (elapsed[i] >= static_cast<float>(rates[i]))
+        {
+          elapsed[i] = 0;
+          ++fired;
+        }
+      }
+      busy += std::chrono::steady_clock::now() - now;
+      ++ticks;
+    }
+    std::cout << "[          ] per tick counters: " << ticks << " ticks, " << fired << " fired, " << std::chrono::duration_cast<std::chrono::milliseconds>(busy).count() << "ms of work" << std::endl;
+  }
+
+  // with the wheel, only the due timers cost anything.
+  {
+    TimerWheel wheel;
+    std::vector<int> due;
+    std::vector<std::unique_ptr<TimerWheel::Timer>> timers;
+    for (auto i = 0; i < numberOfTimers; ++i)
+    {
+      timers.push_back(std::make_unique<TimerWheel::Timer>([i, &due] { due.push_back(i); }));
+      wheel.Schedule(*timers.back(), rates[i]);
+    }
+
+    long long fired = 0;
+    long long ticks = 0;
+    std::chrono::steady_clock::duration busy{};
+    const auto start = std::chrono::steady_clock::now();
+    while (std::chrono::steady_clock::now() - start < std::chrono::milliseconds(durationMilliseconds))
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      const auto now = std::chrono::steady_clock::now();
+      wheel.Advance();
+      for (const auto& i : due)
+      {
+        wheel.Schedule(*timers[i], rates[i]);
+      }
+      fired += static_cast<long long>(due.size());
+      due.clear();
+      busy += std::chrono::steady_clock::now() - now;
+      ++ticks;
+    }
+    std::cout << "[          ] timer wheel: " << ticks << " ticks, " << fired << " fired, " << std::chrono::duration_cast<std::chrono::milliseconds>(busy).count() << "ms of work" << std::endl;
+  }
+}
@@ -1,4 +1,5 @@
 ﻿#pragma once
+#include <limits>
 #include "../myoddweb.directorywatcher.win/utils/Threads/Worker.h"
 #include "../myoddweb.directorywatcher.win/utils/Threads/WorkerPool.h"
 
@@ -62,3 +63,40 @@ public:
     return TestWorker::OnWorkerStart();
   }
 };
+
+class IdleTestWorker : public TestWorker
+{
+  const long long _maxIdleMilliseconds;
+
+public:
+  explicit IdleTestWorker(const long long maxIdleMilliseconds, const int maxUpdate = std::numeric_limits<int>::max())
+    : TestWorker(maxUpdate),
+    _maxIdleMilliseconds(maxIdleMilliseconds)
+  {
+  }
+
+  long long MaxIdleMilliseconds() const override
+  {
+    return _maxIdleMilliseconds;
+  }
+};
+
+class TestWorkerOnEnd : public TestWorker
+{
+  ::Worker& _worker;
+  ::WorkerPool& _pool;
+
+public:
+  TestWorkerOnEnd(::WorkerPool& pool, ::Worker& worker, const int maxUpdate = 5)
+   : TestWorker( maxUpdate ),
+   _worker( worker ),
+   _pool( pool)
+  {
+  }
+
+  void OnWorkerEnd() override
+  {
+    _pool.StopAndWait(_worker, -1);
+    TestWorker::OnWorkerEnd();
+  }
+};
@@ -1,5 +1,14 @@
-#include "../myoddweb.directorywatcher.win/utils/Threads/CallbackWorker.h"
+﻿#include "../myoddweb.directorywatcher.win/utils/Threads/CallbackWorker.h"
 #include "pch.h"
+#include <chrono>
+#include <ctime>
+#include <iostream>
+#include <limits>
+#include <thread>
+#include <vector>
+#if defined( _WIN32) || defined(_WIN64 )
+  #include <windows.h>
+#endif
 #include "../myoddweb.directorywatcher.win/utils/Threads/WorkerPool.h"
 #include "../myoddweb.directorywatcher.win/utils/Threads/Worker.h"
 #include "../myoddweb.directorywatcher.win/utils/Wait.h"
@@ -9,6 +18,26 @@
 using myoddweb::directorywatcher::threads::WorkerPool;
 using myoddweb::directorywatcher::Wait;
 
+/**
+ * \brief the cpu time used by the process, in ms.
+ */
+static double ProcessCpuMilliseconds()
+{
+#if defined( _WIN32) || defined(_WIN64 )
+  FILETIME creation, exit, kernel, user;
+  ::GetProcessTimes(::GetCurrentProcess(), &creation, &exit, &kernel, &user);
+  ULARGE_INTEGER kernelTime, userTime;
+  kernelTime.LowPart = kernel.dwLowDateTime;
+  kernelTime.HighPart = kernel.dwHighDateTime;
+  userTime.LowPart = user.dwLowDateTime;
+  userTime.HighPart = user.dwHighDateTime;
+  // the times are in 100ns
+  return static_cast<double>(kernelTime.QuadPart + userTime.QuadPart) / 10000.0;
+#else
+  return 1000.0 * static_cast<double>(std::clock()) / CLOCKS_PER_SEC;
+#endif
+}
+
 TEST(WorkPool, DefaultValues) {
   {
     const auto pool = ::WorkerPool( 10 );
@@ -651,3 +680,335 @@ TEST(WorkPool, AddAWorkerWithinAWorkerOnStartDurringPoolUpdate) {
   }
 }
 
+TEST(WorkPool, IdleWorkersAreOnlyUpdatedWhenTheyAreReady) {
+  auto worker = IdleTestWorker(-1);
+  auto pool = ::WorkerPool(10);
+  pool.Add(worker);
+
+  // wait for it to start
+  if (!Wait::SpinUntil([&]
+    {
+      return worker.Started();
+    }, TEST_TIMEOUT_WAIT))
+  {
+    GTEST_FATAL_FAILURE_("Unable to start worker");
+  }
+
+  // give it plenty of time to be updated if it was going to be.
+  std::this_thread::sleep_for(std::chrono::milliseconds(10 * TEST_TIMEOUT));
+  EXPECT_EQ(0, worker._updateCalled);
+
+  // it now has something to do.
+  worker.SignalReady();
+  EXPECT_TRUE(Wait::SpinUntil([&]
+    {
+      return worker._updateCalled == 1;
+    }, TEST_TIMEOUT_WAIT));
+
+  const auto wr = pool.StopAndWait(TEST_TIMEOUT_WAIT);
+  EXPECT_EQ(myoddweb::directorywatcher::threads::WaitResult::complete, wr);
+  EXPECT_EQ(1, worker._endCalled);
+}
+
+TEST(WorkPool, IdleWorkersAreUpdatedWhenTheyAreDue) {
+  // updated every 100ms rather than at every 10ms tick.
+  auto worker = IdleTestWorker(100);
+  auto pool = ::WorkerPool(10);
+  pool.Add(worker);
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(550));
+  const auto updateCalled = worker._updateCalled;
+
+  const auto wr = pool.StopAndWait(TEST_TIMEOUT_WAIT);
+  EXPECT_EQ(myoddweb::directorywatcher::threads::WaitResult::complete, wr);
+
+  EXPECT_GE(updateCalled, 2);
+  EXPECT_LE(updateCalled, 10);
+}
+
+TEST(WorkPool, StoppingAnIdleWorkerEndsItRightAway) {
+  auto worker = IdleTestWorker(-1);
+  auto pool = ::WorkerPool(10);
+  pool.Add(worker);
+
+  // wait for it to start
+  if (!Wait::SpinUntil([&]
+    {
+      return worker.Started();
+    }, TEST_TIMEOUT_WAIT))
+  {
+    GTEST_FATAL_FAILURE_("Unable to start worker");
+  }
+
+  // the pool is sleeping, but it is woken up to end the worker.
+  const auto start = std::chrono::steady_clock::now();
+  const auto wr = pool.StopAndWait(worker, TEST_TIMEOUT_WAIT);
+  EXPECT_EQ(myoddweb::directorywatcher::threads::WaitResult::complete, wr);
+  EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(TEST_TIMEOUT_WAIT / 2));
+  EXPECT_EQ(1, worker._endCalled);
+
+  pool.StopAndWait(TEST_TIMEOUT_WAIT);
+}
+
+TEST(WorkPool, AWorkerCanWaitForAnotherWorkerWithASingleThread) {
+  // with one thread, the end of the first worker runs on the thread that the other worker needs.
+  auto pool = ::WorkerPool(10, 1);
+  auto other = TestWorker(std::numeric_limits<int>::max());
+  auto worker = TestWorkerOnEnd(pool, other, 10);
+  pool.Add(other);
+  pool.Add(worker);
+
+  EXPECT_EQ(myoddweb::directorywatcher::threads::WaitResult::complete, pool.WaitFor(worker, TEST_TIMEOUT_WAIT));
+  EXPECT_TRUE(other.Completed());
+  EXPECT_EQ(1, other._endCalled);
+  EXPECT_EQ(1, worker._endCalled);
+
+  pool.StopAndWait(TEST_TIMEOUT_WAIT);
+}
+
+TEST(WorkPool, ManyWorkersAreUpdatedWithASingleThread) {
+  constexpr auto numberOfWorkers = 100;
+  std::vector<TestWorker*> workers;
+  for (auto i = 0; i < numberOfWorkers; ++i)
+  {
+    workers.push_back(new TestWorker(10));
+  }
+
+  auto pool = ::WorkerPool(1, 1);
+  for (const auto& worker : workers)
+  {
+    pool.Add(*worker);
+  }
+
+  EXPECT_EQ(myoddweb::directorywatcher::threads::WaitResult::complete, pool.WaitFor(10 * TEST_TIMEOUT_WAIT));
+  for (const auto& worker : workers)
+  {
+    EXPECT_EQ(10, worker->_updateCalled);
+    EXPECT_EQ(1, worker->_endCalled);
+    delete worker;
+  }
+}
+
+TEST(WorkPool, AddingManyWorkersAddsThemAll) {
+  constexpr auto numberOfWorkers = 10000;
+  std::vector<TestWorker*> workers;
+  for (auto i = 0; i < numberOfWorkers; ++i)
+  {
+    workers.push_back(new TestWorker(1));
+  }
+
+  auto pool = ::WorkerPool(10);
+  for (const auto& worker : workers)
+  {
+    pool.Add(*worker);
+  }
+
+  EXPECT_EQ(myoddweb::directorywatcher::threads::WaitResult::complete, pool.WaitFor(10 * TEST_TIMEOUT_WAIT));
+  for (const auto& worker : workers)
+  {
+    EXPECT_EQ(1, worker->_startCalled);
+    EXPECT_EQ(1, worker->_endCalled);
+    delete worker;
+  }
+}
+
+TEST(WorkPool, AddingTheSameWorkerTwiceOnlyAddsItOnce) {
+  auto worker = TestWorker(5);
+  auto pool = ::WorkerPool(10);
+  pool.Add(worker);
+  pool.Add(worker);
+
+  EXPECT_EQ(myoddweb::directorywatcher::threads::WaitResult::complete, pool.WaitFor(TEST_TIMEOUT_WAIT));
+  EXPECT_EQ(1, worker._startCalled);
+  EXPECT_EQ(5, worker._updateCalled);
+  EXPECT_EQ(1, worker._endCalled);
+}
+
+TEST(WorkPool, WorkersAddedWhileThePoolIsEndingAreStarted) {
+  auto pool = ::WorkerPool(1);
+  for (auto i = 0; i < 50; ++i)
+  {
+    // the pool ends as soon as the previous worker completes, so this one is added while it is ending.
+    auto worker = TestWorker(1);
+    pool.Add(worker);
+    EXPECT_EQ(myoddweb::directorywatcher::threads::WaitResult::complete, pool.WaitFor(worker, TEST_TIMEOUT_WAIT));
+    EXPECT_EQ(1, worker._startCalled);
+  }
+  EXPECT_EQ(myoddweb::directorywatcher::threads::WaitResult::complete, pool.StopAndWait(TEST_TIMEOUT_WAIT));
+}
+
+TEST(WorkPool, DISABLED_BenchmarkIdleCpuWithManyWorkers) {
+
+  constexpr auto numberOfWorkers = 1000;
+  constexpr auto durationMilliseconds = 3000;
+
+  // every tick is how all the workers were updated before they could tell the pool that they are idle.
+  for (auto maxIdleMilliseconds : { 0LL, -1LL })
+  {
+    std::vector<IdleTestWorker*> workers;
+    for (auto i = 0; i < numberOfWorkers; ++i)
+    {
+      workers.push_back(new IdleTestWorker(maxIdleMilliseconds));
+    }
+
+    auto pool = ::WorkerPool(10);
+    for (const auto& worker : workers)
+    {
+      pool.Add(*worker);
+    }
+
+    // give them all a chance to start.
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+
+    const auto start = ProcessCpuMilliseconds();
+    std::this_thread::sleep_for(std::chrono::milliseconds(durationMilliseconds));
+    const auto cpu = ProcessCpuMilliseconds() - start;
+
+    long long updates = 0;
+    for (const auto& worker : workers)
+    {
+      updates += worker->_updateCalled;
+    }
+
+    pool.StopAndWait(-1);
+    for (const auto& worker : workers)
+    {
+      delete worker;
+    }
+
+    std::cout << "[          ] " << numberOfWorkers << " idle workers, " << (maxIdleMilliseconds == 0 ? "updated at every tick" : "updated when ready") << ": " << cpu << "ms of cpu in " << durationMilliseconds << "ms, " << updates << " updates" << std::endl;
+  }
+}
+
+TEST(WorkPool, DISABLED_BenchmarkUpdatesScalingWithTheNumberOfThreads) {
+
+  constexpr auto numberOfWorkers = 1000;
+  constexpr auto durationMilliseconds = 2000;
+
+  for (auto numberOfThreads : { 1u, 2u, 4u, 8u, 16u, 32u, 64u })
+  {
+    // busy workers are updated at every tick.
+    std::vector<IdleTestWorker*> workers;
+    for (auto i = 0; i < numberOfWorkers; ++i)
+    {
+      workers.push_back(new IdleTestWorker(0));
+    }
+
+    auto pool = ::WorkerPool(1, numberOfThreads);
+    for (const auto& worker : workers)
+    {
+      pool.Add(*worker);
+    }
+
+    // give them all a chance to start.
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+
+    long long start = 0;
+    for (const auto& worker : workers)
+    {
+      start += worker->_updateCalled;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(durationMilliseconds));
+    long long updates = 0;
+    for (const auto& worker : workers)
+    {
+      updates += worker->_updateCalled;
+    }
+
+    pool.StopAndWait(-1);
+    for (const auto& worker : workers)
+    {
+      delete worker;
+    }
+
+    std::cout << "[          ] " << numberOfThreads << " threads: " << (updates - start) << " updates of " << numberOfWorkers << " workers in " << durationMilliseconds << "ms" << std::endl;
+  }
+}
+
+TEST(WorkPool, DISABLED_BenchmarkAddingManyWorkers) {
+
+  constexpr auto numberOfWorkers = 10000;
+  std::vector<IdleTestWorker*> workers;
+  for (auto i = 0; i < numberOfWorkers; ++i)
+  {
+    workers.push_back(new IdleTestWorker(-1));
+  }
+
+  auto pool = ::WorkerPool(10);
+  const auto start = std::chrono::steady_clock::now();
+  for (const auto& worker : workers)
+  {
+    pool.Add(*worker);
+  }
+  const auto added = std::chrono::steady_clock::now();
+
+  // wait for all of them to be registered and started.
+  Wait::SpinUntil([&]
+    {
+      for (const auto& worker : workers)
+      {
+        if (!worker->Started())
+        {
+          return false;
+        }
+      }
+      return true;
+    }, -1);
+  const auto started = std::chrono::steady_clock::now();
+
+  pool.StopAndWait(-1);
+  for (const auto& worker : workers)
+  {
+    delete worker;
+  }
+
+  std::cout << "[          ] " << numberOfWorkers << " workers added in " << std::chrono::duration_cast<std::chrono::milliseconds>(added - start).count() << "ms and started in " << std::chrono::duration_cast<std::chrono::milliseconds>(started - start).count() << "ms" << std::endl;
+}
+
+TEST(WorkPool, DISABLED_BenchmarkStopAndWaitManyWorkers) {
+
+  constexpr auto numberOfWorkers = 10000;
+
+  // busy workers are updated at every tick so the pool is still running updates while we wait.
+  for (auto maxIdleMilliseconds : { -1LL, 0LL })
+  {
+    std::vector<IdleTestWorker*> workers;
+    for (auto i = 0; i < numberOfWorkers; ++i)
+    {
+      workers.push_back(new IdleTestWorker(maxIdleMilliseconds));
+    }
+
+    auto pool = ::WorkerPool(10);
+    for (const auto& worker : workers)
+    {
+      pool.Add(*worker);
+    }
+
+    // wait for all of them to be started.
+    Wait::SpinUntil([&]
+      {
+        for (const auto& worker : workers)
+        {
+          if (!worker->Started())
+          {
+            return false;
+          }
+        }
+        return true;
+      }, -1);
+
+    const auto cpu = ProcessCpuMilliseconds();
+    const auto start = std::chrono::steady_clock::now();
+    pool.StopAndWait(-1);
+    const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    const auto used = ProcessCpuMilliseconds() - cpu;
+
+    for (const auto& worker : workers)
+    {
+      EXPECT_TRUE(worker->Completed());
+      delete worker;
+    }
+
+    std::cout << "[          ] " << numberOfWorkers << (maxIdleMilliseconds == 0 ? " busy" : " idle") << " workers stopped in " << elapsed << "ms using " << used << "ms of cpu" << std::endl;
+  }
+}
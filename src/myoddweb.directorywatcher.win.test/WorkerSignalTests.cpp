@@ -0,0 +1,42 @@
+#include "pch.h"
+#include <chrono>
+#include <thread>
+
+#include "../myoddweb.directorywatcher.win/utils/Threads/WorkerSignal.h"
+
+using myoddweb::directorywatcher::threads::WorkerSignal;
+
+TEST(WorkerSignal, WaitTimesOutIfWeAreNotNotified) {
+  WorkerSignal signal;
+  EXPECT_FALSE(signal.Wait(10));
+}
+
+TEST(WorkerSignal, NotificationIsKeptUntilTheNextWait) {
+  WorkerSignal signal;
+  signal.Notify();
+  signal.Notify();
+
+  const auto start = std::chrono::steady_clock::now();
+  EXPECT_TRUE(signal.Wait(10000));
+  EXPECT_GT(std::chrono::seconds(5), std::chrono::steady_clock::now() - start);
+
+  // both notifications were used by the one wait.
+  EXPECT_FALSE(signal.Wait(10));
+}
+
+TEST(WorkerSignal, NotifyWakesUpTheWaitingThread) {
+  WorkerSignal signal;
+  auto notified = false;
+
+  const auto start = std::chrono::steady_clock::now();
+  std::thread waiting([&]
+  {
+    notified = signal.Wait(-1);
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  signal.Notify();
+  waiting.join();
+
+  EXPECT_TRUE(notified);
+  EXPECT_GT(std::chrono::seconds(5), std::chrono::steady_clock::now() - start);
+}
@@ -1,4 +1,6 @@
 #include "pch.h"
+#include <chrono>
+#include <thread>
 #include "../myoddweb.directorywatcher.win/utils/Threads/Worker.h"
 #include "../myoddweb.directorywatcher.win/utils/Wait.h"
 #include "WorkerHelper.h"
@@ -39,3 +41,43 @@ TEST(Worker, StopAfterWeHaveStopped)
   worker.Stop();
   EXPECT_TRUE(worker.Completed());
 }
+
+TEST(Worker, WaitForTimesOutIfTheWorkerDoesNotComplete)
+{
+  auto worker = TestWorker(1);
+  EXPECT_EQ(myoddweb::directorywatcher::threads::WaitResult::timeout, worker.WaitFor(20));
+}
+
+TEST(Worker, WaitForReturnsAsSoonAsTheWorkerCompletes)
+{
+  auto worker = TestWorker(1);
+  auto thread = std::thread([&worker]
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    worker.Execute();
+  });
+
+  // we are woken up by the worker rather than by the timeout.
+  const auto start = std::chrono::steady_clock::now();
+  EXPECT_EQ(myoddweb::directorywatcher::threads::WaitResult::complete, worker.WaitFor(10000));
+  const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+  EXPECT_LT(elapsed, 5000);
+  EXPECT_TRUE(worker.Completed());
+
+  thread.join();
+}
+
+TEST(Worker, WaitForWithoutTimeoutWaitsUntilTheWorkerCompletes)
+{
+  auto worker = TestWorker(1);
+  auto thread = std::thread([&worker]
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    worker.Execute();
+  });
+
+  EXPECT_EQ(myoddweb::directorywatcher::threads::WaitResult::complete, worker.WaitFor(-1));
+  EXPECT_TRUE(worker.Completed());
+
+  thread.join();
+}
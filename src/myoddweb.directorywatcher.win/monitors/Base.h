@@ -32,6 +32,24 @@ namespace myoddweb:: directorywatcher
    */
   const auto MYODDWEB_WORKERPOOL_THROTTLE = 10L;
 
+  /**
+   * \brief the longest the worker pool sleeps for when none of its workers is due
+   *        the workers wake the pool when they are ready so this is only a safety net.
+   */
+  constexpr auto MYODDWEB_WORKERPOOL_MAX_IDLE = 1000L;
+
+  /**
+   * \brief the number of threads the worker pool uses to update its workers
+   *        0 is one thread per hardware thread, idle threads steal the updates queued on the busy ones.
+   */
+  constexpr auto MYODDWEB_WORKERPOOL_THREADS = 0u;
+
+  /**
+   * \brief how long, in ms, the queued updates can wait while all the worker pool threads are blocked
+   *        after that we add a temporary thread so a long running update does not prevent the others from running.
+   */
+  constexpr auto MYODDWEB_WORKERPOOL_STARVATION = 100L;
+
   /**
    * \brief The min number of Milliseconds we want to wait for an IO signal.
    *        If this number is too low then we will use more CPU.
@@ -95,4 +113,58 @@ namespace myoddweb:: directorywatcher
    *        but it should not be that important
    */
   constexpr auto MYODDWEB_MAX_EVENT_AGE_BUFFER = 1000;
+
+  /**
+   * \brief the number of events the collector can hold in the lock free ring
+   *        before a producer has to take the lock and move them to the main container.
+   */
+  constexpr auto MYODDWEB_EVENTS_RING_CAPACITY = 4096;
+
+  /**
+   * \brief the size of each block of memory used by the collector arenas.
+   *        all the events and their paths for a publish window are stored in those blocks.
+   */
+  constexpr auto MYODDWEB_ARENA_BLOCK_SIZE = 64 * 1024;
+
+  /**
+   * \brief the number of events in each segment of the collector deque
+   *        old events are removed one segment at a time.
+   */
+  constexpr auto MYODDWEB_EVENTS_SEGMENT_SIZE = 1024;
+
+  /**
+   * \brief when the collector has too many events it removes them until it is
+   *        below that percentage of its limits, so we do not shed on every new event.
+   */
+  constexpr auto MYODDWEB_OVERFLOW_LOW_WATERMARK = 75;
+
+  /**
+   * \brief the number of times the limits of the collector that can be allocated
+   *        during a single publish window, after that the new events are dropped.
+   *        this is what keeps the memory used by the arenas predictable.
+   */
+  constexpr auto MYODDWEB_OVERFLOW_WINDOW_FACTOR = 2;
+
+  /**
+   * \brief the maximum number of shards a collector can spread its producers over.
+   */
+  constexpr auto MYODDWEB_MAX_COLLECTOR_SHARDS = 64;
+
+  /**
+   * \brief the maximum number of half renames a collector keeps waiting for their other half
+   *        after that the oldest ones are added as they are.
+   */
+  constexpr auto MYODDWEB_MAX_PENDING_RENAMES = 1024;
+
+  /**
+   * \brief the maximum number of ms the low latency publisher waits for the first event
+   *        before it checks if the statistics need to be published, or if it needs to stop.
+   */
+  constexpr auto MYODDWEB_LOW_LATENCY_IDLE_WAIT = 50L;
+
+  /**
+   * \brief the number of batches each dispatching thread can queue
+   *        when we use more than one thread but the queue size was not given.
+   */
+  constexpr auto MYODDWEB_DEFAULT_DISPATCH_QUEUE_SIZE = 16L;
 }
@@ -29,6 +29,135 @@ namespace myoddweb:: directorywatcher
     long long numberOfEvents
     );
 
+  extern "C" {
+    /**
+     * \brief the extended statistics of a monitor, since the last time they were published.
+     *        NB: THE ORDER OF THE VARIABLES IS IMPORTANT! As set in the Delegates.cs file
+     */
+    struct sStatistics
+    {
+      /**
+       * \brief the number of ms since the last time the statistics were published.
+       */
+      double ElapsedTime;
+
+      /**
+       * \brief the number of events since the last time.
+       */
+      long long NumberOfEvents;
+
+      /**
+       * \brief the number of added events.
+       */
+      long long NumberOfAdded;
+
+      /**
+       * \brief the number of removed events.
+       */
+      long long NumberOfRemoved;
+
+      /**
+       * \brief the number of touched events.
+       */
+      long long NumberOfTouched;
+
+      /**
+       * \brief the number of renamed events.
+       */
+      long long NumberOfRenamed;
+
+      /**
+       * \brief the number of events with an error, (including the overflows).
+       */
+      long long NumberOfErrors;
+
+      /**
+       * \brief the number of overflow events.
+       */
+      long long NumberOfOverflows;
+
+      /**
+       * \brief the number of events dropped because of the limits.
+       */
+      long long NumberOfDroppedEvents;
+
+      /**
+       * \brief the median age, in ms, of the events when they were given to the callback.
+       */
+      long long EventAgeP50;
+
+      /**
+       * \brief the 90th percentile of the age of the events, in ms.
+       */
+      long long EventAgeP90;
+
+      /**
+       * \brief the 99th percentile of the age of the events, in ms.
+       */
+      long long EventAgeP99;
+
+      /**
+       * \brief the oldest event, in ms.
+       */
+      long long EventAgeMax;
+
+      /**
+       * \brief the median duration, in microseconds, of the events callback.
+       */
+      long long CallbackDurationP50;
+
+      /**
+       * \brief the 90th percentile of the duration of the events callback, in microseconds.
+       */
+      long long CallbackDurationP90;
+
+      /**
+       * \brief the 99th percentile of the duration of the events callback, in microseconds.
+       */
+      long long CallbackDurationP99;
+
+      /**
+       * \brief the longest events callback, in microseconds.
+       */
+      long long CallbackDurationMax;
+
+      /**
+       * \brief the median number of events in the collector when they were drained.
+       */
+      long long DepthP50;
+
+      /**
+       * \brief the 90th percentile of the number of events in the collector when they were drained.
+       */
+      long long DepthP90;
+
+      /**
+       * \brief the 99th percentile of the number of events in the collector when they were drained.
+       */
+      long long DepthP99;
+
+      /**
+       * \brief the largest number of events in the collector when they were drained.
+       */
+      long long DepthMax;
+
+      /**
+       * \brief the time, in microseconds, we were blocked waiting for room in the dispatch queue.
+       */
+      long long DispatchBlockedTime;
+    };
+  }
+
+  /**
+   * \brief the extended statistics, including the latency histograms.
+   * \param id the monitor id
+   * \param statistics the statistics, only valid for the duration of the call.
+   */
+  typedef void(__stdcall* StatisticsExCallback)(
+    long long id,
+    const sStatistics* statistics
+    );
+
   /**
    * \brief the callback function when an event is raised.
    * \param id the monitor id
@@ -48,4 +177,61 @@ namespace myoddweb:: directorywatcher
     int error,
     long long dateTimeUtc
     );
+
+  extern "C" {
+    /**
+     * \brief a single event as given to the EventsBatchCallback
+     *        the names are offsets, in characters, in the names buffer given with the events.
+     *        NB: THE ORDER OF THE VARIABLES IS IMPORTANT! As set in the Delegates.cs file
+     */
+    struct sEvent
+    {
+      /**
+       * \brief unix timestamp of the event
+       */
+      long long DateTimeUtc;
+
+      /**
+       * \brief the offset of the null terminated name of the file in the names.
+       */
+      int Name;
+
+      /**
+       * \brief the offset of the null terminated previous name of the file in the names.
+       */
+      int OldName;
+
+      /**
+       * \brief the action that happened
+       */
+      int Action;
+
+      /**
+       * \brief the error type, (if any)
+       */
+      int Error;
+
+      /**
+       * \brief if the event is for a file or not, (0 or 1).
+       */
+      int IsFile;
+    };
+  }
+
+  /**
+   * \brief the callback function when a batch of events is published.
+   *        the events and the names are only valid for the duration of the call.
+   * \param id the monitor id
+   * \param events the events, from the oldest to the newest.
+   * \param numberOfEvents the number of events.
+   * \param names all the null terminated names of the events.
+   * \param numberOfCharacters the number of characters in the names.
+   */
+  typedef void(__stdcall* EventsBatchCallback)(
+    long long id,
+    const sEvent* events,
+    int numberOfEvents,
+    const wchar_t* names,
+    int numberOfCharacters
+    );
 }
\ No newline at end of file
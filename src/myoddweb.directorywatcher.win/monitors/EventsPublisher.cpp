@@ -2,11 +2,20 @@
 // Florent Guelfucci licenses this file to you under the MIT license.
 // See the LICENSE file in the project root for more information.
 #include "EventsPublisher.h"
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <string_view>
 #include <vector>
+#include "../utils/Collector.h"
 #include "../utils/Event.h"
+#include "../utils/EventAction.h"
+#include "../utils/EventError.h"
 #include "../utils/Instrumentor.h"
+#include "../utils/Lock.h"
 #include "../utils/Logger.h"
 #include "../utils/LogLevel.h"
+#include "../utils/PathFilter.h"
 #include "Monitor.h"
 
 namespace myoddweb::directorywatcher
@@ -16,38 +25,99 @@ namespace myoddweb::directorywatcher
     _monitor(monitor),
     _id(id),
     _request(request),
-    _elapsedEventsTimeMilliseconds(0),
-    _elapsedStatisticsTimeMilliseconds(0)
+    _nextEventsTime(std::chrono::steady_clock::now() + std::chrono::milliseconds(request.EventsCallbackRateMilliseconds())),
+    _nextStatisticsTime(std::chrono::steady_clock::now() + std::chrono::milliseconds(request.StatsCallbackRateMilliseconds())),
+    _lastStatisticsTime(std::chrono::steady_clock::now()),
+    _lastDroppedEvents(0),
+    _lowLatencyThread(nullptr)
   {
+    // the events are copied to the queues and given to the callback by the dispatching threads.
+    if ((_request.DispatchQueueSize() > 0 || _request.DispatchThreads() > 1) && _request.IsUsingEvents() && !_request.PullEvents())
+    {
+      const auto queueSize = _request.DispatchQueueSize() > 0 ? _request.DispatchQueueSize() : MYODDWEB_DEFAULT_DISPATCH_QUEUE_SIZE;
+      for (auto i = 0; i < _request.DispatchThreads(); ++i)
+      {
+        _dispatchers.push_back(new EventsDispatcher(
+          static_cast<size_t>(queueSize),
+          [this](const EventsBatch& batch) { PublishDispatchedEvents(batch); }));
+      }
+      _dispatchedEvents.resize(_dispatchers.size());
+    }
+
+    // in low latency mode we do not wait for the worker pool to call us
+    // we publish the events as soon as they arrive.
+    if (_request.LowLatencyEvents() && _request.IsUsingEvents() && !_request.PullEvents())
+    {
+      _monitor.Signal().Restart();
+      _lowLatencyThread = new threads::Thread([this] { PublishEventsWhenReady(); });
+    }
+  }
 
+  EventsPublisher::~EventsPublisher()
+  {
+    if (_lowLatencyThread != nullptr)
+    {
+      // stop waiting for events and wait for the thread to complete.
+      _monitor.Signal().Cancel();
+      delete _lowLatencyThread;
+      _lowLatencyThread = nullptr;
+    }
+
+    // nothing else can be queued, wait for the queued events to be dispatched.
+    for (const auto& dispatcher : _dispatchers)
+    {
+      delete dispatcher;
+    }
+    _dispatchers.clear();
   }
 
   /**
-   * \brief check if the time has now elapsed.
-   * \param fElapsedTimeMilliseconds the number of ms since the last time we checked.
+   * \brief move a deadline forward by its rate until it is in the future, keeping its phase.
+   * \param deadline the deadline we are moving.
+   * \param rateMilliseconds how often the deadline is due.
+   * \param now the current time.
+   */
+  void EventsPublisher::RestartDeadline(std::chrono::steady_clock::time_point& deadline, const long long rateMilliseconds, const std::chrono::steady_clock::time_point& now)
+  {
+    const auto rate = std::chrono::milliseconds(std::max(1LL, rateMilliseconds));
+    deadline += rate;
+    if (deadline <= now)
+    {
+      // we missed more than one, skip them all in one go.
+      deadline += ((now - deadline) / rate + 1) * rate;
+    }
+  }
+
+  /**
+   * \brief check if the events are due.
+   * \param now the current time.
    * \return if the time has elapsed and we can continue.
    */
-  bool EventsPublisher::HasEventsElapsed(const float fElapsedTimeMilliseconds)
+  bool EventsPublisher::HasEventsElapsed(const std::chrono::steady_clock::time_point& now)
   {
-    if( !_request.IsUsingEvents())
+    // if the caller is pulling the events, we never publish them
+    // but if we only count them, the monitor might still have kept some for itself.
+    if( (!_request.IsUsingEvents() || _request.PullEvents()) && !_request.IsCountingEvents())
     {
       return false;
     }
 
-    _elapsedEventsTimeMilliseconds += fElapsedTimeMilliseconds;
-    if (_elapsedEventsTimeMilliseconds < static_cast<float>(_request.EventsCallbackRateMilliseconds()))
+    if (now < _nextEventsTime)
     {
       return false;
     }
 
     //  restart the timer.
-    while (_elapsedEventsTimeMilliseconds > static_cast<float>(_request.EventsCallbackRateMilliseconds())) {
-      _elapsedEventsTimeMilliseconds -= static_cast<float>(_request.EventsCallbackRateMilliseconds());
-    }
+    RestartDeadline(_nextEventsTime, _request.EventsCallbackRateMilliseconds(), now);
     return true;
   }
 
-  float EventsPublisher::HasStatisticsElapsed(const float fElapsedTimeMilliseconds)
+  /**
+   * \brief check if the statistics are due.
+   * \param now the current time.
+   * \return 0 if the number has not elapsed otherwise the number of ms elapsed
+   */
+  float EventsPublisher::HasStatisticsElapsed(const std::chrono::steady_clock::time_point& now)
   {
     // are we using stats?
     if( !_request.IsUsingStatistics())
@@ -55,54 +125,101 @@ namespace myoddweb::directorywatcher
       return 0;
     }
 
-    _elapsedStatisticsTimeMilliseconds += fElapsedTimeMilliseconds;
-    if (_elapsedStatisticsTimeMilliseconds < static_cast<float>(_request.StatsCallbackRateMilliseconds()))
+    if (now < _nextStatisticsTime)
     {
       return 0;
     }
 
-    const auto actualElapsedTimeMilliseconds = _elapsedStatisticsTimeMilliseconds;
+    const auto actualElapsedTimeMilliseconds = std::chrono::duration<float, std::milli>(now - _lastStatisticsTime).count();
+    _lastStatisticsTime = now;
 
     //  restart the timer.
-    while (_elapsedStatisticsTimeMilliseconds > static_cast<float>(_request.StatsCallbackRateMilliseconds())) {
-      _elapsedStatisticsTimeMilliseconds -= static_cast<float>(_request.StatsCallbackRateMilliseconds());
-    }
+    RestartDeadline(_nextStatisticsTime, _request.StatsCallbackRateMilliseconds(), now);
     return actualElapsedTimeMilliseconds;
   }
 
-  void EventsPublisher::Update(const float fElapsedTimeMilliseconds)
+  /**
+   * \brief called at various intervals, we publish whatever is due.
+   */
+  void EventsPublisher::Update()
   {
+    // the low latency thread does all the work.
+    if (_lowLatencyThread != nullptr)
+    {
+      return;
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+
     // first check the events
-    UpdateEvents(fElapsedTimeMilliseconds);
+    UpdateEvents(now);
 
     // then the stats
-    UpdateStatistics(fElapsedTimeMilliseconds);
+    UpdateStatistics(now);
   }
 
   /**
-   * \brief called at various intervals.
-   * \param fElapsedTimeMilliseconds the number of ms since the last update
+   * \brief how long we can go without an update before we have something to publish.
+   * \return the number of ms or -1 if there is nothing to publish.
    */
-  void EventsPublisher::UpdateEvents(float fElapsedTimeMilliseconds)
+  long long EventsPublisher::MaxIdleMilliseconds() const
+  {
+    // the low latency thread does all the work.
+    if (_lowLatencyThread != nullptr)
+    {
+      return -1;
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+    auto maxIdleMilliseconds = -1LL;
+    if (_request.IsUsingStatistics())
+    {
+      // the statistics are published at their rate, even if nothing happened.
+      maxIdleMilliseconds = std::max(0LL, static_cast<long long>(std::chrono::duration_cast<std::chrono::milliseconds>(_nextStatisticsTime - now).count()));
+    }
+
+    // we only need to publish the events if some were added since we last published them
+    // but the half renames are added by the collector when they time out, so we must keep checking for them.
+    // if we only count the events, the ones the monitor kept for itself are processed at the same rate.
+    if (((_request.IsUsingEvents() && !_request.PullEvents()) || _request.IsCountingEvents()) && (_monitor.Signal().NumberOfEvents() > 0 || _request.RenamePairingMilliseconds() > 0))
+    {
+      const auto eventsIdleMilliseconds = std::max(0LL, static_cast<long long>(std::chrono::duration_cast<std::chrono::milliseconds>(_nextEventsTime - now).count()));
+      maxIdleMilliseconds = maxIdleMilliseconds < 0 ? eventsIdleMilliseconds : std::min(maxIdleMilliseconds, eventsIdleMilliseconds);
+    }
+    return maxIdleMilliseconds;
+  }
+
+  /**
+   * \brief publish the events if they are due.
+   * \param now the current time.
+   */
+  void EventsPublisher::UpdateEvents(const std::chrono::steady_clock::time_point& now)
   {
     // check if we are ready.
-    if (!HasEventsElapsed(fElapsedTimeMilliseconds))
+    if (!HasEventsElapsed(now))
     {
       return;
     }
 
+    // if we only count the events, there is nothing to publish.
+    if (_request.IsCountingEvents())
+    {
+      ProcessCountedEvents();
+      return;
+    }
+
     // get the events
     PublishEvents();
   }
 
   /**
-   * \brief called at various intervals.
-   * \param fElapsedTimeMilliseconds the number of ms since the last update
+   * \brief publish the statistics if they are due.
+   * \param now the current time.
    */
-  void EventsPublisher::UpdateStatistics(float fElapsedTimeMilliseconds)
+  void EventsPublisher::UpdateStatistics(const std::chrono::steady_clock::time_point& now)
   {
     // check if we are ready.
-    const auto actualElapsedTimeMilliseconds = HasStatisticsElapsed(fElapsedTimeMilliseconds);
+    const auto actualElapsedTimeMilliseconds = HasStatisticsElapsed(now);
     if (actualElapsedTimeMilliseconds == 0 )
     {
       return;
@@ -122,30 +239,48 @@ namespace myoddweb::directorywatcher
    */
   void EventsPublisher::EnsureStatisticsAreUpToDateIfNotCollectingEvents()
   {
-    // if we are collecting events, then things should be fine
-    // we cannot get events for the purpose of updating stats
-    // otherwiswe could loose events.
-    if (_request.IsUsingEvents())
+    // if we are collecting events, then the stats are updated when they are published
+    // and if the caller is pulling the events, they are not ours to get.
+    if (!_request.IsCountingEvents())
     {
       return;
     }
 
-    // other wise get all the events.
-    // and make sure that we update our stats accordingly.
-    auto events = std::vector<Event*>();
-    if (0 != _monitor.GetEvents(events))
-    {
-      // then call the callback
-      for ( auto& event : events )
-      {
-        // update the stats
-        UpdateStatistics(*event);
+    // the events the monitor kept for itself are normally processed at the events rate
+    // but we might as well process the ones added since then.
+    ProcessCountedEvents();
 
-        // we are done with the event
-        // so we can get rid of it.
-        delete event;
-      }
+    const auto counts = _monitor.Counter().Reset();
+    if (0 == counts.numberOfEvents)
+    {
+      return;
     }
+
+    // we do not know how old the events were, we never created them.
+    MYODDWEB_LOCK(_statisticsLock);
+    _depth.Record(counts.numberOfEvents);
+    _currentStatistics.numberOfEvents += counts.numberOfEvents;
+    _currentStatistics.numberOfAdded += counts.numberOfAdded;
+    _currentStatistics.numberOfRemoved += counts.numberOfRemoved;
+    _currentStatistics.numberOfTouched += counts.numberOfTouched;
+    _currentStatistics.numberOfRenamed += counts.numberOfRenamed;
+    _currentStatistics.numberOfErrors += counts.numberOfErrors;
+    _currentStatistics.numberOfOverflows += counts.numberOfOverflows;
+  }
+
+  /**
+   * \brief when we only count the events, let the monitor process the events it kept for itself.
+   */
+  void EventsPublisher::ProcessCountedEvents()
+  {
+    // reset before we get the events, anything added from now on will be processed next time.
+    _monitor.Signal().Reset();
+
+    // the events were counted as they were added, so we never created them.
+    // but the monitor might still have kept some events for itself, (the folders of a multiple monitor)
+    // so we let it process them, they were already counted.
+    auto events = std::vector<Event*>();
+    _monitor.GetEvents(events);
   }
 
   /**
@@ -155,16 +290,32 @@ namespace myoddweb::directorywatcher
   void EventsPublisher::PublishStatistics(const float actualElapsedTimeMilliseconds)
   {
     MYODDWEB_PROFILE_FUNCTION();
-    try
+
+    // take a copy so the dispatching thread is not blocked while we call the callbacks.
+    sStatistics statistics = {};
     {
-      _request.CallbackStatistics()(
-        _id,
-        actualElapsedTimeMilliseconds,
-        _currentStatistics.numberOfEvents
-        );
+      MYODDWEB_LOCK(_statisticsLock);
+      GetStatisticsInLock(actualElapsedTimeMilliseconds, statistics);
 
       // we are done with the stats
-      _currentStatistics = { 0 };
+      ResetStatisticsInLock();
+    }
+
+    try
+    {
+      if (nullptr != _request.CallbackStatistics())
+      {
+        _request.CallbackStatistics()(
+          _id,
+          actualElapsedTimeMilliseconds,
+          statistics.NumberOfEvents
+          );
+      }
+
+      if (nullptr != _request.CallbackStatisticsEx())
+      {
+        _request.CallbackStatisticsEx()(_id, &statistics);
+      }
     }
     catch (std::exception& e)
     {
@@ -174,15 +325,148 @@ namespace myoddweb::directorywatcher
     }
   }
 
+  /**
+   * \brief get the current statistics, including the histograms.
+   * \param actualElapsedTimeMilliseconds the number of ms since the last time we published
+   * \param statistics the statistics we are filling.
+   */
+  void EventsPublisher::GetStatisticsInLock(const float actualElapsedTimeMilliseconds, sStatistics& statistics)
+  {
+    // the dropped events are a running total, we only want the ones since last time.
+    // the total can go down when a child monitor is removed.
+    const auto droppedEvents = _monitor.DroppedEventsCount();
+    const auto numberOfDroppedEvents = droppedEvents > _lastDroppedEvents ? droppedEvents - _lastDroppedEvents : 0;
+    _lastDroppedEvents = droppedEvents;
+
+    statistics.ElapsedTime = actualElapsedTimeMilliseconds;
+    statistics.NumberOfEvents = _currentStatistics.numberOfEvents;
+    statistics.NumberOfAdded = _currentStatistics.numberOfAdded;
+    statistics.NumberOfRemoved = _currentStatistics.numberOfRemoved;
+    statistics.NumberOfTouched = _currentStatistics.numberOfTouched;
+    statistics.NumberOfRenamed = _currentStatistics.numberOfRenamed;
+    statistics.NumberOfErrors = _currentStatistics.numberOfErrors;
+    statistics.NumberOfOverflows = _currentStatistics.numberOfOverflows;
+    statistics.NumberOfDroppedEvents = numberOfDroppedEvents;
+    statistics.EventAgeP50 = _eventAge.ValueAtPercentile(50);
+    statistics.EventAgeP90 = _eventAge.ValueAtPercentile(90);
+    statistics.EventAgeP99 = _eventAge.ValueAtPercentile(99);
+    statistics.EventAgeMax = _eventAge.Max();
+    statistics.CallbackDurationP50 = _callbackDuration.ValueAtPercentile(50);
+    statistics.CallbackDurationP90 = _callbackDuration.ValueAtPercentile(90);
+    statistics.CallbackDurationP99 = _callbackDuration.ValueAtPercentile(99);
+    statistics.CallbackDurationMax = _callbackDuration.Max();
+    statistics.DepthP50 = _depth.ValueAtPercentile(50);
+    statistics.DepthP90 = _depth.ValueAtPercentile(90);
+    statistics.DepthP99 = _depth.ValueAtPercentile(99);
+    statistics.DepthMax = _depth.Max();
+    statistics.DispatchBlockedTime = _currentStatistics.dispatchBlockedTime;
+  }
+
+  /**
+   * \brief reset all the statistics once they have been published.
+   */
+  void EventsPublisher::ResetStatisticsInLock()
+  {
+    _currentStatistics = {};
+    _eventAge.Reset();
+    _callbackDuration.Reset();
+    _depth.Reset();
+  }
+
   /**
    * \brief update the stats with the given event
-   * \paranm event the event we will update the stats with
+   * \param action the action of the event.
+   * \param error the error of the event, if any.
+   * \param timeMillisecondsUtc when the event happened.
+   * \param nowMillisecondsUtc the time now, so we know how old the event is.
    */
-  void EventsPublisher::UpdateStatistics(const Event& event)
+  void EventsPublisher::UpdateStatisticsInLock(const int action, const int error, const long long timeMillisecondsUtc, const long long nowMillisecondsUtc)
   {
+    // the events time is in ms, so that's the best we can do for the age.
+    _eventAge.Record(nowMillisecondsUtc - timeMillisecondsUtc);
+
     ++_currentStatistics.numberOfEvents;
+    if (error != static_cast<int>(EventError::None))
+    {
+      ++_currentStatistics.numberOfErrors;
+      if (error == static_cast<int>(EventError::Overflow))
+      {
+        ++_currentStatistics.numberOfOverflows;
+      }
+      return;
+    }
+
+    switch (static_cast<EventAction>(action))
+    {
+    case EventAction::Added:
+      ++_currentStatistics.numberOfAdded;
+      break;
+
+    case EventAction::Removed:
+      ++_currentStatistics.numberOfRemoved;
+      break;
+
+    case EventAction::Touched:
+      ++_currentStatistics.numberOfTouched;
+      break;
+
+    case EventAction::Renamed:
+      ++_currentStatistics.numberOfRenamed;
+      break;
+
+    default:
+      break;
+    }
   }
 
+  /**
+   * \brief the low latency thread, wait for the events to arrive then publish them.
+   *        the statistics are also published by this thread, when they are due.
+   *        we only collect the events, the monitor is still updated by the worker pool.
+   */
+  void EventsPublisher::PublishEventsWhenReady()
+  {
+    auto& signal = _monitor.Signal();
+    const auto maxBatchSize = _request.MaxBatchSize() > 0 ? _request.MaxBatchSize() : std::numeric_limits<long long>::max();
+    const auto maxBatchDelay = _request.MaxBatchDelayMilliseconds();
+    while (!signal.Cancelled())
+    {
+      // wait for the first event of the batch, but not past the time the statistics are due.
+      auto idleWait = static_cast<long long>(MYODDWEB_LOW_LATENCY_IDLE_WAIT);
+      if (_request.IsUsingStatistics())
+      {
+        const auto statisticsWait = std::chrono::duration_cast<std::chrono::milliseconds>(_nextStatisticsTime - std::chrono::steady_clock::now()).count();
+        idleWait = std::max(0LL, std::min(idleWait, static_cast<long long>(statisticsWait)));
+      }
+
+      // the half renames are only added once they expire, nothing will signal us when they do.
+      const auto renamesWait = _monitor.PendingRenamesMilliseconds();
+      if (renamesWait >= 0)
+      {
+        idleWait = std::min(idleWait, renamesWait);
+      }
+
+      if (signal.Wait(1, idleWait) > 0 && !signal.Cancelled())
+      {
+        // give the batch a chance to fill up, unless it is already full.
+        if (maxBatchDelay > 0)
+        {
+          signal.Wait(maxBatchSize, maxBatchDelay);
+        }
+
+        // anything added from now on will be part of the next batch.
+        PublishEvents();
+      }
+      else if (renamesWait >= 0 && !signal.Cancelled() && _monitor.PendingRenamesMilliseconds() == 0)
+      {
+        // getting the events adds the expired half renames.
+        PublishEvents();
+      }
+
+      // the statistics are still published at their own rate.
+      UpdateStatistics(std::chrono::steady_clock::now());
+    }
+  }
 
   /**
    * \brief publish all the events
@@ -191,6 +475,9 @@ namespace myoddweb::directorywatcher
   {
     MYODDWEB_PROFILE_FUNCTION();
 
+    // reset before we get the events, anything added from now on will be published next time.
+    _monitor.Signal().Reset();
+
     // get the events.
     auto events = std::vector<Event*>();
     if (0 == _monitor.GetEvents(events))
@@ -198,35 +485,214 @@ namespace myoddweb::directorywatcher
       return;
     }
 
-    // then call the callback
-    for ( const auto& event : events )
+    // a slow callback cannot hold us, we only wait if the queue is full.
+    if (!_dispatchers.empty())
     {
-      try
-      {
-        // publish it
-        _request.CallbackEvents()(
-          _id,
-          event->IsFile,
-          event->Name,
-          event->OldName,
-          event->Action,
-          event->Error,
-          event->TimeMillisecondsUtc
-          );
+      const auto blockedTime = DispatchEvents(events);
+
+      MYODDWEB_LOCK(_statisticsLock);
+      _depth.Record(static_cast<long long>(events.size()));
+      _currentStatistics.dispatchBlockedTime += blockedTime;
+      return;
+    }
+
+    {
+      MYODDWEB_LOCK(_statisticsLock);
+      _depth.Record(static_cast<long long>(events.size()));
+    }
+
+    // if we can, we give all the events in one go.
+    if (nullptr != _request.CallbackEventsBatch())
+    {
+      _batch.Assign(events);
+      PublishEventsBatch(_batch);
+      return;
+    }
+    PublishEventsOneByOne(events);
+  }
+
+  /**
+   * \brief give the events to the dispatchers, the events of a given path always go to the same dispatcher
+   *        and the renames are given after the events before them on either path.
+   * \param events the events we are dispatching.
+   * \return the number of microseconds we were blocked waiting for room in the queues.
+   */
+  long long EventsPublisher::DispatchEvents(const std::vector<Event*>& events)
+  {
+    if (_dispatchers.size() == 1)
+    {
+      return _dispatchers[0]->Enqueue(events);
+    }
 
-        // update the stats
-        UpdateStatistics(*event);
+    long long blockedTime = 0;
+    for (const auto& event : events)
+    {
+      const auto index = DispatcherIndex(event->Name);
+      if (event->Action == static_cast<int>(EventAction::Renamed) && event->OldName != nullptr)
+      {
+        // a rename is about two paths, so if they are not given by the same dispatcher
+        // the new path must be done with its previous events before we give the rename
+        // and the rename must be given before the events that follow it on either path.
+        const auto oldIndex = DispatcherIndex(event->OldName);
+        if (oldIndex != index)
+        {
+          blockedTime += EnqueueDispatchedEvents();
+          blockedTime += _dispatchers[index]->WaitUntilDispatched();
+          _dispatchedEvents[oldIndex].push_back(event);
+          blockedTime += EnqueueDispatchedEvents();
+          blockedTime += _dispatchers[oldIndex]->WaitUntilDispatched();
+          continue;
+        }
       }
-      catch (std::exception& e)
+      _dispatchedEvents[index].push_back(event);
+    }
+    return blockedTime + EnqueueDispatchedEvents();
+  }
+
+  /**
+   * \brief the dispatcher that gives the events of a path to the callback.
+   * \param path the path of the event, paths are not case sensitive.
+   */
+  size_t EventsPublisher::DispatcherIndex(const wchar_t* path) const
+  {
+    return PathFilter::Hash()(std::wstring_view(path == nullptr ? L"" : path)) % _dispatchers.size();
+  }
+
+  /**
+   * \brief give the events we split so far to their dispatchers.
+   * \return the number of microseconds we were blocked waiting for room in the queues.
+   */
+  long long EventsPublisher::EnqueueDispatchedEvents()
+  {
+    long long blockedTime = 0;
+    for (size_t i = 0; i < _dispatchers.size(); ++i)
+    {
+      auto& dispatchedEvents = _dispatchedEvents[i];
+      if (dispatchedEvents.empty())
       {
-        // the callback did something wrong!
-        // log the error
-        Logger::Log(LogLevel::Error, L"Caught exception '%hs' in PublishEvents, check the callback!", e.what());
+        continue;
       }
+      blockedTime += _dispatchers[i]->Enqueue(dispatchedEvents);
+      dispatchedEvents.clear();
+    }
+    return blockedTime;
+  }
+
+  /**
+   * \brief called by the dispatching threads to publish a batch of events.
+   * \param batch the events we are publishing.
+   */
+  void EventsPublisher::PublishDispatchedEvents(const EventsBatch& batch)
+  {
+    if (nullptr != _request.CallbackEventsBatch())
+    {
+      PublishEventsBatch(batch);
+      return;
+    }
+
+    // the names are never null, (but can be empty), so the callback gets the same values.
+    const auto events = batch.Events();
+    const auto names = batch.Names();
+    for (auto i = 0; i < batch.NumberOfEvents(); ++i)
+    {
+      const auto& event = events[i];
+      PublishEvent(event.IsFile != 0, names + event.Name, names + event.OldName, event.Action, event.Error, event.DateTimeUtc);
+    }
+  }
+
+  /**
+   * \brief publish all the events in a single call.
+   * \param batch the packed events we are publishing.
+   */
+  void EventsPublisher::PublishEventsBatch(const EventsBatch& batch)
+  {
+    MYODDWEB_PROFILE_FUNCTION();
+    const auto now = Collector::GetMillisecondsNowUtc();
+    const auto start = std::chrono::steady_clock::now();
+    try
+    {
+      // publish them
+      _request.CallbackEventsBatch()(
+        _id,
+        batch.Events(),
+        batch.NumberOfEvents(),
+        batch.Names(),
+        batch.NumberOfCharacters()
+        );
+    }
+    catch (std::exception& e)
+    {
+      // the callback did something wrong!
+      // log the error
+      Logger::Log(LogLevel::Error, L"Caught exception '%hs' in PublishEventsBatch, check the callback!", e.what());
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+
+    // update the stats
+    MYODDWEB_LOCK(_statisticsLock);
+    _callbackDuration.Record(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+    const auto events = batch.Events();
+    for (auto i = 0; i < batch.NumberOfEvents(); ++i)
+    {
+      UpdateStatisticsInLock(events[i].Action, events[i].Error, events[i].DateTimeUtc, now);
+    }
+  }
+
+  /**
+   * \brief publish the events one at a time.
+   * \param events the events we are publishing.
+   */
+  void EventsPublisher::PublishEventsOneByOne(const std::vector<Event*>& events)
+  {
+    MYODDWEB_PROFILE_FUNCTION();
+
+    // then call the callback
+    for ( const auto& event : events )
+    {
+      PublishEvent(event->IsFile, event->Name, event->OldName, event->Action, event->Error, event->TimeMillisecondsUtc);
 
       // we are done with the event
-      // so we can get rid of it.
-      delete event;
+      // it is owned by the collector and will be released the next time we get the events.
+    }
+  }
+
+  /**
+   * \brief publish a single event and update the stats.
+   * \param isFile if the event is a file or a folder.
+   * \param name the name of the file/folder.
+   * \param oldName the old name, if it was renamed.
+   * \param action the action of the event.
+   * \param error the error of the event, if any.
+   * \param timeMillisecondsUtc when the event happened.
+   */
+  void EventsPublisher::PublishEvent(const bool isFile, const wchar_t* name, const wchar_t* oldName, const int action, const int error, const long long timeMillisecondsUtc)
+  {
+    try
+    {
+      // publish it
+      const auto now = Collector::GetMillisecondsNowUtc();
+      const auto start = std::chrono::steady_clock::now();
+      _request.CallbackEvents()(
+        _id,
+        isFile,
+        name,
+        oldName,
+        action,
+        error,
+        timeMillisecondsUtc
+        );
+      const auto elapsed = std::chrono::steady_clock::now() - start;
+
+      // update the stats
+      MYODDWEB_LOCK(_statisticsLock);
+      _callbackDuration.Record(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+      UpdateStatisticsInLock(action, error, timeMillisecondsUtc, now);
+    }
+    catch (std::exception& e)
+    {
+      // the callback did something wrong!
+      // log the error
+      Logger::Log(LogLevel::Error, L"Caught exception '%hs' in PublishEvents, check the callback!", e.what());
     }
   }
 }
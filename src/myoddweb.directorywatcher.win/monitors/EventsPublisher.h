@@ -2,7 +2,13 @@
 // Florent Guelfucci licenses this file to you under the MIT license.
 // See the LICENSE file in the project root for more information.
 #pragma once
+#include <chrono>
+#include "../utils/EventsBatch.h"
+#include "../utils/EventsDispatcher.h"
+#include "../utils/Histogram.h"
 #include "../utils/Request.h"
+#include "../utils/Threads/Thread.h"
+#include "Base.h"
 
 namespace myoddweb::directorywatcher
 {
@@ -13,12 +19,32 @@ namespace myoddweb::directorywatcher
     Monitor& _monitor;
     const long long _id;
     const Request& _request;
-    float _elapsedEventsTimeMilliseconds;
-    float _elapsedStatisticsTimeMilliseconds;
+
+    /**
+     * \brief when we next need to publish the events.
+     */
+    std::chrono::steady_clock::time_point _nextEventsTime;
+
+    /**
+     * \brief when we next need to publish the statistics.
+     */
+    std::chrono::steady_clock::time_point _nextStatisticsTime;
+
+    /**
+     * \brief when we last published the statistics.
+     */
+    std::chrono::steady_clock::time_point _lastStatisticsTime;
 
     struct CurrentStatistics
     {
       long long numberOfEvents;
+      long long numberOfAdded;
+      long long numberOfRemoved;
+      long long numberOfTouched;
+      long long numberOfRenamed;
+      long long numberOfErrors;
+      long long numberOfOverflows;
+      long long dispatchBlockedTime;
     };
 
     /**
@@ -26,27 +52,84 @@ namespace myoddweb::directorywatcher
      */
     CurrentStatistics _currentStatistics{};
 
+    /**
+     * \brief the age of the events, in ms, when we gave them to the callback.
+     */
+    Histogram _eventAge;
+
+    /**
+     * \brief how long the events callback took, in microseconds.
+     */
+    Histogram _callbackDuration;
+
+    /**
+     * \brief the number of events we got from the monitor every time we drained it.
+     */
+    Histogram _depth;
+
+    /**
+     * \brief the number of dropped events the last time we published the statistics.
+     */
+    long long _lastDroppedEvents;
+
+    /**
+     * \brief the lock for the statistics, they are updated by the dispatching thread.
+     */
+    MYODDWEB_MUTEX _statisticsLock;
+
+    /**
+     * \brief the queues and threads giving the events to the callback, if we are using them.
+     */
+    std::vector<EventsDispatcher*> _dispatchers;
+
+    /**
+     * \brief the events split by path, one container per dispatcher, reused every time.
+     */
+    std::vector<std::vector<Event*>> _dispatchedEvents;
+
+    /**
+     * \brief the events we give to the batch callback, kept so we can reuse the memory.
+     */
+    EventsBatch _batch;
+
+    /**
+     * \brief the thread publishing the events as soon as they arrive, (in low latency mode).
+     */
+    threads::Thread* _lowLatencyThread;
+
   public:
     explicit EventsPublisher(Monitor& monitor, long long id, const Request& request );
+    ~EventsPublisher();
+
+    EventsPublisher(const EventsPublisher&) = delete;
+    EventsPublisher(EventsPublisher&&) = delete;
+    const EventsPublisher& operator=(const EventsPublisher&) = delete;
+    EventsPublisher& operator=(EventsPublisher&&) = delete;
 
     /**
-     * \brief called at various intervals.
-     * \param fElapsedTimeMilliseconds the number of ms since the last update
+     * \brief called at various intervals, we publish whatever is due.
      */
-    void Update(float fElapsedTimeMilliseconds);
+    void Update();
+
+    /**
+     * \brief how long we can go without an update before we have something to publish.
+     * \return the number of ms or -1 if there is nothing to publish.
+     */
+    [[nodiscard]]
+    long long MaxIdleMilliseconds() const;
 
   private:
     /**
-     * \brief called at various intervals.
-     * \param fElapsedTimeMilliseconds the number of ms since the last update
+     * \brief publish the events if they are due.
+     * \param now the current time.
      */
-    void UpdateEvents(float fElapsedTimeMilliseconds);
+    void UpdateEvents(const std::chrono::steady_clock::time_point& now);
 
     /**
-     * \brief called at various intervals.
-     * \param fElapsedTimeMilliseconds the number of ms since the last update
+     * \brief publish the statistics if they are due.
+     * \param now the current time.
      */
-    void UpdateStatistics(float fElapsedTimeMilliseconds);
+    void UpdateStatistics(const std::chrono::steady_clock::time_point& now);
 
     /**
      * \brief get the events.
@@ -54,30 +137,115 @@ namespace myoddweb::directorywatcher
      */
     void PublishStatistics(float actualElapsedTimeMilliseconds);
 
+    /**
+     * \brief get the current statistics, including the histograms.
+     * \param actualElapsedTimeMilliseconds the number of ms since the last time we published
+     * \param statistics the statistics we are filling.
+     */
+    void GetStatisticsInLock(float actualElapsedTimeMilliseconds, sStatistics& statistics);
+
+    /**
+     * \brief reset all the statistics once they have been published.
+     */
+    void ResetStatisticsInLock();
+
+    /**
+     * \brief when we only count the events, let the monitor process the events it kept for itself.
+     */
+    void ProcessCountedEvents();
+
     /**
      * \brief get the events.
      */
     void PublishEvents();
 
+    /**
+     * \brief give the events to the dispatchers, the events of a given path always go to the same dispatcher
+     *        and the renames are given after the events before them on either path.
+     * \param events the events we are dispatching.
+     * \return the number of microseconds we were blocked waiting for room in the queues.
+     */
+    long long DispatchEvents(const std::vector<Event*>& events);
+
+    /**
+     * \brief the dispatcher that gives the events of a path to the callback.
+     * \param path the path of the event, paths are not case sensitive.
+     */
+    [[nodiscard]]
+    size_t DispatcherIndex(const wchar_t* path) const;
+
+    /**
+     * \brief give the events we split so far to their dispatchers.
+     * \return the number of microseconds we were blocked waiting for room in the queues.
+     */
+    long long EnqueueDispatchedEvents();
+
+    /**
+     * \brief called by the dispatching threads to publish a batch of events.
+     * \param batch the events we are publishing.
+     */
+    void PublishDispatchedEvents(const EventsBatch& batch);
+
+    /**
+     * \brief publish the events one at a time.
+     * \param events the events we are publishing.
+     */
+    void PublishEventsOneByOne(const std::vector<Event*>& events);
+
+    /**
+     * \brief publish all the events in a single call.
+     * \param batch the packed events we are publishing.
+     */
+    void PublishEventsBatch(const EventsBatch& batch);
+
+    /**
+     * \brief publish a single event and update the stats.
+     * \param isFile if the event is a file or a folder.
+     * \param name the name of the file/folder.
+     * \param oldName the old name, if it was renamed.
+     * \param action the action of the event.
+     * \param error the error of the event, if any.
+     * \param timeMillisecondsUtc when the event happened.
+     */
+    void PublishEvent(bool isFile, const wchar_t* name, const wchar_t* oldName, int action, int error, long long timeMillisecondsUtc);
+
+    /**
+     * \brief the low latency thread, wait for the events to arrive then publish them.
+     *        the statistics are also published by this thread, when they are due.
+     *        we only collect the events, the monitor is still updated by the worker pool.
+     */
+    void PublishEventsWhenReady();
+
     /**
      * \brief update the stats with the given event
-     * \paranm event the event we will update the stats with
+     * \param action the action of the event.
+     * \param error the error of the event, if any.
+     * \param timeMillisecondsUtc when the event happened.
+     * \param nowMillisecondsUtc the time now, so we know how old the event is.
      */
-    void UpdateStatistics(const Event& event);
+    void UpdateStatisticsInLock(int action, int error, long long timeMillisecondsUtc, long long nowMillisecondsUtc);
 
     /**
-     * \brief check if the events time has now elapsed.
-     * \param fElapsedTimeMilliseconds the number of ms since the last time we checked.
+     * \brief check if the events are due.
+     * \param now the current time.
      * \return if the time has elapsed and we can continue.
      */
-    bool HasEventsElapsed(float fElapsedTimeMilliseconds);
+    bool HasEventsElapsed(const std::chrono::steady_clock::time_point& now);
 
     /**
-     * \brief check if the statusticstime has now elapsed.
-     * \param fElapsedTimeMilliseconds the number of ms since the last time we checked.
+     * \brief check if the statistics are due.
+     * \param now the current time.
      * \return 0 if the number has not elapsed otherwise the number of ms elapsed
      */
-    float HasStatisticsElapsed(float fElapsedTimeMilliseconds);
+    float HasStatisticsElapsed(const std::chrono::steady_clock::time_point& now);
+
+    /**
+     * \brief move a deadline forward by its rate until it is in the future, keeping its phase.
+     * \param deadline the deadline we are moving.
+     * \param rateMilliseconds how often the deadline is due.
+     * \param now the current time.
+     */
+    static void RestartDeadline(std::chrono::steady_clock::time_point& deadline, long long rateMilliseconds, const std::chrono::steady_clock::time_point& now);
 
     /**
      * \brief make sure that all the stats values are up to date
@@ -3,8 +3,11 @@
 // See the LICENSE file in the project root for more information.
 #include <Windows.h>
 #include "Monitor.h"
+#include "../utils/EventsBatch.h"
+#include "../utils/EventsCoalescer.h"
 #include "../utils/Io.h"
 #include "../utils/Instrumentor.h"
+#include "../utils/Lock.h"
 #include "../utils/Logger.h"
 #include "../utils/LogLevel.h"
 
@@ -14,12 +17,31 @@ namespace myoddweb:: directorywatcher
     Worker( id ),
     _workerPool( workerPool ),
     _request( request ),
+    _pathFilter( request.IncludePatterns(), request.ExcludePatterns(), request.PatternsRoot(), request.Path() ),
+                      // if nobody wants the events themselves, we only count them for the statistics.
+    _counter( request.IsCountingEvents() ? &_eventsCounter : nullptr ),
                       // we will keep data for as long as we need it, either the event time if not zero, (as it updates the stats)
                       // otherwise we will set the time to the stats time
                       // if both of them are zero then nothing will be collected
-    _eventCollector(request.EventsCallbackRateMilliseconds() == 0 ? request.StatsCallbackRateMilliseconds() : request.EventsCallbackRateMilliseconds()),
-    _publisher(nullptr)
+                      // the limits are per monitor, when we reach them the overflow policy is used.
+    _eventCollector(
+      request.EventsCallbackRateMilliseconds() == 0 ? request.StatsCallbackRateMilliseconds() : request.EventsCallbackRateMilliseconds(),
+      request.Path() == nullptr ? L"" : request.Path(),
+      request.MaxNumberOfEvents(),
+      request.MaxNumberOfBytes(),
+      request.OverflowPolicy(),
+      request.CollectorShards(),
+      request.RenamePairingMilliseconds()),
+    _publisher(nullptr),
+    _nextPulledEvent(0)
   {
+    // the publisher needs to know when events are added
+    // either to publish them straight away or to know that there is something to publish.
+    _eventCollector.SetEventsSignal(&_eventsSignal);
+
+    // the events of our children are added by their own worker
+    // so we need to be woken up to publish them.
+    _eventsSignal.OnFirstEvent([this] { SignalReady(); });
   }
 
   Monitor::~Monitor()
@@ -41,6 +63,77 @@ namespace myoddweb:: directorywatcher
     return _eventCollector;
   }
 
+  /**
+   * \brief the include/exclude patterns of the request.
+   */
+  const PathFilter& Monitor::Filter() const
+  {
+    return _pathFilter;
+  }
+
+  /**
+   * \brief check if the actions mask of the request allows a given action.
+   * \param action the action we are checking.
+   */
+  bool Monitor::IsActionWanted(const EventAction action) const
+  {
+    return _request.IsActionWanted(action);
+  }
+
+  /**
+   * \brief if we keep the folders events whatever the actions mask.
+   */
+  bool Monitor::KeepFolderEvents() const
+  {
+    return _request.KeepFolderEvents();
+  }
+
+  /**
+   * \brief the kind of changes that raise a touched event, (see ChangesMask).
+   */
+  int Monitor::ChangesMask() const
+  {
+    return _request.ChangesMask();
+  }
+
+  /**
+   * \brief the signal notified every time one of our events is added.
+   */
+  EventsSignal& Monitor::Signal()
+  {
+    return _eventsSignal;
+  }
+
+  /**
+   * \brief notify the given signal rather than our own when an event is added.
+   *        this is used by the child monitors so the parent knows about their events.
+   *        this must be called before the monitor is started.
+   * \param signal the signal we will be notifying.
+   */
+  void Monitor::UseEventsSignal(EventsSignal& signal)
+  {
+    _eventCollector.SetEventsSignal(&signal);
+  }
+
+  /**
+   * \brief the counter of our events when we only count them for the statistics.
+   */
+  EventsCounter& Monitor::Counter()
+  {
+    return _eventsCounter;
+  }
+
+  /**
+   * \brief count our events with the given counter rather than collecting them.
+   *        this is used by the child monitors so the parent can publish their statistics.
+   *        this must be called before the monitor is started.
+   * \param counter the counter we will be adding to.
+   */
+  void Monitor::UseEventsCounter(EventsCounter& counter)
+  {
+    _counter = &counter;
+  }
+
   /**
    * \brief the patht that is being monitored.
    */
@@ -66,6 +159,16 @@ namespace myoddweb:: directorywatcher
   void Monitor::AddEvent(const EventAction action, const std::wstring& fileName, const bool isFile)
   {
     MYODDWEB_PROFILE_FUNCTION();
+    if (nullptr != _counter)
+    {
+      _counter->Add(action);
+
+      // the non recursive parents still need the folders events to watch the new folders.
+      if (isFile || action == EventAction::Touched || !_request.KeepFolderEvents())
+      {
+        return;
+      }
+    }
     _eventCollector.Add(action, Path(), fileName, isFile, EventError::None);
   }
 
@@ -78,6 +181,17 @@ namespace myoddweb:: directorywatcher
   void Monitor::AddRenameEvent(const std::wstring& newFileName, const std::wstring& oldFilename, const bool isFile)
   {
     MYODDWEB_PROFILE_FUNCTION();
+    if (nullptr != _counter)
+    {
+      // half a rename is published as an added or a removed event.
+      _counter->Add(oldFilename.empty() ? EventAction::Added : (newFileName.empty() ? EventAction::Removed : EventAction::Renamed));
+
+      // the non recursive parents still need the folders events to watch the new folders.
+      if (isFile || !_request.KeepFolderEvents())
+      {
+        return;
+      }
+    }
     _eventCollector.AddRename(Path(), newFileName, oldFilename, isFile, EventError::None );
   }
 
@@ -88,6 +202,15 @@ namespace myoddweb:: directorywatcher
   void Monitor::AddEventError(const EventError error)
   {
     MYODDWEB_PROFILE_FUNCTION();
+    if (!_request.IsErrorWanted())
+    {
+      return;
+    }
+    if (nullptr != _counter)
+    {
+      _counter->AddError(error);
+      return;
+    }
     _eventCollector.Add(EventAction::Unknown, Path(), L"", false, error );
   }
 
@@ -111,10 +234,86 @@ namespace myoddweb:: directorywatcher
     // allow the base class to add/remove events.
     OnGetEvents(events);
 
+    // reduce the events to their net effect if we were asked to.
+    if (_request.CoalesceEvents())
+    {
+      EventsCoalescer::Coalesce(events);
+    }
+
     // then return how-ever many we found.  
     return static_cast<long long>(events.size());
   }
 
+  /**
+   * \brief copy the events that were not pulled yet to the given buffers.
+   *        we only get new events from the collector once all the previous ones were pulled.
+   * \param events where we will copy the events.
+   * \param eventsCapacity the number of events we can copy.
+   * \param names where we will copy the null terminated names of the events.
+   * \param namesCapacity the number of characters we can copy.
+   * \param numberOfEvents the number of events we copied.
+   * \param numberOfCharacters the number of characters we copied.
+   * \return the number of events that did not fit and are still pending or -ve if the events are not pulled.
+   */
+  long long Monitor::PullEvents(sEvent* events, const int eventsCapacity, wchar_t* names, const int namesCapacity, int& numberOfEvents, int& numberOfCharacters)
+  {
+    MYODDWEB_PROFILE_FUNCTION();
+    numberOfEvents = 0;
+    numberOfCharacters = 0;
+
+    // the collector only has one consumer, if the events are published
+    // then they are not ours to take.
+    if (!_request.PullEvents())
+    {
+      return -1;
+    }
+
+    MYODDWEB_LOCK(_pullLock);
+
+    // only get more events once the caller has all the previous ones
+    // the ones we are holding would no longer be valid.
+    if (_nextPulledEvent >= _pulledEvents.size())
+    {
+      _pulledEvents.clear();
+      _nextPulledEvent = 0;
+      GetEvents(_pulledEvents);
+    }
+
+    // copy as many as we can.
+    size_t characters = 0;
+    while (_nextPulledEvent < _pulledEvents.size() && numberOfEvents < eventsCapacity)
+    {
+      if( !EventsBatch::Pack(*_pulledEvents[_nextPulledEvent], events[numberOfEvents], names, namesCapacity < 0 ? 0 : namesCapacity, characters))
+      {
+        // the names buffer is full.
+        break;
+      }
+      ++numberOfEvents;
+      ++_nextPulledEvent;
+    }
+    numberOfCharacters = static_cast<int>(characters);
+
+    // let the caller know how many are left.
+    return static_cast<long long>(_pulledEvents.size() - _nextPulledEvent);
+  }
+
+  /**
+   * \brief the total number of events that were dropped because of the limits.
+   */
+  long long Monitor::DroppedEventsCount()
+  {
+    return _eventCollector.DroppedCount();
+  }
+
+  /**
+   * \brief the number of ms before the oldest half rename stops waiting for its other half.
+   * \return the ms left, 0 if it already expired or -1 if no half renames are pending.
+   */
+  long long Monitor::PendingRenamesMilliseconds()
+  {
+    return _eventCollector.PendingRenamesMilliseconds();
+  }
+
   /**
    * \brief Start the monitoring, if needed.
    * \return success or not.
@@ -149,18 +348,35 @@ namespace myoddweb:: directorywatcher
    * \brief Give the worker a chance to do something in the loop
    *        Workers can do _all_ the work at once and simply return false
    *        or if they have a tight look they can return true until they need to come out.
-   * \param fElapsedTimeMilliseconds the amount of time since the last time we made this call.
+   * \param fElapsedTimeMilliseconds not used, the events and statistics are published at their own rate.
    * \return true if we want to continue or false if we want to end the thread
    */
-  bool Monitor::OnWorkerUpdate( const float fElapsedTimeMilliseconds)
+  bool Monitor::OnWorkerUpdate([[maybe_unused]] const float fElapsedTimeMilliseconds)
   {
     if( _publisher != nullptr )
     {
-      _publisher->Update(fElapsedTimeMilliseconds);
+      _publisher->Update();
     }
     return !MustStop();
   }
 
+  /**
+   * \brief how long the pool can go without updating us when we have no data
+   *        this depends on when our publisher needs to publish the events and statistics.
+   * \return the number of ms or -1 if we only need to be updated when we have data.
+   */
+  long long Monitor::MaxIdleMilliseconds() const
+  {
+    // we need to be updated until we are stopped.
+    if (MustStop())
+    {
+      return 0;
+    }
+
+    // without a publisher there is nothing to publish.
+    return _publisher == nullptr ? -1 : _publisher->MaxIdleMilliseconds();
+  }
+
   /**
    * \brief stop the worker
    */
@@ -200,6 +416,12 @@ namespace myoddweb:: directorywatcher
     delete _publisher;
     _publisher = nullptr;
 
+    // if there is nothing to publish, we do not need a timer at all.
+    if (!_request.IsUsingEvents() && !_request.IsUsingStatistics())
+    {
+      return;
+    }
+
     // create the new publisher.
     _publisher = new EventsPublisher( *this, ParentId(), _request );
   }
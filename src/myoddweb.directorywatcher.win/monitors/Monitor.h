@@ -6,6 +6,9 @@
 #include "../utils/EventAction.h"
 #include "../utils/EventError.h"
 #include "../utils/Collector.h"
+#include "../utils/EventsCounter.h"
+#include "../utils/EventsSignal.h"
+#include "../utils/PathFilter.h"
 #include "../utils/Request.h"
 #include "../utils/Threads/WorkerPool.h"
 #include "EventsPublisher.h"
@@ -44,6 +47,59 @@ namespace myoddweb
       [[nodiscard]]
       const Collector& EventsCollector() const;
 
+      /**
+       * \brief the include/exclude patterns of the request.
+       */
+      [[nodiscard]]
+      const PathFilter& Filter() const;
+
+      /**
+       * \brief check if the actions mask of the request allows a given action.
+       * \param action the action we are checking.
+       */
+      [[nodiscard]]
+      bool IsActionWanted(EventAction action) const;
+
+      /**
+       * \brief if we keep the folders events whatever the actions mask.
+       */
+      [[nodiscard]]
+      bool KeepFolderEvents() const;
+
+      /**
+       * \brief the kind of changes that raise a touched event, (see ChangesMask).
+       */
+      [[nodiscard]]
+      int ChangesMask() const;
+
+      /**
+       * \brief the signal notified every time one of our events is added.
+       */
+      [[nodiscard]]
+      EventsSignal& Signal();
+
+      /**
+       * \brief notify the given signal rather than our own when an event is added.
+       *        this is used by the child monitors so the parent knows about their events.
+       *        this must be called before the monitor is started.
+       * \param signal the signal we will be notifying.
+       */
+      void UseEventsSignal(EventsSignal& signal);
+
+      /**
+       * \brief the counter of our events when we only count them for the statistics.
+       */
+      [[nodiscard]]
+      EventsCounter& Counter();
+
+      /**
+       * \brief count our events with the given counter rather than collecting them.
+       *        this is used by the child monitors so the parent can publish their statistics.
+       *        this must be called before the monitor is started.
+       * \param counter the counter we will be adding to.
+       */
+      void UseEventsCounter(EventsCounter& counter);
+
       /**
        * \brief check if a given path is the same as the given one.
        * \param maybe the path we are checking against.
@@ -59,6 +115,32 @@ namespace myoddweb
        */
       long long GetEvents(std::vector<Event*>& events);
 
+      /**
+       * \brief copy the events that were not pulled yet to the given buffers.
+       *        we only get new events from the collector once all the previous ones were pulled.
+       * \param events where we will copy the events.
+       * \param eventsCapacity the number of events we can copy.
+       * \param names where we will copy the null terminated names of the events.
+       * \param namesCapacity the number of characters we can copy.
+       * \param numberOfEvents the number of events we copied.
+       * \param numberOfCharacters the number of characters we copied.
+       * \return the number of events that did not fit and are still pending or -ve if the events are not pulled.
+       */
+      long long PullEvents(sEvent* events, int eventsCapacity, wchar_t* names, int namesCapacity, int& numberOfEvents, int& numberOfCharacters);
+
+      /**
+       * \brief the total number of events that were dropped because of the limits.
+       */
+      [[nodiscard]]
+      virtual long long DroppedEventsCount();
+
+      /**
+       * \brief the number of ms before the oldest half rename stops waiting for its other half.
+       * \return the ms left, 0 if it already expired or -1 if no half renames are pending.
+       */
+      [[nodiscard]]
+      virtual long long PendingRenamesMilliseconds();
+
       /**
        * \brief Add an event to our current log.
        * \param action the action that was performed, (added, deleted and so on)
@@ -116,6 +198,14 @@ namespace myoddweb
        * \brief called when the worker has completed
        */
       void OnWorkerEnd() override;
+
+      /**
+       * \brief how long the pool can go without updating us when we have no data
+       *        this depends on when our publisher needs to publish the events and statistics.
+       * \return the number of ms or -1 if we only need to be updated when we have data.
+       */
+      [[nodiscard]]
+      long long MaxIdleMilliseconds() const override;
       #pragma endregion 
 
       #pragma region Member Variables
@@ -129,6 +219,26 @@ namespace myoddweb
        */
       const Request _request;
 
+      /**
+       * \brief the compiled include/exclude patterns of the request.
+       */
+      const PathFilter _pathFilter;
+
+      /**
+       * \brief the signal notified when an event is added.
+       */
+      EventsSignal _eventsSignal;
+
+      /**
+       * \brief the counter of our events when we only count them.
+       */
+      EventsCounter _eventsCounter;
+
+      /**
+       * \brief the counter we add our events to, nullptr if we are collecting them.
+       */
+      EventsCounter* _counter;
+
       /**
        * \brief the current list of collected events.
        */
@@ -138,6 +248,24 @@ namespace myoddweb
        * \brief how often we want to check for new events.
        */
       EventsPublisher* _publisher;
+
+      /**
+       * \brief the events we got from the collector that have not all been pulled yet.
+       *        they remain valid until we get the events from the collector again.
+       *        the collector keeps them apart from the events it is still collecting
+       *        so they cannot grow past the limits of the request, even if they are never pulled.
+       */
+      std::vector<Event*> _pulledEvents;
+
+      /**
+       * \brief the next event in _pulledEvents that we will copy.
+       */
+      size_t _nextPulledEvent;
+
+      /**
+       * \brief the lock for the pulled events.
+       */
+      MYODDWEB_MUTEX _pullLock;
       #pragma endregion 
 
       /**
@@ -21,7 +21,8 @@
 namespace myoddweb::directorywatcher
 {
   MultipleWinMonitor::MultipleWinMonitor(const long long id, threads::WorkerPool& workerPool, const Request& request) :
-    Monitor( id, workerPool, request)
+    Monitor( id, workerPool, request),
+    _numberOfGetEvents(0)
   {
     // use a standar monitor for non recursive items.
     if (!request.Recursive())
@@ -48,6 +49,51 @@ namespace myoddweb::directorywatcher
     return Id();
   }
 
+  /**
+   * \brief the total number of events dropped by all our monitors.
+   */
+  long long MultipleWinMonitor::DroppedEventsCount()
+  {
+    MYODDWEB_LOCK(_lock);
+    auto droppedEvents = Monitor::DroppedEventsCount();
+    for (auto* monitor : _nonRecursiveParents)
+    {
+      droppedEvents += monitor->DroppedEventsCount();
+    }
+    for (auto* monitor : _recursiveChildren)
+    {
+      droppedEvents += monitor->DroppedEventsCount();
+    }
+    return droppedEvents;
+  }
+
+  /**
+   * \brief the number of ms before the oldest half rename of any of our monitors expires.
+   * \return the ms left, 0 if one already expired or -1 if no half renames are pending.
+   */
+  long long MultipleWinMonitor::PendingRenamesMilliseconds()
+  {
+    MYODDWEB_LOCK(_lock);
+    auto pending = Monitor::PendingRenamesMilliseconds();
+    const auto earliest = [&pending](Monitor* monitor)
+    {
+      const auto ms = monitor->PendingRenamesMilliseconds();
+      if (ms >= 0 && (pending < 0 || ms < pending))
+      {
+        pending = ms;
+      }
+    };
+    for (auto* monitor : _nonRecursiveParents)
+    {
+      earliest(monitor);
+    }
+    for (auto* monitor : _recursiveChildren)
+    {
+      earliest(monitor);
+    }
+    return pending;
+  }
+
   /**
    * \brief fill the vector with all the values currently on record.
    * \param events the events we will be filling
@@ -64,18 +110,31 @@ namespace myoddweb::directorywatcher
     // guard for multiple (re)entry.
     MYODDWEB_LOCK(_lock);
 
+    // the events we gave last time were published, so the children
+    // that completed before then can no longer be used.
+    ++_numberOfGetEvents;
+    DeleteCompletedFoldersInLock();
+
+    // all our monitors are published together, in one batch, by our own publisher.
+    // each monitor gives us its events in the order they were added
+    // so we only need to merge the lists rather than sort all the events.
+    auto numberOfLists = static_cast<size_t>(0);
+
     // get the children events
-    const auto childrentEvents = GetAndProcessChildEventsInLock();
+    GetAndProcessChildEventsInLock(numberOfLists);
 
     // then look for the parent events.
-    const auto parentEvents = GetAndProcessParentEventsInLock();
+    GetAndProcessParentEventsInLock(numberOfLists);
 
-    //  add the parents and the children
-    events.insert(events.end(), childrentEvents.begin(), childrentEvents.end());
-    events.insert(events.end(), parentEvents.begin(), parentEvents.end());
+    // then merge everything by inserted time
+    Collector::MergeByTimeMillisecondsUtc(_monitorsEvents, numberOfLists, events);
 
-    // then sort everything by inserted time
-    std::sort(events.begin(), events.end(), Collector::SortByTimeMillisecondsUtc);
+    // the events can be collected by the low latency thread, or the caller pulling them,
+    // so we let the worker pool add and remove our children.
+    if (!_folderChanges.empty())
+    {
+      SignalReady();
+    }
   }
 
 #pragma region Woker functions
@@ -83,6 +142,9 @@ namespace myoddweb::directorywatcher
   {
     Monitor::OnWorkerStop();
 
+    // the worker pool could be updating our children.
+    MYODDWEB_LOCK(_lock);
+
     // stop the parents
     Stop(_nonRecursiveParents);
 
@@ -124,7 +186,10 @@ namespace myoddweb::directorywatcher
    */
   bool MultipleWinMonitor::OnWorkerUpdate(float fElapsedTimeMilliseconds)
   {
-    return Monitor::OnWorkerUpdate( fElapsedTimeMilliseconds );
+    // publish the events first, so the folder changes are up to date.
+    const auto result = Monitor::OnWorkerUpdate( fElapsedTimeMilliseconds );
+    UpdateChildren();
+    return result;
   }
 
   /**
@@ -173,8 +238,9 @@ namespace myoddweb::directorywatcher
       // we are done with this monitor.
       // while we know it is complete, (from the previous check)
       // we are still going to tell the worker pool to do all the required cleanup
+      // the events are owned by each monitor, so we only delete it once its events were published.
       WorkerPool().StopAndWait(*monitor, -1 );
-      delete monitor;
+      _completedChildren.emplace_back(monitor, _numberOfGetEvents);
       _recursiveChildren.erase(it);
 
       // then we want to restart
@@ -182,6 +248,65 @@ namespace myoddweb::directorywatcher
     }
   }
 
+  /**
+   * \brief delete the children that completed once the events they gave us were published.
+   */
+  void MultipleWinMonitor::DeleteCompletedFoldersInLock()
+  {
+    // the events are only collected again once the previous ones were published
+    // so once we collected them again, the children removed before then are no longer used.
+    _completedChildren.erase(std::remove_if(_completedChildren.begin(), _completedChildren.end(), [&](const std::pair<Monitor*, long long>& completed)
+    {
+      if (completed.second >= _numberOfGetEvents)
+      {
+        return false;
+      }
+      delete completed.first;
+      return true;
+    }), _completedChildren.end());
+  }
+
+  /**
+   * \brief add, stop and remove our children as per the folder changes we found in the events.
+   *        this is only done by the worker pool, never by the thread getting the events.
+   */
+  void MultipleWinMonitor::UpdateChildren()
+  {
+    // if we are stopped or stopping, there is nothing for us to do.
+    if (!Is(State::started))
+    {
+      return;
+    }
+
+    MYODDWEB_LOCK(_lock);
+
+    // cleanup the folders that completed.
+    RemoveCompletedFoldersInLock();
+
+    for (const auto& folderChange : _folderChanges)
+    {
+      switch (folderChange.Action)
+      {
+      case EventAction::Added:
+        ProcessAddedFolderInLock(folderChange.Name.c_str());
+        break;
+
+      case EventAction::Renamed:
+        ProcessRenamedFolderInLock(folderChange.Name.c_str(), folderChange.OldName.c_str());
+        break;
+
+      case EventAction::Removed:
+        ProcessDeletedFolderInLock(folderChange.Name.c_str());
+        break;
+
+      default:
+        // we don't care...
+        break;
+      }
+    }
+    _folderChanges.clear();
+  }
+
   /**
    * \brief a folder has been added, process it.
    * \param path the event being processed
@@ -193,14 +318,11 @@ namespace myoddweb::directorywatcher
       return;
     }
 
-    // cleanup folders
-    RemoveCompletedFoldersInLock();
-
     // a folder was added to this path
     // so we have to add this path as a child.
     const auto id = WorkerId::NextId();
-    const auto request = Request(path, true, _request.EventsCallbackRateMilliseconds(), _request.StatsCallbackRateMilliseconds() );
-    const auto child = new WinMonitor(id, ParentId(), WorkerPool(), request );
+    const auto request = Request(_request, path, true);
+    const auto child = CreateChildMonitor(id, request);
     _recursiveChildren.emplace_back(child); 
 
     // add the child.
@@ -218,9 +340,6 @@ namespace myoddweb::directorywatcher
       return;
     }
 
-    // cleanup folders
-    RemoveCompletedFoldersInLock();
-
     // the 'path' folder was removed.
     // so we have to remove it as well as all the child folders.
     // 'cause if it was removed ... then so were the others.
@@ -252,16 +371,28 @@ namespace myoddweb::directorywatcher
   }
 
   /**
-   * \brief process the parent events
-   * \return events the events we will be adding to
+   * \brief get the next list of events we can fill from _monitorsEvents, the list is empty.
+   * \param numberOfLists the number of lists that are already used.
+   * \return the list we can fill.
    */
-  std::vector<Event*> MultipleWinMonitor::GetAndProcessParentEventsInLock()
+  std::vector<Event*>& MultipleWinMonitor::NextEventsListInLock(const size_t numberOfLists)
   {
-    // get the events
-    std::vector<Event*> events;
+    // we keep the lists, (and their memory), from one call to the next.
+    if (numberOfLists == _monitorsEvents.size())
+    {
+      _monitorsEvents.emplace_back();
+    }
+    auto& events = _monitorsEvents[numberOfLists];
+    events.clear();
+    return events;
+  }
 
-    // the current events.
-    std::vector<Event*> levents;
+  /**
+   * \brief process the parent events
+   * \param numberOfLists the number of lists of _monitorsEvents used, updated with the parent lists.
+   */
+  void MultipleWinMonitor::GetAndProcessParentEventsInLock(size_t& numberOfLists)
+  {
     for ( const auto& monitor : _nonRecursiveParents )
     {
       try
@@ -269,10 +400,11 @@ namespace myoddweb::directorywatcher
         // if we are stopped or stopping, there is nothing for us to do.
         if (Is(State::stopped) || Is(State::stopping))
         {
-          return events;
+          return;
         }
 
         // get this directory events
+        auto& levents = NextEventsListInLock(numberOfLists);
         if (0 == monitor->GetEvents(levents))
         {
           continue;
@@ -283,6 +415,7 @@ namespace myoddweb::directorywatcher
         assert(!monitor->Recursive());
 #endif
         // we now need to look for added/deleted paths.
+        // the events are only valid until they are published, so we copy the paths.
         for ( const auto& levent : levents)
         {
           // we don't care about file events.
@@ -292,89 +425,72 @@ namespace myoddweb::directorywatcher
           }
 
           // we care about deleted/added folder events.
-          switch (static_cast<EventAction>(levent->Action))
+          const auto action = static_cast<EventAction>(levent->Action);
+          if (levent->Name != nullptr && (action == EventAction::Added || action == EventAction::Renamed || action == EventAction::Removed))
           {
-          case EventAction::Added:
-            ProcessAddedFolderInLock(levent->Name);
-            break;
-
-          case EventAction::Renamed:
-            ProcessRenamedFolderInLock(levent->Name, levent->OldName);
-            break;
-
-          case EventAction::Removed:
-            ProcessDeletedFolderInLock(levent->Name);
-            break;
-
-          default:
-            // we don't care...
-            break;
+            _folderChanges.push_back({ action, levent->Name, levent->OldName == nullptr ? L"" : levent->OldName });
           }
         }
 
-        // add them to our list of events.
-        events.insert(events.end(), levents.begin(), levents.end());
+        // the parents keep the folders events we need, even if they were not asked for.
+        levents.erase(std::remove_if(levents.begin(), levents.end(), [&](const Event* levent)
+        {
+          return !_request.IsActionWanted(static_cast<EventAction>(levent->Action));
+        }), levents.end());
 
-        // clear the list
-        levents.clear();
+        // add them to our lists of events.
+        if (!levents.empty())
+        {
+          ++numberOfLists;
+        }
       }
       catch (...)
       {
         SaveCurrentException();
       }
     }
-    return events;
   }
 
   /**
    * \brief process the cildren events
-   * \return events the events we will be adding to
+   * \param numberOfLists the number of lists of _monitorsEvents used, updated with the children lists.
    */
-  std::vector<Event*> MultipleWinMonitor::GetAndProcessChildEventsInLock() const
+  void MultipleWinMonitor::GetAndProcessChildEventsInLock(size_t& numberOfLists)
   {
-    // all the events.
-    std::vector<Event*> events;
     for ( const auto& monitor : _recursiveChildren)
     {
-      const auto& levents = GetEvents(monitor);
+      auto& levents = NextEventsListInLock(numberOfLists);
+      GetEvents(monitor, levents);
       if (levents.empty())
       {
         continue;
       }
-      events.insert(events.end(), levents.begin(), levents.end());
+      ++numberOfLists;
     }
-    return events;
   }
 
   /**
    * \brief process the children events
    * \param monitor the monitor we are getting the events for.
-   * \rerturn events the events we will be adding to
+   * \param events the events we will be adding to
    */
-  std::vector<Event*> MultipleWinMonitor::GetEvents(Monitor* monitor) const
+  void MultipleWinMonitor::GetEvents(Monitor* monitor, std::vector<Event*>& events) const
   {
     try
     {
       // if we are stopped or stopping, there is nothing for us to do.
       if (Is(State::stopped) || Is(State::stopping))
       {
-        return {};
+        return;
       }
 
-      // the current events.
-      std::vector<Event*> events;
-
       // get this directory events
       monitor->GetEvents(events);
-
-      // add them to our list of events.
-      return events;
     }
     catch (...)
     {
       SaveCurrentException();
     }
-    return {};
   }
 
   /**
@@ -418,6 +534,13 @@ namespace myoddweb::directorywatcher
     // delete the children
     DeleteInLock(_recursiveChildren);
 
+    // the children that completed were already removed from the worker pool.
+    for (const auto& completed : _completedChildren)
+    {
+      delete completed.first;
+    }
+    _completedChildren.clear();
+
     // and the parents
     DeleteInLock(_nonRecursiveParents);
   }
@@ -472,6 +595,30 @@ namespace myoddweb::directorywatcher
     return static_cast<long>(_recursiveChildren.size()) + static_cast<long>(_nonRecursiveParents.size());
   }
 
+  /**
+   * \brief create a child monitor that notifies our signal when its events are added, if needed,
+   *        and that adds its events to our counter if we only count them.
+   * \param id the id of the child.
+   * \param request the request of the child.
+   * \return the child monitor.
+   */
+  Monitor* MultipleWinMonitor::CreateChildMonitor(const long long id, const Request& request)
+  {
+    const auto child = new WinMonitor(id, ParentId(), WorkerPool(), request);
+
+    // the children requests have no callbacks so they never have a publisher of their own,
+    // the events of our children are published by us, in one batch,
+    // so we need to know when they are added.
+    child->UseEventsSignal(Signal());
+
+    // if we only count the events, our children count them for us.
+    if (_request.IsCountingEvents())
+    {
+      child->UseEventsCounter(Counter());
+    }
+    return child;
+  }
+
   /**
    * \brief Create all the sub-requests for a prarent request.
    * \param parent the parent request itselft.
@@ -499,20 +646,20 @@ namespace myoddweb::directorywatcher
     if (subPaths.empty() || TotalSize() > MYODDWEB_MAX_NUMBER_OF_SUBPATH)
     {
       // we will breach the depth
-      _recursiveChildren.push_back(new WinMonitor(id, ParentId(), WorkerPool(), parent ));
+      _recursiveChildren.push_back(CreateChildMonitor(id, parent));
       return;
     }
     
     // adding all the sub-paths will not breach the limit.
     // so we can add the parent, but non-recuresive.
-    const auto request = Request(parent.Path(), false, parent.EventsCallbackRateMilliseconds(), parent.StatsCallbackRateMilliseconds());
-    _nonRecursiveParents.emplace_back(new WinMonitor(id, ParentId(), WorkerPool(), request ));
+    const auto request = Request(parent, parent.Path(), false);
+    _nonRecursiveParents.emplace_back(CreateChildMonitor(id, request));
 
     // now try and add all the subpath
     for (const auto& path : subPaths)
     {
       // add one more to the list.
-      const auto subRequest = Request(path.c_str(), true, parent.EventsCallbackRateMilliseconds(), parent.StatsCallbackRateMilliseconds());
+      const auto subRequest = Request(parent, path.c_str(), true);
       CreateMonitors( subRequest );
     }
   }
@@ -23,6 +23,12 @@ namespace myoddweb
 
       void OnGetEvents(std::vector<Event*>& events) override;
 
+      [[nodiscard]]
+      long long DroppedEventsCount() override;
+
+      [[nodiscard]]
+      long long PendingRenamesMilliseconds() override;
+
       [[nodiscard]]
       const long long& ParentId() const override;
 
@@ -65,6 +71,37 @@ namespace myoddweb
        */
       std::vector<Monitor*> _recursiveChildren;
 
+      /**
+       * \brief the events of each of our monitors, merged into one batch, kept so we can reuse the memory.
+       */
+      std::vector<std::vector<Event*>> _monitorsEvents;
+
+      /**
+       * \brief a folder that was added, removed or renamed in one of our non recursive parents.
+       */
+      struct FolderChange
+      {
+        EventAction Action;
+        std::wstring Name;
+        std::wstring OldName;
+      };
+
+      /**
+       * \brief the folder changes we found in the events, applied to our children by the worker pool.
+       */
+      std::vector<FolderChange> _folderChanges;
+
+      /**
+       * \brief the children that completed and the number of times our events were collected when they were removed
+       *        they are deleted once their events can no longer be published.
+       */
+      std::vector<std::pair<Monitor*, long long>> _completedChildren;
+
+      /**
+       * \brief the number of times our events were collected.
+       */
+      long long _numberOfGetEvents;
+
       /**
        * \brief get the next available id.
        * \return the next usable id.
@@ -78,6 +115,15 @@ namespace myoddweb
        */
       void CreateMonitors(const Request& parent );
 
+      /**
+       * \brief create a child monitor that notifies our signal when its events are added, if needed,
+       *        and that adds its events to our counter if we only count them.
+       * \param id the id of the child.
+       * \param request the request of the child.
+       * \return the child monitor.
+       */
+      Monitor* CreateChildMonitor(long long id, const Request& request);
+
       /**
        * \brief Clear all the current data
        */
@@ -107,25 +153,42 @@ namespace myoddweb
        */
       void RemoveCompletedFoldersInLock();
 
+      /**
+       * \brief delete the children that completed once the events they gave us were published.
+       */
+      void DeleteCompletedFoldersInLock();
+
+      /**
+       * \brief add, stop and remove our children as per the folder changes we found in the events.
+       *        this is only done by the worker pool, never by the thread getting the events.
+       */
+      void UpdateChildren();
+
+      /**
+       * \brief get the next list of events we can fill from _monitorsEvents, the list is empty.
+       * \param numberOfLists the number of lists that are already used.
+       * \return the list we can fill.
+       */
+      std::vector<Event*>& NextEventsListInLock(size_t numberOfLists);
+
       /**
        * \brief process the parent events
-       * \return events the events we will be adding to
+       * \param numberOfLists the number of lists of _monitorsEvents used, updated with the parent lists.
        */
-      std::vector<Event*> GetAndProcessParentEventsInLock();
+      void GetAndProcessParentEventsInLock(size_t& numberOfLists);
 
       /**
        * \brief process the children events
-       * \rerturn events the events we will be adding to
+       * \param numberOfLists the number of lists of _monitorsEvents used, updated with the children lists.
        */
-      [[nodiscard]]
-      std::vector<Event*> GetAndProcessChildEventsInLock() const;
+      void GetAndProcessChildEventsInLock(size_t& numberOfLists);
 
       /**
        * \brief process the children events
        * \param monitor the monitor we are getting the events for.
-       * \rerturn events the events we will be adding to
+       * \param events the events we will be adding to
        */
-      std::vector<Event*> GetEvents( Monitor* monitor ) const;
+      void GetEvents(Monitor* monitor, std::vector<Event*>& events) const;
 
       /**
        * \brief look for a posible child with a matching path.
@@ -2,6 +2,7 @@
 // Florent Guelfucci licenses this file to you under the MIT license.
 // See the LICENSE file in the project root for more information.
 #include "WinMonitor.h"
+#include <algorithm>
 #include <string>
 
 #include "../utils/Instrumentor.h"
@@ -164,6 +165,26 @@ namespace myoddweb:: directorywatcher
     return Monitor::OnWorkerUpdate(fElapsedTimeMilliseconds);
   }
 
+  /**
+   * \brief how long the pool can go without updating us when we have no data.
+   * \return the number of ms or -1 if we only need to be updated when we have data.
+   */
+  long long WinMonitor::MaxIdleMilliseconds() const
+  {
+    auto maxIdleMilliseconds = Monitor::MaxIdleMilliseconds();
+
+    // if we lost one of our handles we need to be updated when it is time to re-open it.
+    for (const auto& common : { _directories, _files })
+    {
+      const auto reopenMilliseconds = common == nullptr ? -1 : common->MillisecondsUntilReopen();
+      if (reopenMilliseconds >= 0)
+      {
+        maxIdleMilliseconds = maxIdleMilliseconds < 0 ? reopenMilliseconds : std::min(maxIdleMilliseconds, reopenMilliseconds);
+      }
+    }
+    return maxIdleMilliseconds;
+  }
+
   /**
    * \brief called when the worker has completed
    */
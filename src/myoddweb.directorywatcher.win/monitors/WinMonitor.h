@@ -58,6 +58,13 @@ namespace myoddweb
        */
       void OnWorkerEnd() override;
 
+      /**
+       * \brief how long the pool can go without updating us when we have no data.
+       * \return the number of ms or -1 if we only need to be updated when we have data.
+       */
+      [[nodiscard]]
+      long long MaxIdleMilliseconds() const override;
+
     private:
       win::Common* _directories;
       win::Common* _files;
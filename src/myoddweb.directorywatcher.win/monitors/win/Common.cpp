@@ -39,6 +39,12 @@ namespace myoddweb ::directorywatcher :: win
     // https://docs.microsoft.com/en-us/windows/desktop/api/fileapi/nf-fileapi-findfirstchangenotificationa
     // https://docs.microsoft.com/en-gb/windows/desktop/api/WinBase/nf-winbase-readdirectorychangesw
     const auto notifyFilter = GetNotifyFilter();
+    if (0 == notifyFilter)
+    {
+      // all the changes we could be looking for were masked out
+      // so there is nothing for us to watch.
+      return true;
+    }
 
     // create the data
     _data = new Data(
@@ -47,7 +53,8 @@ namespace myoddweb ::directorywatcher :: win
       notifyFilter, 
       _parent.Recursive(), 
       _bufferLength,
-      _parent.WorkerPool() 
+      _parent.WorkerPool(),
+      _parent
     );
 
     // then start monitoring
@@ -74,6 +81,15 @@ namespace myoddweb ::directorywatcher :: win
     _data->CheckStillValid();
   }
 
+  /**
+   * \brief if we lost our directory handle, how long until we try to re-open it.
+   * \return the number of ms or -1 if we did not lose it.
+   */
+  long long Common::MillisecondsUntilReopen() const
+  {
+    return nullptr == _data ? -1 : _data->MillisecondsUntilReopen();
+  }
+
   /**
    * \brief complete all the data collection
    */
@@ -104,54 +120,82 @@ namespace myoddweb ::directorywatcher :: win
         return;
       }
 
-      // rename filenames.
-      std::wstring newFilename;
-      std::wstring oldFilename;
+      // rename filenames, they point to the buffer.
+      std::wstring_view newFilename;
+      std::wstring_view oldFilename;
+      auto newFilenameIncluded = false;
+      auto oldFilenameIncluded = false;
+
+      // the actions we want, we do not create strings for the others.
+      const auto addedWanted = IsActionWanted(EventAction::Added);
+      const auto removedWanted = IsActionWanted(EventAction::Removed);
+      const auto touchedWanted = IsActionWanted(EventAction::Touched);
+      const auto renamedWanted = IsActionWanted(EventAction::Renamed);
 
       // get the file information
       auto pRecord = (FILE_NOTIFY_INFORMATION*)pBuffer;
       for (;;)
       {
-        // get the filename
-        const auto wFilename = std::wstring(pRecord->FileName, pRecord->FileNameLength / sizeof(wchar_t));
+        // get the filename, we only create a string if the path is not filtered out.
+        const auto filename = std::wstring_view(pRecord->FileName, pRecord->FileNameLength / sizeof(wchar_t));
+        const auto included = IsIncluded(filename);
         switch (pRecord->Action)
         {
         case FILE_ACTION_ADDED:
-          _parent.AddEvent(EventAction::Added, wFilename, IsFile(EventAction::Added, wFilename));
+          if (included && addedWanted)
+          {
+            const auto wFilename = std::wstring(filename);
+            _parent.AddEvent(EventAction::Added, wFilename, IsFile(EventAction::Added, wFilename));
+          }
           break;
 
         case FILE_ACTION_REMOVED:
-          _parent.AddEvent(EventAction::Removed, wFilename, IsFile(EventAction::Removed, wFilename));
+          if (included && removedWanted)
+          {
+            const auto wFilename = std::wstring(filename);
+            _parent.AddEvent(EventAction::Removed, wFilename, IsFile(EventAction::Removed, wFilename));
+          }
           break;
 
         case FILE_ACTION_MODIFIED:
-          _parent.AddEvent(EventAction::Touched, wFilename, IsFile(EventAction::Touched, wFilename));
+          if (included && touchedWanted)
+          {
+            const auto wFilename = std::wstring(filename);
+            _parent.AddEvent(EventAction::Touched, wFilename, IsFile(EventAction::Touched, wFilename));
+          }
           break;
 
         case FILE_ACTION_RENAMED_OLD_NAME:
-          oldFilename = wFilename;
+          oldFilename = filename;
+          oldFilenameIncluded = included;
           if (!newFilename.empty())
           {
             // if we already have a new filename then we can add the rename event
             // and then clear both filenames so we do not add again
-            _parent.AddRenameEvent(newFilename, oldFilename, IsFile(EventAction::Renamed, newFilename));
-            newFilename = oldFilename = L"";
+            // the rename is kept if either of the names is included, (like "x.tmp" renamed to "x.txt").
+            AddRenameEvent(newFilename, oldFilename, renamedWanted && (newFilenameIncluded || oldFilenameIncluded));
+            newFilename = oldFilename = std::wstring_view();
           }
           break;
 
         case FILE_ACTION_RENAMED_NEW_NAME:
-          newFilename = wFilename;
+          newFilename = filename;
+          newFilenameIncluded = included;
           if (!oldFilename.empty())
           {
             // if we already have an old filename then we can add the rename event
             // and then clear both filenames so we do not add again
-            _parent.AddRenameEvent(newFilename, oldFilename, IsFile(EventAction::Renamed, newFilename));
-            newFilename = oldFilename = L"";
+            AddRenameEvent(newFilename, oldFilename, renamedWanted && (newFilenameIncluded || oldFilenameIncluded));
+            newFilename = oldFilename = std::wstring_view();
           }
           break;
 
         default:
-          _parent.AddEvent(EventAction::Unknown, wFilename, IsFile(EventAction::Unknown, wFilename));
+          if (included)
+          {
+            const auto wFilename = std::wstring(filename);
+            _parent.AddEvent(EventAction::Unknown, wFilename, IsFile(EventAction::Unknown, wFilename));
+          }
           break;
         }
 
@@ -164,13 +208,17 @@ namespace myoddweb ::directorywatcher :: win
       }
 
       // check for orphan renames...
-      if (!oldFilename.empty())
+      // the other half might be in the next buffer, so we let the collector try and pair them.
+      // if it cannot, they will be published as removed/added events, so either action is enough to keep them.
+      if (!oldFilename.empty() && oldFilenameIncluded && (renamedWanted || removedWanted))
       {
-        _parent.AddEvent(EventAction::Removed, oldFilename, IsFile(EventAction::Removed, oldFilename));
+        const auto wOldFilename = std::wstring(oldFilename);
+        _parent.AddRenameEvent(L"", wOldFilename, IsFile(EventAction::Removed, wOldFilename));
       }
-      if (!newFilename.empty())
+      if (!newFilename.empty() && newFilenameIncluded && (renamedWanted || addedWanted))
       {
-        _parent.AddEvent(EventAction::Added, newFilename, IsFile(EventAction::Added, newFilename));
+        const auto wNewFilename = std::wstring(newFilename);
+        _parent.AddRenameEvent(wNewFilename, L"", IsFile(EventAction::Added, wNewFilename));
       }
     }
     catch (...)
@@ -181,6 +229,68 @@ namespace myoddweb ::directorywatcher :: win
     }
   }
 
+  /**
+   * \brief add a rename event, if either of the names is included.
+   * \param newFilename the new name of the file/folder.
+   * \param oldFilename the previous name.
+   * \param included if either of the names is included.
+   */
+  void Common::AddRenameEvent(const std::wstring_view& newFilename, const std::wstring_view& oldFilename, const bool included) const
+  {
+    if (!included)
+    {
+      return;
+    }
+    const auto wNewFilename = std::wstring(newFilename);
+    const auto wOldFilename = std::wstring(oldFilename);
+    _parent.AddRenameEvent(wNewFilename, wOldFilename, IsFile(EventAction::Renamed, wNewFilename));
+  }
+
+  /**
+   * \brief check if a path is not filtered out by the patterns of the request.
+   * \param path the path relative to the watched folder.
+   * \return if we want the events of that path.
+   */
+  bool Common::IsIncluded(const std::wstring_view& path) const
+  {
+    const auto& filter = _parent.Filter();
+    if (filter.IsEmpty())
+    {
+      return true;
+    }
+    if (filter.IsExcluded(path))
+    {
+      return false;
+    }
+    return !UseIncludePatterns() || filter.IsIncluded(path);
+  }
+
+  /**
+   * \brief if the include patterns apply to the events of this monitor.
+   */
+  bool Common::UseIncludePatterns() const
+  {
+    return true;
+  }
+
+  /**
+   * \brief check if we want the events with a given action, (see ActionsMask).
+   * \param action the action we are checking.
+   * \return if we want the events with that action.
+   */
+  bool Common::IsActionWanted(const EventAction action) const
+  {
+    return _parent.IsActionWanted(action);
+  }
+
+  /**
+   * \brief the parent monitor
+   */
+  const Monitor& Common::Parent() const
+  {
+    return _parent;
+  }
+
   /**
    * \brief check if a given string is a file or a directory.
    * \param action the action we are looking at
@@ -3,6 +3,7 @@
 // See the LICENSE file in the project root for more information.
 #pragma once
 #include <Windows.h>
+#include <string_view>
 
 #include "Data.h"
 #include "../Monitor.h"
@@ -35,6 +36,13 @@ namespace myoddweb
         bool Start();
         void Update() const;
         void Stop();
+
+        /**
+         * \brief if we lost our directory handle, how long until we try to re-open it.
+         * \return the number of ms or -1 if we did not lose it.
+         */
+        [[nodiscard]]
+        long long MillisecondsUntilReopen() const;
       protected:
         /**
          * \brief Get the notification filter.
@@ -52,6 +60,22 @@ namespace myoddweb
 
         void ProcessNotification(const unsigned char* pBuffer) const;
 
+        /**
+         * \brief add a rename event, if either of the names is included.
+         * \param newFilename the new name of the file/folder.
+         * \param oldFilename the previous name.
+         * \param included if either of the names is included.
+         */
+        void AddRenameEvent(const std::wstring_view& newFilename, const std::wstring_view& oldFilename, bool included) const;
+
+        /**
+         * \brief check if a path is not filtered out by the patterns of the request.
+         * \param path the path relative to the watched folder.
+         * \return if we want the events of that path.
+         */
+        [[nodiscard]]
+        bool IsIncluded(const std::wstring_view& path) const;
+
         /**
          * \brief all the data used by the monitor.
          */
@@ -76,6 +100,27 @@ namespace myoddweb
          */
         [[nodiscard]]
         virtual bool IsFile(EventAction action, const std::wstring& path) const;
+
+        /**
+         * \brief if the include patterns apply to the events of this monitor,
+         *        otherwise only the exclude patterns do.
+         */
+        [[nodiscard]]
+        virtual bool UseIncludePatterns() const;
+
+        /**
+         * \brief check if we want the events with a given action, (see ActionsMask).
+         * \param action the action we are checking.
+         * \return if we want the events with that action.
+         */
+        [[nodiscard]]
+        virtual bool IsActionWanted(EventAction action) const;
+
+        /**
+         * \brief the parent monitor
+         */
+        [[nodiscard]]
+        const Monitor& Parent() const;
       };
     }
   }
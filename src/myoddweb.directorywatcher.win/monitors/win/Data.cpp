@@ -1,6 +1,7 @@
 // Licensed to Florent Guelfucci under one or more agreements.
 // Florent Guelfucci licenses this file to you under the MIT license.
 // See the LICENSE file in the project root for more information.
+#include <chrono>
 #include <cstring>
 #include <utility>
 #include "Data.h"
@@ -8,7 +9,6 @@
 #include "../../utils/Lock.h"
 #include "../../utils/Logger.h"
 #include "../../utils/LogLevel.h"
-#include "../../utils/Wait.h"
 #include "../Base.h"
 
 namespace myoddweb:: directorywatcher:: win
@@ -19,12 +19,14 @@ namespace myoddweb:: directorywatcher:: win
     const unsigned long notifyFilter,
     const bool recursive,
     const unsigned long bufferLength,
-    threads::WorkerPool& workerPool
+    threads::WorkerPool& workerPool,
+    threads::Worker& worker
     )
     :
     _stopWorker( nullptr ),
     _workerPool( workerPool ),
-    _invalidHandleWait(0),
+    _worker( worker ),
+    _isWaitingToReopen(false),
     _notifyFilter(notifyFilter),
     _recursive(recursive),
     _operationAborted( false ),
@@ -97,7 +99,7 @@ namespace myoddweb:: directorywatcher:: win
     }
 
     // reset the handle wait.
-    _invalidHandleWait = 0;
+    _isWaitingToReopen = false;
 
     // start reading.
     Listen();
@@ -242,20 +244,20 @@ namespace myoddweb:: directorywatcher:: win
         }
 
         // then wait a little for the operation to be cancelled.
-        if (!_operationAborted && !Wait::SpinUntil([&]
-          {
-            if( _operationAborted != true )
-            {
-              // wait a little to ensure that the aborted message is given.
-              // we will return as soon as the message is recived.
-              // if we do not wait for the abort message, we might get other
-              // messages out of sequence.
-              MYODDWEB_YIELD();
-            }
-            return _operationAborted == true;
-          }, MYODDWEB_WAITFOR_OPERATION_ABORTED_COMPLETION))
+        // if we do not wait for the abort message, we might get other
+        // messages out of sequence.
+        // the completion routine is queued to this thread so an alertable sleep
+        // returns as soon as it has been called, there is no need to spin.
+        const auto until = std::chrono::steady_clock::now() + std::chrono::milliseconds(MYODDWEB_WAITFOR_OPERATION_ABORTED_COMPLETION);
+        while (!_operationAborted)
         {
-          Logger::Log(_id, LogLevel::Warning, L"Timeout waiting operation aborted message!" );
+          const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(until - std::chrono::steady_clock::now()).count();
+          if (remaining <= 0)
+          {
+            Logger::Log(_id, LogLevel::Warning, L"Timeout waiting operation aborted message!");
+            break;
+          }
+          ::SleepEx(static_cast<DWORD>(remaining), TRUE);
         }
       }
       else
@@ -508,6 +510,9 @@ namespace myoddweb:: directorywatcher:: win
      */
   void Data::ProcessError( const unsigned long errorCode)
   {
+    // whatever the error, the worker needs to check if we are still valid.
+    _worker.SignalReady();
+
     switch (errorCode)
     {
     case ERROR_SUCCESS:// all good, continue;
@@ -566,8 +571,13 @@ namespace myoddweb:: directorywatcher:: win
     Listen();
 
     // call the derived function to handle this.
-    MYODDWEB_LOCK(_dataLock);
-    _data.emplace_back( clone );
+    {
+      MYODDWEB_LOCK(_dataLock);
+      _data.emplace_back(clone);
+    }
+
+    // let the worker know that it has something to process.
+    _worker.SignalReady();
   }
 
   std::vector<unsigned char*> Data::Get()
@@ -583,6 +593,26 @@ namespace myoddweb:: directorywatcher:: win
     return clone;
   }
 
+  /**
+   * \brief how long until we try to re-open the handle, if it is not valid.
+   * \return the number of ms or -1 if the handle is valid.
+   */
+  long long Data::MillisecondsUntilReopen() const
+  {
+    if (IsValidHandle())
+    {
+      return -1;
+    }
+
+    // we need an update to notice that the handle is not valid.
+    if (!_isWaitingToReopen)
+    {
+      return 0;
+    }
+    const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(_reopenTime - std::chrono::steady_clock::now()).count();
+    return remaining < 0 ? 0 : remaining;
+  }
+
   /**
    * \brief check that he current handle is still valie
    *        if not then we will close the connection.
@@ -592,23 +622,38 @@ namespace myoddweb:: directorywatcher:: win
     if (IsValidHandle())
     {
       // The handle is good, so we can reset the value
-      _invalidHandleWait = 0;
+      _isWaitingToReopen = false;
+      return;
+    }
+
+    // the first time we notice, we set when we will try again
+    // however often we are called until then.
+    const auto now = std::chrono::steady_clock::now();
+    if (!_isWaitingToReopen)
+    {
+      _isWaitingToReopen = true;
+      _reopenTime = now + std::chrono::milliseconds(MYODDWEB_INVALID_HANDLE_SLEEP);
       return;
     }
 
-    // wait a little bit longer.
-    _invalidHandleWait += MYODDWEB_MIN_THREAD_SLEEP;
-    if (_invalidHandleWait < MYODDWEB_INVALID_HANDLE_SLEEP)
+    if (now < _reopenTime)
     {
       // we need to wait a little longer before we re-open
       return;
     }
 
+    // the read would be cancelled when the temporary thread stops
+    // so we leave it to the next update that is not on one of those threads.
+    if (_workerPool.IsTemporaryTaskThread())
+    {
+      return;
+    }
+
     // we already know that the handle is not valid
     _hDirectory = nullptr;
 
     // we will reopen, so reset the wait time.
-    _invalidHandleWait = 0;
+    _isWaitingToReopen = false;
 
     // reset the start flag so we can restart
     _colectionState = CollectionState::Unknown;
@@ -3,6 +3,7 @@
 // See the LICENSE file in the project root for more information.
 #pragma once
 #include <Windows.h>
+#include <chrono>
 #include "../Monitor.h"
 #include "../../utils/Threads/CallbackWorker.h"
 
@@ -20,7 +21,8 @@ namespace myoddweb:: directorywatcher:: win
       unsigned long notifyFilter,
       bool recursive,
       unsigned long bufferLength,
-      threads::WorkerPool& workerPool
+      threads::WorkerPool& workerPool,
+      threads::Worker& worker
     );
     ~Data();
 
@@ -55,6 +57,19 @@ namespace myoddweb:: directorywatcher:: win
      *        if not then we will close the connection.
      */
     void CheckStillValid();
+
+    /**
+     * \brief Check if the handle is valid
+     */
+    [[nodiscard]]
+    bool IsValidHandle() const;
+
+    /**
+     * \brief how long until we try to re-open the handle, if it is not valid.
+     * \return the number of ms or -1 if the handle is valid.
+     */
+    [[nodiscard]]
+    long long MillisecondsUntilReopen() const;
   private:
     /// <summary>
     /// The worker we will be using to stop collecting data
@@ -78,6 +93,11 @@ namespace myoddweb:: directorywatcher:: win
 
     threads::WorkerPool& _workerPool;
 
+    /// <summary>
+    /// The worker processing our data, it is told when new data arrives.
+    /// </summary>
+    threads::Worker& _worker;
+
     /// <summary>
     /// Stop monitoring data and wait for the work to complete.
     /// </summary>
@@ -88,12 +108,6 @@ namespace myoddweb:: directorywatcher:: win
     /// </summary>
     void StopInLock();
 
-    /**
-     * \brief Check if the handle is valid
-     */
-    [[nodiscard]]
-    bool IsValidHandle() const;
-
     /**
      * \brief set the directory handle
      * \return if success or not.
@@ -148,10 +162,14 @@ namespace myoddweb:: directorywatcher:: win
     #pragma region Variables
 
     /**
-     * \brief the number of times we had an invalid handle.
-     *        after a certain count we will close this.
+     * \brief if the handle is not valid and we are waiting to re-open it.
+     */
+    bool _isWaitingToReopen;
+
+    /**
+     * \brief when we will try to re-open the handle.
      */
-    int _invalidHandleWait;
+    std::chrono::steady_clock::time_point _reopenTime;
 
     /**
      * \brief what we wish to be notified about
@@ -23,6 +23,11 @@ namespace myoddweb:: directorywatcher:: win
     // what we are looking for.
     // https://docs.microsoft.com/en-us/windows/desktop/api/fileapi/nf-fileapi-findfirstchangenotificationa
     // https://docs.microsoft.com/en-gb/windows/desktop/api/WinBase/nf-winbase-readdirectorychangesw
+    if (!IsActionWanted(EventAction::Added) && !IsActionWanted(EventAction::Removed) && !IsActionWanted(EventAction::Renamed))
+    {
+      // we do not want any of the folders events.
+      return 0;
+    }
     return
       // Any directory-name change in the watched directory or subtree causes a change 
       // notification wait operation to return. 
@@ -43,4 +48,28 @@ namespace myoddweb:: directorywatcher:: win
     // so it can never be a file.
     return false;
   }
+
+  /**
+   * \brief the include patterns do not apply to the folders.
+   */
+  bool Directories::UseIncludePatterns() const
+  {
+    // the include patterns are for the files, (like "*.cs"), we still need the folders events
+    // so we can watch the new folders, the exclude patterns are still used.
+    return false;
+  }
+
+  /**
+   * \brief the folders events might be needed whatever the actions mask.
+   */
+  bool Directories::IsActionWanted(const EventAction action) const
+  {
+    // the non recursive parents of a multiple monitor need the folders events
+    // so they can watch the new folders, the unwanted events are removed before they are published.
+    if (Parent().KeepFolderEvents())
+    {
+      return true;
+    }
+    return Common::IsActionWanted(action);
+  }
 }
\ No newline at end of file
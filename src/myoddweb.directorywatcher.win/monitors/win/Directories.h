@@ -38,6 +38,18 @@ namespace myoddweb
          */
         [[nodiscard]]
         bool IsFile(EventAction action, const std::wstring& path) const override;
+
+        /**
+         * \brief the include patterns do not apply to the folders.
+         */
+        [[nodiscard]]
+        bool UseIncludePatterns() const override;
+
+        /**
+         * \brief the folders events might be needed whatever the actions mask.
+         */
+        [[nodiscard]]
+        bool IsActionWanted(EventAction action) const override;
       };
     }
   }
@@ -3,6 +3,7 @@
 // See the LICENSE file in the project root for more information.
 #include <process.h>
 #include "Files.h"
+#include "../../utils/EventsMask.h"
 
 namespace myoddweb:: directorywatcher:: win
 {
@@ -23,39 +24,68 @@ namespace myoddweb:: directorywatcher:: win
     // what we are looking for.
     // https://docs.microsoft.com/en-us/windows/desktop/api/fileapi/nf-fileapi-findfirstchangenotificationa
     // https://docs.microsoft.com/en-gb/windows/desktop/api/WinBase/nf-winbase-readdirectorychangesw
-    return
+    unsigned long notifyFilter = 0;
+    if (IsActionWanted(EventAction::Added) || IsActionWanted(EventAction::Removed) || IsActionWanted(EventAction::Renamed))
+    {
       // Any file name change in the watched directory or subtree causes a change 
       // notification wait operation to return.
       // Changes include renaming, creating, or deleting a file name.
-      FILE_NOTIFY_CHANGE_FILE_NAME |
+      notifyFilter |= FILE_NOTIFY_CHANGE_FILE_NAME;
+    }
+
+    // all the other changes are 'touched' events.
+    if (!IsActionWanted(EventAction::Touched))
+    {
+      return notifyFilter;
+    }
 
+    const auto changesMask = Parent().ChangesMask();
+    if (changesMask & static_cast<int>(ChangesMask::Attributes))
+    {
       // Any attribute change in the watched directory or subtree causes
       // a change notification wait operation to return.
-      FILE_NOTIFY_CHANGE_ATTRIBUTES |
+      notifyFilter |= FILE_NOTIFY_CHANGE_ATTRIBUTES;
+    }
 
+    if (changesMask & static_cast<int>(ChangesMask::Size))
+    {
       // Any file-size change in the watched directory or subtree causes a change 
       // notification wait operation to return. 
       // The operating system detects a change in file size only when the file is written to the disk. 
       // For operating systems that use extensive caching, detection occurs only when the cache is sufficiently flushed.
-      FILE_NOTIFY_CHANGE_SIZE |
+      notifyFilter |= FILE_NOTIFY_CHANGE_SIZE;
+    }
 
+    if (changesMask & static_cast<int>(ChangesMask::LastWrite))
+    {
       // Any change to the last write-time of files in the watched directory or subtree causes a change 
       // notification wait operation to return. The operating system detects a change
       // to the last write-time only when the file is written to the disk. 
       // For operating systems that use extensive caching, detection occurs only when the cache is sufficiently flushed.
-      FILE_NOTIFY_CHANGE_LAST_WRITE |
+      notifyFilter |= FILE_NOTIFY_CHANGE_LAST_WRITE;
+    }
 
+    if (changesMask & static_cast<int>(ChangesMask::LastAccess))
+    {
       // Any change to the last access time of files in the watched directory or subtree causes a 
       // change notification wait operation to return.
-      FILE_NOTIFY_CHANGE_LAST_ACCESS |
+      notifyFilter |= FILE_NOTIFY_CHANGE_LAST_ACCESS;
+    }
 
+    if (changesMask & static_cast<int>(ChangesMask::Creation))
+    {
       // Any change to the creation time of files in the watched directory or subtree 
       // causes a change notification wait operation to return.
-      FILE_NOTIFY_CHANGE_CREATION |
+      notifyFilter |= FILE_NOTIFY_CHANGE_CREATION;
+    }
 
+    if (changesMask & static_cast<int>(ChangesMask::Security))
+    {
       // Any security-descriptor change in the watched directory or subtree causes 
       // a change notification wait operation to return.
-      FILE_NOTIFY_CHANGE_SECURITY;
+      notifyFilter |= FILE_NOTIFY_CHANGE_SECURITY;
+    }
+    return notifyFilter;
   }
 
   /**
@@ -0,0 +1,143 @@
+// Licensed to Florent Guelfucci under one or more agreements.
+// Florent Guelfucci licenses this file to you under the MIT license.
+// See the LICENSE file in the project root for more information.
+#include <Windows.h>
+#include "Arena.h"
+#include "Lock.h"
+#include "Instrumentor.h"
+
+namespace myoddweb:: directorywatcher
+{
+  /**
+   * \brief the alignment of all the allocations.
+   */
+  constexpr size_t ArenaAlignment = 8;
+
+  Arena::Arena(const size_t blockSize) :
+    _blockSize(blockSize),
+    _current(nullptr),
+    _nextBlock(0)
+  {
+  }
+
+  Arena::~Arena()
+  {
+    for (const auto& block : _blocks)
+    {
+      delete[] block->Data;
+      delete block;
+    }
+    _blocks.clear();
+    _current = nullptr;
+  }
+
+  /**
+   * \brief get a block of memory from the arena.
+   *        the memory is released when the arena is reset.
+   * \param bytes the number of bytes we want.
+   * \return the memory, aligned to 8 bytes.
+   */
+  void* Arena::Allocate(size_t bytes)
+  {
+    MYODDWEB_PROFILE_FUNCTION();
+
+    // make sure that the next allocation is aligned.
+    bytes = (bytes + (ArenaAlignment - 1)) & ~(ArenaAlignment - 1);
+    for (;;)
+    {
+      const auto block = _current.load();
+      if (block != nullptr)
+      {
+        // try and get the memory from the current block
+        // if we go past the end of the block then nobody else will be able to use it either.
+        const auto offset = block->Used.fetch_add(bytes);
+        if (offset + bytes <= block->Size)
+        {
+          return block->Data + offset;
+        }
+      }
+
+      // we need a new block
+      MYODDWEB_LOCK(_lock);
+
+      // did someone else already move to another block?
+      if (_current.load() != block)
+      {
+        continue;
+      }
+      _current = NextBlockInLock(bytes);
+    }
+  }
+
+  /**
+   * \brief copy a string to the arena.
+   * \param source the string we are copying.
+   * \param length the number of characters, not including the null terminator.
+   * \return the null terminated copy of the string.
+   */
+  const wchar_t* Arena::Copy(const wchar_t* source, const size_t length)
+  {
+    const auto destination = static_cast<wchar_t*>(Allocate((length + 1) * sizeof(wchar_t)));
+    if (length > 0)
+    {
+      wmemcpy(destination, source, length);
+    }
+    destination[length] = L'\0';
+    return destination;
+  }
+
+  /**
+   * \brief get the next block that can hold at least the given number of bytes.
+   *        the lock must be held by the caller.
+   * \param bytes the minimum number of bytes we need.
+   * \return the block we can use.
+   */
+  Arena::Block* Arena::NextBlockInLock(const size_t bytes)
+  {
+    // can we re-use one of the blocks we already have?
+    while (_nextBlock < _blocks.size())
+    {
+      const auto block = _blocks[_nextBlock++];
+      if (block->Size >= bytes)
+      {
+        block->Used = 0;
+        return block;
+      }
+    }
+
+    // we need a brand new block.
+    const auto block = new Block();
+    block->Size = bytes > _blockSize ? bytes : _blockSize;
+    block->Data = new char[block->Size];
+    block->Used = 0;
+    _blocks.emplace_back(block);
+    _nextBlock = _blocks.size();
+    return block;
+  }
+
+  /**
+   * \brief release all the memory that was allocated
+   *        the blocks themselves are kept so they can be reused.
+   */
+  void Arena::Reset()
+  {
+    MYODDWEB_PROFILE_FUNCTION();
+    MYODDWEB_LOCK(_lock);
+    _current = nullptr;
+    _nextBlock = 0;
+  }
+
+  /**
+   * \brief the total number of bytes we reserved from the system.
+   */
+  size_t Arena::Capacity() const
+  {
+    MYODDWEB_LOCK(_lock);
+    size_t capacity = 0;
+    for (const auto& block : _blocks)
+    {
+      capacity += block->Size;
+    }
+    return capacity;
+  }
+}
@@ -0,0 +1,105 @@
+// Licensed to Florent Guelfucci under one or more agreements.
+// Florent Guelfucci licenses this file to you under the MIT license.
+// See the LICENSE file in the project root for more information.
+#pragma once
+#include <atomic>
+#include <vector>
+
+#include "../monitors/Base.h"
+
+namespace myoddweb
+{
+  namespace directorywatcher
+  {
+    /**
+     * \brief bump allocator, all the memory is released in one go with Reset()
+     *        Allocate() is thread safe and only takes a lock when a new block is needed.
+     *        Reset() is not thread safe and must only be called when nobody is using the memory.
+     *        The blocks are never freed until the arena is destroyed, so once the arena
+     *        has grown to the size it needs there are no more system allocations.
+     */
+    class Arena final
+    {
+    public:
+      explicit Arena(size_t blockSize = MYODDWEB_ARENA_BLOCK_SIZE);
+      ~Arena();
+
+      Arena(const Arena&) = delete;
+      Arena(Arena&&) = delete;
+      const Arena& operator=(const Arena&) = delete;
+      Arena& operator=(Arena&&) = delete;
+
+      /**
+       * \brief get a block of memory from the arena.
+       *        the memory is released when the arena is reset.
+       * \param bytes the number of bytes we want.
+       * \return the memory, aligned to 8 bytes.
+       */
+      void* Allocate(size_t bytes);
+
+      /**
+       * \brief copy a string to the arena.
+       * \param source the string we are copying.
+       * \param length the number of characters, not including the null terminator.
+       * \return the null terminated copy of the string.
+       */
+      const wchar_t* Copy(const wchar_t* source, size_t length);
+
+      /**
+       * \brief release all the memory that was allocated
+       *        the blocks themselves are kept so they can be reused.
+       */
+      void Reset();
+
+      /**
+       * \brief the total number of bytes we reserved from the system.
+       */
+      [[nodiscard]]
+      size_t Capacity() const;
+
+    private:
+      /**
+       * \brief a single block of memory we will be handing out.
+       */
+      struct Block
+      {
+        char* Data;
+        size_t Size;
+        std::atomic<size_t> Used;
+      };
+
+      /**
+       * \brief the default size of each block.
+       */
+      const size_t _blockSize;
+
+      /**
+       * \brief the block we are currently allocating from.
+       */
+      std::atomic<Block*> _current;
+
+      /**
+       * \brief all the blocks we have, in the order they are used.
+       */
+      std::vector<Block*> _blocks;
+
+      /**
+       * \brief the next block we will be (re)using.
+       */
+      size_t _nextBlock;
+
+      /**
+       * \brief the lock we use when we need to move to another block.
+       */
+      mutable MYODDWEB_MUTEX _lock;
+
+      /**
+       * \brief get the next block that can hold at least the given number of bytes.
+       *        the lock must be held by the caller.
+       * \param bytes the minimum number of bytes we need.
+       * \return the block we can use.
+       */
+      Block* NextBlockInLock(size_t bytes);
+    };
+  }
+}
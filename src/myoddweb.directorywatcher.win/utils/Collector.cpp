@@ -2,6 +2,13 @@
 // Florent Guelfucci licenses this file to you under the MIT license.
 // See the LICENSE file in the project root for more information.
 #include <Windows.h>
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <new>
+#include <thread>
+#include <unordered_map>
+#include <utility>
 #include "Collector.h"
 #include "Lock.h"
 #include "Io.h"
@@ -18,16 +25,84 @@ namespace myoddweb:: directorywatcher
    *        this is only a GUIDE because the data is only cleanned when needed.
    */
   Collector::Collector( const long long maxCleanupAgeMilliseconds) :
+    Collector(maxCleanupAgeMilliseconds, L"", 0, 0, OverflowPolicy::DropOldest, 1, 0)
+  {
+  }
+
+  /**
+   * \brief the constructor with limits on the number of events we can hold.
+   * \param maxCleanupAgeMilliseconds the maximum amount of time we want the collector to keep data
+   * \param path the path we are collecting events for, used for the overflow event.
+   * \param maxNumberOfEvents the maximum number of events we want to hold, 0 for no limit.
+   * \param maxNumberOfBytes the maximum number of bytes our events can use, 0 for no limit.
+   * \param overflowPolicy what we do when we have too many events.
+   * \param numberOfShards the number of shards the producer threads are spread over.
+   * \param renamePairingMilliseconds how long we keep half of a rename waiting for the other half, 0 to not pair them.
+   */
+  Collector::Collector(
+    const long long maxCleanupAgeMilliseconds,
+    const std::wstring& path,
+    const long long maxNumberOfEvents,
+    const long long maxNumberOfBytes,
+    const OverflowPolicy overflowPolicy,
+    const int numberOfShards,
+    const long long renamePairingMilliseconds) :
     _maxCleanupAgeMilliseconds(maxCleanupAgeMilliseconds ),
-    _currentEvents(nullptr)
+    _path(path),
+    _renamePairingMilliseconds(renamePairingMilliseconds < 0 ? 0 : renamePairingMilliseconds),
+    _renamesMatched(0),
+    _renamesTimedOut(0),
+    _renamesLatency(0),
+    _eventsSignal(nullptr),
+    _maxNumberOfEvents(maxNumberOfEvents < 0 ? 0 : maxNumberOfEvents),
+    _maxNumberOfBytes(maxNumberOfBytes < 0 ? 0 : maxNumberOfBytes),
+    _overflowPolicy(overflowPolicy),
+    _numberOfEvents(0),
+    _numberOfBytes(0),
+    _overflowed(false),
+    _droppedEvents(0),
+    _activeArena(0),
+    _publishedArena(1),
+    _arenasBusy(false),
+    // with limits, we compact the arena before ReserveWindow() starts dropping events.
+    _compactEvents(_maxNumberOfEvents > 0 ? _maxNumberOfEvents / 2 : (std::numeric_limits<long long>::max)()),
+    _compactBytes(_maxNumberOfBytes > 0 ? (std::min)(_maxNumberOfBytes / 2, static_cast<long long>(MYODDWEB_ARENA_BLOCK_SIZE)) : MYODDWEB_ARENA_BLOCK_SIZE),
+    _removedEvents(0),
+    _removedBytes(0),
+    _lockContention(0),
+    _fullRing(0),
+    _currentEvents(nullptr),
+    _spareEvents(nullptr)
   {
+    // we always have at least one shard.
+    const auto shards = numberOfShards < 1 ? 1 : (numberOfShards > MYODDWEB_MAX_COLLECTOR_SHARDS ? MYODDWEB_MAX_COLLECTOR_SHARDS : numberOfShards);
+    _shards.reserve(shards);
+    for (auto i = 0; i < shards; ++i)
+    {
+      _shards.push_back(new Shard(MYODDWEB_EVENTS_RING_CAPACITY));
+    }
+    for (auto i = 0; i < 3; ++i)
+    {
+      _windowEvents[i] = 0;
+      _windowBytes[i] = 0;
+    }
+
     // calculate the max age
-    _currentEvents = new EventsInformation();
+    _currentEvents = new EventsDeque();
+    _spareEvents = new EventsDeque();
   }
 
   Collector::~Collector()
   {
-    ClearEvents(_currentEvents);
+    // the events themselves are owned by the arenas.
+    delete _currentEvents;
+    delete _spareEvents;
+
+    for (const auto& shard : _shards)
+    {
+      delete shard;
+    }
+    _shards.clear();
   }
 
   /**
@@ -54,7 +129,7 @@ namespace myoddweb:: directorywatcher
    * \param isFile if this is a file or a folder.
    * \param error if there was an error related
    */
-  void Collector::Add(const EventAction action, const std::wstring& path, const std::wstring& filename, bool isFile, EventError error)
+  void Collector::Add(const EventAction action, const wchar_t* path, const std::wstring& filename, bool isFile, EventError error)
   {
     MYODDWEB_PROFILE_FUNCTION();
 
@@ -70,10 +145,17 @@ namespace myoddweb:: directorywatcher
    * \param isFile if this is a file or a folder.
    * \param error if there is an error related to the rename
    */
-  void Collector::AddRename(const std::wstring& path, const std::wstring& newFilename, const std::wstring& oldFilename, bool isFile, EventError error)
+  void Collector::AddRename(const wchar_t* path, const std::wstring& newFilename, const std::wstring& oldFilename, bool isFile, EventError error)
   {
     MYODDWEB_PROFILE_FUNCTION();
 
+    // if we only have half of the rename, the other half might still be coming.
+    if (_renamePairingMilliseconds > 0 && error == EventError::None && newFilename.empty() != oldFilename.empty())
+    {
+      PairRename(path, newFilename, oldFilename, isFile);
+      return;
+    }
+
     // just add the action without an old filename.
     Add(EventAction::Renamed, path, newFilename, oldFilename, isFile, error );
   }
@@ -87,7 +169,7 @@ namespace myoddweb:: directorywatcher
    * \param isFile if this is a file or a folder.
    * \param error if there was an error related to the action
    */
-  void Collector::Add( const EventAction action, const std::wstring& path, const std::wstring& filename, const std::wstring& oldFileName, const bool isFile, EventError error)
+  void Collector::Add( const EventAction action, const wchar_t* path, const std::wstring& filename, const std::wstring& oldFileName, const bool isFile, EventError error)
   {
     MYODDWEB_PROFILE_FUNCTION();
 
@@ -97,47 +179,449 @@ namespace myoddweb:: directorywatcher
       return;
     }
 
+    // flag that we are writing to the arena
+    // so it is not published before we are done.
+    auto& shard = ShardForThisThread();
+    const auto index = AcquireArena(shard);
     try
     {
-      // get the combined path.
-      const auto combinedPath = filename.empty() ? (isFile ? L"" : path) : Io::Combine(path, filename);
+      auto& arena = shard.Arenas[index];
 
-      // We first create the event outside the lock
-      // that way, we only have the lock for the shortest
-      // posible amount of time.
-      const auto ofn = oldFileName.empty() ? L"" : Io::Combine(path, oldFileName);
-      const auto eventInformation = new EventInformation(
+      // we only keep the names relative to the root
+      // the full path is created when the event is published.
+      const auto root = _roots.Intern(path);
+      const auto name = TrimLeadingSeparators(filename);
+      const auto oldName = TrimLeadingSeparators(oldFileName);
+
+      // count what we add to the arena and check our limits before we use any of its memory.
+      const auto size = static_cast<long long>(EventInformation::Size(name.length(), oldName.length()));
+      if (!ReserveWindow(index, size))
+      {
+        // we already used all the memory we are allowed to use in this window.
+        FlagDroppedEvents(1);
+      }
+      else
+      {
+        // We first create the event outside the lock
+        // that way, we only have the lock for the shortest
+        // posible amount of time.
+        // the relative names are copied right after the event in the arena.
+        const auto eventInformation = EventInformation::Create(
+          arena,
           GetMillisecondsNowUtc(),
           action,
           error,
-          combinedPath.c_str(),
-          ofn.c_str(),
-        isFile);
+          root,
+          name,
+          oldName,
+          isFile);
 
-      // we can now add the event to our vector.
-      AddEventInformation(eventInformation);
+        // we can now add the event to our vector.
+        AddEventInformation(shard, eventInformation);
 
-      // try and cleanup the events if need be.
-      CleanupEvents();
+        // let whoever is waiting for events know that we have one more.
+        if (_eventsSignal != nullptr)
+        {
+          _eventsSignal->Notify();
+        }
+
+        // if we have too many events we need to remove some of them.
+        // we still hold the arena so we can create new events in it.
+        if (HasLimits())
+        {
+          const auto numberOfEvents = ++_numberOfEvents;
+          const auto numberOfBytes = (_numberOfBytes += size);
+          if (IsAboveLimits(numberOfEvents, numberOfBytes, 100))
+          {
+            MYODDWEB_LOCK(_lock);
+            ShedEventsInLock(arena);
+          }
+        }
+      }
     }
     catch (std::exception& e)
     {
       // log the error
       Logger::Log(LogLevel::Error, L"Caught exception '%hs' when adding event to collector", e.what());
     }
+
+    // we are done with the arena.
+    ReleaseArena(shard, index);
+
+    // try and cleanup the events if need be.
+    CleanupEvents();
+
+    // the events we removed are still using memory in the arena.
+    CompactArenasIfNeeded();
+  }
+
+  /**
+   * \brief try and pair half of a rename with a pending half.
+   *        if we cannot, the half is kept until the other half arrives or it times out.
+   * \param path the root path.
+   * \param newFilename the new name, empty if this is the old half.
+   * \param oldFilename the old name, empty if this is the new half.
+   * \param isFile if this is a file or a folder.
+   */
+  void Collector::PairRename(const wchar_t* path, const std::wstring& newFilename, const std::wstring& oldFilename, const bool isFile)
+  {
+    MYODDWEB_PROFILE_FUNCTION();
+
+    const auto now = GetMillisecondsNowUtc();
+    const auto root = path == nullptr ? L"" : path;
+    std::vector<PendingRename> expired;
+    auto paired = false;
+    PendingRename rename;
+    {
+      MYODDWEB_LOCK(_renamesLock);
+      TakeExpiredRenamesInLock(now, expired);
+
+      // look for the oldest other half of the same root.
+      const auto isOldHalf = newFilename.empty();
+      for (auto it = _pendingRenames.begin(); it != _pendingRenames.end(); ++it)
+      {
+        if (it->NewName.empty() == isOldHalf || it->Path != root)
+        {
+          continue;
+        }
+
+        // the new half is the one that exists, so it knows if this is a file or not.
+        rename = *it;
+        rename.NewName = isOldHalf ? it->NewName : newFilename;
+        rename.OldName = isOldHalf ? oldFilename : it->OldName;
+        rename.IsFile = isOldHalf ? it->IsFile : isFile;
+        _pendingRenames.erase(it);
+        paired = true;
+        break;
+      }
+
+      if (!paired)
+      {
+        // we have too many, the oldest one will never be paired.
+        if (_pendingRenames.size() >= MYODDWEB_MAX_PENDING_RENAMES)
+        {
+          expired.push_back(_pendingRenames.front());
+          _pendingRenames.pop_front();
+        }
+        _pendingRenames.push_back(PendingRename{ now, root, newFilename, oldFilename, isFile });
+      }
+    }
+
+    // the events are added outside of the renames lock.
+    for (const auto& half : expired)
+    {
+      ++_renamesTimedOut;
+      _renamesLatency += now - half.TimeMillisecondsUtc;
+      Add(EventAction::Renamed, half.Path.c_str(), half.NewName, half.OldName, half.IsFile, EventError::None);
+    }
+
+    if (paired)
+    {
+      ++_renamesMatched;
+      _renamesLatency += now - rename.TimeMillisecondsUtc;
+      Add(EventAction::Renamed, rename.Path.c_str(), rename.NewName, rename.OldName, rename.IsFile, EventError::None);
+    }
+  }
+
+  /**
+   * \brief move the half renames that waited too long to the collection
+   *        they will be turned into added/removed events when published.
+   * \param now the current time.
+   */
+  void Collector::AddExpiredRenames(const long long now)
+  {
+    if (_renamePairingMilliseconds == 0)
+    {
+      return;
+    }
+
+    std::vector<PendingRename> expired;
+    {
+      MYODDWEB_LOCK(_renamesLock);
+      TakeExpiredRenamesInLock(now, expired);
+    }
+
+    for (const auto& half : expired)
+    {
+      ++_renamesTimedOut;
+      _renamesLatency += now - half.TimeMillisecondsUtc;
+      Add(EventAction::Renamed, half.Path.c_str(), half.NewName, half.OldName, half.IsFile, EventError::None);
+    }
+  }
+
+  /**
+   * \brief the number of ms before the oldest half rename stops waiting for its other half.
+   * \return the ms left, 0 if it already expired or -1 if no half renames are pending.
+   */
+  long long Collector::PendingRenamesMilliseconds()
+  {
+    if (_renamePairingMilliseconds == 0)
+    {
+      return -1;
+    }
+
+    MYODDWEB_LOCK(_renamesLock);
+    if (_pendingRenames.empty())
+    {
+      return -1;
+    }
+    const auto expires = _pendingRenames.front().TimeMillisecondsUtc + _renamePairingMilliseconds;
+    return std::max(0LL, expires - GetMillisecondsNowUtc());
+  }
+
+  /**
+   * \brief take the half renames that waited too long out of the pending renames.
+   *        the renames lock must be held by the caller.
+   * \param now the current time.
+   * \param expired where we will add the expired renames.
+   */
+  void Collector::TakeExpiredRenamesInLock(const long long now, std::vector<PendingRename>& expired)
+  {
+    // the renames are in the order they were added.
+    while (!_pendingRenames.empty() && _pendingRenames.front().TimeMillisecondsUtc + _renamePairingMilliseconds <= now)
+    {
+      expired.push_back(_pendingRenames.front());
+      _pendingRenames.pop_front();
+    }
+  }
+
+  /**
+   * \brief create a shard
+   * \param capacity the number of events the ring of the shard can hold.
+   */
+  Collector::Shard::Shard(const size_t capacity) :
+    Ring(capacity)
+  {
+    for (auto& writers : Writers)
+    {
+      writers = 0;
+    }
+  }
+
+  /**
+   * \brief get the shard the current thread adds its events to.
+   *        the shard only depends on the thread id, so the producers of this collector
+   *        are spread over its shards whatever other collectors they added events to.
+   */
+  Collector::Shard& Collector::ShardForThisThread()
+  {
+    if (_shards.size() == 1)
+    {
+      return *_shards[0];
+    }
+
+    static thread_local const auto threadHash = HashThisThread();
+    return *_shards[threadHash % _shards.size()];
+  }
+
+  /**
+   * \brief the hash of the id of the current thread.
+   *        the ids are often addresses, so the bits are mixed before we use the low ones.
+   */
+  unsigned long long Collector::HashThisThread()
+  {
+    auto hash = static_cast<unsigned long long>(std::hash<std::thread::id>()(std::this_thread::get_id()));
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ULL;
+    hash ^= hash >> 33;
+    return hash;
+  }
+
+  /**
+   * \brief get the arena producers can write to and flag that we are using it.
+   * \param shard the shard of the current thread.
+   * \return the index of the arena we are using.
+   */
+  int Collector::AcquireArena(Shard& shard)
+  {
+    for (;;)
+    {
+      // the arenas are being swapped or compacted, we wait for it to be done.
+      if (_arenasBusy.load())
+      {
+        MYODDWEB_LOCK(_arenasLock);
+        continue;
+      }
+
+      const auto index = _activeArena.load();
+      ++shard.Writers[index];
+
+      // make sure that the arena was not swapped while we were flagging it.
+      if (!_arenasBusy.load() && index == _activeArena.load())
+      {
+        return index;
+      }
+      --shard.Writers[index];
+    }
+  }
+
+  /**
+   * \brief flag that we are no longer writing to the arena.
+   * \param shard the shard of the current thread.
+   * \param index the index of the arena we are done with.
+   */
+  void Collector::ReleaseArena(Shard& shard, const int index)
+  {
+    --shard.Writers[index];
+  }
+
+  /**
+   * \brief stop the producers from using the arenas and wait for the ones still writing to the active one.
+   *        the arenas lock must be held by the caller.
+   * \return the index of the active arena.
+   */
+  int Collector::PauseProducersInLock()
+  {
+    MYODDWEB_PROFILE_FUNCTION();
+
+    _arenasBusy = true;
+    const auto index = _activeArena.load();
+
+    // this is very short as they are only creating a single event.
+    for (const auto& shard : _shards)
+    {
+      while (shard->Writers[index].load() != 0)
+      {
+        std::this_thread::yield();
+      }
+    }
+    return index;
+  }
+
+  /**
+   * \brief make an arena the active one and let the producers use it.
+   *        the arenas lock must be held by the caller.
+   * \param index the arena the producers will be writing to.
+   */
+  void Collector::ResumeProducersInLock(const int index)
+  {
+    _activeArena = index;
+    _arenasBusy = false;
+  }
+
+  /**
+   * \brief reset an arena of every shard.
+   *        nobody can be using the events in those arenas.
+   * \param index the arena we are resetting.
+   */
+  void Collector::ResetArenas(const int index)
+  {
+    for (const auto& shard : _shards)
+    {
+      shard->Arenas[index].Reset();
+    }
+    _windowEvents[index] = 0;
+    _windowBytes[index] = 0;
+  }
+
+  /**
+   * \brief flag that events were removed from the active arena, (too old or over our limits).
+   *        the lock must be held by the caller.
+   * \param numberOfEvents the number of events removed.
+   * \param numberOfBytes the number of bytes removed.
+   */
+  void Collector::FlagRemovedEventsInLock(const long long numberOfEvents, const long long numberOfBytes)
+  {
+    _removedEvents += numberOfEvents;
+    _removedBytes += numberOfBytes;
+  }
+
+  /**
+   * \brief if most of the memory of the active arena is used by events we removed.
+   *        copying the events we still hold is then cheaper than what we get back.
+   */
+  bool Collector::MustCompactArenas() const
+  {
+    const auto index = _activeArena.load();
+    const auto removedEvents = _removedEvents.load();
+    if (removedEvents > _compactEvents && 2 * removedEvents > _windowEvents[index])
+    {
+      return true;
+    }
+    const auto removedBytes = _removedBytes.load();
+    return removedBytes > _compactBytes && 2 * removedBytes > _windowBytes[index];
+  }
+
+  /**
+   * \brief the events we removed, (too old or over our limits), still use memory in the active arena
+   *        so once they use most of it, we move the events we still hold to the spare arena and reset it.
+   *        this does not wait if someone else is already using the arenas.
+   */
+  void Collector::CompactArenasIfNeeded()
+  {
+    // most of the time there is nothing to do.
+    if (!MustCompactArenas())
+    {
+      return;
+    }
+
+    // if someone else is swapping or compacting the arenas, the next event will try again.
+    std::unique_lock<MYODDWEB_MUTEX> arenasLock(_arenasLock, std::try_to_lock);
+    if (!arenasLock.owns_lock())
+    {
+      ++_lockContention;
+      return;
+    }
+
+    // the events might have been published while we were getting the lock.
+    if (!MustCompactArenas())
+    {
+      return;
+    }
+
+    MYODDWEB_PROFILE_FUNCTION();
+    const auto index = PauseProducersInLock();
+    const auto spare = 3 - index - _publishedArena;
+    auto& arena = _shards[0]->Arenas[spare];
+    long long numberOfBytes = 0;
+    EventsInformation events;
+    {
+      MYODDWEB_LOCK(_lock);
+
+      // move whatever the producers added to the ring.
+      DrainRingInLock();
+
+      // copy the events we still hold, the ones we removed are left behind.
+      _currentEvents->CopyTo(events);
+      for (auto& eventInformation : events)
+      {
+        eventInformation = EventInformation::Create(
+          arena,
+          eventInformation->TimeMillisecondsUtc,
+          eventInformation->Action,
+          eventInformation->Error,
+          eventInformation->Root,
+          std::wstring_view(eventInformation->Name, eventInformation->NameLength),
+          std::wstring_view(eventInformation->OldName, eventInformation->OldNameLength),
+          eventInformation->IsFile);
+        numberOfBytes += EventSize(*eventInformation);
+      }
+      _currentEvents->Clear();
+      _currentEvents->Append(events);
+      _removedEvents = 0;
+      _removedBytes = 0;
+    }
+
+    // nothing points to the old active arenas anymore.
+    ResetArenas(index);
+    _windowEvents[spare] = static_cast<long long>(events.size());
+    _windowBytes[spare] = numberOfBytes;
+    ResumeProducersInLock(spare);
   }
 
   /**
    * \brief copy the current content of the events into a local variable.
    * Then erase the current content so we can continue receiving data.
    */
-  Collector::EventsInformation* Collector::CloneEventsAndEraseCurrent()
+  EventsDeque* Collector::CloneEventsAndEraseCurrent()
   {
     MYODDWEB_PROFILE_FUNCTION();
 
     // if we have nothing to do, no point in calling the extra functions.
     // this is thread safe, so we can check out of lock
-    if (_nextCleanupTimeCheck == 0)
+    if (_nextCleanupTimeCheck == 0 && !_overflowed)
     {
       return nullptr;
     }
@@ -146,14 +630,48 @@ namespace myoddweb:: directorywatcher
     // and we erased all the data, there is nothing else to do.
     _nextCleanupTimeCheck = 0;
 
-    // lock
-    MYODDWEB_LOCK(_lock);
+    // the producers wait while we take the events out of the active arenas
+    // so all the events we publish are in the arenas we are about to publish.
+    // this must be done outside the lock as producers might need it if the ring is full.
+    MYODDWEB_LOCK(_arenasLock);
+    const auto previous = PauseProducersInLock();
+
+    EventsDeque* clone;
+    {
+      // lock
+      MYODDWEB_LOCK(_lock);
+
+      // move whatever the producers added to the ring.
+      DrainRingInLock();
 
-    // copy the address, it is up to the clone now to handle it all.
-    const auto clone = _currentEvents;
+      // copy the address, it is up to the clone now to handle it all.
+      clone = _currentEvents;
 
-    // create a brand new container.
-    _currentEvents = new EventsInformation();
+      // those events are no longer counted against our limits.
+      if (HasLimits())
+      {
+        long long numberOfBytes = 0;
+        for (size_t i = 0; i < clone->Size(); ++i)
+        {
+          numberOfBytes += EventSize(*(*clone)[i]);
+        }
+        _numberOfEvents -= static_cast<long long>(clone->Size());
+        _numberOfBytes -= numberOfBytes;
+      }
+
+      // use the spare container, it was emptied the last time we were called.
+      _currentEvents = _spareEvents != nullptr ? _spareEvents : new EventsDeque();
+      _spareEvents = nullptr;
+      _removedEvents = 0;
+      _removedBytes = 0;
+    }
+
+    // the events in the arenas we published last time are no longer used
+    // so the producers can now use them.
+    const auto next = _publishedArena;
+    ResetArenas(next);
+    _publishedArena = previous;
+    ResumeProducersInLock(next);
 
     // return the number of items
     return clone;
@@ -170,8 +688,68 @@ namespace myoddweb:: directorywatcher
     return lhs->TimeMillisecondsUtc < rhs->TimeMillisecondsUtc;
   }
 
+  /**
+   * \brief merge lists of events, each one in time order, into a single list in time order.
+   *        a list that is not in order, (the clock moved back), is sorted first.
+   * \param sources the lists of events we are merging.
+   * \param numberOfSources the number of lists we are merging, from the start of sources.
+   * \param events where we are adding the merged events.
+   */
+  void Collector::MergeByTimeMillisecondsUtc(std::vector<std::vector<Event*>>& sources, const size_t numberOfSources, std::vector<Event*>& events)
+  {
+    MYODDWEB_PROFILE_FUNCTION();
+
+    auto numberOfEvents = static_cast<size_t>(0);
+    for (size_t i = 0; i < numberOfSources; ++i)
+    {
+      auto& source = sources[i];
+      if (!std::is_sorted(source.begin(), source.end(), SortByTimeMillisecondsUtc))
+      {
+        std::stable_sort(source.begin(), source.end(), SortByTimeMillisecondsUtc);
+      }
+      numberOfEvents += source.size();
+    }
+    events.reserve(events.size() + numberOfEvents);
+
+    // the next event of each list, (the list and the position in that list).
+    // the heap keeps the oldest one at the front, the first list wins if the times are the same.
+    std::vector<std::pair<size_t, size_t>> next;
+    next.reserve(numberOfSources);
+    const auto isNewer = [&sources](const std::pair<size_t, size_t>& lhs, const std::pair<size_t, size_t>& rhs)
+    {
+      const auto lhsTime = sources[lhs.first][lhs.second]->TimeMillisecondsUtc;
+      const auto rhsTime = sources[rhs.first][rhs.second]->TimeMillisecondsUtc;
+      return lhsTime != rhsTime ? lhsTime > rhsTime : lhs.first > rhs.first;
+    };
+    for (size_t i = 0; i < numberOfSources; ++i)
+    {
+      if (!sources[i].empty())
+      {
+        next.emplace_back(i, 0);
+      }
+    }
+    std::make_heap(next.begin(), next.end(), isNewer);
+
+    while (!next.empty())
+    {
+      std::pop_heap(next.begin(), next.end(), isNewer);
+      auto& oldest = next.back();
+      const auto& source = sources[oldest.first];
+      events.push_back(source[oldest.second]);
+      if (++oldest.second < source.size())
+      {
+        std::push_heap(next.begin(), next.end(), isNewer);
+      }
+      else
+      {
+        next.pop_back();
+      }
+    }
+  }
+
   /**
    * \brief fill the vector with all the values currently on record.
+   *        our events that are the same as one already in the vector are not added.
    * \param events the events we will be filling
    * \return the number of events we found.
    */
@@ -179,6 +757,9 @@ namespace myoddweb:: directorywatcher
   {
     MYODDWEB_PROFILE_FUNCTION();
 
+    // the half renames that waited long enough are published as they are.
+    AddExpiredRenames(GetMillisecondsNowUtc());
+
     // quickly make a copy of the current list
     // and erase the current contents.
     // the lock is released as soon as posible making sure that other threads
@@ -194,65 +775,73 @@ namespace myoddweb:: directorywatcher
     // we can now reserve some space in our return vector.
     // we know that it will be a maximum of that size.
     // but we will not be adding more to id.
-    events.reserve( clone->size() );
+    const auto first = events.size();
+    events.reserve( first + clone->Size() );
+
+    // create the index we will use to look for duplicates
+    // we want at least twice as many slots as we have events
+    // so we do not have to go too far to find a free slot.
+    size_t numberOfSlots = 16;
+    while( numberOfSlots < (first + clone->Size()) * 2 )
+    {
+      numberOfSlots <<= 1;
+    }
+    _duplicates.assign(numberOfSlots, DuplicateSlot{ 0, nullptr });
+
+    // the caller might already have some events, (from other collectors)
+    // our events are not added if they are the same as one of those.
+    for (size_t i = 0; i < first; ++i)
+    {
+      IsOlderDuplicate(_duplicates, *events[i]);
+    }
+
+    // the events are created in the arena we are publishing
+    // they will be released the next time we are called.
+    // only we use the first shard's arena when publishing.
+    auto& arena = _shards[0]->Arenas[_publishedArena];
 
     // go around the data from the newest to the oldest.
-    // and we will add them in reverse as well.
     // this is useful to make sure that we remove 'older' dulicates.
-    for( auto it = clone->rbegin(); it != clone->rend(); ++it )
+    for( auto i = clone->Size(); i-- > 0; )
     {
-      const auto& eventInformation = (*it);
-
-      const auto e = new Event(
-        eventInformation->Name,
-        eventInformation->OldName,
-        ConvertEventAction(eventInformation->Action),
-        ConvertEventError(eventInformation->Error),
-        eventInformation->TimeMillisecondsUtc,
-        eventInformation->IsFile);
-      if (IsOlderDuplicate(events, *e))
+      // we need the full paths to compare them with the events of the caller
+      // the memory is owned by the arena.
+      const auto& eventInformation = (*clone)[i];
+      const auto event = CreateFullEvent(arena, _roots.Get(eventInformation->Root), *eventInformation);
+      if (IsOlderDuplicate(_duplicates, *event))
       {
         // it is an older duplicate
         // so we do not want to add it,
-        delete e;
+        // the memory will be released with the arena.
         continue;
       }
-
-      // it is not a duplicate, so we can add it.
-      // because we are getting the data in reverse we will add the data
-      // in the front, it is older than the previous one.
-      // the caller will now be in charge of cleanning up the memory
-      events.insert( events.begin(), e);
+      events.push_back(event);
     }
 
+    // because we got the data in reverse, we now need to put it back
+    // in the order it was added, from the oldest to the newest.
+    std::reverse(events.begin() + first, events.end());
+
     // last step is to cleanup all the renames.
     ValidateRenames(events);
 
-    // finally we can cleanup the clone
-    // we took ownership of the data ... so we have to clean it all up.
-    ClearEvents(clone);
-  }
-
-  /**
-   * \brief clear all the events information and delete all the data.
-   * \param events the data we want to clear.
-   */
-  void Collector::ClearEvents(EventsInformation* events)
-  {
-    if( nullptr == events )
+    // if we had to drop some events, let the caller know.
+    if (_overflowed.exchange(false))
     {
-      return;
+      const auto e = new (arena.Allocate(sizeof(Event))) Event(
+        arena.Copy(_path.c_str(), _path.length()),
+        L"",
+        ConvertEventAction(EventAction::Unknown),
+        ConvertEventError(EventError::Overflow),
+        GetMillisecondsNowUtc(),
+        false);
+      events.push_back(e);
     }
 
-    // delete each events in the container.
-    for ( const auto& event : *events )
-    {
-      delete event;
-    }
-
-    // finaly delete the container itself
-    delete events;
-    events = nullptr;
+    // finally we can empty the clone and keep it for next time.
+    // the events themselves are owned by the arena.
+    clone->Clear();
+    _spareEvents = clone;
   }
 
   /**
@@ -271,9 +860,9 @@ namespace myoddweb:: directorywatcher
         continue;
       }
 
-      // get the file sizes.
-      const auto oldNameLen = event->OldName == nullptr ? 0 : wcslen(event->OldName);
-      const auto nameLen = event->Name == nullptr ? 0 : wcslen(event->Name);
+      // we only need to know if the names are empty, not their actual sizes.
+      const auto oldNameLen = event->OldName == nullptr ? 0 : (event->OldName[0] == L'\0' ? 0 : 1);
+      const auto nameLen = event->Name == nullptr ? 0 : (event->Name[0] == L'\0' ? 0 : 1);
 
       // old name is empty, but not new name
       if (oldNameLen == 0 && nameLen > 0)
@@ -302,18 +891,69 @@ namespace myoddweb:: directorywatcher
   }
 
   /**
-   * \brief check if the given information already exists in the source
-   * \param source the collection of events we will be looking in
-   * \param duplicate the event information we want to add.
-   * \return if the event information is already in the 'source'
+   * \brief calculate the hash of the (action, isFile, name) of an event.
+   * \param event the event we are calculating the hash for.
+   * \return the hash value
    */
-  bool Collector::IsOlderDuplicate(const std::vector<Event*>& source, const Event& duplicate)
+  unsigned long long Collector::HashEvent(const Event& event)
+  {
+    // FNV-1a hash of the name
+    constexpr auto prime = 1099511628211ULL;
+    auto hash = 14695981039346656037ULL;
+    for (auto c = event.Name; *c != L'\0'; ++c)
+    {
+      hash ^= static_cast<unsigned long long>(*c);
+      hash *= prime;
+    }
+
+    // then mix the action and the file flag.
+    hash ^= static_cast<unsigned long long>(event.Action);
+    hash *= prime;
+    hash ^= event.IsFile ? 1ULL : 0ULL;
+    hash *= prime;
+    return hash;
+  }
+
+  /**
+   * \brief check if the given information already exists in the index
+   *        if it does not exist then we will add it to the index.
+   * \param index the index of events we will be looking in
+   * \param duplicate the event we want to add.
+   * \return if the event is already in the 'index'
+   */
+  bool Collector::IsOlderDuplicate(DuplicatesIndex& index, const Event& duplicate)
   {
     MYODDWEB_PROFILE_FUNCTION();
 
-    for( auto it = source.begin(); it != source.end(); ++it )
+    // we cannot compare events without a name
+    // so they are never duplicates.
+    if (duplicate.Name == nullptr)
     {
-      const auto& e = (*it);
+      return false;
+    }
+
+    // the number of slots is a power of 2
+    const auto mask = index.size() - 1;
+    const auto hash = HashEvent(duplicate);
+    for( auto slot = static_cast<size_t>(hash) & mask;; slot = (slot + 1) & mask )
+    {
+      auto& current = index[slot];
+      if (current.Item == nullptr)
+      {
+        // we reached a free slot, so this is not a duplicate
+        // we will use this slot for this event.
+        current.Hash = hash;
+        current.Item = &duplicate;
+        return false;
+      }
+
+      // if the hash is not the same then it cannot be the same event.
+      if (current.Hash != hash)
+      {
+        continue;
+      }
+
+      const auto& e = current.Item;
 
       // they must both be of the same type.
       if (e->IsFile != duplicate.IsFile)
@@ -327,15 +967,12 @@ namespace myoddweb:: directorywatcher
         continue;
       }
 
-      if (e->Name != nullptr && duplicate.Name != nullptr && wcscmp(duplicate.Name, e->Name) == 0 )
+      if (wcscmp(duplicate.Name, e->Name) == 0 )
       {
         // they are the same!
         return true;
       }
     }
-
-    // if we made it here, then it is not an older duplicate
-    return false;
   }
 
   /**
@@ -356,29 +993,557 @@ namespace myoddweb:: directorywatcher
     return static_cast<int>(error);
   }
 
+  /**
+   * \brief the number of times a producer had to retry to add an event
+   *        or could not get the lock to cleanup the events.
+   */
+  long long Collector::ContentionCount() const
+  {
+    auto contention = _lockContention.load(std::memory_order_relaxed);
+    for (const auto& shard : _shards)
+    {
+      contention += shard->Ring.ContentionCount();
+    }
+    return contention;
+  }
+
+  /**
+   * \brief the number of times a producer found the ring full
+   *        and had to move the events to the main container.
+   */
+  long long Collector::FullRingCount() const
+  {
+    return _fullRing.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * \brief the number of events that were removed, or never added
+   *        because we had too many events.
+   */
+  long long Collector::DroppedCount() const
+  {
+    return _droppedEvents.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * \brief the number of shards the producers are using.
+   */
+  size_t Collector::NumberOfShards() const
+  {
+    return _shards.size();
+  }
+
+  /**
+   * \brief the number of half renames that were paired with their other half.
+   */
+  long long Collector::RenamesMatchedCount() const
+  {
+    return _renamesMatched.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * \brief the number of half renames that were never paired.
+   */
+  long long Collector::RenamesTimedOutCount() const
+  {
+    return _renamesTimedOut.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * \brief the total number of ms the half renames were held for before being added.
+   */
+  long long Collector::RenamesLatencyMilliseconds() const
+  {
+    return _renamesLatency.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * \brief the number of bytes reserved by the arenas of all the shards.
+   */
+  size_t Collector::ArenasCapacity() const
+  {
+    size_t capacity = 0;
+    for (const auto& shard : _shards)
+    {
+      for (const auto& arena : shard->Arenas)
+      {
+        capacity += arena.Capacity();
+      }
+    }
+    return capacity;
+  }
+
+  /**
+   * \brief set the signal we notify every time an event is added.
+   *        this must be set before we start adding events.
+   * \param signal the signal, can be null.
+   */
+  void Collector::SetEventsSignal(EventsSignal* signal)
+  {
+    _eventsSignal = signal;
+  }
+
+  /**
+   * \brief if we have a limit on the number of events and/or the number of bytes.
+   */
+  bool Collector::HasLimits() const
+  {
+    return _maxNumberOfEvents > 0 || _maxNumberOfBytes > 0;
+  }
+
+  /**
+   * \brief check if the given values are above a percentage of our limits.
+   * \param numberOfEvents the number of events we are checking.
+   * \param numberOfBytes the number of bytes we are checking.
+   * \param percent the percentage of the limits we are checking against.
+   * \return if either value is above its limit.
+   */
+  bool Collector::IsAboveLimits(const long long numberOfEvents, const long long numberOfBytes, const long long percent) const
+  {
+    if (_maxNumberOfEvents > 0 && numberOfEvents * 100 > _maxNumberOfEvents * percent)
+    {
+      return true;
+    }
+    return _maxNumberOfBytes > 0 && numberOfBytes * 100 > _maxNumberOfBytes * percent;
+  }
+
+  /**
+   * \brief the number of bytes an event uses, including its strings.
+   * \param event the event we are checking.
+   * \return the number of bytes.
+   */
+  long long Collector::EventSize(const EventInformation& event)
+  {
+    return static_cast<long long>(EventInformation::Size(event.NameLength, event.OldNameLength));
+  }
+
+  /**
+   * \brief get the parent folder of a relative path.
+   * \param name the relative path we want the parent folder of.
+   * \return the parent folder or an empty view if it is the root.
+   */
+  std::wstring_view Collector::ParentFolder(const wchar_t* name)
+  {
+    const std::wstring_view path(name);
+    const auto pos = path.find_last_of(L"\\/");
+    if (pos == std::wstring_view::npos)
+    {
+      return {};
+    }
+    return path.substr(0, pos);
+  }
+
+  /**
+   * \brief remove the separators at the start of a relative path.
+   * \param name the path we are trimming.
+   * \return the path without the leading separators.
+   */
+  std::wstring_view Collector::TrimLeadingSeparators(const std::wstring& name)
+  {
+    const auto start = name.find_first_not_of(L"\\/");
+    if (start == std::wstring::npos)
+    {
+      return {};
+    }
+    return std::wstring_view(name).substr(start);
+  }
+
+  /**
+   * \brief create the full path of a relative path.
+   * \param root the root path.
+   * \param relative the path relative to the root.
+   * \param relativeLength the number of characters in the relative path.
+   * \param emptyIsRoot if an empty relative path is the root itself or an empty path.
+   * \param buffer where we will write the null terminated path, if nullptr we only return the length.
+   * \return the number of characters in the full path, not including the null terminator.
+   */
+  size_t Collector::CreateFullPath(const std::wstring& root, const wchar_t* relative, const size_t relativeLength, const bool emptyIsRoot, wchar_t* buffer)
+  {
+    if (relative == nullptr || relativeLength == 0)
+    {
+      const auto length = emptyIsRoot ? root.length() : 0;
+      if (buffer != nullptr)
+      {
+        wmemcpy(buffer, root.c_str(), length);
+        buffer[length] = L'\0';
+      }
+      return length;
+    }
+    return Io::Combine(root, std::wstring_view(relative, relativeLength), buffer);
+  }
+
+  /**
+   * \brief create the event we will publish, with the full paths, in the arena.
+   *        the event and both paths are created in a single allocation.
+   * \param arena where we will be creating the event.
+   * \param root the root path.
+   * \param eventInformation the event we are publishing.
+   * \return the event, owned by the arena.
+   */
+  Event* Collector::CreateFullEvent(Arena& arena, const std::wstring& root, const EventInformation& eventInformation)
+  {
+    const auto emptyIsRoot = !eventInformation.IsFile;
+    const auto nameLength = CreateFullPath(root, eventInformation.Name, eventInformation.NameLength, emptyIsRoot, nullptr);
+    const auto oldNameLength = CreateFullPath(root, eventInformation.OldName, eventInformation.OldNameLength, false, nullptr);
+
+    // the size of the event is a multiple of the arena alignment
+    // so the paths are properly aligned as well.
+    const auto memory = static_cast<char*>(arena.Allocate(sizeof(Event) + (nameLength + 1 + oldNameLength + 1) * sizeof(wchar_t)));
+    const auto name = reinterpret_cast<wchar_t*>(memory + sizeof(Event));
+    const auto oldName = name + nameLength + 1;
+    CreateFullPath(root, eventInformation.Name, eventInformation.NameLength, emptyIsRoot, name);
+    CreateFullPath(root, eventInformation.OldName, eventInformation.OldNameLength, false, oldName);
+
+    return new (memory) Event(
+      name,
+      oldName,
+      ConvertEventAction(eventInformation.Action),
+      ConvertEventError(eventInformation.Error),
+      eventInformation.TimeMillisecondsUtc,
+      eventInformation.IsFile);
+  }
+
+  /**
+   * \brief add an event to the number of events written to the arena in this window.
+   * \param index the index of the arena we are writing to.
+   * \param size the size of the event we are adding.
+   * \return false if the arena is full and the event should be dropped.
+   */
+  bool Collector::ReserveWindow(const int index, const long long size)
+  {
+    const auto numberOfEvents = ++_windowEvents[index];
+    const auto numberOfBytes = (_windowBytes[index] += size);
+    return !IsAboveLimits(numberOfEvents, numberOfBytes, 100LL * MYODDWEB_OVERFLOW_WINDOW_FACTOR);
+  }
+
+  /**
+   * \brief flag that an event was removed, or never added, because we have too many.
+   * \param numberOfEvents the number of events removed.
+   */
+  void Collector::FlagDroppedEvents(const long long numberOfEvents)
+  {
+    if (numberOfEvents <= 0)
+    {
+      return;
+    }
+    _droppedEvents += numberOfEvents;
+    _overflowed = true;
+  }
+
+  /**
+   * \brief remove events, as per our policy, until we are below our limits
+   *        then add the overflow event, the lock must be held by the caller.
+   * \param arena the arena the caller is writing to, used to create new events.
+   */
+  void Collector::ShedEventsInLock(Arena& arena)
+  {
+    MYODDWEB_PROFILE_FUNCTION();
+
+    // move whatever the producers added to the ring.
+    DrainRingInLock();
+
+    // another producer might have done the work while we were waiting for the lock.
+    if (!IsAboveLimits(_numberOfEvents, _numberOfBytes, 100))
+    {
+      return;
+    }
+
+    switch (_overflowPolicy)
+    {
+    case OverflowPolicy::DropTouchedFirst:
+      DropTouchedEventsInLock();
+      break;
+
+    case OverflowPolicy::CollapseToDirectory:
+      CollapseToDirectoriesInLock(arena);
+      break;
+
+    default:
+      break;
+    }
+
+    // whatever the policy, if we still have too many we remove the oldest ones.
+    DropOldestEventsInLock();
+  }
+
+  /**
+   * \brief remove the oldest touched events until we are below our limits.
+   *        the lock must be held by the caller.
+   */
+  void Collector::DropTouchedEventsInLock()
+  {
+    MYODDWEB_PROFILE_FUNCTION();
+
+    const long long numberOfEvents = _numberOfEvents;
+    const long long numberOfBytes = _numberOfBytes;
+    long long droppedEvents = 0;
+    long long droppedBytes = 0;
+
+    // the touched events can be anywhere, so we rebuild the events.
+    EventsInformation events;
+    _currentEvents->CopyTo(events);
+    size_t kept = 0;
+    for (const auto& eventInformation : events)
+    {
+      if (eventInformation->Action == EventAction::Touched &&
+          IsAboveLimits(numberOfEvents - droppedEvents, numberOfBytes - droppedBytes, MYODDWEB_OVERFLOW_LOW_WATERMARK))
+      {
+        ++droppedEvents;
+        droppedBytes += EventSize(*eventInformation);
+        continue;
+      }
+      events[kept++] = eventInformation;
+    }
+    events.resize(kept);
+    _currentEvents->Clear();
+    _currentEvents->Append(events);
+
+    _numberOfEvents -= droppedEvents;
+    _numberOfBytes -= droppedBytes;
+    FlagRemovedEventsInLock(droppedEvents, droppedBytes);
+    FlagDroppedEvents(droppedEvents);
+  }
+
+  /**
+   * \brief replace the events of folders with more than one event with a single touched event.
+   *        the lock must be held by the caller.
+   * \param arena the arena we will be creating the folder events in.
+   */
+  void Collector::CollapseToDirectoriesInLock(Arena& arena)
+  {
+    MYODDWEB_PROFILE_FUNCTION();
+
+    // the number of events in a folder, the names are relative
+    // so we only collapse the events of the same root.
+    struct Folder
+    {
+      unsigned int Root;
+      long long Count;
+    };
+
+    // count the number of events in each folder.
+    // the events of the root itself, or with errors, are never collapsed.
+    EventsInformation events;
+    _currentEvents->CopyTo(events);
+    std::unordered_map<std::wstring_view, Folder> folders;
+    for (const auto& eventInformation : events)
+    {
+      if (*eventInformation->Name == L'\0' || eventInformation->Error != EventError::None)
+      {
+        continue;
+      }
+      const auto folder = ParentFolder(eventInformation->Name);
+      const auto found = folders.try_emplace(folder, Folder{ eventInformation->Root, 0 }).first;
+      if (found->second.Root == eventInformation->Root)
+      {
+        ++found->second.Count;
+      }
+    }
+
+    // go from the newest to the oldest so the folder event
+    // is where the newest event of that folder was.
+    EventsInformation collapsed;
+    collapsed.reserve(events.size());
+    long long removedEvents = 0;
+    long long removedBytes = 0;
+    long long addedEvents = 0;
+    long long addedBytes = 0;
+    for (auto it = events.rbegin(); it != events.rend(); ++it)
+    {
+      const auto& eventInformation = *it;
+      auto found = folders.end();
+      if (*eventInformation->Name != L'\0' && eventInformation->Error == EventError::None)
+      {
+        found = folders.find(ParentFolder(eventInformation->Name));
+      }
+      if (found == folders.end() || found->second.Root != eventInformation->Root || found->second.Count == 1)
+      {
+        // nothing to collapse this event with.
+        collapsed.push_back(eventInformation);
+        continue;
+      }
+
+      ++removedEvents;
+      removedBytes += EventSize(*eventInformation);
+
+      // we already added the folder event
+      if (found->second.Count < 0)
+      {
+        continue;
+      }
+      found->second.Count = -1;
+
+      // an empty folder name is the root itself.
+      const auto& folder = found->first;
+      const auto folderEvent = EventInformation::Create(
+        arena,
+        eventInformation->TimeMillisecondsUtc,
+        EventAction::Touched,
+        EventError::None,
+        eventInformation->Root,
+        folder,
+        {},
+        false);
+      ++addedEvents;
+      addedBytes += EventSize(*folderEvent);
+      collapsed.push_back(folderEvent);
+    }
+
+    // put them back from the oldest to the newest.
+    std::reverse(collapsed.begin(), collapsed.end());
+    _currentEvents->Clear();
+    _currentEvents->Append(collapsed);
+
+    _numberOfEvents += addedEvents - removedEvents;
+    _numberOfBytes += addedBytes - removedBytes;
+    FlagRemovedEventsInLock(removedEvents, removedBytes);
+    FlagDroppedEvents(removedEvents - addedEvents);
+  }
+
+  /**
+   * \brief remove the oldest events until we are below our limits.
+   *        the lock must be held by the caller.
+   */
+  void Collector::DropOldestEventsInLock()
+  {
+    MYODDWEB_PROFILE_FUNCTION();
+
+    const long long numberOfEvents = _numberOfEvents;
+    const long long numberOfBytes = _numberOfBytes;
+    long long droppedEvents = 0;
+    long long droppedBytes = 0;
+
+    const auto size = _currentEvents->Size();
+    size_t count = 0;
+    while (count < size && IsAboveLimits(numberOfEvents - droppedEvents, numberOfBytes - droppedBytes, MYODDWEB_OVERFLOW_LOW_WATERMARK))
+    {
+      ++droppedEvents;
+      droppedBytes += EventSize(*(*_currentEvents)[count]);
+      ++count;
+    }
+
+    // the memory itself is owned by the arena.
+    _currentEvents->PopFront(count);
+
+    _numberOfEvents -= droppedEvents;
+    _numberOfBytes -= droppedBytes;
+    FlagRemovedEventsInLock(droppedEvents, droppedBytes);
+    FlagDroppedEvents(droppedEvents);
+  }
+
+  /**
+   * \brief move all the events in the ring to the current events.
+   *        the lock must be held by the caller.
+   */
+  void Collector::DrainRingInLock()
+  {
+    // with a single shard the events are already in order.
+    if (_shards.size() == 1)
+    {
+      auto& drained = _shards[0]->Drained;
+      _shards[0]->Ring.Drain(drained);
+      _currentEvents->Append(drained);
+      drained.clear();
+      return;
+    }
+
+    for (const auto& shard : _shards)
+    {
+      shard->Ring.Drain(shard->Drained);
+    }
+    MergeShardsInLock();
+  }
+
+  /**
+   * \brief merge the events drained from each shard, by time, into the current events.
+   *        the events of each shard are already in order so we only need to look
+   *        at the first event of each shard, (k-way merge).
+   *        the lock must be held by the caller.
+   */
+  void Collector::MergeShardsInLock()
+  {
+    MYODDWEB_PROFILE_FUNCTION();
+
+    // the position we are at in each shard.
+    struct Cursor
+    {
+      const EventsInformation* Events;
+      size_t Position;
+      size_t Shard;
+    };
+
+    // the cursor with the oldest event is at the top of the heap
+    // if two events have the same time, the one from the first shard is used first.
+    const auto newer = [](const Cursor& lhs, const Cursor& rhs)
+    {
+      const auto l = (*lhs.Events)[lhs.Position]->TimeMillisecondsUtc;
+      const auto r = (*rhs.Events)[rhs.Position]->TimeMillisecondsUtc;
+      return l != r ? l > r : lhs.Shard > rhs.Shard;
+    };
+
+    std::vector<Cursor> cursors;
+    cursors.reserve(_shards.size());
+    size_t total = 0;
+    for (size_t i = 0; i < _shards.size(); ++i)
+    {
+      const auto& drained = _shards[i]->Drained;
+      if (!drained.empty())
+      {
+        cursors.push_back(Cursor{ &drained, 0, i });
+        total += drained.size();
+      }
+    }
+
+    std::make_heap(cursors.begin(), cursors.end(), newer);
+    while (!cursors.empty())
+    {
+      std::pop_heap(cursors.begin(), cursors.end(), newer);
+      auto& cursor = cursors.back();
+      _currentEvents->PushBack((*cursor.Events)[cursor.Position]);
+      if (++cursor.Position < cursor.Events->size())
+      {
+        std::push_heap(cursors.begin(), cursors.end(), newer);
+      }
+      else
+      {
+        cursors.pop_back();
+      }
+    }
+
+    for (const auto& shard : _shards)
+    {
+      shard->Drained.clear();
+    }
+  }
+
   /**
    * \brief add an event to the array
    * At regular intervals we will be removing old data.
+   * \param shard the shard of the current thread.
    * \param event the event we are adding to the vector.
    */
-  void Collector::AddEventInformation(const EventInformation* event)
+  void Collector::AddEventInformation(Shard& shard, const EventInformation* event)
   {
     MYODDWEB_PROFILE_FUNCTION();
 
-    // we can now get the lock so we can add data.
-    // the lock is released automatically.
-    MYODDWEB_LOCK(_lock);
+    // try and add it to the ring, this does not block.
+    if( !shard.Ring.Push(event) )
+    {
+      // the ring is full, so we have no choice but to get the lock
+      // and move everything to the main container.
+      ++_fullRing;
 
-    // add it.
-    _currentEvents->emplace_back(event);
+      // the lock is released automatically.
+      MYODDWEB_LOCK(_lock);
+      DrainRingInLock();
+      _currentEvents->PushBack(event);
+    }
 
     // update the internal counter.
-    if(_nextCleanupTimeCheck == 0 )
-    {
-      // when we want to check for the next cleanup
-      // if the time is zero then we will use the event time + the max time.
-      _nextCleanupTimeCheck = event->TimeMillisecondsUtc + (_maxCleanupAgeMilliseconds + MYODDWEB_MAX_EVENT_AGE_BUFFER);
-    }
+    // when we want to check for the next cleanup
+    // if the time is zero then we will use the event time + the max time.
+    auto expected = 0LL;
+    _nextCleanupTimeCheck.compare_exchange_strong(expected, event->TimeMillisecondsUtc + (_maxCleanupAgeMilliseconds + MYODDWEB_MAX_EVENT_AGE_BUFFER));
   }
 
   /**
@@ -402,50 +1567,51 @@ namespace myoddweb:: directorywatcher
       return;
     }
 
+    // we do not want producers to wait for the lock
+    // if someone else has it, the next event will try again.
+    std::unique_lock<MYODDWEB_MUTEX> lock(_lock, std::try_to_lock);
+    if( !lock.owns_lock() )
+    {
+      ++_lockContention;
+      return;
+    }
+
     // reset the counter so we can check again later.
     _nextCleanupTimeCheck = 0;
 
-    // lock and check again if we need to do the work.
-    // and if not, get out straight away.
-    MYODDWEB_LOCK(_lock);
+    // move whatever the producers added to the ring.
+    DrainRingInLock();
 
-    // get the current time.
+    // the events are ordered from older to newer
+    // so we only need to find where the newer events start.
     const auto old = now - (_maxCleanupAgeMilliseconds + MYODDWEB_MAX_EVENT_AGE_BUFFER);
-    auto begin = _currentEvents->end();
-    auto end = _currentEvents->end();
-    for( auto it = _currentEvents->begin();; ++it )
-    {
-      // get the first iterator.
-      if (it == _currentEvents->end())
-      {
-        // we reached the end of the list
-        end = it;
-        break;
-      }
+    const auto count = _currentEvents->CountNotNewerThan(old);
 
-      // is this item newer than our oler time.
-      if ((*it)->TimeMillisecondsUtc > old)
+    // do we hae anything to remove?
+    // the memory itself is owned by the arena.
+    if (count > 0)
+    {
+      long long numberOfBytes = 0;
+      for (size_t i = 0; i < count; ++i)
       {
-        // because everything is ordered from 
-        // older to newer, there is no point in going any further.
-        break;
+        numberOfBytes += EventSize(*(*_currentEvents)[i]);
       }
 
-      // have we already set the begining?
-      if ( begin == _currentEvents->end() )
+      // those events are no longer counted against our limits.
+      if (HasLimits())
       {
-        begin = it;
+        _numberOfEvents -= static_cast<long long>(count);
+        _numberOfBytes -= numberOfBytes;
       }
+      FlagRemovedEventsInLock(static_cast<long long>(count), numberOfBytes);
+      _currentEvents->PopFront(count);
     }
 
-    // do we hae anything to delete?
-    if (begin != _currentEvents->end())
+    // if we still have events, we will need to check them again.
+    if( !_currentEvents->Empty() )
     {
-      for (auto it = begin; it != end; ++it)
-      {
-        delete* it;
-      }
-      _currentEvents->erase(begin, end);
+      auto expected = 0LL;
+      _nextCleanupTimeCheck.compare_exchange_strong(expected, _currentEvents->Front()->TimeMillisecondsUtc + (_maxCleanupAgeMilliseconds + MYODDWEB_MAX_EVENT_AGE_BUFFER));
     }
   }
 }
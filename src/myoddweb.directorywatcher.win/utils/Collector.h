@@ -3,14 +3,22 @@
 // See the LICENSE file in the project root for more information.
 #pragma once
 #include <atomic>
+#include <deque>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <mutex>
 
 #include "../monitors/Base.h"
+#include "Arena.h"
 #include "EventAction.h"
 #include "EventInformation.h"
+#include "EventsDeque.h"
+#include "EventsRing.h"
+#include "EventsSignal.h"
 #include "Event.h"
+#include "OverflowPolicy.h"
+#include "RootPaths.h"
 
 namespace myoddweb
 {
@@ -23,8 +31,14 @@ namespace myoddweb
     {
     public:
       explicit Collector(long long maxCleanupAgeMilliseconds);
+      Collector(long long maxCleanupAgeMilliseconds, const std::wstring& path, long long maxNumberOfEvents, long long maxNumberOfBytes, OverflowPolicy overflowPolicy, int numberOfShards, long long renamePairingMilliseconds);
       ~Collector();
 
+      Collector(const Collector&) = delete;
+      Collector(Collector&&) = delete;
+      const Collector& operator=(const Collector&) = delete;
+      Collector& operator=(Collector&&) = delete;
+
       /**
        * \brief sort events by TimeMillisecondsUtc
        * \param lhs the lhs element we are checking.
@@ -33,17 +47,91 @@ namespace myoddweb
        */
       static bool SortByTimeMillisecondsUtc(const Event* lhs, const Event* rhs);
 
-      void Add(EventAction action, const std::wstring& path, const std::wstring& filename, bool isFile, EventError error);
-      void AddRename(const std::wstring& path, const std::wstring&newFilename, const std::wstring&oldFilename, bool isFile, EventError error);
+      /**
+       * \brief merge lists of events, each one in time order, into a single list in time order.
+       *        a list that is not in order, (the clock moved back), is sorted first.
+       * \param sources the lists of events we are merging.
+       * \param numberOfSources the number of lists we are merging, from the start of sources.
+       * \param events where we are adding the merged events.
+       */
+      static void MergeByTimeMillisecondsUtc(std::vector<std::vector<Event*>>& sources, size_t numberOfSources, std::vector<Event*>& events);
+
+      void Add(EventAction action, const wchar_t* path, const std::wstring& filename, bool isFile, EventError error);
+      void AddRename(const wchar_t* path, const std::wstring&newFilename, const std::wstring&oldFilename, bool isFile, EventError error);
 
       /**
        * \brief fill the vector with all the values currently on record.
+       *        the events are owned by the collector and are valid until the next call to GetEvents
+       *        the caller must not delete them.
+       *        our events that are the same as one already in the vector are not added.
        * \param events the events we will be filling
        */
       void GetEvents( std::vector<Event*>& events);
 
+      /**
+       * \brief the number of times a producer had to retry to add an event
+       *        or could not get the lock to cleanup the events.
+       */
+      long long ContentionCount() const;
+
+      /**
+       * \brief the number of times a producer found the ring full
+       *        and had to move the events to the main container.
+       */
+      long long FullRingCount() const;
+
+      /**
+       * \brief Get the time now in milliseconds since 1970
+       * \return the current ms time
+       */
+      static long long GetMillisecondsNowUtc();
+
+      /**
+       * \brief the number of events that were removed, or never added
+       *        because we had too many events.
+       */
+      long long DroppedCount() const;
+
+      /**
+       * \brief the number of shards the producers are using.
+       */
+      size_t NumberOfShards() const;
+
+      /**
+       * \brief the number of half renames that were paired with their other half.
+       */
+      long long RenamesMatchedCount() const;
+
+      /**
+       * \brief the number of half renames that were never paired.
+       */
+      long long RenamesTimedOutCount() const;
+
+      /**
+       * \brief the total number of ms the half renames were held for before being added.
+       */
+      long long RenamesLatencyMilliseconds() const;
+
+      /**
+       * \brief the number of ms before the oldest half rename stops waiting for its other half.
+       * \return the ms left, 0 if it already expired or -1 if no half renames are pending.
+       */
+      long long PendingRenamesMilliseconds();
+
+      /**
+       * \brief the number of bytes reserved by the arenas of all the shards.
+       */
+      size_t ArenasCapacity() const;
+
+      /**
+       * \brief set the signal we notify every time an event is added.
+       *        this must be set before we start adding events.
+       * \param signal the signal, can be null.
+       */
+      void SetEventsSignal(EventsSignal* signal);
+
     private:
-      void Add(EventAction action, const std::wstring& path, const std::wstring& filename, const std::wstring& oldFileName, bool isFile, EventError error);
+      void Add(EventAction action, const wchar_t* path, const std::wstring& filename, const std::wstring& oldFileName, bool isFile, EventError error);
 
       /**
        * \brief This is the oldest number of ms we want something to be.
@@ -51,6 +139,230 @@ namespace myoddweb
        */
       const long long _maxCleanupAgeMilliseconds;
 
+      /**
+       * \brief the path we are collecting events for, used for the overflow event.
+       */
+      const std::wstring _path;
+
+      /**
+       * \brief the root paths of our events, the events only keep the path relative to their root.
+       */
+      RootPaths _roots;
+
+      /**
+       * \brief how long we keep half of a rename waiting for the other half, 0 if we do not pair them.
+       */
+      const long long _renamePairingMilliseconds;
+
+      /**
+       * \brief half of a rename waiting for the other half.
+       *        the names are owned by the rename as it can outlive the arenas.
+       */
+      struct PendingRename
+      {
+        long long TimeMillisecondsUtc;
+        std::wstring Path;
+        std::wstring NewName;
+        std::wstring OldName;
+        bool IsFile;
+      };
+
+      /**
+       * \brief the half renames in the order they were added.
+       */
+      std::deque<PendingRename> _pendingRenames;
+
+      /**
+       * \brief the lock for the pending renames.
+       */
+      MYODDWEB_MUTEX _renamesLock;
+
+      /**
+       * \brief the number of half renames that were paired.
+       */
+      std::atomic<long long> _renamesMatched;
+
+      /**
+       * \brief the number of half renames that were never paired.
+       */
+      std::atomic<long long> _renamesTimedOut;
+
+      /**
+       * \brief the total number of ms the half renames were held for.
+       */
+      std::atomic<long long> _renamesLatency;
+
+      /**
+       * \brief the signal we notify when an event is added, if any.
+       */
+      EventsSignal* _eventsSignal;
+
+      /**
+       * \brief try and pair half of a rename with a pending half.
+       *        if we cannot, the half is kept until the other half arrives or it times out.
+       * \param path the root path.
+       * \param newFilename the new name, empty if this is the old half.
+       * \param oldFilename the old name, empty if this is the new half.
+       * \param isFile if this is a file or a folder.
+       */
+      void PairRename(const wchar_t* path, const std::wstring& newFilename, const std::wstring& oldFilename, bool isFile);
+
+      /**
+       * \brief move the half renames that waited too long to the collection
+       *        they will be turned into added/removed events when published.
+       * \param now the current time.
+       */
+      void AddExpiredRenames(long long now);
+
+      /**
+       * \brief take the half renames that waited too long out of the pending renames.
+       *        the renames lock must be held by the caller.
+       * \param now the current time.
+       * \param expired where we will add the expired renames.
+       */
+      void TakeExpiredRenamesInLock(long long now, std::vector<PendingRename>& expired);
+
+      /**
+       * \brief remove the separators at the start of a relative path.
+       * \param name the path we are trimming.
+       * \return the path without the leading separators.
+       */
+      static std::wstring_view TrimLeadingSeparators(const std::wstring& name);
+
+      /**
+       * \brief create the full path of a relative path.
+       * \param root the root path.
+       * \param relative the path relative to the root.
+       * \param relativeLength the number of characters in the relative path.
+       * \param emptyIsRoot if an empty relative path is the root itself or an empty path.
+       * \param buffer where we will write the null terminated path, if nullptr we only return the length.
+       * \return the number of characters in the full path, not including the null terminator.
+       */
+      static size_t CreateFullPath(const std::wstring& root, const wchar_t* relative, size_t relativeLength, bool emptyIsRoot, wchar_t* buffer);
+
+      /**
+       * \brief create the event we will publish, with the full paths, in the arena.
+       *        the event and both paths are created in a single allocation.
+       * \param arena where we will be creating the event.
+       * \param root the root path.
+       * \param eventInformation the event we are publishing.
+       * \return the event, owned by the arena.
+       */
+      static Event* CreateFullEvent(Arena& arena, const std::wstring& root, const EventInformation& eventInformation);
+
+      /**
+       * \brief the maximum number of events we want to hold, 0 for no limit.
+       */
+      const long long _maxNumberOfEvents;
+
+      /**
+       * \brief the maximum number of bytes our events can use, 0 for no limit.
+       */
+      const long long _maxNumberOfBytes;
+
+      /**
+       * \brief what we do when we have too many events.
+       */
+      const OverflowPolicy _overflowPolicy;
+
+      /**
+       * \brief the number of events we are currently holding, only used if we have limits.
+       */
+      std::atomic<long long> _numberOfEvents;
+
+      /**
+       * \brief the number of bytes our events are currently using, only used if we have limits.
+       */
+      std::atomic<long long> _numberOfBytes;
+
+      /**
+       * \brief the number of events that were added to each arena since it was last reset.
+       */
+      std::atomic<long long> _windowEvents[3];
+
+      /**
+       * \brief the number of bytes that were added to each arena since it was last reset.
+       */
+      std::atomic<long long> _windowBytes[3];
+
+      /**
+       * \brief if we dropped events since the last time we published them.
+       */
+      std::atomic<bool> _overflowed;
+
+      /**
+       * \brief the total number of events we dropped.
+       */
+      std::atomic<long long> _droppedEvents;
+
+      /**
+       * \brief if we have a limit on the number of events and/or the number of bytes.
+       */
+      bool HasLimits() const;
+
+      /**
+       * \brief check if the given values are above a percentage of our limits.
+       * \param numberOfEvents the number of events we are checking.
+       * \param numberOfBytes the number of bytes we are checking.
+       * \param percent the percentage of the limits we are checking against.
+       * \return if either value is above its limit.
+       */
+      bool IsAboveLimits(long long numberOfEvents, long long numberOfBytes, long long percent) const;
+
+      /**
+       * \brief the number of bytes an event uses, including its strings.
+       * \param event the event we are checking.
+       * \return the number of bytes.
+       */
+      static long long EventSize(const EventInformation& event);
+
+      /**
+       * \brief get the parent folder of a relative path.
+       * \param name the relative path we want the parent folder of.
+       * \return the parent folder or an empty view if it is the root.
+       */
+      static std::wstring_view ParentFolder(const wchar_t* name);
+
+      /**
+       * \brief add an event to the number of events written to the arena in this window.
+       * \param index the index of the arena we are writing to.
+       * \param size the size of the event we are adding.
+       * \return false if the arena is full and the event should be dropped.
+       */
+      bool ReserveWindow(int index, long long size);
+
+      /**
+       * \brief remove events, as per our policy, until we are below our limits
+       *        then add the overflow event, the lock must be held by the caller.
+       * \param arena the arena the caller is writing to, used to create new events.
+       */
+      void ShedEventsInLock(Arena& arena);
+
+      /**
+       * \brief remove the oldest touched events until we are below our limits.
+       *        the lock must be held by the caller.
+       */
+      void DropTouchedEventsInLock();
+
+      /**
+       * \brief replace the events of folders with more than one event with a single touched event.
+       *        the lock must be held by the caller.
+       * \param arena the arena we will be creating the folder events in.
+       */
+      void CollapseToDirectoriesInLock(Arena& arena);
+
+      /**
+       * \brief remove the oldest events until we are below our limits.
+       *        the lock must be held by the caller.
+       */
+      void DropOldestEventsInLock();
+
+      /**
+       * \brief flag that an event was removed, or never added, because we have too many.
+       * \param numberOfEvents the number of events removed.
+       */
+      void FlagDroppedEvents(long long numberOfEvents);
+
       /**
        * \brief The next time we want to check for cleanup
        *        We will be using an atomic variable to make sure that it is thread safe.
@@ -63,37 +375,199 @@ namespace myoddweb
       void CleanupEvents();
 
       /**
-       * \brief Add an event to the vector and remove older events.
-       * \param event
+       * \brief the events list
+       */
+      typedef std::vector<const EventInformation*> EventsInformation;
+
+      /**
+       * \brief where a group of producer threads add their events, each shard has its own
+       *        ring and arenas so producers of different shards never share anything.
+       */
+      struct Shard
+      {
+        explicit Shard(size_t capacity);
+
+        /**
+         * \brief where the producers add their events without any lock.
+         */
+        EventsRing Ring;
+
+        /**
+         * \brief the three arenas where the events and their paths are stored.
+         *        producers write to the active one, the caller is still using the events of the published one
+         *        and the spare one is where we move the events we still hold when we compact the active one.
+         */
+        Arena Arenas[3];
+
+        /**
+         * \brief the number of producers currently writing to each arena.
+         */
+        std::atomic<long long> Writers[3];
+
+        /**
+         * \brief the events we took from the ring before they are merged with the other shards.
+         *        only used by whoever holds the lock.
+         */
+        EventsInformation Drained;
+      };
+
+      /**
+       * \brief all the shards, there is always at least one
+       *        and the number never changes once the collector is created.
+       */
+      std::vector<Shard*> _shards;
+
+      /**
+       * \brief get the shard the current thread adds its events to.
+       */
+      Shard& ShardForThisThread();
+
+      /**
+       * \brief the hash of the id of the current thread.
+       */
+      static unsigned long long HashThisThread();
+
+      /**
+       * \brief Add an event to the ring, or to the vector if the ring is full.
+       * \param shard the shard of the current thread.
+       * \param event the event we are adding.
        */
-      void AddEventInformation(const EventInformation* event);
+      void AddEventInformation(Shard& shard, const EventInformation* event);
 
       /**
-       * \brief the locks so we can add data.
+       * \brief move all the events in the rings to the current events
+       *        the events of the shards are merged by time.
+       *        the lock must be held by the caller.
+       */
+      void DrainRingInLock();
+
+      /**
+       * \brief merge the events drained from each shard, by time, into the current events.
+       *        the lock must be held by the caller.
+       */
+      void MergeShardsInLock();
+
+      /**
+       * \brief the lock owned by whoever is moving data out of the ring.
        */
       MYODDWEB_MUTEX _lock;
 
       /**
-       * \brief the events list
+       * \brief the arena the producers are currently writing to.
        */
-      typedef std::vector<const EventInformation*> EventsInformation;
+      std::atomic<int> _activeArena;
 
       /**
-       * \brief this is the event that we are _currently adding data to.
+       * \brief the arena holding the events we published last time, they are valid until we publish again.
+       *        only changed while we hold the arenas lock.
        */
-      EventsInformation* _currentEvents;
+      int _publishedArena;
 
       /**
-       * \brief clear all the events information and delete all the data.
-       * \param events the data we want to clear.
+       * \brief the lock owned by whoever is swapping or compacting the arenas.
        */
-      static void ClearEvents(EventsInformation* events);
+      MYODDWEB_MUTEX _arenasLock;
 
       /**
-       * \brief Get the time now in milliseconds since 1970
-       * \return the current ms time
+       * \brief if the arenas are being swapped or compacted, the producers wait until it is done.
        */
-      static long long GetMillisecondsNowUtc();
+      std::atomic<bool> _arenasBusy;
+
+      /**
+       * \brief the minimum number of removed events before we compact the active arena.
+       */
+      const long long _compactEvents;
+
+      /**
+       * \brief the minimum number of removed bytes before we compact the active arena.
+       */
+      const long long _compactBytes;
+
+      /**
+       * \brief the number of events removed from the active arena since it was last reset or compacted.
+       */
+      std::atomic<long long> _removedEvents;
+
+      /**
+       * \brief the number of bytes removed from the active arena since it was last reset or compacted.
+       */
+      std::atomic<long long> _removedBytes;
+
+      /**
+       * \brief get the arena producers can write to and flag that we are using it.
+       * \param shard the shard of the current thread.
+       * \return the index of the arena we are using.
+       */
+      int AcquireArena(Shard& shard);
+
+      /**
+       * \brief flag that we are no longer writing to the arena.
+       * \param shard the shard of the current thread.
+       * \param index the index of the arena we are done with.
+       */
+      static void ReleaseArena(Shard& shard, int index);
+
+      /**
+       * \brief stop the producers from using the arenas and wait for the ones still writing to the active one.
+       *        the arenas lock must be held by the caller.
+       * \return the index of the active arena.
+       */
+      int PauseProducersInLock();
+
+      /**
+       * \brief make an arena the active one and let the producers use it.
+       *        the arenas lock must be held by the caller.
+       * \param index the arena the producers will be writing to.
+       */
+      void ResumeProducersInLock(int index);
+
+      /**
+       * \brief reset an arena of every shard.
+       *        nobody can be using the events in those arenas.
+       * \param index the arena we are resetting.
+       */
+      void ResetArenas(int index);
+
+      /**
+       * \brief flag that events were removed from the active arena, (too old or over our limits).
+       *        the lock must be held by the caller.
+       * \param numberOfEvents the number of events removed.
+       * \param numberOfBytes the number of bytes removed.
+       */
+      void FlagRemovedEventsInLock(long long numberOfEvents, long long numberOfBytes);
+
+      /**
+       * \brief if most of the memory of the active arena is used by events we removed.
+       */
+      bool MustCompactArenas() const;
+
+      /**
+       * \brief the events we removed, (too old or over our limits), still use memory in the active arena
+       *        so once they use most of it, we move the events we still hold to the spare arena and reset it.
+       *        this does not wait if someone else is already using the arenas.
+       */
+      void CompactArenasIfNeeded();
+
+      /**
+       * \brief the number of time a producer could not get the lock to cleanup.
+       */
+      std::atomic<long long> _lockContention;
+
+      /**
+       * \brief the number of time a producer found the ring full.
+       */
+      std::atomic<long long> _fullRing;
+
+      /**
+       * \brief this is the event that we are _currently adding data to.
+       */
+      EventsDeque* _currentEvents;
+
+      /**
+       * \brief the container we will be swapping with the current events
+       *        so we do not have to create a new one every time.
+       */
+      EventsDeque* _spareEvents;
 
       /**
        * \brief convert an EventAction to an un-managed IAction
@@ -108,12 +582,47 @@ namespace myoddweb
       static int ConvertEventError(const EventError& error);
 
       /**
-       * \brief check if the given information already exists in the source
-       * \param source the collection of events we will be looking in
-       * \param duplicate the event information we want to add.
-       * \return if the event information is already in the 'source'
+       * \brief a single slot in the index we use to look for duplicates.
+       */
+      struct DuplicateSlot
+      {
+        /**
+         * \brief the hash of the (action, isFile, name) of the event.
+         */
+        unsigned long long Hash;
+
+        /**
+         * \brief the event in that slot, nullptr if the slot is free.
+         */
+        const Event* Item;
+      };
+
+      /**
+       * \brief the open addressing index used to look for duplicates
+       *        the number of slots is always a power of 2.
+       */
+      typedef std::vector<DuplicateSlot> DuplicatesIndex;
+
+      /**
+       * \brief calculate the hash of the (action, isFile, name) of an event.
+       * \param event the event we are calculating the hash for.
+       * \return the hash value
+       */
+      static unsigned long long HashEvent(const Event& event);
+
+      /**
+       * \brief check if the given information already exists in the index
+       *        if it does not exist then we will add it to the index.
+       * \param index the index of events we will be looking in
+       * \param duplicate the event we want to add.
+       * \return if the event is already in the 'index'
+       */
+      static bool IsOlderDuplicate(DuplicatesIndex& index, const Event& duplicate);
+
+      /**
+       * \brief the index we use to look for duplicates, re-used for every call.
        */
-      static bool IsOlderDuplicate(const std::vector<Event*>& source, const Event& duplicate);
+      DuplicatesIndex _duplicates;
 
       /**
        * \brief go around all the renamed events and look the the ones that are 'invalid'
@@ -127,7 +636,7 @@ namespace myoddweb
        * Then erase the current content so we can continue receiving data.
        * \return the number of items.
        */
-      EventsInformation* CloneEventsAndEraseCurrent();
+      EventsDeque* CloneEventsAndEraseCurrent();
     };
   }
 }
\ No newline at end of file
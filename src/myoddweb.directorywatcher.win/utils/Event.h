@@ -9,6 +9,9 @@ namespace myoddweb
   {
     /**
      * \brief unmanaged implementation of IEvent
+     *        the strings are not owned by the event, they belong to the arena of the collector
+     *        and remain valid until the next time the events are collected.
+     *        The collector packs both names right after the event, in the same allocation.
      */
     class Event final
     {
@@ -25,15 +28,16 @@ namespace myoddweb
       }
 
       Event(const wchar_t* name, const wchar_t* oldName, const int action, const int error, const long long timeMillisecondsUtc, const bool isFile) :
-        Event()
+        Name(name),
+        OldName(oldName),
+        Action(action),
+        Error(error),
+        TimeMillisecondsUtc(timeMillisecondsUtc),
+        IsFile(isFile)
       {
-        Assign(name, oldName, action, error, timeMillisecondsUtc, isFile);
       }
 
-      ~Event()
-      {
-        Clear();
-      }
+      ~Event() = default;
 
       // prevent copy and move
       Event(const Event& src) = delete;
@@ -41,98 +45,22 @@ namespace myoddweb
       const Event& operator=(const Event& src) = delete;
       const Event& operator=(Event&& src) = delete;
 
-    private:
-      void Assign(const wchar_t* name, const wchar_t* oldName, const int action, const int error, const long long timeMillisecondsUtc, const bool isFile)
-      {
-        // clear the old values.
-        Clear();
-
-        // and set the values.
-        Action = action;
-        Error = error;
-        TimeMillisecondsUtc = timeMillisecondsUtc;
-        IsFile = isFile;
-
-        if (name != nullptr)
-        {
-          const auto len = wcslen(name);
-          Name = new wchar_t[len + 1];
-          wmemset(Name, L'\0', len + 1);
-          wcscpy_s(Name, len + 1, name);
-        }
-
-        if (oldName != nullptr)
-        {
-          const auto len = wcslen(oldName);
-          OldName = new wchar_t[len + 1];
-          wmemset(OldName, L'\0', len + 1);
-          wcscpy_s(OldName, len + 1, oldName);
-        }
-      }
-
-      /**
-       * \brief free all the memory
-       */
-      void Clear()
-      {
-        ClearName();
-        ClearOldName();
-      }
-
-      /**
-       * \brief free the name memory
-       */
-      void ClearName()
-      {
-        if (Name == nullptr)
-        {
-          return;
-        }
-        delete[] Name;
-        Name = nullptr;
-      }
-
-      /**
-       * \brief free the old name memory
-       */
-      void ClearOldName()
-      {
-        if (OldName == nullptr)
-        {
-          return;
-        }
-        delete[] OldName;
-        OldName = nullptr;
-      }
-
-    public:
       void MoveOldNameToName()
       {
-        // get rid of the current name
-        ClearName();
-
-        // copy one over the other
-        if (OldName != nullptr)
-        {
-          const auto len = wcslen(OldName);
-          Name = new wchar_t[len + 1];
-          wmemset(Name, L'\0', len + 1);
-          wcscpy_s(Name, len + 1, OldName);
-        }
-
-        // we can get rid of the old name
-        ClearOldName();
+        // the old name becomes the name
+        Name = OldName;
+        OldName = nullptr;
       }
 
       /**
        * \brief The path that was changed.
        */
-      wchar_t* Name;
+      const wchar_t* Name;
 
       /**
        * \brief Extra information, (used for rename and so on).
        */
-      wchar_t* OldName;
+      const wchar_t* OldName;
 
       /**
        * \brief the action.
@@ -2,6 +2,10 @@
 // Florent Guelfucci licenses this file to you under the MIT license.
 // See the LICENSE file in the project root for more information.
 #pragma once
+#include <cwchar>
+#include <new>
+#include <string_view>
+#include "Arena.h"
 #include "EventAction.h"
 #include "EventError.h"
 
@@ -11,6 +15,9 @@ namespace myoddweb
   {
     /**
      * \brief Information about a file/folder event.
+     *        the strings are not owned by the event, they belong to the arena of the collector.
+     *        the names are relative to the root path, the full path is only created when the event is published.
+     *        When created with Create(...) the names are packed right after the event, in the same allocation.
      */
     class EventInformation final
     {
@@ -19,8 +26,11 @@ namespace myoddweb
         TimeMillisecondsUtc(0),
         Action(EventAction::Unknown),
         Error(EventError::None ),
+        Root( 0 ),
         Name( nullptr ),
         OldName( nullptr ),
+        NameLength( 0 ),
+        OldNameLength( 0 ),
         IsFile( false )
       {
       }
@@ -29,18 +39,78 @@ namespace myoddweb
         const long long timeMillisecondsUtc,
         const EventAction action,
         const EventError error,
+        const unsigned int root,
         const wchar_t* name,
         const wchar_t* oldName,
         const bool isFile
       )
-      : EventInformation()
+      :
+        TimeMillisecondsUtc(timeMillisecondsUtc),
+        Action(action),
+        Error(error),
+        Root(root),
+        Name(name),
+        OldName(oldName),
+        NameLength(name == nullptr ? 0 : static_cast<unsigned int>(wcslen(name))),
+        OldNameLength(oldName == nullptr ? 0 : static_cast<unsigned int>(wcslen(oldName))),
+        IsFile(isFile)
       {
-        Assign(name, oldName, action, error, timeMillisecondsUtc, isFile);
       }
 
-      ~EventInformation()
+      ~EventInformation() = default;
+
+      /**
+       * \brief create an event information in the arena with both names packed right after it.
+       *        there is only one allocation per event and the names are next to the event in memory.
+       * \param arena where we will be creating the event.
+       * \param timeMillisecondsUtc the time in Ms when this event was recorded.
+       * \param action the action we are recording
+       * \param error the error we are recording
+       * \param root the id of the root path the names are relative to.
+       * \param name the filename/folder that was updated, relative to the root path.
+       * \param oldName the old name in the case of a rename, relative to the root path.
+       * \param isFile if the update is a file or a directory.
+       * \return the event, owned by the arena.
+       */
+      static EventInformation* Create(
+        Arena& arena,
+        const long long timeMillisecondsUtc,
+        const EventAction action,
+        const EventError error,
+        const unsigned int root,
+        const std::wstring_view name,
+        const std::wstring_view oldName,
+        const bool isFile
+      )
       {
-        Clear();
+        // the size of the event is a multiple of the arena alignment
+        // so the names are properly aligned as well.
+        const auto memory = static_cast<char*>(arena.Allocate(Size(name.length(), oldName.length())));
+        const auto packedName = reinterpret_cast<wchar_t*>(memory + sizeof(EventInformation));
+        wmemcpy(packedName, name.data(), name.length());
+        packedName[name.length()] = L'\0';
+
+        const auto packedOldName = packedName + name.length() + 1;
+        wmemcpy(packedOldName, oldName.data(), oldName.length());
+        packedOldName[oldName.length()] = L'\0';
+
+        const auto event = new (memory) EventInformation(timeMillisecondsUtc, action, error, root, nullptr, nullptr, isFile);
+        event->Name = packedName;
+        event->OldName = packedOldName;
+        event->NameLength = static_cast<unsigned int>(name.length());
+        event->OldNameLength = static_cast<unsigned int>(oldName.length());
+        return event;
+      }
+
+      /**
+       * \brief the number of bytes used by a packed event with the given names.
+       * \param nameLength the number of characters in the name.
+       * \param oldNameLength the number of characters in the old name.
+       * \return the number of bytes.
+       */
+      static size_t Size(const size_t nameLength, const size_t oldNameLength)
+      {
+        return sizeof(EventInformation) + (nameLength + 1 + oldNameLength + 1) * sizeof(wchar_t);
       }
 
       EventInformation(const EventInformation&) = delete;
@@ -62,80 +132,34 @@ namespace myoddweb
       EventError Error;
 
       /**
-       * \brief the filename/folder that was updated.
+       * \brief the id of the root path the names are relative to.
        */
-      wchar_t* Name;
+      unsigned int Root;
 
       /**
-       * \brief the old name in the case of a rename.
+       * \brief the filename/folder that was updated, relative to the root path.
        */
-      wchar_t* OldName;
+      const wchar_t* Name;
 
       /**
-     * \brief Boolean if the update is a file or a directory.
+       * \brief the old name in the case of a rename, relative to the root path.
        */
-      bool IsFile;
-
-    private:
-      void Assign(const wchar_t* name, const wchar_t* oldName, const EventAction action, const EventError error, const long long timeMillisecondsUtc, const bool isFile)
-      {
-        // clear the old values.
-        Clear();
-
-        // and set the values.
-        Action = action;
-        Error = error;
-        TimeMillisecondsUtc = timeMillisecondsUtc;
-        IsFile = isFile;
-
-        if (name != nullptr)
-        {
-          const auto len = wcslen(name);
-          Name = new wchar_t[len + 1];
-          wmemset(Name, L'\0', len + 1);
-          wcscpy_s(Name, len + 1, name);
-        }
-
-        if (oldName != nullptr)
-        {
-          const auto len = wcslen(oldName);
-          OldName = new wchar_t[len + 1];
-          wmemset(OldName, L'\0', len + 1);
-          wcscpy_s(OldName, len + 1, oldName);
-        }
-      }
+      const wchar_t* OldName;
 
-      void Clear()
-      {
-        ClearName();
-        ClearOldName();
-      }
+      /**
+       * \brief the number of characters in the name.
+       */
+      unsigned int NameLength;
 
       /**
-       * \brief free the name memory
+       * \brief the number of characters in the old name.
        */
-      void ClearName()
-      {
-        if (Name == nullptr)
-        {
-          return;
-        }
-        delete[] Name;
-        Name = nullptr;
-      }
+      unsigned int OldNameLength;
 
       /**
-       * \brief free the old name memory
+     * \brief Boolean if the update is a file or a directory.
        */
-      void ClearOldName()
-      {
-        if (OldName == nullptr)
-        {
-          return;
-        }
-        delete[] OldName;
-        OldName = nullptr;
-      }
+      bool IsFile;
     };
   }
 }
\ No newline at end of file
@@ -0,0 +1,125 @@
+// Licensed to Florent Guelfucci under one or more agreements.
+// Florent Guelfucci licenses this file to you under the MIT license.
+// See the LICENSE file in the project root for more information.
+#include <cwchar>
+#include "EventsBatch.h"
+#include "Instrumentor.h"
+
+namespace myoddweb:: directorywatcher
+{
+  /**
+   * \brief replace the current content with the given events.
+   * \param events the events we are packing.
+   */
+  void EventsBatch::Assign(const std::vector<Event*>& events)
+  {
+    MYODDWEB_PROFILE_FUNCTION();
+
+    // we first need to know how much space we need for all the names
+    // so we only grow the buffer once, if at all.
+    size_t numberOfCharacters = 0;
+    for (const auto& event : events)
+    {
+      numberOfCharacters += NumberOfCharactersNeeded(*event);
+    }
+    _names.resize(numberOfCharacters);
+    _events.resize(events.size());
+
+    size_t offset = 0;
+    for (size_t i = 0; i < events.size(); ++i)
+    {
+      Pack(*events[i], _events[i], _names.data(), _names.size(), offset);
+    }
+  }
+
+  /**
+   * \brief the number of characters needed to pack the names of an event.
+   * \param event the event we are checking.
+   * \return the number of characters including the null terminators.
+   */
+  size_t EventsBatch::NumberOfCharactersNeeded(const Event& event)
+  {
+    const auto nameLength = event.Name == nullptr ? 0 : wcslen(event.Name);
+    const auto oldNameLength = event.OldName == nullptr ? 0 : wcslen(event.OldName);
+    return nameLength + 1 + oldNameLength + 1;
+  }
+
+  /**
+   * \brief pack a single event in the given buffers.
+   * \param event the event we are packing.
+   * \param packed where we will be packing the event.
+   * \param names the buffer where the names are copied.
+   * \param namesCapacity the number of characters the names buffer can hold.
+   * \param numberOfCharacters the number of characters already used in the names, updated if the event fits.
+   * \return false if the names of the event do not fit in the names buffer.
+   */
+  bool EventsBatch::Pack(const Event& event, sEvent& packed, wchar_t* names, const size_t namesCapacity, size_t& numberOfCharacters)
+  {
+    const auto nameLength = event.Name == nullptr ? 0 : wcslen(event.Name);
+    const auto oldNameLength = event.OldName == nullptr ? 0 : wcslen(event.OldName);
+    if (numberOfCharacters + nameLength + 1 + oldNameLength + 1 > namesCapacity)
+    {
+      return false;
+    }
+
+    packed.DateTimeUtc = event.TimeMillisecondsUtc;
+    packed.Name = AddName(event.Name, nameLength, names, numberOfCharacters);
+    packed.OldName = AddName(event.OldName, oldNameLength, names, numberOfCharacters);
+    packed.Action = event.Action;
+    packed.Error = event.Error;
+    packed.IsFile = event.IsFile ? 1 : 0;
+    return true;
+  }
+
+  /**
+   * \brief copy a name at the end of the names.
+   * \param name the name we are adding, can be null.
+   * \param length the number of characters in the name.
+   * \param names the buffer where the name is copied.
+   * \param offset where we are adding the name, will be moved after the name.
+   * \return the offset of the name.
+   */
+  int EventsBatch::AddName(const wchar_t* name, const size_t length, wchar_t* names, size_t& offset)
+  {
+    const auto start = offset;
+    if (length > 0)
+    {
+      wmemcpy(names + offset, name, length);
+    }
+    names[offset + length] = L'\0';
+    offset += length + 1;
+    return static_cast<int>(start);
+  }
+
+  /**
+   * \brief the packed events.
+   */
+  const sEvent* EventsBatch::Events() const
+  {
+    return _events.data();
+  }
+
+  /**
+   * \brief the number of packed events.
+   */
+  int EventsBatch::NumberOfEvents() const
+  {
+    return static_cast<int>(_events.size());
+  }
+
+  /**
+   * \brief all the null terminated names of the events.
+   */
+  const wchar_t* EventsBatch::Names() const
+  {
+    return _names.data();
+  }
+
+  /**
+   * \brief the number of characters in the names.
+   */
+  int EventsBatch::NumberOfCharacters() const
+  {
+    return static_cast<int>(_names.size());
+  }
+}
@@ -0,0 +1,101 @@
+// Licensed to Florent Guelfucci under one or more agreements.
+// Florent Guelfucci licenses this file to you under the MIT license.
+// See the LICENSE file in the project root for more information.
+#pragma once
+#include <vector>
+
+#include "../monitors/Callbacks.h"
+#include "Event.h"
+
+namespace myoddweb
+{
+  namespace directorywatcher
+  {
+    /**
+     * \brief the events packed in contiguous records with all the names in a single buffer.
+     *        this is what we give the batch callback so we only cross the boundary once per publish.
+     *        the buffers are kept between calls so, once they are big enough, there are no more allocations.
+     *        this class is not thread safe.
+     */
+    class EventsBatch final
+    {
+    public:
+      EventsBatch() = default;
+      ~EventsBatch() = default;
+
+      EventsBatch(const EventsBatch&) = delete;
+      EventsBatch(EventsBatch&&) = delete;
+      const EventsBatch& operator=(const EventsBatch&) = delete;
+      EventsBatch& operator=(EventsBatch&&) = delete;
+
+      /**
+       * \brief replace the current content with the given events.
+       * \param events the events we are packing.
+       */
+      void Assign(const std::vector<Event*>& events);
+
+      /**
+       * \brief the packed events.
+       */
+      [[nodiscard]]
+      const sEvent* Events() const;
+
+      /**
+       * \brief the number of packed events.
+       */
+      [[nodiscard]]
+      int NumberOfEvents() const;
+
+      /**
+       * \brief all the null terminated names of the events.
+       */
+      [[nodiscard]]
+      const wchar_t* Names() const;
+
+      /**
+       * \brief the number of characters in the names.
+       */
+      [[nodiscard]]
+      int NumberOfCharacters() const;
+
+      /**
+       * \brief pack a single event in the given buffers.
+       * \param event the event we are packing.
+       * \param packed where we will be packing the event.
+       * \param names the buffer where the names are copied.
+       * \param namesCapacity the number of characters the names buffer can hold.
+       * \param numberOfCharacters the number of characters already used in the names, updated if the event fits.
+       * \return false if the names of the event do not fit in the names buffer.
+       */
+      static bool Pack(const Event& event, sEvent& packed, wchar_t* names, size_t namesCapacity, size_t& numberOfCharacters);
+
+      /**
+       * \brief the number of characters needed to pack the names of an event.
+       * \param event the event we are checking.
+       * \return the number of characters including the null terminators.
+       */
+      static size_t NumberOfCharactersNeeded(const Event& event);
+
+    private:
+      /**
+       * \brief copy a name at the end of the names.
+       * \param name the name we are adding, can be null.
+       * \param length the number of characters in the name.
+       * \param names the buffer where the name is copied.
+       * \param offset where we are adding the name, will be moved after the name.
+       * \return the offset of the name.
+       */
+      static int AddName(const wchar_t* name, size_t length, wchar_t* names, size_t& offset);
+
+      /**
+       * \brief the packed events.
+       */
+      std::vector<sEvent> _events;
+
+      /**
+       * \brief the names of all the events.
+       */
+      std::vector<wchar_t> _names;
+    };
+  }
+}
@@ -0,0 +1,190 @@
+// Licensed to Florent Guelfucci under one or more agreements.
+// Florent Guelfucci licenses this file to you under the MIT license.
+// See the LICENSE file in the project root for more information.
+#include <algorithm>
+#include "EventsCoalescer.h"
+#include "EventAction.h"
+#include "EventError.h"
+#include "Instrumentor.h"
+
+namespace myoddweb:: directorywatcher
+{
+  /**
+   * \brief get the state of a path, or create a new one if we do not know that path.
+   * \param states all the states.
+   * \param name the path we are looking for.
+   * \return the state of the path.
+   */
+  EventsCoalescer::PathState& EventsCoalescer::GetState(PathStates& states, const wchar_t* name)
+  {
+    const auto it = states.find(name);
+    if (it != states.end())
+    {
+      return it->second;
+    }
+    return states.emplace(name, PathState{ -1, -1 }).first->second;
+  }
+
+  /**
+   * \brief check if we are allowed to coalesce that event.
+   * \param event the event we are checking.
+   * \return if we can coalesce it or not.
+   */
+  bool EventsCoalescer::CanCoalesce(const Event& event)
+  {
+    // errors are always published as they are.
+    if (event.Error != static_cast<int>(EventError::None))
+    {
+      return false;
+    }
+
+    // we need a name to know what path this is about
+    return event.Name != nullptr && *event.Name != L'\0';
+  }
+
+  /**
+   * \brief coalesce the events, the events must be ordered from the oldest to the newest.
+   *        the events are updated in place and the ones we no longer need are removed.
+   * \param events the events we want to coalesce.
+   */
+  void EventsCoalescer::Coalesce(std::vector<Event*>& events)
+  {
+    MYODDWEB_PROFILE_FUNCTION();
+
+    PathStates states;
+    states.reserve(events.size());
+
+    const auto size = static_cast<long long>(events.size());
+    for (long long i = 0; i < size; ++i)
+    {
+      const auto event = events[i];
+      if (!CanCoalesce(*event))
+      {
+        continue;
+      }
+
+      switch (static_cast<EventAction>(event->Action))
+      {
+      case EventAction::Added:
+        {
+          // this is the start of a brand new path.
+          auto& state = GetState(states, event->Name);
+          state.Origin = i;
+          state.Touched = -1;
+        }
+        break;
+
+      case EventAction::Touched:
+        {
+          auto& state = GetState(states, event->Name);
+          if (state.Origin != -1 && events[state.Origin]->Action == static_cast<int>(EventAction::Added))
+          {
+            // the add already tells the caller that something changed.
+            events[i] = nullptr;
+            break;
+          }
+
+          // we only need the last touch, the older one is not needed.
+          if (state.Touched != -1)
+          {
+            events[state.Touched] = nullptr;
+          }
+          state.Touched = i;
+        }
+        break;
+
+      case EventAction::Removed:
+        {
+          const auto it = states.find(event->Name);
+          if (it == states.end())
+          {
+            break;
+          }
+          const auto state = it->second;
+          states.erase(it);
+
+          // whatever was changed does not matter, it is now gone.
+          if (state.Touched != -1)
+          {
+            events[state.Touched] = nullptr;
+          }
+          if (state.Origin == -1)
+          {
+            break;
+          }
+
+          const auto origin = events[state.Origin];
+          events[state.Origin] = nullptr;
+          if (origin->Action == static_cast<int>(EventAction::Added))
+          {
+            // added then removed, as far as the caller is concerned it never existed.
+            events[i] = nullptr;
+          }
+          else
+          {
+            // renamed then removed, so it is the original name that is gone.
+            event->Name = origin->OldName;
+          }
+        }
+        break;
+
+      case EventAction::Renamed:
+        {
+          if (event->OldName == nullptr)
+          {
+            break;
+          }
+
+          // move the state from the old name to the new name.
+          auto previous = PathState{ -1, -1 };
+          const auto it = states.find(event->OldName);
+          if (it != states.end())
+          {
+            previous = it->second;
+            states.erase(it);
+          }
+
+          if (previous.Origin != -1)
+          {
+            const auto origin = events[previous.Origin];
+            events[previous.Origin] = nullptr;
+            if (origin->Action == static_cast<int>(EventAction::Added))
+            {
+              // added then renamed, as far as the caller is concerned it was added with the new name.
+              // and the touches were folded into the add.
+              event->Action = static_cast<int>(EventAction::Added);
+              event->OldName = nullptr;
+              if (previous.Touched != -1)
+              {
+                events[previous.Touched] = nullptr;
+              }
+            }
+            else
+            {
+              // A->B->C becomes A->C
+              event->OldName = origin->OldName;
+            }
+          }
+
+          // A->B->A, as far as the caller is concerned nothing was renamed.
+          if (event->OldName != nullptr && std::wstring_view(event->OldName) == event->Name)
+          {
+            events[i] = nullptr;
+            break;
+          }
+
+          auto& state = GetState(states, event->Name);
+          state.Origin = i;
+          state.Touched = -1;
+        }
+        break;
+
+      default:
+        break;
+      }
+    }
+
+    // remove all the events we no longer need.
+    events.erase(std::remove(events.begin(), events.end(), nullptr), events.end());
+  }
+}
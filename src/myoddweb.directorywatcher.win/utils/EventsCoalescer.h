@@ -0,0 +1,77 @@
+// Licensed to Florent Guelfucci under one or more agreements.
+// Florent Guelfucci licenses this file to you under the MIT license.
+// See the LICENSE file in the project root for more information.
+#pragma once
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "Event.h"
+
+namespace myoddweb
+{
+  namespace directorywatcher
+  {
+    /**
+     * \brief reduce the events of a publish window to their net effect, per path.
+     *        - added then removed cancel each other out.
+     *        - touches after an add are folded into the add.
+     *        - touches before a remove are dropped.
+     *        - added then renamed becomes an add of the new name.
+     *        - rename chains, A->B->C, become a single A->C rename.
+     *        - renamed then removed becomes a remove of the original name.
+     */
+    class EventsCoalescer final
+    {
+    public:
+      EventsCoalescer(const EventsCoalescer&) = delete;
+      EventsCoalescer& operator=(const EventsCoalescer&) = delete;
+
+    private:
+      EventsCoalescer() = default;
+      ~EventsCoalescer() = default;
+
+    public:
+      /**
+       * \brief coalesce the events, the events must be ordered from the oldest to the newest.
+       *        the events are updated in place and the ones we no longer need are removed.
+       * \param events the events we want to coalesce.
+       */
+      static void Coalesce(std::vector<Event*>& events);
+
+    private:
+      /**
+       * \brief what we know of a path so far.
+       */
+      struct PathState
+      {
+        /**
+         * \brief the event that created the current name, (added or renamed), -1 if none.
+         */
+        long long Origin;
+
+        /**
+         * \brief the last touch of the current name, -1 if none.
+         */
+        long long Touched;
+      };
+
+      typedef std::unordered_map<std::wstring_view, PathState> PathStates;
+
+      /**
+       * \brief get the state of a path, or create a new one if we do not know that path.
+       * \param states all the states.
+       * \param name the path we are looking for.
+       * \return the state of the path.
+       */
+      static PathState& GetState(PathStates& states, const wchar_t* name);
+
+      /**
+       * \brief check if we are allowed to coalesce that event.
+       * \param event the event we are checking.
+       * \return if we can coalesce it or not.
+       */
+      static bool CanCoalesce(const Event& event);
+    };
+  }
+}
@@ -0,0 +1,81 @@
+// Licensed to Florent Guelfucci under one or more agreements.
+// Florent Guelfucci licenses this file to you under the MIT license.
+// See the LICENSE file in the project root for more information.
+#include "EventsCounter.h"
+
+namespace myoddweb:: directorywatcher
+{
+  EventsCounter::EventsCounter() :
+    _numberOfEvents(0),
+    _numberOfAdded(0),
+    _numberOfRemoved(0),
+    _numberOfTouched(0),
+    _numberOfRenamed(0),
+    _numberOfErrors(0),
+    _numberOfOverflows(0)
+  {
+  }
+
+  /**
+   * \brief count one more event with the given action.
+   * \param action the action of the event.
+   */
+  void EventsCounter::Add(const EventAction action)
+  {
+    // the counters are only read when the statistics are published
+    // so they do not need to be in sync with each other.
+    _numberOfEvents.fetch_add(1, std::memory_order_relaxed);
+    switch (action)
+    {
+    case EventAction::Added:
+      _numberOfAdded.fetch_add(1, std::memory_order_relaxed);
+      break;
+
+    case EventAction::Removed:
+      _numberOfRemoved.fetch_add(1, std::memory_order_relaxed);
+      break;
+
+    case EventAction::Touched:
+      _numberOfTouched.fetch_add(1, std::memory_order_relaxed);
+      break;
+
+    case EventAction::Renamed:
+      _numberOfRenamed.fetch_add(1, std::memory_order_relaxed);
+      break;
+
+    default:
+      break;
+    }
+  }
+
+  /**
+   * \brief count one more error.
+   * \param error the error we are counting.
+   */
+  void EventsCounter::AddError(const EventError error)
+  {
+    _numberOfEvents.fetch_add(1, std::memory_order_relaxed);
+    _numberOfErrors.fetch_add(1, std::memory_order_relaxed);
+    if (error == EventError::Overflow)
+    {
+      _numberOfOverflows.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  /**
+   * \brief get the number of events counted since the last reset and start again from zero.
+   * \return the number of events since the previous reset.
+   */
+  EventsCounter::Counts EventsCounter::Reset()
+  {
+    Counts counts = {};
+    counts.numberOfEvents = _numberOfEvents.exchange(0, std::memory_order_relaxed);
+    counts.numberOfAdded = _numberOfAdded.exchange(0, std::memory_order_relaxed);
+    counts.numberOfRemoved = _numberOfRemoved.exchange(0, std::memory_order_relaxed);
+    counts.numberOfTouched = _numberOfTouched.exchange(0, std::memory_order_relaxed);
+    counts.numberOfRenamed = _numberOfRenamed.exchange(0, std::memory_order_relaxed);
+    counts.numberOfErrors = _numberOfErrors.exchange(0, std::memory_order_relaxed);
+    counts.numberOfOverflows = _numberOfOverflows.exchange(0, std::memory_order_relaxed);
+    return counts;
+  }
+}
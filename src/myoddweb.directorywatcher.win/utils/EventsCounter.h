@@ -0,0 +1,97 @@
+// Licensed to Florent Guelfucci under one or more agreements.
+// Florent Guelfucci licenses this file to you under the MIT license.
+// See the LICENSE file in the project root for more information.
+#pragma once
+#include <atomic>
+#include "EventAction.h"
+#include "EventError.h"
+
+namespace myoddweb
+{
+  namespace directorywatcher
+  {
+    /**
+     * \brief count the events of one or more monitors when we only want the statistics.
+     *        the events are never created, we only keep a counter per action.
+     */
+    class EventsCounter final
+    {
+    public:
+      /**
+       * \brief the number of events counted since the last reset.
+       */
+      struct Counts
+      {
+        long long numberOfEvents;
+        long long numberOfAdded;
+        long long numberOfRemoved;
+        long long numberOfTouched;
+        long long numberOfRenamed;
+        long long numberOfErrors;
+        long long numberOfOverflows;
+      };
+
+      EventsCounter();
+      ~EventsCounter() = default;
+
+      EventsCounter(const EventsCounter&) = delete;
+      EventsCounter(EventsCounter&&) = delete;
+      const EventsCounter& operator=(const EventsCounter&) = delete;
+      EventsCounter& operator=(EventsCounter&&) = delete;
+
+      /**
+       * \brief count one more event with the given action.
+       * \param action the action of the event.
+       */
+      void Add(EventAction action);
+
+      /**
+       * \brief count one more error.
+       * \param error the error we are counting.
+       */
+      void AddError(EventError error);
+
+      /**
+       * \brief get the number of events counted since the last reset and start again from zero.
+       * \return the number of events since the previous reset.
+       */
+      Counts Reset();
+
+    private:
+      /**
+       * \brief the number of events, (including the errors and the unknown actions).
+       */
+      std::atomic<long long> _numberOfEvents;
+
+      /**
+       * \brief the number of added events.
+       */
+      std::atomic<long long> _numberOfAdded;
+
+      /**
+       * \brief the number of removed events.
+       */
+      std::atomic<long long> _numberOfRemoved;
+
+      /**
+       * \brief the number of touched events.
+       */
+      std::atomic<long long> _numberOfTouched;
+
+      /**
+       * \brief the number of renamed events.
+       */
+      std::atomic<long long> _numberOfRenamed;
+
+      /**
+       * \brief the number of errors.
+       */
+      std::atomic<long long> _numberOfErrors;
+
+      /**
+       * \brief the number of overflow errors.
+       */
+      std::atomic<long long> _numberOfOverflows;
+    };
+  }
+}
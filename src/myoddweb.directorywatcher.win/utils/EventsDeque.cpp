@@ -0,0 +1,208 @@
+// Licensed to Florent Guelfucci under one or more agreements.
+// Florent Guelfucci licenses this file to you under the MIT license.
+// See the LICENSE file in the project root for more information.
+#include "EventsDeque.h"
+#include "Instrumentor.h"
+
+namespace myoddweb:: directorywatcher
+{
+  /**
+   * \brief round the number up to the next power of 2.
+   * \param value the number we want to round up.
+   * \return the rounded up number.
+   */
+  size_t EventsDeque::RoundUpToPowerOfTwo(const size_t value)
+  {
+    size_t rounded = 1;
+    while (rounded < value)
+    {
+      rounded <<= 1;
+    }
+    return rounded;
+  }
+
+  EventsDeque::EventsDeque(const size_t segmentSize) :
+    _mask(RoundUpToPowerOfTwo(segmentSize) - 1),
+    _shift(0),
+    _begin(0),
+    _size(0)
+  {
+    while ((static_cast<size_t>(1) << _shift) <= _mask)
+    {
+      ++_shift;
+    }
+  }
+
+  EventsDeque::~EventsDeque()
+  {
+    // we do not own the events, only the segments.
+    for (const auto& segment : _segments)
+    {
+      delete[] segment;
+    }
+    for (const auto& segment : _spareSegments)
+    {
+      delete[] segment;
+    }
+    _segments.clear();
+    _spareSegments.clear();
+  }
+
+  /**
+   * \brief add an event at the back of the deque.
+   * \param event the event we are adding.
+   */
+  void EventsDeque::PushBack(const EventInformation* event)
+  {
+    const auto position = _begin + _size;
+    const auto segment = position >> _shift;
+    if (segment == _segments.size())
+    {
+      // we need a new segment, re-use one if we can.
+      if (_spareSegments.empty())
+      {
+        _segments.push_back(new const EventInformation*[_mask + 1]);
+      }
+      else
+      {
+        _segments.push_back(_spareSegments.back());
+        _spareSegments.pop_back();
+      }
+    }
+    _segments[segment][position & _mask] = event;
+    ++_size;
+  }
+
+  /**
+   * \brief add all the events at the back of the deque, in order.
+   * \param events the events we are adding.
+   */
+  void EventsDeque::Append(const std::vector<const EventInformation*>& events)
+  {
+    MYODDWEB_PROFILE_FUNCTION();
+    for (const auto& event : events)
+    {
+      PushBack(event);
+    }
+  }
+
+  /**
+   * \brief move the first segment to the spare segments.
+   */
+  void EventsDeque::ReleaseFrontSegment()
+  {
+    _spareSegments.push_back(_segments.front());
+    _segments.pop_front();
+  }
+
+  /**
+   * \brief remove events from the front of the deque
+   *        the segments that are no longer used are kept for later.
+   * \param count the number of events we want to remove.
+   */
+  void EventsDeque::PopFront(const size_t count)
+  {
+    if (count >= _size)
+    {
+      Clear();
+      return;
+    }
+
+    // we only drop whole segments, the events that are left never move.
+    _begin += count;
+    _size -= count;
+    while (_begin > _mask)
+    {
+      ReleaseFrontSegment();
+      _begin -= (_mask + 1);
+    }
+  }
+
+  /**
+   * \brief remove all the events.
+   */
+  void EventsDeque::Clear()
+  {
+    while (!_segments.empty())
+    {
+      ReleaseFrontSegment();
+    }
+    _begin = 0;
+    _size = 0;
+  }
+
+  /**
+   * \brief the number of events at the front of the deque that are not newer than the given time.
+   *        the events are ordered by time so we use a binary search.
+   * \param timeMillisecondsUtc the time we are checking against.
+   * \return the number of events.
+   */
+  size_t EventsDeque::CountNotNewerThan(const long long timeMillisecondsUtc) const
+  {
+    size_t first = 0;
+    auto count = _size;
+    while (count > 0)
+    {
+      const auto step = count / 2;
+      const auto middle = first + step;
+      if ((*this)[middle]->TimeMillisecondsUtc <= timeMillisecondsUtc)
+      {
+        first = middle + 1;
+        count -= step + 1;
+      }
+      else
+      {
+        count = step;
+      }
+    }
+    return first;
+  }
+
+  /**
+   * \brief copy all the events, in order, to a vector.
+   * \param events where we will be adding the events.
+   */
+  void EventsDeque::CopyTo(std::vector<const EventInformation*>& events) const
+  {
+    events.reserve(events.size() + _size);
+    for (size_t i = 0; i < _size; ++i)
+    {
+      events.push_back((*this)[i]);
+    }
+  }
+
+  /**
+   * \brief the number of events in the deque.
+   */
+  size_t EventsDeque::Size() const
+  {
+    return _size;
+  }
+
+  /**
+   * \brief if the deque is empty.
+   */
+  bool EventsDeque::Empty() const
+  {
+    return _size == 0;
+  }
+
+  /**
+   * \brief the oldest event, the deque cannot be empty.
+   */
+  const EventInformation* EventsDeque::Front() const
+  {
+    return _segments.front()[_begin];
+  }
+
+  /**
+   * \brief get an event by position, 0 is the oldest event.
+   * \param index the position of the event.
+   * \return the event
+   */
+  const EventInformation* EventsDeque::operator[](const size_t index) const
+  {
+    const auto position = _begin + index;
+    return _segments[position >> _shift][position & _mask];
+  }
+}
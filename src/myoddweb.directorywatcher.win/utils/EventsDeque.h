@@ -0,0 +1,146 @@
+// Licensed to Florent Guelfucci under one or more agreements.
+// Florent Guelfucci licenses this file to you under the MIT license.
+// See the LICENSE file in the project root for more information.
+#pragma once
+#include <deque>
+#include <vector>
+
+#include "../monitors/Base.h"
+#include "EventInformation.h"
+
+namespace myoddweb
+{
+  namespace directorywatcher
+  {
+    /**
+     * \brief segmented deque of events, ordered from the oldest to the newest.
+     *        events are only added at the back and removed from the front
+     *        so removing old events never moves the events that are left.
+     *        the deque never owns the events themselves.
+     *        this class is not thread safe.
+     */
+    class EventsDeque final
+    {
+    public:
+      /**
+       * \brief create the deque
+       * \param segmentSize the number of events in each segment, will be rounded up to a power of 2.
+       */
+      explicit EventsDeque(size_t segmentSize = MYODDWEB_EVENTS_SEGMENT_SIZE);
+      ~EventsDeque();
+
+      EventsDeque(const EventsDeque&) = delete;
+      EventsDeque(EventsDeque&&) = delete;
+      const EventsDeque& operator=(const EventsDeque&) = delete;
+      EventsDeque& operator=(EventsDeque&&) = delete;
+
+      /**
+       * \brief add an event at the back of the deque.
+       * \param event the event we are adding.
+       */
+      void PushBack(const EventInformation* event);
+
+      /**
+       * \brief add all the events at the back of the deque, in order.
+       * \param events the events we are adding.
+       */
+      void Append(const std::vector<const EventInformation*>& events);
+
+      /**
+       * \brief remove events from the front of the deque
+       *        the segments that are no longer used are kept for later.
+       * \param count the number of events we want to remove.
+       */
+      void PopFront(size_t count);
+
+      /**
+       * \brief remove all the events.
+       */
+      void Clear();
+
+      /**
+       * \brief the number of events at the front of the deque that are not newer than the given time.
+       *        the events are ordered by time so we use a binary search.
+       * \param timeMillisecondsUtc the time we are checking against.
+       * \return the number of events.
+       */
+      [[nodiscard]]
+      size_t CountNotNewerThan(long long timeMillisecondsUtc) const;
+
+      /**
+       * \brief copy all the events, in order, to a vector.
+       * \param events where we will be adding the events.
+       */
+      void CopyTo(std::vector<const EventInformation*>& events) const;
+
+      /**
+       * \brief the number of events in the deque.
+       */
+      [[nodiscard]]
+      size_t Size() const;
+
+      /**
+       * \brief if the deque is empty.
+       */
+      [[nodiscard]]
+      bool Empty() const;
+
+      /**
+       * \brief the oldest event, the deque cannot be empty.
+       */
+      [[nodiscard]]
+      const EventInformation* Front() const;
+
+      /**
+       * \brief get an event by position, 0 is the oldest event.
+       * \param index the position of the event.
+       * \return the event
+       */
+      const EventInformation* operator[](size_t index) const;
+
+    private:
+      /**
+       * \brief the number of events in each segment - 1, the size is a power of 2.
+       */
+      const size_t _mask;
+
+      /**
+       * \brief the number of bits we shift the position by to get the segment.
+       */
+      size_t _shift;
+
+      /**
+       * \brief the segments in use, only the first one can have events removed
+       *        and only the last one can have free space.
+       */
+      std::deque<const EventInformation**> _segments;
+
+      /**
+       * \brief the segments we are no longer using, kept so we do not need to allocate them again.
+       */
+      std::vector<const EventInformation**> _spareSegments;
+
+      /**
+       * \brief the position of the first event in the first segment.
+       */
+      size_t _begin;
+
+      /**
+       * \brief the number of events
+       */
+      size_t _size;
+
+      /**
+       * \brief move the first segment to the spare segments.
+       */
+      void ReleaseFrontSegment();
+
+      /**
+       * \brief round the number up to the next power of 2.
+       * \param value the number we want to round up.
+       * \return the rounded up number.
+       */
+      static size_t RoundUpToPowerOfTwo(size_t value);
+    };
+  }
+}
@@ -0,0 +1,131 @@
+// Licensed to Florent Guelfucci under one or more agreements.
+// Florent Guelfucci licenses this file to you under the MIT license.
+// See the LICENSE file in the project root for more information.
+#include <chrono>
+#include "EventsDispatcher.h"
+
+namespace myoddweb:: directorywatcher
+{
+  EventsDispatcher::EventsDispatcher(const size_t queueSize, DispatchFunction dispatch) :
+    _head(0),
+    _tail(0),
+    _stop(false),
+    _dispatch(std::move(dispatch)),
+    _thread(nullptr)
+  {
+    const auto numberOfBatches = queueSize == 0 ? 1 : queueSize;
+    _batches.reserve(numberOfBatches);
+    for (size_t i = 0; i < numberOfBatches; ++i)
+    {
+      _batches.push_back(new EventsBatch());
+    }
+    _thread = new threads::Thread([this] { Dispatch(); });
+  }
+
+  EventsDispatcher::~EventsDispatcher()
+  {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _stop = true;
+    }
+    _notEmpty.notify_all();
+
+    // wait for the queue to be dispatched.
+    delete _thread;
+    _thread = nullptr;
+
+    for (const auto& batch : _batches)
+    {
+      delete batch;
+    }
+    _batches.clear();
+  }
+
+  /**
+   * \brief copy the events to the queue, waiting for room if the queue is full.
+   *        this must only be called by a single producer.
+   * \param events the events we are dispatching, they are not used after this call.
+   * \return the number of microseconds we were blocked waiting for room in the queue.
+   */
+  long long EventsDispatcher::Enqueue(const std::vector<Event*>& events)
+  {
+    long long blockedMicroseconds = 0;
+    const auto tail = _tail.load(std::memory_order_relaxed);
+    if (tail - _head.load(std::memory_order_acquire) == _batches.size())
+    {
+      const auto start = std::chrono::steady_clock::now();
+      std::unique_lock<std::mutex> lock(_mutex);
+      _notFull.wait(lock, [&] { return tail - _head.load(std::memory_order_acquire) < _batches.size(); });
+      blockedMicroseconds = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // the consumer is done with this batch, so we can reuse it.
+    _batches[tail % _batches.size()]->Assign(events);
+    _tail.store(tail + 1, std::memory_order_release);
+
+    // take the lock so the consumer cannot miss the notification
+    // between checking the queue and waiting.
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+    }
+    _notEmpty.notify_one();
+    return blockedMicroseconds;
+  }
+
+  /**
+   * \brief the number of batches waiting to be dispatched, including the one being dispatched.
+   */
+  size_t EventsDispatcher::NumberOfQueuedBatches() const
+  {
+    return _tail.load(std::memory_order_acquire) - _head.load(std::memory_order_acquire);
+  }
+
+  /**
+   * \brief wait for all the batches queued so far to be dispatched.
+   *        this must only be called by the producer.
+   * \return the number of microseconds we were blocked.
+   */
+  long long EventsDispatcher::WaitUntilDispatched()
+  {
+    const auto tail = _tail.load(std::memory_order_relaxed);
+    if (_head.load(std::memory_order_acquire) == tail)
+    {
+      return 0;
+    }
+
+    // the consumer notifies us every time a batch is dispatched.
+    const auto start = std::chrono::steady_clock::now();
+    std::unique_lock<std::mutex> lock(_mutex);
+    _notFull.wait(lock, [&] { return _head.load(std::memory_order_acquire) == tail; });
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+  }
+
+  /**
+   * \brief the dispatching thread, call the dispatch function until we are stopped and the queue is empty.
+   */
+  void EventsDispatcher::Dispatch()
+  {
+    for (;;)
+    {
+      const auto head = _head.load(std::memory_order_relaxed);
+      {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _notEmpty.wait(lock, [&] { return _stop || _tail.load(std::memory_order_acquire) != head; });
+      }
+
+      // we only stop once everything was dispatched.
+      if (_tail.load(std::memory_order_acquire) == head)
+      {
+        return;
+      }
+
+      _dispatch(*_batches[head % _batches.size()]);
+      _head.store(head + 1, std::memory_order_release);
+
+      {
+        std::lock_guard<std::mutex> lock(_mutex);
+      }
+      _notFull.notify_one();
+    }
+  }
+}
@@ -0,0 +1,120 @@
+// Licensed to Florent Guelfucci under one or more agreements.
+// Florent Guelfucci licenses this file to you under the MIT license.
+// See the LICENSE file in the project root for more information.
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+#include "Event.h"
+#include "EventsBatch.h"
+#include "Threads/Thread.h"
+
+namespace myoddweb
+{
+  namespace directorywatcher
+  {
+    /**
+     * \brief a bounded, single producer/single consumer, queue of events batches
+     *        with its own thread calling the dispatch function for each batch.
+     *        the producer only packs the events so a slow consumer cannot stall the monitors.
+     *        once the queue is full the producer waits for the consumer to catch up.
+     */
+    class EventsDispatcher final
+    {
+    public:
+      typedef std::function<void(const EventsBatch&)> DispatchFunction;
+
+      /**
+       * \brief create the dispatcher and start the dispatching thread.
+       * \param queueSize the maximum number of batches waiting to be dispatched.
+       * \param dispatch the function called, on the dispatching thread, for each batch.
+       */
+      EventsDispatcher(size_t queueSize, DispatchFunction dispatch);
+
+      /**
+       * \brief dispatch whatever is still queued then stop the thread.
+       */
+      ~EventsDispatcher();
+
+      EventsDispatcher(const EventsDispatcher&) = delete;
+      EventsDispatcher(EventsDispatcher&&) = delete;
+      const EventsDispatcher& operator=(const EventsDispatcher&) = delete;
+      EventsDispatcher& operator=(EventsDispatcher&&) = delete;
+
+      /**
+       * \brief copy the events to the queue, waiting for room if the queue is full.
+       *        this must only be called by a single producer.
+       * \param events the events we are dispatching, they are not used after this call.
+       * \return the number of microseconds we were blocked waiting for room in the queue.
+       */
+      long long Enqueue(const std::vector<Event*>& events);
+
+      /**
+       * \brief the number of batches waiting to be dispatched, including the one being dispatched.
+       */
+      [[nodiscard]]
+      size_t NumberOfQueuedBatches() const;
+
+      /**
+       * \brief wait for all the batches queued so far to be dispatched.
+       *        this must only be called by the producer.
+       * \return the number of microseconds we were blocked.
+       */
+      long long WaitUntilDispatched();
+
+    private:
+      /**
+       * \brief the dispatching thread, call the dispatch function until we are stopped and the queue is empty.
+       */
+      void Dispatch();
+
+      /**
+       * \brief the batches, reused in turn so we do not allocate once they are big enough.
+       */
+      std::vector<EventsBatch*> _batches;
+
+      /**
+       * \brief the next batch the consumer will dispatch.
+       */
+      std::atomic<size_t> _head;
+
+      /**
+       * \brief the next batch the producer will fill.
+       */
+      std::atomic<size_t> _tail;
+
+      /**
+       * \brief if we are stopping, the queue is still dispatched.
+       */
+      bool _stop;
+
+      /**
+       * \brief the lock used by the condition variables, the queue itself does not need it.
+       */
+      std::mutex _mutex;
+
+      /**
+       * \brief notified when a batch is added to the queue.
+       */
+      std::condition_variable _notEmpty;
+
+      /**
+       * \brief notified when a batch is removed from the queue.
+       */
+      std::condition_variable _notFull;
+
+      /**
+       * \brief the function we call for each batch.
+       */
+      DispatchFunction _dispatch;
+
+      /**
+       * \brief the dispatching thread.
+       */
+      threads::Thread* _thread;
+    };
+  }
+}
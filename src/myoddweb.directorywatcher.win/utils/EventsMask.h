@@ -0,0 +1,89 @@
+﻿// Licensed to Florent Guelfucci under one or more agreements.
+// Florent Guelfucci licenses this file to you under the MIT license.
+// See the LICENSE file in the project root for more information.
+#pragma once
+
+namespace myoddweb
+{
+  namespace directorywatcher
+  {
+    /**
+     * \brief the actions we want to be told about, the values can be combined.
+     *        the actions that are not wanted are never added to the collector.
+     */
+    enum class ActionsMask
+    {
+      /**
+       * \brief a file folder was added.
+       */
+      Added = 1,
+
+      /**
+       * \brief a file folder was removed.
+       */
+      Removed = 2,
+
+      /**
+       * \brief small changed, timestamp, attribute etc... (see ChangesMask)
+       */
+      Touched = 4,
+
+      /**
+       * \brief a file folder was renamed.
+       */
+      Renamed = 8,
+
+      /**
+       * \brief the errors, (overflow, memory and so on).
+       */
+      Errors = 16,
+
+      /**
+       * \brief all of the above.
+       */
+      All = Added | Removed | Touched | Renamed | Errors
+    };
+
+    /**
+     * \brief the kind of changes that raise a touched event, the values can be combined.
+     *        the changes that are not wanted are not even asked to the file system.
+     */
+    enum class ChangesMask
+    {
+      /**
+       * \brief the size of the file changed.
+       */
+      Size = 1,
+
+      /**
+       * \brief the last write time changed.
+       */
+      LastWrite = 2,
+
+      /**
+       * \brief the last access time changed.
+       */
+      LastAccess = 4,
+
+      /**
+       * \brief one of the attributes changed.
+       */
+      Attributes = 8,
+
+      /**
+       * \brief the creation time changed.
+       */
+      Creation = 16,
+
+      /**
+       * \brief the security descriptor changed.
+       */
+      Security = 32,
+
+      /**
+       * \brief all of the above.
+       */
+      All = Size | LastWrite | LastAccess | Attributes | Creation | Security
+    };
+  }
+}
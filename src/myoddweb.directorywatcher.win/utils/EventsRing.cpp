@@ -0,0 +1,130 @@
+// Licensed to Florent Guelfucci under one or more agreements.
+// Florent Guelfucci licenses this file to you under the MIT license.
+// See the LICENSE file in the project root for more information.
+#include "EventsRing.h"
+#include "Instrumentor.h"
+
+namespace myoddweb:: directorywatcher
+{
+  EventsRing::EventsRing(const size_t capacity) :
+    _cells(nullptr),
+    _mask(RoundUpToPowerOfTwo(capacity) - 1),
+    _enqueuePosition(0),
+    _dequeuePosition(0),
+    _contention(0)
+  {
+    _cells = new Cell[_mask + 1];
+    for (size_t i = 0; i <= _mask; ++i)
+    {
+      // each cell is free for the producer that will claim position 'i'
+      _cells[i].Sequence.store(i, std::memory_order_relaxed);
+      _cells[i].Event = nullptr;
+    }
+  }
+
+  EventsRing::~EventsRing()
+  {
+    // we do not own the events, so we just get rid of the cells.
+    delete[] _cells;
+    _cells = nullptr;
+  }
+
+  /**
+   * \brief round the number up to the next power of 2.
+   * \param value the number we want to round up.
+   * \return the rounded up number.
+   */
+  size_t EventsRing::RoundUpToPowerOfTwo(const size_t value)
+  {
+    size_t rounded = 2;
+    while (rounded < value)
+    {
+      rounded <<= 1;
+    }
+    return rounded;
+  }
+
+  /**
+   * \brief the number of time producers had to retry because another producer
+   *        claimed the same slot before them.
+   */
+  long long EventsRing::ContentionCount() const
+  {
+    return _contention.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * \brief try and add an event to the ring.
+   *        the ring never takes ownership of the event.
+   * \param event the event we want to add.
+   * \return false if the ring is full and the event was not added.
+   */
+  bool EventsRing::Push(const EventInformation* event)
+  {
+    MYODDWEB_PROFILE_FUNCTION();
+
+    auto position = _enqueuePosition.load(std::memory_order_relaxed);
+    for (;;)
+    {
+      auto& cell = _cells[position & _mask];
+      const auto sequence = cell.Sequence.load(std::memory_order_acquire);
+      const auto difference = static_cast<long long>(sequence) - static_cast<long long>(position);
+      if (difference == 0)
+      {
+        // the cell is free, try and claim it.
+        if (_enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+        {
+          cell.Event = event;
+          cell.Sequence.store(position + 1, std::memory_order_release);
+          return true;
+        }
+
+        // another producer claimed it before us, 'position' was updated.
+        _contention.fetch_add(1, std::memory_order_relaxed);
+        continue;
+      }
+
+      if (difference < 0)
+      {
+        // the consumer has not read that cell yet, we are full.
+        return false;
+      }
+
+      // another producer moved ahead, try again from the new position.
+      _contention.fetch_add(1, std::memory_order_relaxed);
+      position = _enqueuePosition.load(std::memory_order_relaxed);
+    }
+  }
+
+  /**
+   * \brief move all the events currently in the ring to the given container
+   * \param events where we will be adding the events.
+   * \return the number of events we moved.
+   */
+  size_t EventsRing::Drain(std::vector<const EventInformation*>& events)
+  {
+    MYODDWEB_PROFILE_FUNCTION();
+
+    size_t count = 0;
+    for (;;)
+    {
+      auto& cell = _cells[_dequeuePosition & _mask];
+      const auto sequence = cell.Sequence.load(std::memory_order_acquire);
+      if (sequence != _dequeuePosition + 1)
+      {
+        // either empty or the producer has not finished writing.
+        // either way, we will get it on the next drain.
+        break;
+      }
+
+      events.emplace_back(cell.Event);
+      cell.Event = nullptr;
+
+      // release the cell for the producer that will claim it on the next lap.
+      cell.Sequence.store(_dequeuePosition + _mask + 1, std::memory_order_release);
+      ++_dequeuePosition;
+      ++count;
+    }
+    return count;
+  }
+}
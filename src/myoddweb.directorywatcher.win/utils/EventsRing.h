@@ -0,0 +1,102 @@
+// Licensed to Florent Guelfucci under one or more agreements.
+// Florent Guelfucci licenses this file to you under the MIT license.
+// See the LICENSE file in the project root for more information.
+#pragma once
+#include <atomic>
+#include <vector>
+
+#include "EventInformation.h"
+
+namespace myoddweb
+{
+  namespace directorywatcher
+  {
+    /**
+     * \brief bounded, lock free, multiple producers/single consumer ring of events.
+     *        producers never block, if the ring is full then Push() returns false
+     *        and it is up to the caller to decide what to do with the event.
+     *        only one thread at a time is allowed to call Drain()
+     */
+    class EventsRing final
+    {
+    public:
+      /**
+       * \brief create the ring
+       * \param capacity the number of events we can hold, will be rounded up to a power of 2.
+       */
+      explicit EventsRing(size_t capacity);
+      ~EventsRing();
+
+      EventsRing(const EventsRing&) = delete;
+      EventsRing(EventsRing&&) = delete;
+      const EventsRing& operator=(const EventsRing&) = delete;
+      EventsRing& operator=(EventsRing&&) = delete;
+
+      /**
+       * \brief try and add an event to the ring.
+       *        the ring never takes ownership of the event.
+       * \param event the event we want to add.
+       * \return false if the ring is full and the event was not added.
+       */
+      bool Push(const EventInformation* event);
+
+      /**
+       * \brief move all the events currently in the ring to the given container
+       * \param events where we will be adding the events.
+       * \return the number of events we moved.
+       */
+      size_t Drain(std::vector<const EventInformation*>& events);
+
+      /**
+       * \brief the number of time producers had to retry because another producer
+       *        claimed the same slot before them.
+       */
+      long long ContentionCount() const;
+
+    private:
+      /**
+       * \brief a single cell in the ring.
+       *        the sequence tells us if the cell is free for the producer
+       *        or ready for the consumer.
+       */
+      struct Cell
+      {
+        std::atomic<size_t> Sequence;
+        const EventInformation* Event;
+      };
+
+      /**
+       * \brief all the cells
+       */
+      Cell* _cells;
+
+      /**
+       * \brief the capacity - 1, the capacity is a power of 2.
+       */
+      const size_t _mask;
+
+      /**
+       * \brief the next position the producers will be writting to.
+       */
+      std::atomic<size_t> _enqueuePosition;
+
+      /**
+       * \brief the next position the consumer will be reading from.
+       *        only ever used by the consumer.
+       */
+      size_t _dequeuePosition;
+
+      /**
+       * \brief the number of times a producer lost a race for a cell.
+       */
+      std::atomic<long long> _contention;
+
+      /**
+       * \brief round the number up to the next power of 2.
+       * \param value the number we want to round up.
+       * \return the rounded up number.
+       */
+      static size_t RoundUpToPowerOfTwo(size_t value);
+    };
+  }
+}
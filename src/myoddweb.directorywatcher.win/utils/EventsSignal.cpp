@@ -0,0 +1,115 @@
+// Licensed to Florent Guelfucci under one or more agreements.
+// Florent Guelfucci licenses this file to you under the MIT license.
+// See the LICENSE file in the project root for more information.
+#include <chrono>
+#include <limits>
+#include <utility>
+#include "EventsSignal.h"
+
+namespace myoddweb:: directorywatcher
+{
+  /**
+   * \brief the target when nobody is waiting, so we never need to notify anyone.
+   */
+  constexpr auto NobodyIsWaiting = std::numeric_limits<long long>::max();
+
+  EventsSignal::EventsSignal() :
+    _numberOfEvents(0),
+    _target(NobodyIsWaiting),
+    _cancelled(false)
+  {
+  }
+
+  /**
+   * \brief flag that one more event was added.
+   */
+  void EventsSignal::Notify()
+  {
+    // both the count and the target must be sequentially consistent
+    // so we cannot miss a waiter that sets its target while we are adding.
+    const auto numberOfEvents = ++_numberOfEvents;
+    if (numberOfEvents == 1 && _firstEvent != nullptr)
+    {
+      _firstEvent();
+    }
+    if (numberOfEvents < _target.load())
+    {
+      return;
+    }
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    _conditionVariable.notify_all();
+  }
+
+  /**
+   * \brief set the function called when the first event is added after a reset.
+   *        this must be called before any event is added.
+   * \param firstEvent the function we will call.
+   */
+  void EventsSignal::OnFirstEvent(std::function<void()> firstEvent)
+  {
+    _firstEvent = std::move(firstEvent);
+  }
+
+  /**
+   * \brief wait until at least the given number of events were added since the last reset.
+   * \param numberOfEvents the number of events we are waiting for.
+   * \param milliseconds the maximum number of ms we want to wait for.
+   * \return the number of events added since the last reset.
+   */
+  long long EventsSignal::Wait(const long long numberOfEvents, const long long milliseconds)
+  {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _target = numberOfEvents;
+    _conditionVariable.wait_for(lock, std::chrono::milliseconds(milliseconds), [&]
+    {
+      return _cancelled.load() || _numberOfEvents.load() >= numberOfEvents;
+    });
+    _target = NobodyIsWaiting;
+    return _numberOfEvents.load();
+  }
+
+  /**
+   * \brief reset the number of events, usually when all the events have been collected.
+   * \return the number of events added since the previous reset.
+   */
+  long long EventsSignal::Reset()
+  {
+    return _numberOfEvents.exchange(0);
+  }
+
+  /**
+   * \brief the number of events added since the last reset.
+   */
+  long long EventsSignal::NumberOfEvents() const
+  {
+    return _numberOfEvents.load();
+  }
+
+  /**
+   * \brief stop everybody from waiting, now and until Restart() is called.
+   */
+  void EventsSignal::Cancel()
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _cancelled = true;
+    _conditionVariable.notify_all();
+  }
+
+  /**
+   * \brief allow callers to wait again after a Cancel()
+   */
+  void EventsSignal::Restart()
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _cancelled = false;
+  }
+
+  /**
+   * \brief if Cancel() was called.
+   */
+  bool EventsSignal::Cancelled() const
+  {
+    return _cancelled.load();
+  }
+}
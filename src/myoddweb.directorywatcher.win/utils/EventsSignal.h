@@ -0,0 +1,110 @@
+// Licensed to Florent Guelfucci under one or more agreements.
+// Florent Guelfucci licenses this file to you under the MIT license.
+// See the LICENSE file in the project root for more information.
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+
+namespace myoddweb
+{
+  namespace directorywatcher
+  {
+    /**
+     * \brief count the events added to one or more collectors so a publisher can wait for them
+     *        rather than polling the collectors at fixed intervals.
+     *        Notify() is cheap, it only takes the lock when someone is waiting for that many events.
+     */
+    class EventsSignal final
+    {
+    public:
+      EventsSignal();
+      ~EventsSignal() = default;
+
+      EventsSignal(const EventsSignal&) = delete;
+      EventsSignal(EventsSignal&&) = delete;
+      const EventsSignal& operator=(const EventsSignal&) = delete;
+      EventsSignal& operator=(EventsSignal&&) = delete;
+
+      /**
+       * \brief flag that one more event was added.
+       */
+      void Notify();
+
+      /**
+       * \brief set the function called when the first event is added after a reset.
+       *        this must be called before any event is added.
+       * \param firstEvent the function we will call.
+       */
+      void OnFirstEvent(std::function<void()> firstEvent);
+
+      /**
+       * \brief wait until at least the given number of events were added since the last reset.
+       * \param numberOfEvents the number of events we are waiting for.
+       * \param milliseconds the maximum number of ms we want to wait for.
+       * \return the number of events added since the last reset.
+       */
+      long long Wait(long long numberOfEvents, long long milliseconds);
+
+      /**
+       * \brief reset the number of events, usually when all the events have been collected.
+       * \return the number of events added since the previous reset.
+       */
+      long long Reset();
+
+      /**
+       * \brief the number of events added since the last reset.
+       */
+      [[nodiscard]]
+      long long NumberOfEvents() const;
+
+      /**
+       * \brief stop everybody from waiting, now and until Restart() is called.
+       */
+      void Cancel();
+
+      /**
+       * \brief allow callers to wait again after a Cancel()
+       */
+      void Restart();
+
+      /**
+       * \brief if Cancel() was called.
+       */
+      [[nodiscard]]
+      bool Cancelled() const;
+
+    private:
+      /**
+       * \brief the number of events since the last reset.
+       */
+      std::atomic<long long> _numberOfEvents;
+
+      /**
+       * \brief called when the first event is added after a reset, if set.
+       */
+      std::function<void()> _firstEvent;
+
+      /**
+       * \brief the number of events the waiting thread needs before it wakes up.
+       */
+      std::atomic<long long> _target;
+
+      /**
+       * \brief if we were cancelled.
+       */
+      std::atomic<bool> _cancelled;
+
+      /**
+       * \brief the lock for the condition variable.
+       */
+      std::mutex _mutex;
+
+      /**
+       * \brief the condition we are waiting on.
+       */
+      std::condition_variable _conditionVariable;
+    };
+  }
+}
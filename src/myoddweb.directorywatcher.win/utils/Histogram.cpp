@@ -0,0 +1,150 @@
+// Licensed to Florent Guelfucci under one or more agreements.
+// Florent Guelfucci licenses this file to you under the MIT license.
+// See the LICENSE file in the project root for more information.
+#include "Histogram.h"
+
+namespace myoddweb:: directorywatcher
+{
+  Histogram::Histogram() :
+    _counts{},
+    _count(0),
+    _max(0)
+  {
+  }
+
+  /**
+   * \brief add a value to the histogram, negative values are recorded as 0.
+   * \param value the value we are adding.
+   */
+  void Histogram::Record(long long value)
+  {
+    if (value < 0)
+    {
+      value = 0;
+    }
+    ++_counts[BucketIndex(value)];
+    ++_count;
+    if (value > _max)
+    {
+      _max = value;
+    }
+  }
+
+  /**
+   * \brief remove all the values.
+   */
+  void Histogram::Reset()
+  {
+    // nothing to do if we never recorded anything.
+    if (_count == 0)
+    {
+      return;
+    }
+    _counts.fill(0);
+    _count = 0;
+    _max = 0;
+  }
+
+  /**
+   * \brief the number of values recorded.
+   */
+  long long Histogram::Count() const
+  {
+    return _count;
+  }
+
+  /**
+   * \brief the largest value recorded, 0 if we have none.
+   */
+  long long Histogram::Max() const
+  {
+    return _max;
+  }
+
+  /**
+   * \brief get the value at a given percentile.
+   * \param percentile the percentile, between 0 and 100.
+   * \return the highest value of the bucket the percentile is in, 0 if we have no values.
+   */
+  long long Histogram::ValueAtPercentile(const double percentile) const
+  {
+    if (_count == 0)
+    {
+      return 0;
+    }
+
+    // the number of values that must be at, or below, the value we are looking for.
+    auto target = static_cast<long long>(static_cast<double>(_count) * (percentile < 0 ? 0 : percentile > 100 ? 100 : percentile) / 100.0 + 0.5);
+    if (target < 1)
+    {
+      target = 1;
+    }
+
+    long long total = 0;
+    for (auto i = 0; i < NumberOfBuckets; ++i)
+    {
+      total += _counts[i];
+      if (total >= target)
+      {
+        // the bucket might go past the largest value we actually recorded.
+        const auto value = BucketHighestValue(i);
+        return value > _max ? _max : value;
+      }
+    }
+    return _max;
+  }
+
+  /**
+   * \brief get the bucket a value belongs to.
+   * \param value the positive value.
+   * \return the index of the bucket.
+   */
+  int Histogram::BucketIndex(const long long value)
+  {
+    // the small values have a bucket each.
+    if (value < SubBucketCount)
+    {
+      return static_cast<int>(value);
+    }
+
+    // then we use the top bits of the value for the linear bucket within its power of 2.
+    const auto shift = MostSignificantBit(static_cast<unsigned long long>(value)) - SubBucketBits;
+    const auto subBucket = static_cast<int>(value >> shift) - SubBucketCount;
+    return SubBucketCount + shift * SubBucketCount + subBucket;
+  }
+
+  /**
+   * \brief the highest value that belongs to a bucket.
+   * \param index the index of the bucket.
+   * \return the highest value.
+   */
+  long long Histogram::BucketHighestValue(const int index)
+  {
+    if (index < SubBucketCount)
+    {
+      return index;
+    }
+    const auto shift = (index - SubBucketCount) / SubBucketCount;
+    const auto subBucket = static_cast<unsigned long long>((index - SubBucketCount) % SubBucketCount + SubBucketCount);
+    return static_cast<long long>(((subBucket + 1) << shift) - 1);
+  }
+
+  /**
+   * \brief the position of the most significant bit of a positive value.
+   * \param value the value, must be greater than 0.
+   * \return the position, 0 for the lowest bit.
+   */
+  int Histogram::MostSignificantBit(unsigned long long value)
+  {
+    auto position = 0;
+    for (auto bits = 32; bits > 0; bits >>= 1)
+    {
+      if (value >> bits)
+      {
+        value >>= bits;
+        position += bits;
+      }
+    }
+    return position;
+  }
+}
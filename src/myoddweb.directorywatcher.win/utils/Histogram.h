@@ -0,0 +1,112 @@
+// Licensed to Florent Guelfucci under one or more agreements.
+// Florent Guelfucci licenses this file to you under the MIT license.
+// See the LICENSE file in the project root for more information.
+#pragma once
+#include <array>
+
+namespace myoddweb
+{
+  namespace directorywatcher
+  {
+    /**
+     * \brief log-linear histogram, (HDR style), of positive values.
+     *        each power of 2 is split in 16 linear buckets so the values are within ~6% of the recorded ones.
+     *        recording a value is a couple of shifts and an increment, there are no allocations.
+     *        this class is not thread safe.
+     */
+    class Histogram final
+    {
+    public:
+      Histogram();
+      ~Histogram() = default;
+
+      Histogram(const Histogram&) = delete;
+      Histogram(Histogram&&) = delete;
+      const Histogram& operator=(const Histogram&) = delete;
+      Histogram& operator=(Histogram&&) = delete;
+
+      /**
+       * \brief add a value to the histogram, negative values are recorded as 0.
+       * \param value the value we are adding.
+       */
+      void Record(long long value);
+
+      /**
+       * \brief remove all the values.
+       */
+      void Reset();
+
+      /**
+       * \brief the number of values recorded.
+       */
+      [[nodiscard]]
+      long long Count() const;
+
+      /**
+       * \brief the largest value recorded, 0 if we have none.
+       */
+      [[nodiscard]]
+      long long Max() const;
+
+      /**
+       * \brief get the value at a given percentile.
+       * \param percentile the percentile, between 0 and 100.
+       * \return the highest value of the bucket the percentile is in, 0 if we have no values.
+       */
+      [[nodiscard]]
+      long long ValueAtPercentile(double percentile) const;
+
+    private:
+      /**
+       * \brief the number of bits used for the linear buckets within a power of 2.
+       */
+      static constexpr int SubBucketBits = 4;
+
+      /**
+       * \brief the number of linear buckets within a power of 2.
+       */
+      static constexpr int SubBucketCount = 1 << SubBucketBits;
+
+      /**
+       * \brief the total number of buckets we need for all the positive long long values.
+       */
+      static constexpr int NumberOfBuckets = SubBucketCount + (63 - SubBucketBits) * SubBucketCount;
+
+      /**
+       * \brief get the bucket a value belongs to.
+       * \param value the positive value.
+       * \return the index of the bucket.
+       */
+      static int BucketIndex(long long value);
+
+      /**
+       * \brief the highest value that belongs to a bucket.
+       * \param index the index of the bucket.
+       * \return the highest value.
+       */
+      static long long BucketHighestValue(int index);
+
+      /**
+       * \brief the position of the most significant bit of a positive value.
+       * \param value the value, must be greater than 0.
+       * \return the position, 0 for the lowest bit.
+       */
+      static int MostSignificantBit(unsigned long long value);
+
+      /**
+       * \brief the number of values in each bucket.
+       */
+      std::array<long long, NumberOfBuckets> _counts;
+
+      /**
+       * \brief the number of values recorded.
+       */
+      long long _count;
+
+      /**
+       * \brief the largest value recorded.
+       */
+      long long _max;
+    };
+  }
+}
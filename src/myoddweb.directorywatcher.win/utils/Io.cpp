@@ -129,6 +129,59 @@ namespace myoddweb
       return Combine(lhs.substr(0, sl - 1), rhs.substr(1, sr - 1));
     }
 
+    /**
+     * \brief combine 2 paths together without allocating any memory.
+     * This follows the same rules as Combine( lhs, rhs )
+     * \param lhs the left hand side of the path
+     * \param rhs the right hand side of the path
+     * \param buffer where we will write the null terminated path, if nullptr we only return the length.
+     * \return the number of characters in the combined path, not including the null terminator.
+     */
+    size_t Io::Combine(const std::wstring_view lhs, const std::wstring_view rhs, wchar_t* buffer)
+    {
+      // the two type of separators.
+      const auto sep1 = L'/';
+      const auto sep2 = L'\\';
+
+      // and the one we will be using
+#ifdef WIN32
+      const auto sep = L'\\';
+#else
+      const auto sep = L'/';
+#endif
+
+      // remove all the separators at the end of the lhs
+      auto sl = lhs.length();
+      while (sl > 0 && (lhs[sl - 1] == sep1 || lhs[sl - 1] == sep2))
+      {
+        --sl;
+      }
+
+      // and all the separators at the start of the rhs
+      const auto sr = rhs.length();
+      size_t start = 0;
+      while (start < sr && (rhs[start] == sep1 || rhs[start] == sep2))
+      {
+        ++start;
+      }
+
+      // if both are empty, then we return an empty string
+      const auto length = (sl == 0 && start == sr) ? 0 : sl + 1 + (sr - start);
+      if (buffer == nullptr)
+      {
+        return length;
+      }
+
+      if (length > 0)
+      {
+        wmemcpy(buffer, lhs.data(), sl);
+        buffer[sl] = sep;
+        wmemcpy(buffer + sl + 1, rhs.data() + start, sr - start);
+      }
+      buffer[length] = L'\0';
+      return length;
+    }
+
     /**
      * \brief Check if a given directory is a dot or double dot
      * \param directory the lhs folder.
@@ -1,5 +1,6 @@
 #pragma once
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace myoddweb
@@ -27,6 +28,16 @@ namespace myoddweb
        */
       static std::wstring Combine(const std::wstring& lhs, const std::wstring& rhs);
 
+      /**
+       * \brief combine 2 paths together without allocating any memory.
+       * This follows the same rules as Combine( lhs, rhs )
+       * \param lhs the left hand side of the path
+       * \param rhs the right hand side of the path
+       * \param buffer where we will write the null terminated path, if nullptr we only return the length.
+       * \return the number of characters in the combined path, not including the null terminator.
+       */
+      static size_t Combine(std::wstring_view lhs, std::wstring_view rhs, wchar_t* buffer);
+
       /**
        * \brief check if a given string is a file or a directory.
        * \param path the file we are checking.
@@ -159,6 +159,48 @@ namespace myoddweb:: directorywatcher
     }
   }
 
+  /**
+   * \brief copy the pending events of a monitor to the given buffers.
+   * \param id the id of the monitor.
+   * \param events where we will copy the events.
+   * \param eventsCapacity the number of events we can copy.
+   * \param names where we will copy the null terminated names of the events.
+   * \param namesCapacity the number of characters we can copy.
+   * \param numberOfEvents the number of events we copied.
+   * \param numberOfCharacters the number of characters we copied.
+   * \return the number of events still pending or -ve if the monitor does not exist or does not pull its events.
+   */
+  long long MonitorsManager::GetEvents(const long long id, sEvent* events, const int eventsCapacity, wchar_t* names, const int namesCapacity, int& numberOfEvents, int& numberOfCharacters)
+  {
+    MYODDWEB_PROFILE_FUNCTION();
+    numberOfEvents = 0;
+    numberOfCharacters = 0;
+    try
+    {
+      // the lock prevents the monitor from being stopped while we copy the events.
+      MYODDWEB_LOCK(_lock);
+
+      // if we do not have an instance... then we have nothing.
+      if (_instance == nullptr)
+      {
+        return -1;
+      }
+
+      const auto monitor = _instance->_monitors.find(id);
+      if (monitor == _instance->_monitors.end())
+      {
+        return -1;
+      }
+      return monitor->second->PullEvents(events, eventsCapacity, names, namesCapacity, numberOfEvents, numberOfCharacters);
+    }
+    catch (std::exception& e)
+    {
+      // log the error
+      Logger::Log(id, LogLevel::Error, L"Caught exception '%hs' trying to get the events of a monitor!", e.what());
+      return -1;
+    }
+  }
+
   /***
    * \brief Create a monitor instance and add it to the list.
    * \param request the request we are creating
@@ -39,6 +39,19 @@ namespace myoddweb:: directorywatcher
      * \return if it is ready or not.
      */
     static bool Ready();
+
+    /**
+     * \brief copy the pending events of a monitor to the given buffers.
+     * \param id the id of the monitor.
+     * \param events where we will copy the events.
+     * \param eventsCapacity the number of events we can copy.
+     * \param names where we will copy the null terminated names of the events.
+     * \param namesCapacity the number of characters we can copy.
+     * \param numberOfEvents the number of events we copied.
+     * \param numberOfCharacters the number of characters we copied.
+     * \return the number of events still pending or -ve if the monitor does not exist or does not pull its events.
+     */
+    static long long GetEvents(long long id, sEvent* events, int eventsCapacity, wchar_t* names, int namesCapacity, int& numberOfEvents, int& numberOfCharacters);
     
   protected:
     /**
@@ -0,0 +1,34 @@
+﻿// Licensed to Florent Guelfucci under one or more agreements.
+// Florent Guelfucci licenses this file to you under the MIT license.
+// See the LICENSE file in the project root for more information.
+#pragma once
+
+namespace myoddweb
+{
+  namespace directorywatcher
+  {
+    /**
+     * \brief what the collector does when it holds more events, (or bytes), than it is allowed to.
+     *        in all cases an EventError::Overflow event is added.
+     */
+    enum class OverflowPolicy
+    {
+      /**
+       * \brief remove the oldest events first.
+       */
+      DropOldest = 0,
+
+      /**
+       * \brief remove the touched events first, oldest first,
+       *        then the oldest events if we still have too many.
+       */
+      DropTouchedFirst = 1,
+
+      /**
+       * \brief replace all the events of a directory with a single 'something changed' event
+       *        then the oldest events if we still have too many.
+       */
+      CollapseToDirectory = 2,
+    };
+  }
+}
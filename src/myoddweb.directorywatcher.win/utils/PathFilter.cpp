@@ -0,0 +1,507 @@
+// Licensed to Florent Guelfucci under one or more agreements.
+// Florent Guelfucci licenses this file to you under the MIT license.
+// See the LICENSE file in the project root for more information.
+#include <algorithm>
+#include <cwctype>
+#include "PathFilter.h"
+
+namespace myoddweb:: directorywatcher
+{
+  PathFilter::PathFilter(const std::wstring& includePatterns, const std::wstring& excludePatterns, const wchar_t* root, const wchar_t* path) :
+    _prefixIncluded(false),
+    _prefixExcluded(false)
+  {
+    Compile(includePatterns, _includes);
+    Compile(excludePatterns, _excludes);
+
+    // if we are watching a sub folder, the patterns are still relative to the root.
+    if (root == nullptr || path == nullptr)
+    {
+      return;
+    }
+    const auto rootView = std::wstring_view(root);
+    auto relative = std::wstring_view(path);
+    if (relative.size() <= rootView.size() || !Equal()(relative.substr(0, rootView.size()), rootView))
+    {
+      return;
+    }
+    relative.remove_prefix(rootView.size());
+    while (!relative.empty() && relative.front() == L'\\')
+    {
+      relative.remove_prefix(1);
+    }
+    while (!relative.empty() && relative.back() == L'\\')
+    {
+      relative.remove_suffix(1);
+    }
+    if (relative.empty())
+    {
+      return;
+    }
+
+    // the folder itself could be matched, in that case so is everything in it.
+    _prefixIncluded = Matches(relative, _includes);
+    _prefixExcluded = Matches(relative, _excludes);
+    _prefix = std::wstring(relative) + L'\\';
+  }
+
+  /**
+   * \brief if we have no patterns at all.
+   */
+  bool PathFilter::IsEmpty() const
+  {
+    return _includes.empty && _excludes.empty;
+  }
+
+  /**
+   * \brief check if a path matches one of the include patterns.
+   * \param path the path relative to the watched path.
+   * \return true if it matches or if we have no include patterns.
+   */
+  bool PathFilter::IsIncluded(const std::wstring_view& path) const
+  {
+    if (_includes.empty || _prefixIncluded)
+    {
+      return true;
+    }
+    return Matches(path, _includes);
+  }
+
+  /**
+   * \brief check if a path matches one of the exclude patterns.
+   * \param path the path relative to the watched path.
+   * \return true if it matches.
+   */
+  bool PathFilter::IsExcluded(const std::wstring_view& path) const
+  {
+    if (_excludes.empty)
+    {
+      return false;
+    }
+    if (_prefixExcluded)
+    {
+      return true;
+    }
+    return Matches(path, _excludes);
+  }
+
+  /**
+   * \brief split the patterns and add them to the list.
+   * \param patterns the '|' separated patterns.
+   * \param compiled where we are adding the patterns.
+   */
+  void PathFilter::Compile(const std::wstring& patterns, Patterns& compiled)
+  {
+    size_t start = 0;
+    while (start <= patterns.size())
+    {
+      auto end = patterns.find(L'|', start);
+      if (end == std::wstring::npos)
+      {
+        end = patterns.size();
+      }
+      auto pattern = patterns.substr(start, end - start);
+      std::replace(pattern.begin(), pattern.end(), L'/', L'\\');
+      std::transform(pattern.begin(), pattern.end(), pattern.begin(), Lower);
+      Add(std::move(pattern), compiled);
+      start = end + 1;
+    }
+  }
+
+  /**
+   * \brief add a single pattern to the list.
+   * \param pattern the pattern, with '\' separators.
+   * \param compiled where we are adding the pattern.
+   */
+  void PathFilter::Add(std::wstring pattern, Patterns& compiled)
+  {
+    // trim the spaces and the trailing separators, "bin\" is the same as "bin"
+    const auto last = pattern.find_last_not_of(L" \t\\");
+    if (last == std::wstring::npos)
+    {
+      return;
+    }
+    pattern.erase(last + 1);
+    const auto first = pattern.find_first_not_of(L" \t");
+    pattern.erase(0, first);
+
+    // a leading separator anchors the pattern to the root.
+    const auto isPath = pattern.front() == L'\\' || pattern.find(L'\\') != std::wstring::npos;
+    pattern.erase(0, pattern.find_first_not_of(L'\\'));
+    compiled.empty = false;
+
+    if (isPath)
+    {
+      // "folder\**" is everything in the folder, and we already match the content of the folders.
+      while (pattern.size() > 3 && pattern.compare(pattern.size() - 3, 3, L"\\**") == 0 && pattern.find_first_of(L"*?") == pattern.size() - 2)
+      {
+        pattern.erase(pattern.size() - 3);
+      }
+
+      const auto wildcard = pattern.find_first_of(L"*?");
+      if (wildcard == std::wstring::npos)
+      {
+        AddToSet(std::move(pattern), compiled.pathLiterals, compiled);
+        return;
+      }
+      if (wildcard == 0)
+      {
+        compiled.pathGlobs.push_back(std::move(pattern));
+        return;
+      }
+      auto key = pattern.substr(0, wildcard);
+      AddToGlobIndex(std::move(key), std::move(pattern), compiled.pathGlobsByPrefix, compiled);
+      return;
+    }
+
+    const auto wildcard = pattern.find_first_of(L"*?");
+    if (wildcard == std::wstring::npos)
+    {
+      AddToSet(std::move(pattern), compiled.segmentLiterals, compiled);
+      return;
+    }
+
+    // "*suffix", (like "*.tmp"), and "prefix*", (like "~$*"), are the most common.
+    const auto lastWildcard = pattern.find_last_of(L"*?");
+    if (wildcard == 0 && lastWildcard == 0 && pattern.size() > 1 && pattern[0] == L'*')
+    {
+      AddToIndex(pattern.substr(1), compiled.segmentSuffixes, compiled);
+      return;
+    }
+    if (wildcard == pattern.size() - 1 && wildcard > 0 && pattern[wildcard] == L'*')
+    {
+      AddToIndex(pattern.substr(0, wildcard), compiled.segmentPrefixes, compiled);
+      return;
+    }
+
+    // otherwise we group the globs by whatever literal they start, or end, with.
+    if (wildcard > 0)
+    {
+      auto key = pattern.substr(0, wildcard);
+      AddToGlobIndex(std::move(key), std::move(pattern), compiled.segmentGlobsByPrefix, compiled);
+      return;
+    }
+    if (lastWildcard < pattern.size() - 1)
+    {
+      auto key = pattern.substr(lastWildcard + 1);
+      AddToGlobIndex(std::move(key), std::move(pattern), compiled.segmentGlobsBySuffix, compiled);
+      return;
+    }
+    compiled.segmentGlobs.push_back(std::move(pattern));
+  }
+
+  /**
+   * \brief add a string to a set.
+   * \param value the value we are adding.
+   * \param set the set we are adding the value to.
+   * \param compiled the list that owns the value.
+   */
+  void PathFilter::AddToSet(std::wstring value, Set& set, Patterns& compiled)
+  {
+    if (set.find(value) != set.end())
+    {
+      return;
+    }
+    compiled.storage.push_back(std::move(value));
+    set.insert(compiled.storage.back());
+  }
+
+  /**
+   * \brief add a string to an index.
+   * \param value the value we are adding.
+   * \param index the index we are adding the value to.
+   * \param compiled the list that owns the value.
+   */
+  void PathFilter::AddToIndex(std::wstring value, Index& index, Patterns& compiled)
+  {
+    if (std::find(index.lengths.begin(), index.lengths.end(), value.size()) == index.lengths.end())
+    {
+      index.lengths.push_back(value.size());
+      std::sort(index.lengths.begin(), index.lengths.end());
+    }
+    AddToSet(std::move(value), index.values, compiled);
+  }
+
+  /**
+   * \brief add a glob to an index.
+   * \param key the literal start, or end, of the glob.
+   * \param glob the glob we are adding.
+   * \param index the index we are adding the glob to.
+   * \param compiled the list that owns the key.
+   */
+  void PathFilter::AddToGlobIndex(std::wstring key, std::wstring glob, GlobIndex& index, Patterns& compiled)
+  {
+    const auto it = index.globs.find(key);
+    if (it != index.globs.end())
+    {
+      it->second.push_back(std::move(glob));
+      return;
+    }
+    if (std::find(index.lengths.begin(), index.lengths.end(), key.size()) == index.lengths.end())
+    {
+      index.lengths.push_back(key.size());
+      std::sort(index.lengths.begin(), index.lengths.end());
+    }
+    compiled.storage.push_back(std::move(key));
+    index.globs[compiled.storage.back()].push_back(std::move(glob));
+  }
+
+  /**
+   * \brief check if the start, or the end, of a value is in the index.
+   * \param value the value we are checking.
+   * \param index the index.
+   * \param suffix if we are checking the end of the value rather than the start.
+   * \return if we have a match.
+   */
+  bool PathFilter::MatchesIndex(const std::wstring_view& value, const Index& index, const bool suffix)
+  {
+    for (const auto& length : index.lengths)
+    {
+      if (length > value.size())
+      {
+        break;
+      }
+      const auto part = suffix ? value.substr(value.size() - length) : value.substr(0, length);
+      if (index.values.find(part) != index.values.end())
+      {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /**
+   * \brief check if a value matches any of the globs with the same start, or end.
+   * \param value the value we are checking.
+   * \param index the globs.
+   * \param suffix if the globs are grouped by the end of the value rather than the start.
+   * \return if we have a match.
+   */
+  bool PathFilter::MatchesGlobIndex(const std::wstring_view& value, const GlobIndex& index, const bool suffix)
+  {
+    for (const auto& length : index.lengths)
+    {
+      if (length > value.size())
+      {
+        break;
+      }
+      const auto part = suffix ? value.substr(value.size() - length) : value.substr(0, length);
+      const auto it = index.globs.find(part);
+      if (it != index.globs.end() && MatchesGlobs(value, it->second))
+      {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /**
+   * \brief check if a value matches any of the globs.
+   * \param value the value we are checking.
+   * \param globs the globs.
+   * \return if we have a match.
+   */
+  bool PathFilter::MatchesGlobs(const std::wstring_view& value, const std::vector<std::wstring>& globs)
+  {
+    for (const auto& glob : globs)
+    {
+      if (Glob(glob, value))
+      {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /**
+   * \brief check if a path matches any of the patterns.
+   * \param path the path relative to the watched path.
+   * \param compiled the patterns.
+   * \return if we have a match.
+   */
+  bool PathFilter::Matches(const std::wstring_view& path, const Patterns& compiled) const
+  {
+    if (compiled.empty)
+    {
+      return false;
+    }
+
+    // check each part of the path.
+    size_t start = 0;
+    for (;;)
+    {
+      const auto end = path.find(L'\\', start);
+      const auto segment = path.substr(start, end == std::wstring_view::npos ? std::wstring_view::npos : end - start);
+      if (!segment.empty() && MatchesSegment(segment, compiled))
+      {
+        return true;
+      }
+      if (end == std::wstring_view::npos)
+      {
+        break;
+      }
+      start = end + 1;
+    }
+
+    if (compiled.pathLiterals.empty() && compiled.pathGlobsByPrefix.globs.empty() && compiled.pathGlobs.empty())
+    {
+      return false;
+    }
+    if (_prefix.empty())
+    {
+      return MatchesPath(path, compiled);
+    }
+
+    // we only build the full path if we really have to
+    // and the buffer is reused so we do not allocate every time.
+    thread_local std::wstring fullPath;
+    fullPath.assign(_prefix).append(path);
+    return MatchesPath(fullPath, compiled);
+  }
+
+  /**
+   * \brief check if a part of the path matches any of the patterns.
+   * \param segment the part of the path, without any separators.
+   * \param compiled the patterns.
+   * \return if we have a match.
+   */
+  bool PathFilter::MatchesSegment(const std::wstring_view& segment, const Patterns& compiled)
+  {
+    return compiled.segmentLiterals.find(segment) != compiled.segmentLiterals.end()
+      || MatchesIndex(segment, compiled.segmentSuffixes, true)
+      || MatchesIndex(segment, compiled.segmentPrefixes, false)
+      || MatchesGlobIndex(segment, compiled.segmentGlobsByPrefix, false)
+      || MatchesGlobIndex(segment, compiled.segmentGlobsBySuffix, true)
+      || MatchesGlobs(segment, compiled.segmentGlobs);
+  }
+
+  /**
+   * \brief check if the path, or one of its folders, matches any of the patterns.
+   * \param path the path relative to the root of the patterns.
+   * \param compiled the patterns.
+   * \return if we have a match.
+   */
+  bool PathFilter::MatchesPath(const std::wstring_view& path, const Patterns& compiled)
+  {
+    size_t end = 0;
+    for (;;)
+    {
+      end = path.find(L'\\', end);
+      const auto folder = path.substr(0, end);
+      if (!folder.empty())
+      {
+        if (compiled.pathLiterals.find(folder) != compiled.pathLiterals.end()
+          || MatchesGlobIndex(folder, compiled.pathGlobsByPrefix, false)
+          || MatchesGlobs(folder, compiled.pathGlobs))
+        {
+          return true;
+        }
+      }
+      if (end == std::wstring_view::npos)
+      {
+        return false;
+      }
+      ++end;
+    }
+  }
+
+  /**
+   * \brief case insensitive glob matching.
+   * \param pattern the pattern we are matching, in lower case.
+   * \param value the value we are checking.
+   * \return if the value matches the pattern.
+   */
+  bool PathFilter::Glob(const std::wstring_view& pattern, const std::wstring_view& value)
+  {
+    size_t p = 0;
+    size_t v = 0;
+    while (p < pattern.size())
+    {
+      if (pattern[p] == L'*')
+      {
+        const auto anything = p + 1 < pattern.size() && pattern[p + 1] == L'*';
+        p += anything ? 2 : 1;
+
+        // "a\**\b" also matches "a\b"
+        if (anything && p < pattern.size() && pattern[p] == L'\\' && Glob(pattern.substr(p + 1), value.substr(v)))
+        {
+          return true;
+        }
+        for (;; ++v)
+        {
+          if (Glob(pattern.substr(p), value.substr(v)))
+          {
+            return true;
+          }
+          if (v == value.size() || (!anything && value[v] == L'\\'))
+          {
+            return false;
+          }
+        }
+      }
+
+      if (v == value.size())
+      {
+        return false;
+      }
+      if (pattern[p] == L'?')
+      {
+        if (value[v] == L'\\')
+        {
+          return false;
+        }
+      }
+      else if (pattern[p] != Lower(value[v]))
+      {
+        return false;
+      }
+      ++p;
+      ++v;
+    }
+    return v == value.size();
+  }
+
+  /**
+   * \brief the lower case of a character.
+   */
+  wchar_t PathFilter::Lower(const wchar_t c)
+  {
+    if (c < 128)
+    {
+      return c >= L'A' && c <= L'Z' ? static_cast<wchar_t>(c + (L'a' - L'A')) : c;
+    }
+    return static_cast<wchar_t>(std::towlower(c));
+  }
+
+  /**
+   * \brief case insensitive hash of a path.
+   */
+  size_t PathFilter::Hash::operator()(const std::wstring_view& value) const noexcept
+  {
+    size_t hash = 0;
+    for (const auto& c : value)
+    {
+      hash = hash * 31 + static_cast<size_t>(Lower(c));
+    }
+    return hash;
+  }
+
+  /**
+   * \brief case insensitive comparison of two paths.
+   */
+  bool PathFilter::Equal::operator()(const std::wstring_view& lhs, const std::wstring_view& rhs) const noexcept
+  {
+    if (lhs.size() != rhs.size())
+    {
+      return false;
+    }
+    for (size_t i = 0; i < lhs.size(); ++i)
+    {
+      if (Lower(lhs[i]) != Lower(rhs[i]))
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+}
@@ -0,0 +1,296 @@
+// Licensed to Florent Guelfucci under one or more agreements.
+// Florent Guelfucci licenses this file to you under the MIT license.
+// See the LICENSE file in the project root for more information.
+#pragma once
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace myoddweb
+{
+  namespace directorywatcher
+  {
+    /**
+     * \brief the include/exclude glob patterns of a request, compiled so we can check a path
+     *        before we create any string or add anything to the collector.
+     *        the patterns are separated by '|' and are not case sensitive.
+     *        - '*' matches anything but a separator, '**' matches anything and '?' matches one character.
+     *        - a pattern without a separator, (like "*.tmp" or ".git"), matches any part of the path
+     *          so the content of a matching folder is matched as well.
+     *        - a pattern with a separator, (like "bin\**" or "src\*.cs"), matches the path from the root
+     *          as well as the content of a matching folder.
+     *        the literal, "*suffix" and "prefix*" patterns are looked up in hash sets and the other globs
+     *        are grouped by their literal start, or end, so thousands of them cost no more than a handful.
+     */
+    class PathFilter final
+    {
+    public:
+      /**
+       * \brief compile the patterns.
+       * \param includePatterns the patterns that the paths must match, if empty all the paths are included.
+       * \param excludePatterns the patterns that the paths must not match.
+       * \param root the path the patterns are relative to.
+       * \param path the path we are watching, the paths we are given are relative to this path.
+       */
+      PathFilter(const std::wstring& includePatterns, const std::wstring& excludePatterns, const wchar_t* root, const wchar_t* path);
+      ~PathFilter() = default;
+
+      PathFilter(const PathFilter&) = delete;
+      PathFilter(PathFilter&&) = delete;
+      const PathFilter& operator=(const PathFilter&) = delete;
+      PathFilter& operator=(PathFilter&&) = delete;
+
+      /**
+       * \brief if we have no patterns at all.
+       */
+      [[nodiscard]]
+      bool IsEmpty() const;
+
+      /**
+       * \brief check if a path matches one of the include patterns.
+       * \param path the path relative to the watched path.
+       * \return true if it matches or if we have no include patterns.
+       */
+      [[nodiscard]]
+      bool IsIncluded(const std::wstring_view& path) const;
+
+      /**
+       * \brief check if a path matches one of the exclude patterns.
+       * \param path the path relative to the watched path.
+       * \return true if it matches.
+       */
+      [[nodiscard]]
+      bool IsExcluded(const std::wstring_view& path) const;
+
+      /**
+       * \brief case insensitive hash of a path.
+       */
+      struct Hash
+      {
+        size_t operator()(const std::wstring_view& value) const noexcept;
+      };
+
+    private:
+      /**
+       * \brief case insensitive comparison of two paths.
+       */
+      struct Equal
+      {
+        bool operator()(const std::wstring_view& lhs, const std::wstring_view& rhs) const noexcept;
+      };
+
+      typedef std::unordered_set<std::wstring_view, Hash, Equal> Set;
+      typedef std::unordered_map<std::wstring_view, std::vector<std::wstring>, Hash, Equal> GlobMap;
+
+      /**
+       * \brief the start, or the end, of the values we are looking for and the distinct lengths of those.
+       */
+      struct Index
+      {
+        Set values;
+        std::vector<size_t> lengths;
+      };
+
+      /**
+       * \brief the globs grouped by the literal start, or end, of the pattern so we only check the few that could match.
+       */
+      struct GlobIndex
+      {
+        GlobMap globs;
+        std::vector<size_t> lengths;
+      };
+
+      /**
+       * \brief the compiled patterns of one list.
+       */
+      struct Patterns
+      {
+        /**
+         * \brief the patterns themselves, the sets point to them.
+         */
+        std::deque<std::wstring> storage;
+
+        /**
+         * \brief the patterns without any wildcard that match a part of the path.
+         */
+        Set segmentLiterals;
+
+        /**
+         * \brief the "*suffix" patterns that match a part of the path.
+         */
+        Index segmentSuffixes;
+
+        /**
+         * \brief the "prefix*" patterns that match a part of the path.
+         */
+        Index segmentPrefixes;
+
+        /**
+         * \brief the other patterns that match a part of the path, by their literal start.
+         */
+        GlobIndex segmentGlobsByPrefix;
+
+        /**
+         * \brief the other patterns that match a part of the path, that start with a wildcard, by their literal end.
+         */
+        GlobIndex segmentGlobsBySuffix;
+
+        /**
+         * \brief the patterns that match a part of the path and have a wildcard at both ends.
+         */
+        std::vector<std::wstring> segmentGlobs;
+
+        /**
+         * \brief the patterns without any wildcard that match the path from the root.
+         */
+        Set pathLiterals;
+
+        /**
+         * \brief the other patterns that match the path from the root, by their literal start.
+         */
+        GlobIndex pathGlobsByPrefix;
+
+        /**
+         * \brief the patterns that match the path from the root and start with a wildcard.
+         */
+        std::vector<std::wstring> pathGlobs;
+
+        /**
+         * \brief if we have no patterns.
+         */
+        bool empty = true;
+      };
+
+      /**
+       * \brief split the patterns and add them to the list.
+       * \param patterns the '|' separated patterns.
+       * \param compiled where we are adding the patterns.
+       */
+      static void Compile(const std::wstring& patterns, Patterns& compiled);
+
+      /**
+       * \brief add a single pattern to the list.
+       * \param pattern the pattern, with '\' separators.
+       * \param compiled where we are adding the pattern.
+       */
+      static void Add(std::wstring pattern, Patterns& compiled);
+
+      /**
+       * \brief add a string to a set.
+       * \param value the value we are adding.
+       * \param set the set we are adding the value to.
+       * \param compiled the list that owns the value.
+       */
+      static void AddToSet(std::wstring value, Set& set, Patterns& compiled);
+
+      /**
+       * \brief add a string to an index.
+       * \param value the value we are adding.
+       * \param index the index we are adding the value to.
+       * \param compiled the list that owns the value.
+       */
+      static void AddToIndex(std::wstring value, Index& index, Patterns& compiled);
+
+      /**
+       * \brief add a glob to an index.
+       * \param key the literal start, or end, of the glob.
+       * \param glob the glob we are adding.
+       * \param index the index we are adding the glob to.
+       * \param compiled the list that owns the key.
+       */
+      static void AddToGlobIndex(std::wstring key, std::wstring glob, GlobIndex& index, Patterns& compiled);
+
+      /**
+       * \brief check if the start, or the end, of a value is in the index.
+       * \param value the value we are checking.
+       * \param index the index.
+       * \param suffix if we are checking the end of the value rather than the start.
+       * \return if we have a match.
+       */
+      static bool MatchesIndex(const std::wstring_view& value, const Index& index, bool suffix);
+
+      /**
+       * \brief check if a value matches any of the globs with the same start, or end.
+       * \param value the value we are checking.
+       * \param index the globs.
+       * \param suffix if the globs are grouped by the end of the value rather than the start.
+       * \return if we have a match.
+       */
+      static bool MatchesGlobIndex(const std::wstring_view& value, const GlobIndex& index, bool suffix);
+
+      /**
+       * \brief check if a value matches any of the globs.
+       * \param value the value we are checking.
+       * \param globs the globs.
+       * \return if we have a match.
+       */
+      static bool MatchesGlobs(const std::wstring_view& value, const std::vector<std::wstring>& globs);
+
+      /**
+       * \brief check if a path matches any of the patterns.
+       * \param path the path relative to the watched path.
+       * \param compiled the patterns.
+       * \return if we have a match.
+       */
+      bool Matches(const std::wstring_view& path, const Patterns& compiled) const;
+
+      /**
+       * \brief check if a part of the path matches any of the patterns.
+       * \param segment the part of the path, without any separators.
+       * \param compiled the patterns.
+       * \return if we have a match.
+       */
+      static bool MatchesSegment(const std::wstring_view& segment, const Patterns& compiled);
+
+      /**
+       * \brief check if the path, or one of its folders, matches any of the patterns.
+       * \param path the path relative to the root of the patterns.
+       * \param compiled the patterns.
+       * \return if we have a match.
+       */
+      static bool MatchesPath(const std::wstring_view& path, const Patterns& compiled);
+
+      /**
+       * \brief case insensitive glob matching.
+       * \param pattern the pattern we are matching, in lower case.
+       * \param value the value we are checking.
+       * \return if the value matches the pattern.
+       */
+      static bool Glob(const std::wstring_view& pattern, const std::wstring_view& value);
+
+      /**
+       * \brief the lower case of a character.
+       */
+      static wchar_t Lower(wchar_t c);
+
+      /**
+       * \brief the patterns that paths must match.
+       */
+      Patterns _includes;
+
+      /**
+       * \brief the patterns that paths must not match.
+       */
+      Patterns _excludes;
+
+      /**
+       * \brief the path we are watching, relative to the root of the patterns, with a trailing separator.
+       *        this is empty unless we are watching a sub folder of the root.
+       */
+      std::wstring _prefix;
+
+      /**
+       * \brief if the path we are watching matches one of the include patterns, so everything in it does.
+       */
+      bool _prefixIncluded;
+
+      /**
+       * \brief if the path we are watching matches one of the exclude patterns, so everything in it does.
+       */
+      bool _prefixExcluded;
+    };
+  }
+}
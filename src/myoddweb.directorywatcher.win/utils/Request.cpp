@@ -16,7 +16,24 @@ namespace myoddweb:: directorywatcher
     _statisticsCallback(nullptr),
     _eventsCallbackRateMs(0),
     _statisticsCallbackRateMs(0),
-    _loggerCallback(nullptr)
+    _loggerCallback(nullptr),
+    _coalesceEvents(false),
+    _maxNumberOfEvents(0),
+    _maxNumberOfBytes(0),
+    _overflowPolicy(myoddweb::directorywatcher::OverflowPolicy::DropOldest),
+    _collectorShards(1),
+    _renamePairingMs(0),
+    _eventsBatchCallback(nullptr),
+    _pullEvents(false),
+    _lowLatencyEvents(false),
+    _maxBatchDelayMs(0),
+    _maxBatchSize(0),
+    _statisticsExCallback(nullptr),
+    _dispatchQueueSize(0),
+    _dispatchThreads(1),
+    _actionsMask(static_cast<int>(myoddweb::directorywatcher::ActionsMask::All)),
+    _changesMask(static_cast<int>(myoddweb::directorywatcher::ChangesMask::All)),
+    _keepFolderEvents(false)
   {
   }
 
@@ -69,6 +86,30 @@ namespace myoddweb:: directorywatcher
     Assign(path, recursive, nullptr, nullptr, nullptr, eventsCallbackRateMs, statisticsCallbackRateMs);
   }
 
+  /**
+   * \brief create a child request from a parent request, (no callback)
+   *        the rates, the limits, the shards, the rename pairing, the patterns and the masks of the parent are used.
+   *        a non recursive child always keeps the folders events, (see KeepFolderEvents).
+   * \param parent the request we are getting the rates and limits from.
+   * \param path the path being watched.
+   * \param recursive if the request is recursive or not.
+   */
+  Request::Request(const Request& parent, const wchar_t* path, const bool recursive) :
+    Request(path, recursive, parent.EventsCallbackRateMilliseconds(), parent.StatsCallbackRateMilliseconds())
+  {
+    _maxNumberOfEvents = parent._maxNumberOfEvents;
+    _maxNumberOfBytes = parent._maxNumberOfBytes;
+    _overflowPolicy = parent._overflowPolicy;
+    _collectorShards = parent._collectorShards;
+    _renamePairingMs = parent._renamePairingMs;
+    _includePatterns = parent._includePatterns;
+    _excludePatterns = parent._excludePatterns;
+    _patternsRoot = parent.PatternsRoot() == nullptr ? L"" : parent.PatternsRoot();
+    _actionsMask = parent._actionsMask;
+    _changesMask = parent._changesMask;
+    _keepFolderEvents = !recursive;
+  }
+
   Request::Request(const sRequest& request) :
     Request()
   {
@@ -80,6 +121,36 @@ namespace myoddweb:: directorywatcher
       request.StatisticsCallback, 
       request.EventsCallbackRateMs, 
       request.StatisticsCallbackRateMs);
+    _coalesceEvents = request.CoalesceEvents;
+    _maxNumberOfEvents = request.MaxNumberOfEvents < 0 ? 0 : request.MaxNumberOfEvents;
+    _maxNumberOfBytes = request.MaxNumberOfBytes < 0 ? 0 : request.MaxNumberOfBytes;
+    switch (request.OverflowPolicy)
+    {
+    case static_cast<int>(myoddweb::directorywatcher::OverflowPolicy::DropTouchedFirst):
+    case static_cast<int>(myoddweb::directorywatcher::OverflowPolicy::CollapseToDirectory):
+      _overflowPolicy = static_cast<myoddweb::directorywatcher::OverflowPolicy>(request.OverflowPolicy);
+      break;
+
+    default:
+      _overflowPolicy = myoddweb::directorywatcher::OverflowPolicy::DropOldest;
+      break;
+    }
+    _collectorShards = request.CollectorShards < 1 ? 1 : request.CollectorShards;
+    _renamePairingMs = request.RenamePairingMs < 0 ? 0 : request.RenamePairingMs;
+    _eventsBatchCallback = request.EventsBatchCallback;
+    _pullEvents = request.PullEvents;
+    _lowLatencyEvents = request.LowLatencyEvents;
+    _maxBatchDelayMs = request.MaxBatchDelayMs < 0 ? 0 : request.MaxBatchDelayMs;
+    _maxBatchSize = request.MaxBatchSize < 0 ? 0 : request.MaxBatchSize;
+    _statisticsExCallback = request.StatisticsExCallback;
+    _dispatchQueueSize = request.DispatchQueueSize < 0 ? 0 : request.DispatchQueueSize;
+    _dispatchThreads = request.DispatchThreads < 1 ? 1 : request.DispatchThreads;
+    _includePatterns = request.IncludePatterns == nullptr ? L"" : request.IncludePatterns;
+    _excludePatterns = request.ExcludePatterns == nullptr ? L"" : request.ExcludePatterns;
+    const auto actionsMask = request.ActionsMask & static_cast<int>(myoddweb::directorywatcher::ActionsMask::All);
+    _actionsMask = actionsMask == 0 ? static_cast<int>(myoddweb::directorywatcher::ActionsMask::All) : actionsMask;
+    const auto changesMask = request.ChangesMask & static_cast<int>(myoddweb::directorywatcher::ChangesMask::All);
+    _changesMask = changesMask == 0 ? static_cast<int>(myoddweb::directorywatcher::ChangesMask::All) : changesMask;
   }
     
   Request::Request(const Request& request) :
@@ -104,6 +175,8 @@ namespace myoddweb:: directorywatcher
     _loggerCallback = nullptr;
     _eventsCallback = nullptr;
     _statisticsCallback = nullptr;
+    _eventsBatchCallback = nullptr;
+    _statisticsExCallback = nullptr;
     if (_path == nullptr)
     {
       return;
@@ -122,6 +195,26 @@ namespace myoddweb:: directorywatcher
       return;
     }
     Assign( request._path, request._recursive, request._loggerCallback, request._eventsCallback, request._statisticsCallback, request._eventsCallbackRateMs, request._statisticsCallbackRateMs );
+    _coalesceEvents = request._coalesceEvents;
+    _maxNumberOfEvents = request._maxNumberOfEvents;
+    _maxNumberOfBytes = request._maxNumberOfBytes;
+    _overflowPolicy = request._overflowPolicy;
+    _collectorShards = request._collectorShards;
+    _renamePairingMs = request._renamePairingMs;
+    _eventsBatchCallback = request._eventsBatchCallback;
+    _pullEvents = request._pullEvents;
+    _lowLatencyEvents = request._lowLatencyEvents;
+    _maxBatchDelayMs = request._maxBatchDelayMs;
+    _maxBatchSize = request._maxBatchSize;
+    _statisticsExCallback = request._statisticsExCallback;
+    _dispatchQueueSize = request._dispatchQueueSize;
+    _dispatchThreads = request._dispatchThreads;
+    _includePatterns = request._includePatterns;
+    _excludePatterns = request._excludePatterns;
+    _patternsRoot = request._patternsRoot;
+    _actionsMask = request._actionsMask;
+    _changesMask = request._changesMask;
+    _keepFolderEvents = request._keepFolderEvents;
   }
 
   /**
@@ -219,13 +312,230 @@ namespace myoddweb:: directorywatcher
     return _statisticsCallbackRateMs;
   }
 
+  /**
+   * \brief if we want to coalesce the events of a path before they are published.
+   */
+  [[nodiscard]]
+  bool Request::CoalesceEvents() const
+  {
+    return _coalesceEvents;
+  }
+
+  /**
+   * \brief the maximum number of events we want to hold, 0 for no limit.
+   */
+  [[nodiscard]]
+  long long Request::MaxNumberOfEvents() const
+  {
+    return _maxNumberOfEvents;
+  }
+
+  /**
+   * \brief the maximum number of bytes our events can use, 0 for no limit.
+   */
+  [[nodiscard]]
+  long long Request::MaxNumberOfBytes() const
+  {
+    return _maxNumberOfBytes;
+  }
+
+  /**
+   * \brief what we do when we have too many events.
+   */
+  [[nodiscard]]
+  myoddweb::directorywatcher::OverflowPolicy Request::OverflowPolicy() const
+  {
+    return _overflowPolicy;
+  }
+
+  /**
+   * \brief the number of shards the events are collected in.
+   */
+  [[nodiscard]]
+  int Request::CollectorShards() const
+  {
+    return _collectorShards;
+  }
+
+  /**
+   * \brief how long we keep half of a rename waiting for the other half.
+   */
+  [[nodiscard]]
+  long long Request::RenamePairingMilliseconds() const
+  {
+    return _renamePairingMs;
+  }
+
+  /**
+   * \brief the callback with all the events of a publish interval.
+   */
+  [[nodiscard]]
+  const EventsBatchCallback& Request::CallbackEventsBatch() const
+  {
+    return _eventsBatchCallback;
+  }
+
+  /**
+   * \brief if the events are pulled by the caller rather than published.
+   */
+  [[nodiscard]]
+  bool Request::PullEvents() const
+  {
+    return _pullEvents;
+  }
+
+  /**
+   * \brief if we publish the events as soon as they arrive.
+   */
+  [[nodiscard]]
+  bool Request::LowLatencyEvents() const
+  {
+    return _lowLatencyEvents;
+  }
+
+  /**
+   * \brief in low latency mode, how long we wait for more events after the first one.
+   */
+  [[nodiscard]]
+  long long Request::MaxBatchDelayMilliseconds() const
+  {
+    return _maxBatchDelayMs;
+  }
+
+  /**
+   * \brief in low latency mode, the number of events that will be published without waiting, 0 for no limit.
+   */
+  [[nodiscard]]
+  long long Request::MaxBatchSize() const
+  {
+    return _maxBatchSize;
+  }
+
+  /**
+   * \brief the callback with the extended statistics.
+   */
+  [[nodiscard]]
+  const StatisticsExCallback& Request::CallbackStatisticsEx() const
+  {
+    return _statisticsExCallback;
+  }
+
+  /**
+   * \brief the maximum number of batches waiting for the dispatching thread, 0 if we are not using one.
+   */
+  [[nodiscard]]
+  long long Request::DispatchQueueSize() const
+  {
+    return _dispatchQueueSize;
+  }
+
+  /**
+   * \brief the number of threads giving the events to the callback, at least 1.
+   */
+  [[nodiscard]]
+  long long Request::DispatchThreads() const
+  {
+    return _dispatchThreads;
+  }
+
+  /**
+   * \brief the '|' separated glob patterns the paths must match.
+   */
+  [[nodiscard]]
+  const std::wstring& Request::IncludePatterns() const
+  {
+    return _includePatterns;
+  }
+
+  /**
+   * \brief the '|' separated glob patterns of the paths we do not want.
+   */
+  [[nodiscard]]
+  const std::wstring& Request::ExcludePatterns() const
+  {
+    return _excludePatterns;
+  }
+
+  /**
+   * \brief the path the patterns are relative to, the path of the parent request for a child request.
+   */
+  [[nodiscard]]
+  const wchar_t* Request::PatternsRoot() const
+  {
+    return _patternsRoot.empty() ? _path : _patternsRoot.c_str();
+  }
+
+  /**
+   * \brief the actions we want to be told about, (see ActionsMask).
+   */
+  [[nodiscard]]
+  int Request::ActionsMask() const
+  {
+    return _actionsMask;
+  }
+
+  /**
+   * \brief the kind of changes that raise a touched event, (see ChangesMask).
+   */
+  [[nodiscard]]
+  int Request::ChangesMask() const
+  {
+    return _changesMask;
+  }
+
+  /**
+   * \brief if we keep the folders added/removed/renamed events whatever the actions mask.
+   *        the non recursive parents of a multiple monitor need them to watch the new folders.
+   */
+  [[nodiscard]]
+  bool Request::KeepFolderEvents() const
+  {
+    return _keepFolderEvents;
+  }
+
+  /**
+   * \brief check if the actions mask allows a given action, unknown actions are always allowed.
+   * \param action the action we are checking.
+   * \return if we want the events with that action.
+   */
+  [[nodiscard]]
+  bool Request::IsActionWanted(const EventAction action) const
+  {
+    switch (action)
+    {
+    case EventAction::Added:
+      return (_actionsMask & static_cast<int>(myoddweb::directorywatcher::ActionsMask::Added)) != 0;
+
+    case EventAction::Removed:
+      return (_actionsMask & static_cast<int>(myoddweb::directorywatcher::ActionsMask::Removed)) != 0;
+
+    case EventAction::Touched:
+      return (_actionsMask & static_cast<int>(myoddweb::directorywatcher::ActionsMask::Touched)) != 0;
+
+    case EventAction::Renamed:
+      return (_actionsMask & static_cast<int>(myoddweb::directorywatcher::ActionsMask::Renamed)) != 0;
+
+    default:
+      return true;
+    }
+  }
+
+  /**
+   * \brief check if the actions mask allows the errors.
+   */
+  [[nodiscard]]
+  bool Request::IsErrorWanted() const
+  {
+    return (_actionsMask & static_cast<int>(myoddweb::directorywatcher::ActionsMask::Errors)) != 0;
+  }
+
   /**
    * \brief return if we are using events or not
    */
   bool Request::IsUsingEvents() const
   {
     // null is allowed
-    if (nullptr == CallbackEvents())
+    if (nullptr == CallbackEvents() && nullptr == CallbackEventsBatch())
     {
       return false;
     }
@@ -244,7 +554,7 @@ namespace myoddweb:: directorywatcher
   bool Request::IsUsingStatistics() const
   {
     // null is allowed
-    if (nullptr == CallbackStatistics())
+    if (nullptr == CallbackStatistics() && nullptr == CallbackStatisticsEx())
     {
       return false;
     }
@@ -258,4 +568,12 @@ namespace myoddweb:: directorywatcher
     // we are using it
     return true;
   }
-}
\ No newline at end of file
+
+  /**
+   * \brief return if we only count the events for the statistics, (no events callback and nobody pulling them).
+   */
+  bool Request::IsCountingEvents() const
+  {
+    return IsUsingStatistics() && !IsUsingEvents() && !PullEvents();
+  }
+}
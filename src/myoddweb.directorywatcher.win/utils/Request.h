@@ -2,8 +2,12 @@
 // Florent Guelfucci licenses this file to you under the MIT license.
 // See the LICENSE file in the project root for more information.
 #pragma once
+#include <string>
 #include "../monitors/Callbacks.h"
 #include "../watcher.h"
+#include "OverflowPolicy.h"
+#include "EventsMask.h"
+#include "EventAction.h"
 
 namespace myoddweb:: directorywatcher
 {
@@ -51,6 +55,16 @@ namespace myoddweb:: directorywatcher
      * \param statisticsCallbackRateMs how long we want to keep stats data for.
      */
     Request(const wchar_t* path, bool recursive, long long eventsCallbackRateMs, long long statisticsCallbackRateMs);
+
+    /**
+     * \brief create a child request from a parent request, (no callback)
+     *        the rates, the limits, the shards, the rename pairing, the patterns and the masks of the parent are used.
+     *        a non recursive child always keeps the folders events, (see KeepFolderEvents).
+     * \param parent the request we are getting the rates and limits from.
+     * \param path the path being watched.
+     * \param recursive if the request is recursive or not.
+     */
+    Request(const Request& parent, const wchar_t* path, bool recursive);
     virtual ~Request();
 
     /**
@@ -100,6 +114,12 @@ namespace myoddweb:: directorywatcher
     [[nodiscard]]
     bool IsUsingStatistics() const;
 
+    /**
+     * \brief return if we only count the events for the statistics, (no events callback and nobody pulling them).
+     */
+    [[nodiscard]]
+    bool IsCountingEvents() const;
+
     /**
      * \brief access the path
      */
@@ -143,6 +163,141 @@ namespace myoddweb:: directorywatcher
     [[nodiscard]]
     long long StatsCallbackRateMilliseconds() const;
 
+    /**
+     * \brief if we want to coalesce the events of a path before they are published.
+     */
+    [[nodiscard]]
+    bool CoalesceEvents() const;
+
+    /**
+     * \brief the maximum number of events we want to hold, 0 for no limit.
+     */
+    [[nodiscard]]
+    long long MaxNumberOfEvents() const;
+
+    /**
+     * \brief the maximum number of bytes our events can use, 0 for no limit.
+     */
+    [[nodiscard]]
+    long long MaxNumberOfBytes() const;
+
+    /**
+     * \brief what we do when we have too many events.
+     */
+    [[nodiscard]]
+    myoddweb::directorywatcher::OverflowPolicy OverflowPolicy() const;
+
+    /**
+     * \brief the number of shards the events are collected in.
+     */
+    [[nodiscard]]
+    int CollectorShards() const;
+
+    /**
+     * \brief how long we keep half of a rename waiting for the other half.
+     */
+    [[nodiscard]]
+    long long RenamePairingMilliseconds() const;
+
+    /**
+     * \brief the callback with all the events of a publish interval.
+     */
+    [[nodiscard]]
+    const EventsBatchCallback& CallbackEventsBatch() const;
+
+    /**
+     * \brief if the events are pulled by the caller rather than published.
+     */
+    [[nodiscard]]
+    bool PullEvents() const;
+
+    /**
+     * \brief if we publish the events as soon as they arrive.
+     */
+    [[nodiscard]]
+    bool LowLatencyEvents() const;
+
+    /**
+     * \brief in low latency mode, how long we wait for more events after the first one.
+     */
+    [[nodiscard]]
+    long long MaxBatchDelayMilliseconds() const;
+
+    /**
+     * \brief in low latency mode, the number of events that will be published without waiting, 0 for no limit.
+     */
+    [[nodiscard]]
+    long long MaxBatchSize() const;
+
+    /**
+     * \brief the callback with the extended statistics.
+     */
+    [[nodiscard]]
+    const StatisticsExCallback& CallbackStatisticsEx() const;
+
+    /**
+     * \brief the maximum number of batches waiting for the dispatching thread, 0 if we are not using one.
+     */
+    [[nodiscard]]
+    long long DispatchQueueSize() const;
+
+    /**
+     * \brief the number of threads giving the events to the callback, at least 1.
+     */
+    [[nodiscard]]
+    long long DispatchThreads() const;
+
+    /**
+     * \brief the '|' separated glob patterns the paths must match.
+     */
+    [[nodiscard]]
+    const std::wstring& IncludePatterns() const;
+
+    /**
+     * \brief the '|' separated glob patterns of the paths we do not want.
+     */
+    [[nodiscard]]
+    const std::wstring& ExcludePatterns() const;
+
+    /**
+     * \brief the path the patterns are relative to, the path of the parent request for a child request.
+     */
+    [[nodiscard]]
+    const wchar_t* PatternsRoot() const;
+
+    /**
+     * \brief the actions we want to be told about, (see ActionsMask).
+     */
+    [[nodiscard]]
+    int ActionsMask() const;
+
+    /**
+     * \brief the kind of changes that raise a touched event, (see ChangesMask).
+     */
+    [[nodiscard]]
+    int ChangesMask() const;
+
+    /**
+     * \brief if we keep the folders added/removed/renamed events whatever the actions mask.
+     *        the non recursive parents of a multiple monitor need them to watch the new folders.
+     */
+    [[nodiscard]]
+    bool KeepFolderEvents() const;
+
+    /**
+     * \brief check if the actions mask allows a given action, unknown actions are always allowed.
+     * \param action the action we are checking.
+     * \return if we want the events with that action.
+     */
+    [[nodiscard]]
+    bool IsActionWanted(EventAction action) const;
+
+    /**
+     * \brief check if the actions mask allows the errors.
+     */
+    [[nodiscard]]
+    bool IsErrorWanted() const;
+
   private:
 
     /**
@@ -179,5 +334,105 @@ namespace myoddweb:: directorywatcher
      * \brief the logger callback
      */ 
     LoggerCallback _loggerCallback;
+
+    /**
+     * \brief if we want to coalesce the events of a path before they are published.
+     */
+    bool _coalesceEvents;
+
+    /**
+     * \brief the maximum number of events we want to hold, 0 for no limit.
+     */
+    long long _maxNumberOfEvents;
+
+    /**
+     * \brief the maximum number of bytes our events can use, 0 for no limit.
+     */
+    long long _maxNumberOfBytes;
+
+    /**
+     * \brief what we do when we have too many events.
+     */
+    myoddweb::directorywatcher::OverflowPolicy _overflowPolicy;
+
+    /**
+     * \brief the number of shards the events are collected in.
+     */
+    int _collectorShards;
+
+    /**
+     * \brief how long we keep half of a rename waiting for the other half.
+     */
+    long long _renamePairingMs;
+
+    /**
+     * \brief the callback with all the events of a publish interval.
+     */
+    EventsBatchCallback _eventsBatchCallback;
+
+    /**
+     * \brief if the events are pulled by the caller rather than published.
+     */
+    bool _pullEvents;
+
+    /**
+     * \brief if we publish the events as soon as they arrive.
+     */
+    bool _lowLatencyEvents;
+
+    /**
+     * \brief in low latency mode, how long we wait for more events after the first one.
+     */
+    long long _maxBatchDelayMs;
+
+    /**
+     * \brief in low latency mode, the number of events that will be published without waiting, 0 for no limit.
+     */
+    long long _maxBatchSize;
+
+    /**
+     * \brief the callback with the extended statistics.
+     */
+    StatisticsExCallback _statisticsExCallback;
+
+    /**
+     * \brief the maximum number of batches waiting for the dispatching thread, 0 if we are not using one.
+     */
+    long long _dispatchQueueSize;
+
+    /**
+     * \brief the number of threads giving the events to the callback, at least 1.
+     */
+    long long _dispatchThreads;
+
+    /**
+     * \brief the '|' separated glob patterns the paths must match.
+     */
+    std::wstring _includePatterns;
+
+    /**
+     * \brief the '|' separated glob patterns of the paths we do not want.
+     */
+    std::wstring _excludePatterns;
+
+    /**
+     * \brief the path the patterns are relative to, empty if it is our own path.
+     */
+    std::wstring _patternsRoot;
+
+    /**
+     * \brief the actions we want to be told about, (see ActionsMask).
+     */
+    int _actionsMask;
+
+    /**
+     * \brief the kind of changes that raise a touched event, (see ChangesMask).
+     */
+    int _changesMask;
+
+    /**
+     * \brief if we keep the folders added/removed/renamed events whatever the actions mask.
+     */
+    bool _keepFolderEvents;
   };
 }
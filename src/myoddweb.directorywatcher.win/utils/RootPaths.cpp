@@ -0,0 +1,105 @@
+// Licensed to Florent Guelfucci under one or more agreements.
+// Florent Guelfucci licenses this file to you under the MIT license.
+// See the LICENSE file in the project root for more information.
+#include <cwchar>
+#include "RootPaths.h"
+#include "Lock.h"
+
+namespace myoddweb:: directorywatcher
+{
+  RootPaths::RootPaths() :
+    _head(nullptr)
+  {
+  }
+
+  RootPaths::~RootPaths()
+  {
+    auto root = _head.load();
+    while (root != nullptr)
+    {
+      const auto next = root->Next;
+      delete root;
+      root = next;
+    }
+    _head = nullptr;
+  }
+
+  /**
+   * \brief look for a path without getting the lock.
+   * \param path the path we are looking for.
+   * \return the root or nullptr if we do not have it.
+   */
+  const RootPaths::Root* RootPaths::Find(const wchar_t* path) const
+  {
+    for (auto root = _head.load(std::memory_order_acquire); root != nullptr; root = root->Next)
+    {
+      if (wcscmp(root->Path.c_str(), path) == 0)
+      {
+        return root;
+      }
+    }
+    return nullptr;
+  }
+
+  /**
+   * \brief get the id of a root path, add it if we do not have it yet.
+   * \param path the root path we are looking for.
+   * \return the id of the path.
+   */
+  unsigned int RootPaths::Intern(const wchar_t* path)
+  {
+    if (path == nullptr)
+    {
+      path = L"";
+    }
+
+    // most of the time we already have it.
+    auto root = Find(path);
+    if (root != nullptr)
+    {
+      return root->Id;
+    }
+
+    // we need to add it, but someone else might have done it already.
+    MYODDWEB_LOCK(_lock);
+    root = Find(path);
+    if (root != nullptr)
+    {
+      return root->Id;
+    }
+
+    // the ids follow the order the roots were added.
+    const auto head = _head.load();
+    const auto added = new Root{ head == nullptr ? 0 : head->Id + 1, path, head };
+    _head.store(added, std::memory_order_release);
+    return added->Id;
+  }
+
+  /**
+   * \brief get a root path by id.
+   * \param id the id of the path, as returned by Intern()
+   * \return the path or an empty string if we do not know that id.
+   */
+  const std::wstring& RootPaths::Get(const unsigned int id) const
+  {
+    for (auto root = _head.load(std::memory_order_acquire); root != nullptr; root = root->Next)
+    {
+      if (root->Id == id)
+      {
+        return root->Path;
+      }
+    }
+
+    static const std::wstring empty;
+    return empty;
+  }
+
+  /**
+   * \brief the number of root paths we are holding.
+   */
+  unsigned int RootPaths::Count() const
+  {
+    const auto head = _head.load(std::memory_order_acquire);
+    return head == nullptr ? 0 : head->Id + 1;
+  }
+}
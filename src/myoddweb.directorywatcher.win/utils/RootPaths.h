@@ -0,0 +1,81 @@
+// Licensed to Florent Guelfucci under one or more agreements.
+// Florent Guelfucci licenses this file to you under the MIT license.
+// See the LICENSE file in the project root for more information.
+#pragma once
+#include <atomic>
+#include <mutex>
+#include <string>
+
+#include "../monitors/Base.h"
+
+namespace myoddweb
+{
+  namespace directorywatcher
+  {
+    /**
+     * \brief the root paths used by the events of a collector, each path is only saved once
+     *        and the events only keep the id of their root and the path relative to it.
+     *        looking up a root does not take any lock, adding a new root does.
+     *        the roots are never removed until the class is destroyed.
+     */
+    class RootPaths final
+    {
+    public:
+      RootPaths();
+      ~RootPaths();
+
+      RootPaths(const RootPaths&) = delete;
+      RootPaths(RootPaths&&) = delete;
+      const RootPaths& operator=(const RootPaths&) = delete;
+      RootPaths& operator=(RootPaths&&) = delete;
+
+      /**
+       * \brief get the id of a root path, add it if we do not have it yet.
+       * \param path the root path we are looking for.
+       * \return the id of the path.
+       */
+      unsigned int Intern(const wchar_t* path);
+
+      /**
+       * \brief get a root path by id.
+       * \param id the id of the path, as returned by Intern()
+       * \return the path or an empty string if we do not know that id.
+       */
+      const std::wstring& Get(unsigned int id) const;
+
+      /**
+       * \brief the number of root paths we are holding.
+       */
+      [[nodiscard]]
+      unsigned int Count() const;
+
+    private:
+      /**
+       * \brief a single root path, the nodes never move once they are added.
+       */
+      struct Root
+      {
+        unsigned int Id;
+        std::wstring Path;
+        Root* Next;
+      };
+
+      /**
+       * \brief the last root path we added.
+       */
+      std::atomic<Root*> _head;
+
+      /**
+       * \brief the lock we use when adding a new root.
+       */
+      MYODDWEB_MUTEX _lock;
+
+      /**
+       * \brief look for a path without getting the lock.
+       * \param path the path we are looking for.
+       * \return the root or nullptr if we do not have it.
+       */
+      const Root* Find(const wchar_t* path) const;
+    };
+  }
+}
@@ -0,0 +1,434 @@
+// Licensed to Florent Guelfucci under one or more agreements.
+// Florent Guelfucci licenses this file to you under the MIT license.
+// See the LICENSE file in the project root for more information.
+#include "TaskPool.h"
+#include <thread>
+
+#include "../Lock.h"
+#include "Thread.h"
+
+namespace myoddweb::directorywatcher::threads
+{
+  /// <summary>
+  /// The pool that owns the current thread, if any.
+  /// </summary>
+  static thread_local const TaskPool* _currentTaskPool = nullptr;
+
+  /// <summary>
+  /// The index of the queue owned by the current thread.
+  /// </summary>
+  static thread_local unsigned int _currentQueueIndex = 0;
+
+  /// <summary>
+  /// If the current thread is one of the temporary threads of its pool.
+  /// </summary>
+  static thread_local bool _currentThreadIsTemporary = false;
+
+  /// <summary>
+  /// Create the pool and start all the threads.
+  /// </summary>
+  /// <param name="numberOfThreads">The number of threads, 0 to use the number of hardware threads.</param>
+  TaskPool::TaskPool(unsigned int numberOfThreads) :
+    _numberOfPendingTasks(0),
+    _numberOfRunningThreads(0),
+    _numberOfBusyThreads(0),
+    _numberOfCompletedTasks(0),
+    _numberOfWakeUps(0),
+    _numberOfCompletionWaiters(0),
+    _lastNumberOfCompletedTasks(0),
+    _lastProgress(std::chrono::steady_clock::now()),
+    _nextQueue(0),
+    _mustStop(false)
+  {
+    if (numberOfThreads == 0)
+    {
+      numberOfThreads = std::thread::hardware_concurrency();
+    }
+    if (numberOfThreads == 0)
+    {
+      // we could not tell how many threads we have.
+      numberOfThreads = 1;
+    }
+
+    // all the queues must exist before any of the threads can look at them.
+    for (auto i = 0u; i < numberOfThreads; ++i)
+    {
+      _queues.push_back(new TaskQueue());
+    }
+
+    MYODDWEB_LOCK(_threadsLock);
+    for (auto i = 0u; i < numberOfThreads; ++i)
+    {
+      AddThreadInLock(i, false);
+    }
+  }
+
+  /// <summary>
+  /// Run all the pending tasks and stop the threads.
+  /// </summary>
+  TaskPool::~TaskPool()
+  {
+    // the threads only stop once there is nothing left to do.
+    _mustStop = true;
+    _signal.Notify();
+
+    {
+      MYODDWEB_LOCK(_threadsLock);
+      for (const auto& thread : _threads)
+      {
+        delete thread;
+      }
+      _threads.clear();
+    }
+
+    for (const auto& queue : _queues)
+    {
+      delete queue;
+    }
+    _queues.clear();
+  }
+
+  /// <summary>
+  /// If we are called from one of our threads, run one of the pending tasks.
+  /// A thread waiting for another task to complete must help or all our threads could end up waiting.
+  /// </summary>
+  /// <returns>True if we ran a task.</returns>
+  bool TaskPool::RunPendingTask()
+  {
+    // other threads are not blocking ours so they do not need to help
+    // and they might be holding locks that our tasks need.
+    unsigned int index;
+    if (!TryGetThreadIndex(index))
+    {
+      return false;
+    }
+
+    Task task;
+    if (!TryPop(index, task))
+    {
+      return false;
+    }
+    Execute(task);
+    return true;
+  }
+
+  /// <summary>
+  /// Add a temporary thread if all our threads are busy and none of them completed a task for a while.
+  /// This prevents a task that blocks for a long time from preventing all the other tasks from running.
+  /// </summary>
+  /// <returns>True if we added a thread.</returns>
+  bool TaskPool::AddThreadIfStarved()
+  {
+    MYODDWEB_LOCK(_threadsLock);
+    const auto now = std::chrono::steady_clock::now();
+
+    // if some tasks completed, then we are not blocked.
+    const auto numberOfCompletedTasks = _numberOfCompletedTasks.load();
+    if (numberOfCompletedTasks != _lastNumberOfCompletedTasks)
+    {
+      _lastNumberOfCompletedTasks = numberOfCompletedTasks;
+      _lastProgress = now;
+      return false;
+    }
+
+    // if nothing is waiting or if one of the threads is free, it will run the next task.
+    if (_numberOfPendingTasks == 0 || _numberOfBusyThreads < _numberOfRunningThreads || _mustStop)
+    {
+      _lastProgress = now;
+      return false;
+    }
+
+    // give the busy threads a chance to complete their tasks.
+    if (std::chrono::duration_cast<std::chrono::milliseconds>(now - _lastProgress).count() < MYODDWEB_WORKERPOOL_STARVATION)
+    {
+      return false;
+    }
+
+    // the new thread will share the queue of one of our threads.
+    AddThreadInLock(static_cast<unsigned int>(_threads.size() % _queues.size()), true);
+    _lastProgress = now;
+    return true;
+  }
+
+  /// <summary>
+  /// Check if the calling thread is one of ours.
+  /// </summary>
+  /// <returns>True if the calling thread is one of ours.</returns>
+  bool TaskPool::IsTaskThread() const
+  {
+    unsigned int index;
+    return TryGetThreadIndex(index);
+  }
+
+  /// <summary>
+  /// Check if the calling thread is one of our temporary threads.
+  /// On windows the IO started by a thread is cancelled when it stops, so it must be left to our other threads.
+  /// </summary>
+  /// <returns>True if the calling thread is one of our temporary threads.</returns>
+  bool TaskPool::IsTemporaryThread() const
+  {
+    return IsTaskThread() && _currentThreadIsTemporary;
+  }
+
+  /// <summary>
+  /// Check if some tasks are waiting for one of our threads.
+  /// </summary>
+  /// <returns>True if at least one task is queued.</returns>
+  bool TaskPool::HasPendingTasks() const
+  {
+    return _numberOfPendingTasks > 0;
+  }
+
+  /// <summary>
+  /// Get the number of tasks that were completed so far.
+  /// The times the waiters were woken up outside of our tasks are counted as well.
+  /// </summary>
+  /// <returns>The number of completed tasks.</returns>
+  long long TaskPool::NumberOfCompletedTasks() const
+  {
+    return _numberOfCompletedTasks + _numberOfWakeUps;
+  }
+
+  /// <summary>
+  /// Wait until at least one more task is completed, or until the timeout.
+  /// If we are called from one of our threads we also return as soon as a task is queued
+  /// so the thread can help with it rather than waiting for a task that might be waiting for it.
+  /// </summary>
+  /// <param name="numberOfCompletedTasks">The number of completed tasks we already know about.</param>
+  /// <param name="milliseconds">How long we want to wait for, -1 to wait until a task completes.</param>
+  /// <returns>True if a task was completed, or queued when we are one of our threads.</returns>
+  bool TaskPool::WaitForCompletedTask(const long long numberOfCompletedTasks, const long long milliseconds)
+  {
+    const auto isTaskThread = IsTaskThread();
+    std::unique_lock<std::mutex> lock(_completedTasksLock);
+
+    // the tasks only notify us if they know that we are waiting.
+    ++_numberOfCompletionWaiters;
+    const auto isCompleted = [this, numberOfCompletedTasks, isTaskThread]
+    {
+      return NumberOfCompletedTasks() != numberOfCompletedTasks || (isTaskThread && _numberOfPendingTasks > 0);
+    };
+    auto completed = true;
+    if (milliseconds < 0)
+    {
+      _completedTasksChanged.wait(lock, isCompleted);
+    }
+    else
+    {
+      completed = _completedTasksChanged.wait_for(lock, std::chrono::milliseconds(milliseconds), isCompleted);
+    }
+    --_numberOfCompletionWaiters;
+    return completed;
+  }
+
+  /// <summary>
+  /// Wake the threads waiting for a task to complete, when what they are waiting for
+  /// was changed by something other than one of our tasks.
+  /// </summary>
+  void TaskPool::WakeCompletionWaiters()
+  {
+    ++_numberOfWakeUps;
+    NotifyCompletionWaiters();
+  }
+
+  /// <summary>
+  /// Get the number of threads running the tasks, not counting the temporary ones.
+  /// </summary>
+  /// <returns>The number of threads</returns>
+  unsigned int TaskPool::NumberOfThreads() const
+  {
+    return static_cast<unsigned int>(_queues.size());
+  }
+
+  /// <summary>
+  /// Create a thread and add it to our list of threads.
+  /// </summary>
+  /// <param name="index">The index of the queue this thread owns.</param>
+  /// <param name="isTemporary">If the thread stops once it has nothing to do for a while.</param>
+  void TaskPool::AddThreadInLock(const unsigned int index, const bool isTemporary)
+  {
+    // remove the temporary threads that are complete.
+    auto it = _threads.begin();
+    while (it != _threads.end())
+    {
+      if (!(*it)->Completed())
+      {
+        ++it;
+        continue;
+      }
+      delete *it;
+      it = _threads.erase(it);
+    }
+
+    ++_numberOfRunningThreads;
+    _threads.push_back(new Thread([this, index, isTemporary]
+      {
+        ThreadRun(index, isTemporary);
+        --_numberOfRunningThreads;
+      }));
+  }
+
+  /// <summary>
+  /// Run a task and tell whoever is waiting that it is completed.
+  /// </summary>
+  /// <param name="task">The task to run.</param>
+  void TaskPool::Execute(const Task& task)
+  {
+    // the future is ready once the task returns.
+    task();
+    ++_numberOfCompletedTasks;
+    NotifyCompletionWaiters();
+  }
+
+  /// <summary>
+  /// Wake the threads waiting for a task to complete, if there are any.
+  /// </summary>
+  void TaskPool::NotifyCompletionWaiters()
+  {
+    // if nobody is waiting we do not need the lock.
+    if (_numberOfCompletionWaiters == 0)
+    {
+      return;
+    }
+
+    // the lock makes sure that the waiting thread is not between its check and its wait.
+    {
+      std::lock_guard<std::mutex> lock(_completedTasksLock);
+    }
+    _completedTasksChanged.notify_all();
+  }
+
+  /// <summary>
+  /// Add a task to one of our queues and wake a thread to run it.
+  /// </summary>
+  /// <param name="task">The task to add.</param>
+  void TaskPool::Push(Task task)
+  {
+    // our own threads keep their tasks, the others share them out.
+    unsigned int index;
+    if (!TryGetThreadIndex(index))
+    {
+      index = _nextQueue++ % _queues.size();
+    }
+
+    {
+      auto& queue = *_queues[index];
+      MYODDWEB_LOCK(queue._lock);
+      queue._tasks.push_back(std::move(task));
+      ++_numberOfPendingTasks;
+    }
+
+    _signal.Notify();
+
+    // one of our threads waiting for a task to complete might be able to help with this one.
+    NotifyCompletionWaiters();
+  }
+
+  /// <summary>
+  /// Get the next task from our own queue or, if it is empty, steal one from the other threads.
+  /// </summary>
+  /// <param name="index">The index of the queue we want to look in first.</param>
+  /// <param name="task">The task we found.</param>
+  /// <returns>True if we found a task.</returns>
+  bool TaskPool::TryPop(const unsigned int index, Task& task)
+  {
+    // the newest of our own tasks.
+    {
+      auto& queue = *_queues[index];
+      MYODDWEB_LOCK(queue._lock);
+      if (!queue._tasks.empty())
+      {
+        task = std::move(queue._tasks.back());
+        queue._tasks.pop_back();
+        --_numberOfPendingTasks;
+        return true;
+      }
+    }
+
+    // otherwise the oldest task of the other threads.
+    const auto numberOfQueues = static_cast<unsigned int>(_queues.size());
+    for (auto i = 1u; i < numberOfQueues; ++i)
+    {
+      auto& queue = *_queues[(index + i) % numberOfQueues];
+      MYODDWEB_LOCK(queue._lock);
+      if (!queue._tasks.empty())
+      {
+        task = std::move(queue._tasks.front());
+        queue._tasks.pop_front();
+        --_numberOfPendingTasks;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /// <summary>
+  /// The body of each of our threads.
+  /// </summary>
+  /// <param name="index">The index of the queue this thread owns.</param>
+  /// <param name="isTemporary">If the thread stops once it has nothing to do for a while.</param>
+  void TaskPool::ThreadRun(const unsigned int index, const bool isTemporary)
+  {
+    _currentTaskPool = this;
+    _currentQueueIndex = index;
+    _currentThreadIsTemporary = isTemporary;
+
+    for (;;)
+    {
+      Task task;
+      if (TryPop(index, task))
+      {
+        // there is more work than we can do, so we wake another thread to help.
+        if (_numberOfPendingTasks > 0)
+        {
+          _signal.Notify();
+        }
+
+        ++_numberOfBusyThreads;
+        Execute(task);
+        --_numberOfBusyThreads;
+        continue;
+      }
+
+      if (_mustStop)
+      {
+        // pass the stop on to the next thread.
+        _signal.Notify();
+        break;
+      }
+
+      // on windows the wait is alertable so the IO completion routines
+      // of the reads started by our tasks are called while we are idle.
+      // the temporary threads never start any reads, so they can stop.
+      if (!isTemporary)
+      {
+        _signal.Wait(-1);
+        continue;
+      }
+
+      // the temporary threads are no longer needed once they have been idle for a while.
+      if (!_signal.Wait(MYODDWEB_WORKERPOOL_MAX_IDLE))
+      {
+        break;
+      }
+    }
+
+    _currentTaskPool = nullptr;
+    _currentThreadIsTemporary = false;
+  }
+
+  /// <summary>
+  /// Get the index of the queue of the calling thread if it is one of ours.
+  /// </summary>
+  /// <param name="index">The index of the queue.</param>
+  /// <returns>True if the calling thread is one of ours.</returns>
+  bool TaskPool::TryGetThreadIndex(unsigned int& index) const
+  {
+    if (_currentTaskPool != this)
+    {
+      return false;
+    }
+    index = _currentQueueIndex;
+    return true;
+  }
+}
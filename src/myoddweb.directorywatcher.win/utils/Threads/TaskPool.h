@@ -0,0 +1,298 @@
+// Licensed to Florent Guelfucci under one or more agreements.
+// Florent Guelfucci licenses this file to you under the MIT license.
+// See the LICENSE file in the project root for more information.
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <vector>
+
+#include "../../monitors/Base.h"
+#include "WorkerSignal.h"
+
+namespace myoddweb:: directorywatcher:: threads
+{
+  class Thread;
+
+  /// <summary>
+  /// A fixed number of threads that run short tasks.
+  /// Each thread has its own queue of tasks and, when it runs out, it steals tasks from the other threads.
+  /// If all the threads are blocked for too long, a temporary thread is added until they are not.
+  /// The temporary threads stop once they are idle, so they must not start any IO.
+  /// </summary>
+  class TaskPool final
+  {
+  public:
+    TaskPool(const TaskPool&) = delete;
+    TaskPool(TaskPool&&) = delete;
+    TaskPool& operator=(TaskPool&&) = delete;
+    TaskPool& operator=(const TaskPool&) = delete;
+
+    /// <summary>
+    /// Create the pool and start all the threads.
+    /// </summary>
+    /// <param name="numberOfThreads">The number of threads, 0 to use the number of hardware threads.</param>
+    explicit TaskPool(unsigned int numberOfThreads);
+
+    /// <summary>
+    /// Run all the pending tasks and stop the threads.
+    /// </summary>
+    ~TaskPool();
+
+    /// <summary>
+    /// Queue a task to be run by one of our threads.
+    /// If we are called from one of our threads the task is added to its own queue.
+    /// </summary>
+    /// <param name="function">The function we want to run.</param>
+    /// <returns>The future that will hold the result.</returns>
+    template<typename T>
+    std::future<T> Run(std::function<T()> function)
+    {
+      // a packaged task cannot be copied, so we share it with the queued function.
+      const auto task = std::make_shared<std::packaged_task<T()>>(std::move(function));
+      auto future = task->get_future();
+      Push([task]
+        {
+          (*task)();
+        });
+      return future;
+    }
+
+    /// <summary>
+    /// Queue a task to be run by one of our threads and call a function once its future is ready.
+    /// </summary>
+    /// <param name="function">The function we want to run.</param>
+    /// <param name="completed">Called by the thread that ran the task, after the result was set.</param>
+    /// <returns>The future that will hold the result.</returns>
+    template<typename T>
+    std::future<T> Run(std::function<T()> function, std::function<void()> completed)
+    {
+      const auto task = std::make_shared<std::packaged_task<T()>>(std::move(function));
+      auto future = task->get_future();
+      Push([task, completed = std::move(completed)]
+        {
+          (*task)();
+          completed();
+        });
+      return future;
+    }
+
+    /// <summary>
+    /// If we are called from one of our threads, run one of the pending tasks.
+    /// A thread waiting for another task to complete must help or all our threads could end up waiting.
+    /// </summary>
+    /// <returns>True if we ran a task.</returns>
+    bool RunPendingTask();
+
+    /// <summary>
+    /// Add a temporary thread if all our threads are busy and none of them completed a task for a while.
+    /// This prevents a task that blocks for a long time from preventing all the other tasks from running.
+    /// </summary>
+    /// <returns>True if we added a thread.</returns>
+    bool AddThreadIfStarved();
+
+    /// <summary>
+    /// Check if the calling thread is one of ours.
+    /// </summary>
+    /// <returns>True if the calling thread is one of ours.</returns>
+    [[nodiscard]]
+    bool IsTaskThread() const;
+
+    /// <summary>
+    /// Check if the calling thread is one of our temporary threads.
+    /// On windows the IO started by a thread is cancelled when it stops, so it must be left to our other threads.
+    /// </summary>
+    /// <returns>True if the calling thread is one of our temporary threads.</returns>
+    [[nodiscard]]
+    bool IsTemporaryThread() const;
+
+    /// <summary>
+    /// Check if some tasks are waiting for one of our threads.
+    /// </summary>
+    /// <returns>True if at least one task is queued.</returns>
+    [[nodiscard]]
+    bool HasPendingTasks() const;
+
+    /// <summary>
+    /// Get the number of tasks that were completed so far.
+    /// The times the waiters were woken up outside of our tasks are counted as well.
+    /// </summary>
+    /// <returns>The number of completed tasks.</returns>
+    [[nodiscard]]
+    long long NumberOfCompletedTasks() const;
+
+    /// <summary>
+    /// Wait until at least one more task is completed, or until the timeout.
+    /// If we are called from one of our threads we also return as soon as a task is queued
+    /// so the thread can help with it rather than waiting for a task that might be waiting for it.
+    /// </summary>
+    /// <param name="numberOfCompletedTasks">The number of completed tasks we already know about.</param>
+    /// <param name="milliseconds">How long we want to wait for, -1 to wait until a task completes.</param>
+    /// <returns>True if a task was completed, or queued when we are one of our threads.</returns>
+    bool WaitForCompletedTask(long long numberOfCompletedTasks, long long milliseconds);
+
+    /// <summary>
+    /// Wake the threads waiting for a task to complete, when what they are waiting for
+    /// was changed by something other than one of our tasks.
+    /// </summary>
+    void WakeCompletionWaiters();
+
+    /// <summary>
+    /// Get the number of threads running the tasks, not counting the temporary ones.
+    /// </summary>
+    /// <returns>The number of threads</returns>
+    [[nodiscard]]
+    unsigned int NumberOfThreads() const;
+
+  private:
+    typedef std::function<void()> Task;
+
+    /// <summary>
+    /// The tasks of one of our threads.
+    /// The owner takes the newest task and the other threads steal the oldest one.
+    /// </summary>
+    class TaskQueue final
+    {
+    public:
+      TaskQueue() = default;
+      TaskQueue(const TaskQueue&) = delete;
+      TaskQueue(TaskQueue&&) = delete;
+      TaskQueue& operator=(const TaskQueue&) = delete;
+      TaskQueue& operator=(TaskQueue&&) = delete;
+      ~TaskQueue() = default;
+
+      std::deque<Task> _tasks;
+      MYODDWEB_MUTEX _lock;
+    };
+
+    /// <summary>
+    /// Add a task to one of our queues and wake a thread to run it.
+    /// </summary>
+    /// <param name="task">The task to add.</param>
+    void Push(Task task);
+
+    /// <summary>
+    /// Get the next task from our own queue or, if it is empty, steal one from the other threads.
+    /// </summary>
+    /// <param name="index">The index of the queue we want to look in first.</param>
+    /// <param name="task">The task we found.</param>
+    /// <returns>True if we found a task.</returns>
+    bool TryPop(unsigned int index, Task& task);
+
+    /// <summary>
+    /// The body of each of our threads.
+    /// </summary>
+    /// <param name="index">The index of the queue this thread owns.</param>
+    /// <param name="isTemporary">If the thread stops once it has nothing to do for a while.</param>
+    void ThreadRun(unsigned int index, bool isTemporary);
+
+    /// <summary>
+    /// Create a thread and add it to our list of threads.
+    /// </summary>
+    /// <param name="index">The index of the queue this thread owns.</param>
+    /// <param name="isTemporary">If the thread stops once it has nothing to do for a while.</param>
+    void AddThreadInLock(unsigned int index, bool isTemporary);
+
+    /// <summary>
+    /// Run a task and tell whoever is waiting that it is completed.
+    /// </summary>
+    /// <param name="task">The task to run.</param>
+    void Execute(const Task& task);
+
+    /// <summary>
+    /// Wake the threads waiting for a task to complete, if there are any.
+    /// </summary>
+    void NotifyCompletionWaiters();
+
+    /// <summary>
+    /// Get the index of the queue of the calling thread if it is one of ours.
+    /// </summary>
+    /// <param name="index">The index of the queue.</param>
+    /// <returns>True if the calling thread is one of ours.</returns>
+    bool TryGetThreadIndex(unsigned int& index) const;
+
+    /// <summary>
+    /// One queue per thread.
+    /// </summary>
+    std::vector<TaskQueue*> _queues;
+
+    /// <summary>
+    /// Our threads, including the temporary ones.
+    /// </summary>
+    std::vector<Thread*> _threads;
+
+    /// <summary>
+    /// The lock for the list of threads.
+    /// </summary>
+    mutable MYODDWEB_MUTEX _threadsLock;
+
+    /// <summary>
+    /// The number of tasks in all our queues.
+    /// </summary>
+    std::atomic<long long> _numberOfPendingTasks;
+
+    /// <summary>
+    /// The number of threads that are still running, including the temporary ones.
+    /// </summary>
+    std::atomic<unsigned int> _numberOfRunningThreads;
+
+    /// <summary>
+    /// The number of threads currently running a task.
+    /// </summary>
+    std::atomic<unsigned int> _numberOfBusyThreads;
+
+    /// <summary>
+    /// The number of tasks that were completed so far.
+    /// </summary>
+    std::atomic<long long> _numberOfCompletedTasks;
+
+    /// <summary>
+    /// The number of times the waiters were woken up outside of our tasks.
+    /// </summary>
+    std::atomic<long long> _numberOfWakeUps;
+
+    /// <summary>
+    /// The number of threads waiting for a task to complete.
+    /// </summary>
+    std::atomic<unsigned int> _numberOfCompletionWaiters;
+
+    /// <summary>
+    /// The lock for the completed tasks condition.
+    /// </summary>
+    std::mutex _completedTasksLock;
+
+    /// <summary>
+    /// Notified when a task completes, or is queued, and someone is waiting for it.
+    /// </summary>
+    std::condition_variable _completedTasksChanged;
+
+    /// <summary>
+    /// The number of completed tasks the last time we checked if we were starved.
+    /// </summary>
+    long long _lastNumberOfCompletedTasks;
+
+    /// <summary>
+    /// The last time we saw a task complete, or added a thread.
+    /// </summary>
+    std::chrono::steady_clock::time_point _lastProgress;
+
+    /// <summary>
+    /// The queue that the next task coming from another thread will be added to.
+    /// </summary>
+    std::atomic<unsigned int> _nextQueue;
+
+    /// <summary>
+    /// Set when our threads must stop once the queues are empty.
+    /// </summary>
+    std::atomic<bool> _mustStop;
+
+    /// <summary>
+    /// Used to wake one of our threads when a task is added.
+    /// </summary>
+    WorkerSignal _signal;
+  };
+}
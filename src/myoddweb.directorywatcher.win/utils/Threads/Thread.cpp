@@ -202,16 +202,9 @@ namespace myoddweb::directorywatcher::threads
       return WaitResult::complete;
     }
 
-    if (!Wait::SpinUntil([&]
-      {
-        MYODDWEB_YIELD();
-        return worker->Completed();
-      },
-      timeout))
-    {
-      return WaitResult::timeout;
-    }
-    return WaitResult::complete;
+    // the worker wakes us up as soon as it completes.
+    // we do not call our own override as it would end up waiting for us again.
+    return worker->Worker::WaitFor(timeout);
   }
 
   /**
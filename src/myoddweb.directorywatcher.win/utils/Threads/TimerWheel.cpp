@@ -0,0 +1,309 @@
+// Licensed to Florent Guelfucci under one or more agreements.
+// Florent Guelfucci licenses this file to you under the MIT license.
+// See the LICENSE file in the project root for more information.
+#include "TimerWheel.h"
+#include <algorithm>
+
+#include "../Lock.h"
+
+namespace myoddweb::directorywatcher::threads
+{
+  /// <summary>
+  /// Create a timer that is not scheduled yet.
+  /// </summary>
+  /// <param name="callback">The function called when the timer is due.</param>
+  TimerWheel::Timer::Timer(std::function<void()> callback) :
+    _callback(std::move(callback)),
+    _wheel(nullptr),
+    _due(0),
+    _slot(nullptr),
+    _previous(nullptr),
+    _next(nullptr)
+  {
+  }
+
+  /// <summary>
+  /// Remove the timer from its wheel, if it is scheduled.
+  /// </summary>
+  TimerWheel::Timer::~Timer()
+  {
+    // if the wheel is calling us right now, this waits for it to be done.
+    const auto wheel = _wheel.load();
+    if (wheel != nullptr)
+    {
+      wheel->Cancel(*this);
+    }
+  }
+
+  TimerWheel::TimerWheel() :
+    _start(std::chrono::steady_clock::now()),
+    _current(0),
+    _numberOfTimers(0),
+    _slots{}
+  {
+  }
+
+  /// <summary>
+  /// Remove all the timers that are still scheduled.
+  /// </summary>
+  TimerWheel::~TimerWheel()
+  {
+    MYODDWEB_LOCK(_lock);
+    for (auto& level : _slots)
+    {
+      for (auto& slot : level)
+      {
+        for (auto timer = slot; timer != nullptr; timer = timer->_next)
+        {
+          timer->_slot = nullptr;
+          timer->_wheel = nullptr;
+        }
+        slot = nullptr;
+      }
+    }
+    _numberOfTimers = 0;
+  }
+
+  /// <summary>
+  /// Schedule a timer, if it was already scheduled the new due time replaces the old one.
+  /// </summary>
+  /// <param name="timer">The timer we are scheduling.</param>
+  /// <param name="milliseconds">How long from now the timer is due.</param>
+  void TimerWheel::Schedule(Timer& timer, const long long milliseconds)
+  {
+    // a timer can only be in one wheel at a time.
+    const auto wheel = timer._wheel.load();
+    if (wheel != nullptr && wheel != this)
+    {
+      wheel->Cancel(timer);
+    }
+
+    MYODDWEB_LOCK(_lock);
+    if (timer._wheel == this)
+    {
+      RemoveInLock(timer);
+    }
+
+    // if the wheel is empty there is nothing to catch up with.
+    const auto now = Now();
+    if (_numberOfTimers == 0)
+    {
+      _current = std::max(_current, now);
+    }
+
+    // part of the current tick has already gone by, so we round up to never call the timer early.
+    timer._due = now + std::max(0LL, milliseconds) + 1;
+    InsertInLock(timer);
+  }
+
+  /// <summary>
+  /// Remove a timer from the wheel, it does nothing if the timer is not scheduled.
+  /// </summary>
+  /// <param name="timer">The timer we are cancelling.</param>
+  void TimerWheel::Cancel(Timer& timer)
+  {
+    MYODDWEB_LOCK(_lock);
+    if (timer._wheel != this)
+    {
+      return;
+    }
+    RemoveInLock(timer);
+  }
+
+  /// <summary>
+  /// Move the wheel to the current time and call the timers that are due.
+  /// </summary>
+  /// <returns>The number of ms until the next timer might be due or -1 if there are none.</returns>
+  long long TimerWheel::Advance()
+  {
+    MYODDWEB_LOCK(_lock);
+    const auto now = Now();
+    while (_current < now)
+    {
+      // if there is nothing left, we can jump straight to now.
+      if (_numberOfTimers == 0)
+      {
+        _current = now;
+        break;
+      }
+
+      ++_current;
+      const auto index = static_cast<int>(_current & (NumberOfSlots - 1));
+
+      // every time the first level goes around, the next slot of the level above is moved down
+      // and so on for as long as the levels above also go around.
+      if (index == 0)
+      {
+        for (auto level = 1; level < NumberOfLevels; ++level)
+        {
+          const auto levelIndex = static_cast<int>((_current >> (level * SlotBits)) & (NumberOfSlots - 1));
+          CascadeInLock(level, levelIndex);
+          if (levelIndex != 0)
+          {
+            break;
+          }
+        }
+      }
+      ExpireInLock(index);
+    }
+    return NextDueInLock();
+  }
+
+  /// <summary>
+  /// Get the number of timers that are scheduled.
+  /// </summary>
+  /// <returns>The number of timers.</returns>
+  long long TimerWheel::NumberOfTimers() const
+  {
+    MYODDWEB_LOCK(_lock);
+    return _numberOfTimers;
+  }
+
+  /// <summary>
+  /// The number of ms since the wheel was created.
+  /// </summary>
+  /// <returns>The current tick.</returns>
+  long long TimerWheel::Now() const
+  {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - _start).count();
+  }
+
+  /// <summary>
+  /// Add a timer to the slot that covers its due time.
+  /// </summary>
+  /// <param name="timer">The timer we are adding.</param>
+  void TimerWheel::InsertInLock(Timer& timer)
+  {
+    // anything that is already due is called at the next tick.
+    timer._due = std::max(timer._due, _current + 1);
+
+    // the timers that are too far in the future go in the last slot of the last level
+    // and are moved back up when that slot is cascaded.
+    const auto maxDelta = (1LL << (NumberOfLevels * SlotBits)) - 1;
+    const auto delta = timer._due - _current;
+    const auto due = delta > maxDelta ? _current + maxDelta : timer._due;
+
+    auto level = 0;
+    while (level < NumberOfLevels - 1 && (due - _current) >= (1LL << ((level + 1) * SlotBits)))
+    {
+      ++level;
+    }
+    const auto index = static_cast<int>((due >> (level * SlotBits)) & (NumberOfSlots - 1));
+
+    auto& slot = _slots[level][index];
+    timer._slot = &slot;
+    timer._previous = nullptr;
+    timer._next = slot;
+    if (slot != nullptr)
+    {
+      slot->_previous = &timer;
+    }
+    slot = &timer;
+    timer._wheel = this;
+    ++_numberOfTimers;
+  }
+
+  /// <summary>
+  /// Remove a timer from its slot.
+  /// </summary>
+  /// <param name="timer">The timer we are removing.</param>
+  void TimerWheel::RemoveInLock(Timer& timer)
+  {
+    if (timer._previous != nullptr)
+    {
+      timer._previous->_next = timer._next;
+    }
+    else if (timer._slot != nullptr)
+    {
+      *timer._slot = timer._next;
+    }
+    if (timer._next != nullptr)
+    {
+      timer._next->_previous = timer._previous;
+    }
+
+    timer._slot = nullptr;
+    timer._previous = nullptr;
+    timer._next = nullptr;
+    timer._wheel = nullptr;
+    --_numberOfTimers;
+  }
+
+  /// <summary>
+  /// Move all the timers of a slot to the lower levels.
+  /// </summary>
+  /// <param name="level">The level of the slot.</param>
+  /// <param name="index">The index of the slot.</param>
+  void TimerWheel::CascadeInLock(const int level, const int index)
+  {
+    auto timer = _slots[level][index];
+    _slots[level][index] = nullptr;
+    while (timer != nullptr)
+    {
+      const auto next = timer->_next;
+      --_numberOfTimers;
+      InsertInLock(*timer);
+      timer = next;
+    }
+  }
+
+  /// <summary>
+  /// Call all the timers of a slot of the first level.
+  /// </summary>
+  /// <param name="index">The index of the slot.</param>
+  void TimerWheel::ExpireInLock(const int index)
+  {
+    auto timer = _slots[0][index];
+    _slots[0][index] = nullptr;
+    while (timer != nullptr)
+    {
+      const auto next = timer->_next;
+      timer->_slot = nullptr;
+      timer->_previous = nullptr;
+      timer->_next = nullptr;
+      --_numberOfTimers;
+
+      // we only let go of the timer once the callback is done
+      // so it cannot be deleted while we are calling it.
+      timer->_callback();
+      timer->_wheel = nullptr;
+      timer = next;
+    }
+  }
+
+  /// <summary>
+  /// Get the number of ms until the next timer might be due.
+  /// A timer in one of the upper levels is counted as due when it needs to be moved down.
+  /// </summary>
+  /// <returns>The number of ms or -1 if there are no timers.</returns>
+  long long TimerWheel::NextDueInLock() const
+  {
+    if (_numberOfTimers == 0)
+    {
+      return -1;
+    }
+
+    auto next = -1LL;
+    for (auto level = 0; level < NumberOfLevels; ++level)
+    {
+      const auto shift = level * SlotBits;
+      const auto current = _current >> shift;
+      for (auto offset = 1; offset < NumberOfSlots; ++offset)
+      {
+        if (_slots[level][(current + offset) & (NumberOfSlots - 1)] == nullptr)
+        {
+          continue;
+        }
+
+        // the first slot we find is the earliest of this level.
+        const auto due = ((current + offset) << shift) - _current;
+        if (next < 0 || due < next)
+        {
+          next = due;
+        }
+        break;
+      }
+    }
+    return next;
+  }
+}
@@ -0,0 +1,200 @@
+// Licensed to Florent Guelfucci under one or more agreements.
+// Florent Guelfucci licenses this file to you under the MIT license.
+// See the LICENSE file in the project root for more information.
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <functional>
+
+#include "../../monitors/Base.h"
+
+namespace myoddweb:: directorywatcher:: threads
+{
+  /// <summary>
+  /// A hierarchical timer wheel, with a resolution of one ms.
+  /// Each level has 64 slots, a timer is added to the level that covers its due time
+  /// and moved down to the lower levels as its due time gets closer.
+  /// Adding or cancelling a timer does not depend on the number of timers
+  /// and advancing the wheel only costs something for the slots that are due.
+  /// </summary>
+  class TimerWheel final
+  {
+  public:
+    /// <summary>
+    /// A timer that can be scheduled in a wheel, it is owned by the caller.
+    /// The callback is called by the thread advancing the wheel while it is locked,
+    /// so it must be short and it cannot use the wheel itself.
+    /// </summary>
+    class Timer final
+    {
+    public:
+      Timer(const Timer&) = delete;
+      Timer(Timer&&) = delete;
+      Timer& operator=(const Timer&) = delete;
+      Timer& operator=(Timer&&) = delete;
+
+      /// <summary>
+      /// Create a timer that is not scheduled yet.
+      /// </summary>
+      /// <param name="callback">The function called when the timer is due.</param>
+      explicit Timer(std::function<void()> callback);
+
+      /// <summary>
+      /// Remove the timer from its wheel, if it is scheduled.
+      /// </summary>
+      ~Timer();
+
+    private:
+      friend class TimerWheel;
+
+      /// <summary>
+      /// The function called when the timer is due.
+      /// </summary>
+      std::function<void()> _callback;
+
+      /// <summary>
+      /// The wheel we are scheduled in, if any.
+      /// </summary>
+      std::atomic<TimerWheel*> _wheel;
+
+      /// <summary>
+      /// The tick at which we are due.
+      /// </summary>
+      long long _due;
+
+      /// <summary>
+      /// The slot we are in.
+      /// </summary>
+      Timer** _slot;
+
+      /// <summary>
+      /// The previous timer in our slot.
+      /// </summary>
+      Timer* _previous;
+
+      /// <summary>
+      /// The next timer in our slot.
+      /// </summary>
+      Timer* _next;
+    };
+
+    TimerWheel(const TimerWheel&) = delete;
+    TimerWheel(TimerWheel&&) = delete;
+    TimerWheel& operator=(const TimerWheel&) = delete;
+    TimerWheel& operator=(TimerWheel&&) = delete;
+
+    TimerWheel();
+
+    /// <summary>
+    /// Remove all the timers that are still scheduled.
+    /// </summary>
+    ~TimerWheel();
+
+    /// <summary>
+    /// Schedule a timer, if it was already scheduled the new due time replaces the old one.
+    /// </summary>
+    /// <param name="timer">The timer we are scheduling.</param>
+    /// <param name="milliseconds">How long from now the timer is due.</param>
+    void Schedule(Timer& timer, long long milliseconds);
+
+    /// <summary>
+    /// Remove a timer from the wheel, it does nothing if the timer is not scheduled.
+    /// </summary>
+    /// <param name="timer">The timer we are cancelling.</param>
+    void Cancel(Timer& timer);
+
+    /// <summary>
+    /// Move the wheel to the current time and call the timers that are due.
+    /// </summary>
+    /// <returns>The number of ms until the next timer might be due or -1 if there are none.</returns>
+    long long Advance();
+
+    /// <summary>
+    /// Get the number of timers that are scheduled.
+    /// </summary>
+    /// <returns>The number of timers.</returns>
+    [[nodiscard]]
+    long long NumberOfTimers() const;
+
+  private:
+    /// <summary>
+    /// The number of bits used by the slots of each level.
+    /// </summary>
+    static constexpr int SlotBits = 6;
+
+    /// <summary>
+    /// The number of slots of each level.
+    /// </summary>
+    static constexpr int NumberOfSlots = 1 << SlotBits;
+
+    /// <summary>
+    /// The number of levels, the last level covers 2^24 ms, (a little over 4 hours).
+    /// </summary>
+    static constexpr int NumberOfLevels = 4;
+
+    /// <summary>
+    /// The number of ms since the wheel was created.
+    /// </summary>
+    /// <returns>The current tick.</returns>
+    [[nodiscard]]
+    long long Now() const;
+
+    /// <summary>
+    /// Add a timer to the slot that covers its due time.
+    /// </summary>
+    /// <param name="timer">The timer we are adding.</param>
+    void InsertInLock(Timer& timer);
+
+    /// <summary>
+    /// Remove a timer from its slot.
+    /// </summary>
+    /// <param name="timer">The timer we are removing.</param>
+    void RemoveInLock(Timer& timer);
+
+    /// <summary>
+    /// Move all the timers of a slot to the lower levels.
+    /// </summary>
+    /// <param name="level">The level of the slot.</param>
+    /// <param name="index">The index of the slot.</param>
+    void CascadeInLock(int level, int index);
+
+    /// <summary>
+    /// Call all the timers of a slot of the first level.
+    /// </summary>
+    /// <param name="index">The index of the slot.</param>
+    void ExpireInLock(int index);
+
+    /// <summary>
+    /// Get the number of ms until the next timer might be due.
+    /// A timer in one of the upper levels is counted as due when it needs to be moved down.
+    /// </summary>
+    /// <returns>The number of ms or -1 if there are no timers.</returns>
+    [[nodiscard]]
+    long long NextDueInLock() const;
+
+    /// <summary>
+    /// When the wheel was created, the ticks are counted from there.
+    /// </summary>
+    const std::chrono::steady_clock::time_point _start;
+
+    /// <summary>
+    /// The last tick we processed.
+    /// </summary>
+    long long _current;
+
+    /// <summary>
+    /// The number of timers that are scheduled.
+    /// </summary>
+    long long _numberOfTimers;
+
+    /// <summary>
+    /// The first timer of each slot of each level.
+    /// </summary>
+    Timer* _slots[NumberOfLevels][NumberOfSlots];
+
+    /// <summary>
+    /// The lock for the slots.
+    /// </summary>
+    mutable MYODDWEB_MUTEX _lock;
+  };
+}
@@ -2,6 +2,7 @@
 // Florent Guelfucci licenses this file to you under the MIT license.
 // See the LICENSE file in the project root for more information.
 #include "Worker.h"
+#include <algorithm>
 #include "../../monitors/Base.h"
 #include "../Instrumentor.h"
 #include "../Lock.h"
@@ -9,6 +10,7 @@
 #include "../LogLevel.h"
 #include "../Wait.h"
 #include "WorkerId.h"
+#include "WorkerPool.h"
 
 namespace myoddweb::directorywatcher::threads
 {
@@ -23,7 +25,10 @@ namespace myoddweb::directorywatcher::threads
   /// <returns></returns>
   Worker::Worker( const long long id ) :
     _state(State::unknown),
-    _id(id)
+    _id(id),
+    _ready(false),
+    _pool(nullptr),
+    _idleTimer([this] { SignalReady(); })
   {
     // set he current time point
     _timePoint1 = std::chrono::system_clock::now();
@@ -74,7 +79,19 @@ namespace myoddweb::directorywatcher::threads
   /// <param name="state">The new value</param>
   void Worker::SetState(const State& state)
   {
+    // we notify while holding the lock so a waiting thread
+    // cannot delete this worker while we are still notifying it.
+    std::lock_guard<std::mutex> lock(_stateChangedLock);
     _state = state;
+    _stateChanged.notify_all();
+
+    // the threads of our pool waiting for us are waiting for its tasks, and we might not
+    // have completed in one of them, (if we did not want to start for example).
+    const auto pool = _pool.load();
+    if (pool != nullptr && state == State::complete)
+    {
+      pool->WakeCompletedTaskWaiters();
+    }
   }
 
   /**
@@ -113,8 +130,51 @@ namespace myoddweb::directorywatcher::threads
   void Worker::Stop()
   {
     MYODDWEB_PROFILE_FUNCTION();
-    MYODDWEB_LOCK(_lockState);
-    StopInLock();
+    {
+      MYODDWEB_LOCK(_lockState);
+      StopInLock();
+    }
+
+    // the pool needs to update us one last time so we can end.
+    SignalReady();
+  }
+
+  /// <summary>
+  /// Flag that this worker has something to do, (data arrived, stop requested and so on).
+  /// If the worker is in a pool, the pool is woken up and updates it at its next tick.
+  /// </summary>
+  void Worker::SignalReady()
+  {
+    // if we were flagged already then the pool was woken up already.
+    if (_ready.exchange(true))
+    {
+      return;
+    }
+
+    const auto pool = _pool.load();
+    if (pool != nullptr)
+    {
+      pool->AddReadyWorker(*this);
+    }
+  }
+
+  /// <summary>
+  /// The longest the pool can go without updating this worker when it did not signal that it is ready.
+  /// The pool asks after every update and registers the deadline in its timer wheel.
+  /// By default we are updated at every tick of the pool.
+  /// </summary>
+  /// <returns>The number of ms, 0 for every tick or -1 if we only want to be updated when we are ready.</returns>
+  long long Worker::MaxIdleMilliseconds() const
+  {
+    return 0;
+  }
+
+  /// <summary>
+  /// Called before each update of our own loop, by default we simply yield to the other threads.
+  /// </summary>
+  void Worker::OnWorkerYield()
+  {
+    MYODDWEB_YIELD();
   }
 
   void Worker::StopInLock()
@@ -180,15 +240,64 @@ namespace myoddweb::directorywatcher::threads
   /// <returns>Either complete or timeout</returns>
   WaitResult Worker::WaitFor(const long long timeout)
   {
-    // just spin for a while and get out if we complete.
-    if (Wait::SpinUntil([this]
+    const auto until = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout < 0 ? 0 : timeout);
+
+    // if we are waiting from one of the threads of our pool we help with the updates as ours might be one of them.
+    // we then wait for one of the tasks to complete, (our end is one of them), or for a task to be queued.
+    const auto pool = _pool.load();
+    if (pool != nullptr && pool->IsTaskThread())
+    {
+      for (;;)
       {
-        return Completed();
-      }, timeout))
+        if (pool->RunPendingTask())
+        {
+          continue;
+        }
+
+        // get the count before we check so we do not miss a task completing in between.
+        const auto numberOfCompletedTasks = pool->NumberOfCompletedTasks();
+        if (Completed())
+        {
+          return WaitResult::complete;
+        }
+
+        auto remaining = -1LL;
+        if (timeout >= 0)
+        {
+          remaining = std::chrono::duration_cast<std::chrono::milliseconds>(until - std::chrono::steady_clock::now()).count();
+          if (remaining <= 0)
+          {
+            return WaitResult::timeout;
+          }
+        }
+        pool->WaitForCompletedTask(numberOfCompletedTasks, remaining);
+      }
+    }
+
+    std::unique_lock<std::mutex> lock(_stateChangedLock);
+    for (;;)
     {
-      return WaitResult::complete;
+      if (Completed())
+      {
+        return WaitResult::complete;
+      }
+
+      const auto now = std::chrono::steady_clock::now();
+      if (timeout >= 0 && now >= until)
+      {
+        return WaitResult::timeout;
+      }
+
+      // otherwise we are woken up as soon as our state changes.
+      if (timeout < 0)
+      {
+        _stateChanged.wait(lock);
+      }
+      else
+      {
+        _stateChanged.wait_until(lock, until);
+      }
     }
-    return WaitResult::timeout;
   }
 
   /**
@@ -203,11 +312,13 @@ namespace myoddweb::directorywatcher::threads
       switch (_state)
       {
       case State::unknown:
-      case State::starting:
       case State::complete:
         // we have not really started
         return WaitResult::complete;
 
+      case State::starting:
+        // the start is running on another thread, stop will wait for it
+        // otherwise that thread would carry on after we returned.
       case State::started:
       case State::stopping:
       case State::stopped:
@@ -323,8 +434,8 @@ namespace myoddweb::directorywatcher::threads
         try
         {
           // make sure that we yield to other thread
-          // from time to time.
-          MYODDWEB_YIELD();
+          // from time to time, we do not hold the lock while we wait.
+          OnWorkerYield();
 
           // grab the lock not because we are doing anything, but because _we_ might be in the middle of an update
           MYODDWEB_LOCK(_lockState);
@@ -2,10 +2,13 @@
 // Florent Guelfucci licenses this file to you under the MIT license.
 // See the LICENSE file in the project root for more information.
 #pragma once
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
 #include <mutex>
 
 #include "../../monitors/Base.h"
+#include "TimerWheel.h"
 #include "WaitResult.h"
 
 namespace myoddweb:: directorywatcher:: threads
@@ -46,6 +49,37 @@ namespace myoddweb:: directorywatcher:: threads
      */
     MYODDWEB_MUTEX _lockState;
 
+    /// <summary>
+    /// If the worker has something to do since the last time the pool updated it.
+    /// </summary>
+    std::atomic<bool> _ready;
+
+    /// <summary>
+    /// The pool that is looking after this worker, if any.
+    /// </summary>
+    std::atomic<WorkerPool*> _pool;
+
+    /// <summary>
+    /// When the pool last updated this worker.
+    /// </summary>
+    std::chrono::steady_clock::time_point _lastUpdate;
+
+    /// <summary>
+    /// The lock used to wait for our state to change.
+    /// </summary>
+    std::mutex _stateChangedLock;
+
+    /// <summary>
+    /// Notified when our state changes so we can wait for it to complete without spinning.
+    /// </summary>
+    std::condition_variable _stateChanged;
+
+    /// <summary>
+    /// Scheduled in the timer wheel of our pool when we need to be updated even if we are not ready.
+    /// This is our last member so it is cancelled before anything it uses is destroyed.
+    /// </summary>
+    TimerWheel::Timer _idleTimer;
+
   public:
     Worker(const Worker&) = delete;
     Worker(Worker&&) = delete;
@@ -86,6 +120,12 @@ namespace myoddweb:: directorywatcher:: threads
      */
     void Stop();
 
+    /// <summary>
+    /// Flag that this worker has something to do, (data arrived, stop requested and so on).
+    /// If the worker is in a pool, the pool is woken up and updates it at its next tick.
+    /// </summary>
+    void SignalReady();
+
     /// <summary>
     /// Get the Id of this worker.
     /// </summary>
@@ -174,6 +214,20 @@ namespace myoddweb:: directorywatcher:: threads
     /// <param name="state">The new value</param>
     void SetState(const State& state);
 
+    /// <summary>
+    /// The longest the pool can go without updating this worker when it did not signal that it is ready.
+    /// The pool asks after every update and registers the deadline in its timer wheel.
+    /// By default we are updated at every tick of the pool.
+    /// </summary>
+    /// <returns>The number of ms, 0 for every tick or -1 if we only want to be updated when we are ready.</returns>
+    [[nodiscard]]
+    virtual long long MaxIdleMilliseconds() const;
+
+    /// <summary>
+    /// Called before each update of our own loop, by default we simply yield to the other threads.
+    /// </summary>
+    virtual void OnWorkerYield();
+
     /// <summary>
     /// called when the worker is ready to start
     /// </summary>
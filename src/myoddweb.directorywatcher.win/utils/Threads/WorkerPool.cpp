@@ -2,8 +2,8 @@
 // Florent Guelfucci licenses this file to you under the MIT license.
 // See the LICENSE file in the project root for more information.
 #include "WorkerPool.h"
+#include <algorithm>
 #include <cassert>
-#include <execution>
 
 #include "../Lock.h"
 #include "../Logger.h"
@@ -17,9 +17,23 @@ namespace myoddweb::directorywatcher::threads
   /// </summary>
   /// <param name="throttleElapsedTimeMilliseconds">How often we want updates to happen</param>
   WorkerPool::WorkerPool( const long long throttleElapsedTimeMilliseconds) :
+    WorkerPool(throttleElapsedTimeMilliseconds, MYODDWEB_WORKERPOOL_THREADS)
+  {
+  }
+
+  /// <summary>
+  /// Called when when the pool is starting
+  /// </summary>
+  /// <param name="throttleElapsedTimeMilliseconds">How often we want updates to happen</param>
+  /// <param name="numberOfThreads">The number of threads running the updates, 0 to use the number of hardware threads.</param>
+  WorkerPool::WorkerPool(const long long throttleElapsedTimeMilliseconds, const unsigned int numberOfThreads) :
     _throttleElapsedTimeMilliseconds(static_cast<float>(throttleElapsedTimeMilliseconds)),
-    _fElapsedTimeMilliseconds( 0 ),
-    _thread( nullptr)
+    _nextTick( std::chrono::steady_clock::now() ),
+    _nextUpdateMilliseconds( 0 ),
+    _tasks( numberOfThreads ),
+    _thread( nullptr),
+    _pendingWorkers( nullptr ),
+    _isEnding( false )
   {
   }
 
@@ -43,7 +57,7 @@ namespace myoddweb::directorywatcher::threads
 #ifdef _DEBUG
       // make sure that the memory is clear.
       assert(_thread == nullptr);
-      assert(_addFutures.empty());
+      assert(_pendingWorkers == nullptr);
       assert(_workerAndFutures.empty());
 #endif
     }
@@ -61,13 +75,15 @@ namespace myoddweb::directorywatcher::threads
   /// <param name="worker">The worker we want to add.</param>
   void WorkerPool::Add(Worker& worker)
   {
-    // just add the worker to our list of workers.
-    // we do that in a thread in case we have workers that add within workers.
-    MYODDWEB_LOCK(_addFuturesLock);
-    _addFutures.push_back( new std::future<void>(std::async(std::launch::async, [this, &worker]
-      {
-        AddWorker(worker);
-      })));
+    // we cannot add the worker to our list here as we might be called from within
+    // one of our own updates, so we queue it and the whole queue is added in one go.
+    const auto pendingWorker = new PendingWorker{ &worker, _pendingWorkers.load() };
+    while (!_pendingWorkers.compare_exchange_weak(pendingWorker->_next, pendingWorker))
+    {
+    }
+
+    // make sure that the thread is running and that it knows about the new worker.
+    StartWorkerThreadForPendingWorkers();
   }
 
   /// <summary>
@@ -78,8 +94,8 @@ namespace myoddweb::directorywatcher::threads
   /// <returns>Either complete or timeout</returns>
   WaitResult WorkerPool::WaitFor(Worker& worker, const long long timeout)
   {
-    // wait for everybody to be added
-    WaitForAllAddFuturesPending();
+    // make sure that everybody is added
+    AddAllPendingWorkers();
 
     // look for that worker
     if (!Exists(worker))
@@ -104,8 +120,8 @@ namespace myoddweb::directorywatcher::threads
   /// <returns>Either complete or timeout</returns>
   WaitResult WorkerPool::WaitFor(const long long timeout)
   {
-    // wait for everybody to be added
-    WaitForAllAddFuturesPending();
+    // make sure that everybody is added
+    AddAllPendingWorkers();
 
     StartWorkerThreadIfNeeded();
     const auto wait = Worker::WaitFor( timeout );
@@ -149,20 +165,24 @@ namespace myoddweb::directorywatcher::threads
     // to make sure that everybody is started
     StartAllPendingWorkers();
 
-    // first we will stop the workers
+    // first we will stop all the workers so they can all end at the same time.
+    for (const auto& worker : workers)
+    {
+      if (Exists(*worker))
+      {
+        worker->Stop();
+      }
+    }
+
     // we now need to wait for all the processes to finish
-    std::for_each(
-      std::execution::par,
-      workers.begin(),
-      workers.end(),
-      [timeout, this](Worker* worker)
+    // if we are one of the update threads we will help with the pending updates while we wait.
+    for (const auto& worker : workers)
+    {
+      if (Exists(*worker))
       {
-        if (Exists(*worker))
-        {
-          worker->StopAndWait(timeout);
-        }
+        worker->StopAndWait(timeout);
       }
-    );
+    }
 
     // then make sure that the futures are done
     return WaitForAllFuturesToComplete(workers, timeout);
@@ -203,7 +223,14 @@ namespace myoddweb::directorywatcher::threads
     // now that our futures are complete, (the ones we are aware of)
     // we can call ourselves to stop
     // if we could not complete the futures, then we cannot stop
-    return Worker::StopAndWait(timeout);
+    if (WaitResult::timeout == Worker::StopAndWait(timeout))
+    {
+      return WaitResult::timeout;
+    }
+
+    // as we ended we might have ended some of the workers as well
+    // so we need to wait for those futures as well.
+    return WaitForAllFuturesToComplete(timeout);
   }
   #pragma endregion
 
@@ -220,6 +247,9 @@ namespace myoddweb::directorywatcher::threads
 
     // send a stop notification to all the workers.
     StopAllWorkers();
+
+    // and make sure that our thread is not sleeping.
+    Wake();
   }
 
   /// <summary>
@@ -233,31 +263,55 @@ namespace myoddweb::directorywatcher::threads
 
   /// <summary>
   /// Called at regular intervals
+  /// We only look at the workers that were signaled, whose timer expired or whose future completed.
   /// </summary>
-  /// <param name="fElapsedTimeMilliseconds"></param>
+  /// <param name="fElapsedTimeMilliseconds">Not used, each worker is given the time since its own last update.</param>
   /// <returns>False if we want to end the pool or true if we want to continue</returns>
-  bool WorkerPool::OnWorkerUpdate(const float fElapsedTimeMilliseconds)
+  bool WorkerPool::OnWorkerUpdate([[maybe_unused]] const float fElapsedTimeMilliseconds)
   {
-    // wait for all the start workers
-    WaitForAllAddFuturesPending();
+    // add all the workers that are waiting.
+    AddAllPendingWorkers();
+
+    // if some updates have been blocking all our threads for too long, we need one more.
+    _tasks.AddThreadIfStarved();
+
+    // the timers of the workers that are due add them to the ready list.
+    _timers.Advance();
 
-    // assume that none of our workers want to continue
-    // ignore the completed workers.
-    auto mustContinue = false;
+    // the updates are only given out at every tick.
+    const auto now = std::chrono::steady_clock::now();
+    const auto isTick = now >= _nextTick;
+    const auto nextTickMilliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(_nextTick - now).count();
 
-    // update our elasped time
-    _fElapsedTimeMilliseconds += fElapsedTimeMilliseconds;
+    // until one of the workers is due we can sleep until we are woken up.
+    auto nextUpdateMilliseconds = -1LL;
+
+    // the workers that were waiting for this tick are looked at again.
+    auto workers = TakeReadyWorkers();
+    if (isTick)
+    {
+      workers.insert(workers.end(), _nextTickWorkers.begin(), _nextTickWorkers.end());
+      _nextTickWorkers.clear();
+    }
+    else if (!_nextTickWorkers.empty())
+    {
+      KeepEarliestUpdate(nextUpdateMilliseconds, nextTickMilliseconds);
+    }
 
     MYODDWEB_LOCK(_workerAndFuturesLock);
-    for (const auto& workerAndFuture : _workerAndFutures)
+    for (const auto& worker : workers)
     {
-      // the worker
-      const auto worker = workerAndFuture.first;
+      // the worker might have been removed since it was added to the list.
+      if (_workerAndFutures.find(worker) == _workerAndFutures.end())
+      {
+        continue;
+      }
 
       // if that worker is completed then we do not care
       // it will be removed at some other poing
       if (worker->Completed())
       {
+        _activeWorkers.erase(worker);
         continue;
       }
 
@@ -268,29 +322,30 @@ namespace myoddweb::directorywatcher::threads
         if (!worker->WorkerStart())
         {
           // it does not want to start so it has to be completed.
-          // we do not change the mustContinue flag in case
-          // another worker wants to continue.
           assert(worker->Completed());
+          _activeWorkers.erase(worker);
           continue;
         }
+
+        // from now on it is updated when it is ready or when its timer is due.
+        worker->_lastUpdate = now;
+        ScheduleIdleTimer(*worker);
       }
 
-      // while we are in the quick update loop, we want to check if the future returned false,
-      // or if we completed our end workers.
-      // if it did, then we need to end it right away rather than waiting for the next loop.
+      // check if the end future is complete or still running.
+      // either way, there is nothing more for us to do with this worker for now.
       const auto end = GetEndFutureEndStateInLock(*worker);
       if (FutureEndState::CompleteTrue == end )
       {
         // we are now completely done with this worker
         // all the updates and end futures have been called.
-        // we don't change the flag in case someone else wants to continue
+        _activeWorkers.erase(worker);
         continue;
       }
 
       if (FutureEndState::StillRunning == end )
       {
-        // this is still running, so we want to go on.
-        mustContinue = true;
+        // it will be added back to the list when it completes.
         continue;
       }
 
@@ -299,49 +354,74 @@ namespace myoddweb::directorywatcher::threads
       {
         // the worker returned false, so it wants to end
         WorkerEndInLock( *worker );
-
-        // we want to continue, only once the end future is done can we end
-        mustContinue = true;
         continue;
       }
-      else if (FutureEndState::StillRunning == update)
+
+      if (FutureEndState::StillRunning == update)
       {
         // the worker is still busy, so we do not want to call it again
-        // so we must go around one more time.
-        mustContinue = true;
+        // it will be added back to the list when it completes.
         continue;
       }
 
-      // if the timeout has expired
-      if(_fElapsedTimeMilliseconds < _throttleElapsedTimeMilliseconds )
+      // if the worker is not ready or due, there is nothing to do.
+      if (!IsWorkerDue(*worker))
       {
-        mustContinue = true;
         continue;
       }
 
-      // we can now call the update
-      if (!UpdateOnceInLock( *worker, _fElapsedTimeMilliseconds ))
+      // if the timeout has not expired we will come back for it at the next tick.
+      if(!isTick)
       {
-        WorkerEndInLock(*worker);
+        _nextTickWorkers.push_back(worker);
+        KeepEarliestUpdate(nextUpdateMilliseconds, nextTickMilliseconds);
+        continue;
+      }
 
+      // anything signaled from now on will be for the next update.
+      worker->_ready = false;
+      const auto idleTimeMilliseconds = std::chrono::duration<float, std::milli>(now - worker->_lastUpdate).count();
+      worker->_lastUpdate = now;
+
+      // we can now call the update
+      if (!UpdateOnceInLock( *worker, idleTimeMilliseconds))
+      {
         // we want to continue, only once the end future is done can we end
-        mustContinue = true;
-        continue;
+        WorkerEndInLock(*worker);
       }
+    }
 
-      // because at least one worker wants to continue
-      // so we will go forward once more.
-      mustContinue = true;
+    // while tasks are waiting for a thread we need to come back to check that our threads are not all blocked.
+    if (_tasks.HasPendingTasks())
+    {
+      KeepEarliestUpdate(nextUpdateMilliseconds, static_cast<long long>(_throttleElapsedTimeMilliseconds));
     }
 
     // did we go over our elapsed time?
-    if (_fElapsedTimeMilliseconds >= _throttleElapsedTimeMilliseconds)
+    if (isTick)
     {
-      _fElapsedTimeMilliseconds = 0;
+      _nextTick = now + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<float, std::milli>(_throttleElapsedTimeMilliseconds));
     }
 
-    // return if we must continue or not or if we still have pending futures.
-    return mustContinue || HasAddFuturesPending();
+    // this is how long our thread can now sleep for, including the timers we scheduled for the workers we started.
+    KeepEarliestUpdate(nextUpdateMilliseconds, _timers.Advance());
+    _nextUpdateMilliseconds = nextUpdateMilliseconds;
+
+    // we continue for as long as one of our workers is not complete.
+    if (!_activeWorkers.empty())
+    {
+      return true;
+    }
+
+    // or if we still have workers to add, a worker added after this check
+    // will see that we are ending and start a new thread.
+    MYODDWEB_LOCK(_threadLock);
+    if (HasPendingWorkers())
+    {
+      return true;
+    }
+    _isEnding = true;
+    return false;
   }
 
   /// <summary>
@@ -349,8 +429,8 @@ namespace myoddweb::directorywatcher::threads
   /// </summary>
   void WorkerPool::OnWorkerEnd()
   {
-    // wait for all the start workers
-    WaitForAllAddFuturesPending();
+    // add all the workers that are waiting.
+    AddAllPendingWorkers();
 
     MYODDWEB_LOCK(_workerAndFuturesLock);
     for (const auto& workerAndFutures : _workerAndFutures)
@@ -368,6 +448,23 @@ namespace myoddweb::directorywatcher::threads
       WorkerEndInLock( *worker );
     }
   }
+
+  /// <summary>
+  /// Sleep until one of our workers is due or until we are woken up.
+  /// </summary>
+  void WorkerPool::OnWorkerYield()
+  {
+    // something is due right away, so we only give the other threads a chance.
+    if (_nextUpdateMilliseconds == 0)
+    {
+      Worker::OnWorkerYield();
+      return;
+    }
+
+    // we never sleep forever in case a worker changed without telling us.
+    const auto wait = _nextUpdateMilliseconds < 0 ? MYODDWEB_WORKERPOOL_MAX_IDLE : std::min<long long>(_nextUpdateMilliseconds, MYODDWEB_WORKERPOOL_MAX_IDLE);
+    _signal.Wait(wait);
+  }
   #pragma endregion
 
   #pragma region Private Helpers
@@ -379,8 +476,8 @@ namespace myoddweb::directorywatcher::threads
   /// <returns></returns>
   bool WorkerPool::StartAllPendingWorkers()
   {
-    // wait for all the start workers
-    WaitForAllAddFuturesPending();
+    // add all the workers that are waiting.
+    AddAllPendingWorkers();
 
     // if anything started and returned true
     // by default we assume that nothing started
@@ -412,6 +509,10 @@ namespace myoddweb::directorywatcher::threads
         assert(worker->Completed());
         continue;
       }
+
+      // from now on it is updated when it is ready or when its timer is due.
+      worker->_lastUpdate = std::chrono::steady_clock::now();
+      ScheduleIdleTimer(*worker);
       startedOrRunning = true;
     }
 
@@ -467,7 +568,9 @@ namespace myoddweb::directorywatcher::threads
     MYODDWEB_LOCK(_threadLock);
     delete _thread;
     _thread = nullptr;
-    _fElapsedTimeMilliseconds = 0;
+    _nextTick = std::chrono::steady_clock::now();
+    _nextUpdateMilliseconds = 0;
+    _isEnding = false;
     SetState(State::unknown);
   }
 
@@ -486,6 +589,37 @@ namespace myoddweb::directorywatcher::threads
     _thread = new Thread(*this);
   }
 
+  /// <summary>
+  /// Make sure that our thread will look at the workers that were just added.
+  /// If our thread already decided to end, we wait for it to complete and start a new one.
+  /// </summary>
+  void WorkerPool::StartWorkerThreadForPendingWorkers()
+  {
+    // if the work is complete then we need to restart it
+    DeleteWorkerThreadIfComplete();
+
+    {
+      MYODDWEB_LOCK(_threadLock);
+      if (!_isEnding)
+      {
+        // our thread will see the new workers before it can decide to end.
+        if (_thread == nullptr)
+        {
+          _thread = new Thread(*this);
+        }
+        Wake();
+        return;
+      }
+    }
+
+    // our thread is ending without the new workers, we cannot hold the lock
+    // while we wait as it might need it before it completes.
+    Worker::WaitFor(-1);
+    DeleteWorkerThreadIfComplete();
+    StartWorkerThreadIfNeeded();
+    Wake();
+  }
+
   /// <summary>
   /// Get the current number of running workers
   /// </summary>
@@ -507,26 +641,192 @@ namespace myoddweb::directorywatcher::threads
   }
 
   /// <summary>
-  /// Safely add a container to the list.
+  /// Add all the pending workers to our list in one go.
   /// </summary>
-  /// <param name="worker">The container to add.</param>
-  void WorkerPool::AddWorker(Worker& worker)
+  void WorkerPool::AddAllPendingWorkers()
   {
+    // take the whole queue at once.
+    auto pendingWorker = _pendingWorkers.exchange(nullptr);
+    if (pendingWorker == nullptr)
+    {
+      return;
+    }
+
+    // the newest worker is first, so we reverse the list to add them in order.
+    PendingWorker* oldestWorker = nullptr;
+    while (pendingWorker != nullptr)
+    {
+      const auto next = pendingWorker->_next;
+      pendingWorker->_next = oldestWorker;
+      oldestWorker = pendingWorker;
+      pendingWorker = next;
+    }
+
     // if the work is complete then we need to restart it
     DeleteWorkerThreadIfComplete();
 
-    MYODDWEB_LOCK(_workerAndFuturesLock);
-    // make sure that this worker does not exist already.
-    const auto it = _workerAndFutures.find(&worker);
-    if( it != _workerAndFutures.end() )
     {
-      return;
-    }
+      MYODDWEB_LOCK(_workerAndFuturesLock);
+      while (oldestWorker != nullptr)
+      {
+        // make sure that this worker does not exist already.
+        const auto worker = oldestWorker->_worker;
+        if (_workerAndFutures.find(worker) == _workerAndFutures.end())
+        {
+          _workerAndFutures[worker] = nullptr;
+          _activeWorkers.insert(worker);
+          worker->_pool = this;
+        }
 
-    _workerAndFutures[&worker] = nullptr;
+        // our thread needs to start it.
+        AddReadyWorker(*worker);
+
+        const auto next = oldestWorker->_next;
+        delete oldestWorker;
+        oldestWorker = next;
+      }
+    }
 
     // make sure that the thread is running
     StartWorkerThreadIfNeeded();
+
+    // and that it knows about the new workers.
+    Wake();
+  }
+
+  /// <summary>
+  /// Wake our thread so it checks the workers now rather than when the next one is due.
+  /// </summary>
+  void WorkerPool::Wake()
+  {
+    _signal.Notify();
+  }
+
+  /// <summary>
+  /// Add a worker to the list of workers our thread needs to look at, and wake it.
+  /// The worker is not used, so it is safe to call this even if it is removed in the meantime.
+  /// </summary>
+  /// <param name="worker">The worker that is ready, due, or whose future completed.</param>
+  void WorkerPool::AddReadyWorker(Worker& worker)
+  {
+    {
+      MYODDWEB_LOCK(_readyWorkersLock);
+      _readyWorkers.push_back(&worker);
+    }
+    Wake();
+  }
+
+  /// <summary>
+  /// Take all the workers that were added to the ready list since we last looked.
+  /// </summary>
+  /// <returns>The workers, a worker can be in the list more than once.</returns>
+  std::vector<Worker*> WorkerPool::TakeReadyWorkers()
+  {
+    std::vector<Worker*> workers;
+    MYODDWEB_LOCK(_readyWorkersLock);
+    workers.swap(_readyWorkers);
+    return workers;
+  }
+
+  /// <summary>
+  /// Check if a started worker with no update running needs to be updated.
+  /// The workers that are not ready are flagged by their timer when they are due.
+  /// </summary>
+  /// <param name="worker">The worker we are checking.</param>
+  /// <returns>True if it needs to be updated at this tick.</returns>
+  bool WorkerPool::IsWorkerDue(const Worker& worker)
+  {
+    // if it has something to do or if it needs to end, we update it.
+    return worker._ready || worker.MustStop();
+  }
+
+  /// <summary>
+  /// Schedule the timer of a worker for the longest it can go without an update.
+  /// </summary>
+  /// <param name="worker">The worker that was started or updated.</param>
+  void WorkerPool::ScheduleIdleTimer(Worker& worker)
+  {
+    const auto maxIdleMilliseconds = worker.MaxIdleMilliseconds();
+    if (maxIdleMilliseconds < 0)
+    {
+      // it will tell us when it is ready.
+      _timers.Cancel(worker._idleTimer);
+      return;
+    }
+    _timers.Schedule(worker._idleTimer, maxIdleMilliseconds);
+  }
+
+  /// <summary>
+  /// If we are called from one of the threads running the updates, run one of the pending updates.
+  /// </summary>
+  /// <returns>True if we ran an update.</returns>
+  bool WorkerPool::RunPendingTask()
+  {
+    return _tasks.RunPendingTask();
+  }
+
+  /// <summary>
+  /// Check if we are called from one of the threads running the updates.
+  /// </summary>
+  /// <returns>True if the calling thread runs our updates.</returns>
+  bool WorkerPool::IsTaskThread() const
+  {
+    return _tasks.IsTaskThread();
+  }
+
+  /// <summary>
+  /// Check if we are called from one of the temporary threads added when the updates are blocked.
+  /// Those threads stop once they are idle, so they must not start any IO.
+  /// </summary>
+  /// <returns>True if the calling thread is a temporary thread.</returns>
+  bool WorkerPool::IsTemporaryTaskThread() const
+  {
+    return _tasks.IsTemporaryThread();
+  }
+
+  /// <summary>
+  /// Get the number of updates and ends that were completed so far.
+  /// </summary>
+  /// <returns>The number of completed tasks.</returns>
+  long long WorkerPool::NumberOfCompletedTasks() const
+  {
+    return _tasks.NumberOfCompletedTasks();
+  }
+
+  /// <summary>
+  /// Wait until one more update or end completes, until one is queued if we are one of the threads running them,
+  /// or until the timeout.
+  /// </summary>
+  /// <param name="numberOfCompletedTasks">The number of completed tasks we already know about.</param>
+  /// <param name="milliseconds">How long we want to wait for, -1 to wait until a task completes.</param>
+  void WorkerPool::WaitForCompletedTask(const long long numberOfCompletedTasks, const long long milliseconds)
+  {
+    _tasks.WaitForCompletedTask(numberOfCompletedTasks, milliseconds);
+  }
+
+  /// <summary>
+  /// Wake the threads waiting for an update or an end to complete, when a worker completed without one.
+  /// </summary>
+  void WorkerPool::WakeCompletedTaskWaiters()
+  {
+    _tasks.WakeCompletionWaiters();
+  }
+
+  /// <summary>
+  /// Keep the earliest of two update times where -1 means that no update is due.
+  /// </summary>
+  /// <param name="nextUpdateMilliseconds">The current earliest time that will be updated.</param>
+  /// <param name="milliseconds">The time we want to compare with.</param>
+  void WorkerPool::KeepEarliestUpdate(long long& nextUpdateMilliseconds, const long long milliseconds)
+  {
+    if (milliseconds < 0)
+    {
+      return;
+    }
+    if (nextUpdateMilliseconds < 0 || milliseconds < nextUpdateMilliseconds)
+    {
+      nextUpdateMilliseconds = milliseconds;
+    }
   }
 
   /// <summary>
@@ -568,8 +868,8 @@ namespace myoddweb::directorywatcher::threads
 
     // so the future for this worker is still running
     // so we want to get a result for it.
-    // wait one more ms to see if it needs to be complete.
-    const auto wait = std::chrono::milliseconds(1);
+    // we are woken up when it completes so there is no need to wait for it.
+    const auto wait = std::chrono::milliseconds(0);
     if (currentFutures->_update->wait_for(wait) == std::future_status::ready)
     {
       // it is complete! So we can get the result from it.
@@ -615,8 +915,8 @@ namespace myoddweb::directorywatcher::threads
 
     // so the future for this worker is still running
     // so we want to get a result for it.
-    // wait one more ms to see if it needs to be complete.
-    const auto wait = std::chrono::milliseconds(1);
+    // we are woken up when it completes so there is no need to wait for it.
+    const auto wait = std::chrono::milliseconds(0);
     if (currentFutures->_end->wait_for(wait) == std::future_status::ready)
     {
       // it is complete! So we can get the result from it.
@@ -655,10 +955,18 @@ namespace myoddweb::directorywatcher::threads
       return;
     }
 
+    // it no longer needs to be updated.
+    _timers.Cancel(worker._idleTimer);
+
     // get the future we will be calling
-    const auto newFuture = new std::future<void>(std::async(std::launch::async, [&worker]
+    const auto newFuture = new std::future<void>(_tasks.Run<void>([&worker]
       {
         worker.WorkerEnd();
+      },
+      [this, &worker]
+      {
+        // the future is ready, so our thread can now get the result.
+        AddReadyWorker(worker);
       }));
 
     if( nullptr == futures )
@@ -709,9 +1017,21 @@ namespace myoddweb::directorywatcher::threads
     }
 
     // if we are here then we need to create another future
-    const auto newFuture = new std::future<bool>(std::async(std::launch::async, [fElapsedTimeMilliseconds, &worker]
+    const auto newFuture = new std::future<bool>(_tasks.Run<bool>([this, fElapsedTimeMilliseconds, &worker]
+      {
+        const auto result = worker.WorkerUpdateOnce(fElapsedTimeMilliseconds);
+
+        // the worker knows best when it will next need an update, now that it is done.
+        if (result)
+        {
+          ScheduleIdleTimer(worker);
+        }
+        return result;
+      },
+      [this, &worker]
       {
-        return worker.WorkerUpdateOnce(fElapsedTimeMilliseconds);
+        // the future is ready, so our thread can now get the result.
+        AddReadyWorker(worker);
       }));
 
     // then update the current values.
@@ -745,7 +1065,7 @@ namespace myoddweb::directorywatcher::threads
   WaitResult WorkerPool::WaitForAllFuturesToComplete(const std::vector<Worker*>& workers, const long long timeout)
   {
     // wait for the operation to complete.
-    const auto wait = Wait::SpinUntil([this, &workers]
+    const auto wait = WaitForFutures([this, &workers]
       {
         auto stillRunning = false;
         MYODDWEB_LOCK(_workerAndFuturesLock);
@@ -785,7 +1105,7 @@ namespace myoddweb::directorywatcher::threads
   WaitResult WorkerPool::WaitForAllFuturesToComplete( const long long timeout)
   {
     // wait for the operation to complete.
-    const auto wait = Wait::SpinUntil([this]
+    const auto wait = WaitForFutures([this]
       {
         auto stillRunning = false;
         MYODDWEB_LOCK(_workerAndFuturesLock);
@@ -810,6 +1130,46 @@ namespace myoddweb::directorywatcher::threads
     return wait ? WaitResult::complete : WaitResult::timeout;
   }
 
+  /// <summary>
+  /// Wait until a condition on our futures is true, or until the timeout.
+  /// Rather than spinning we sleep until one of the update or end tasks completes.
+  /// </summary>
+  /// <param name="isComplete">Returns true when the futures we are waiting for are complete.</param>
+  /// <param name="timeout">How long we want to wait, -1 to wait until they complete.</param>
+  /// <returns>True if the condition was met, false if we timed out.</returns>
+  bool WorkerPool::WaitForFutures(const std::function<bool()>& isComplete, const long long timeout)
+  {
+    const auto until = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout < 0 ? 0 : timeout);
+    for (;;)
+    {
+      // if we are one of the update threads, the futures might be waiting for us.
+      if (RunPendingTask())
+      {
+        continue;
+      }
+
+      // get the count before we check so we do not miss a task completing in between.
+      const auto numberOfCompletedTasks = _tasks.NumberOfCompletedTasks();
+      if (isComplete())
+      {
+        return true;
+      }
+
+      auto remaining = -1LL;
+      if (timeout >= 0)
+      {
+        remaining = std::chrono::duration_cast<std::chrono::milliseconds>(until - std::chrono::steady_clock::now()).count();
+        if (remaining <= 0)
+        {
+          return false;
+        }
+      }
+
+      // on one of our threads we are also woken up when a task is queued so we can help with it.
+      _tasks.WaitForCompletedTask(numberOfCompletedTasks, remaining);
+    }
+  }
+
   /// <summary>
   /// Remove all the completed workers from the list and free the memories
   /// </summary>
@@ -826,6 +1186,9 @@ namespace myoddweb::directorywatcher::threads
         continue;
       }
       delete workerAndFuture.second;
+      _timers.Cancel(workerAndFuture.first->_idleTimer);
+      _activeWorkers.erase(workerAndFuture.first);
+      workerAndFuture.first->_pool = nullptr;
       workersToRemove.push_back(workerAndFuture.first);
     }
 
@@ -838,58 +1201,12 @@ namespace myoddweb::directorywatcher::threads
   }
 
   /// <summary>
-  /// Check if we have any wokers still being added.
+  /// Check if we still have some workers waiting to be added.
   /// </summary>
   /// <returns>If we still have workers.</returns>
-  bool WorkerPool::HasAddFuturesPending()
+  bool WorkerPool::HasPendingWorkers() const
   {
-    MYODDWEB_LOCK(_addFuturesLock);
-    auto busy = false;
-    const auto wait = std::chrono::milliseconds(1);
-    auto it = _addFutures.begin();
-    while( it != _addFutures.end() )
-    {
-      auto currentFutures = (*it);
-      if( !(*it)->valid())
-      {
-        delete currentFutures;
-        _addFutures.erase(it);
-        it = _addFutures.begin();
-        continue;
-      }
-      
-      if (currentFutures->wait_for(wait) == std::future_status::ready)
-      {
-        currentFutures->get();
-        delete currentFutures;
-        _addFutures.erase(it);
-        it = _addFutures.begin();
-        continue;
-      }
-
-      // if we are her, then we are still busy
-      busy = true;
-
-      // check the others if they can be removed.
-      ++it;
-    }
-    return busy;
-  }
-
-  /// <summary>
-  /// Wait for all the add futures to complete.
-  /// </summary>
-  void WorkerPool::WaitForAllAddFuturesPending()
-  {
-    Wait::SpinUntil([this]
-    {
-      return !HasAddFuturesPending();
-    }, -1);
-
-#ifdef _DEBUG
-    // make sure that the memory is clear.
-    assert(_addFutures.empty());
-#endif
+    return _pendingWorkers.load() != nullptr;
   }
   #pragma endregion 
 }
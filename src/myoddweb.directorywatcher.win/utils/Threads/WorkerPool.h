@@ -2,8 +2,14 @@
 // Florent Guelfucci licenses this file to you under the MIT license.
 // See the LICENSE file in the project root for more information.
 #pragma once
+#include <chrono>
 #include <map>
+#include <set>
+#include <vector>
+#include "TaskPool.h"
 #include "Thread.h"
+#include "TimerWheel.h"
+#include "WorkerSignal.h"
 
 namespace myoddweb:: directorywatcher:: threads
 {
@@ -20,6 +26,13 @@ namespace myoddweb:: directorywatcher:: threads
     /// </summary>
     /// <param name="throttleElapsedTimeMilliseconds">How often we want updates to happen</param>
     explicit WorkerPool(long long throttleElapsedTimeMilliseconds);
+
+    /// <summary>
+    /// Called when when the pool is starting
+    /// </summary>
+    /// <param name="throttleElapsedTimeMilliseconds">How often we want updates to happen</param>
+    /// <param name="numberOfThreads">The number of threads running the updates, 0 to use the number of hardware threads.</param>
+    WorkerPool(long long throttleElapsedTimeMilliseconds, unsigned int numberOfThreads);
     virtual ~WorkerPool();
 
     #pragma region Helpers
@@ -73,6 +86,14 @@ namespace myoddweb:: directorywatcher:: threads
     /// <param name="timeout">The number of ms we want to wait for</param>
     /// <returns>Either timeout or complete if all the workers completed</returns>
     WaitResult StopAndWait(long long timeout) override;
+
+    /// <summary>
+    /// Check if we are called from one of the temporary threads added when the updates are blocked.
+    /// Those threads stop once they are idle, so they must not start any IO.
+    /// </summary>
+    /// <returns>True if the calling thread is a temporary thread.</returns>
+    [[nodiscard]]
+    bool IsTemporaryTaskThread() const;
     #pragma endregion
 
   protected:
@@ -99,9 +120,16 @@ namespace myoddweb:: directorywatcher:: threads
     /// When the worker pool has ended.
     /// </summary>
     void OnWorkerEnd() override;
+
+    /// <summary>
+    /// Sleep until one of our workers is due or until we are woken up.
+    /// </summary>
+    void OnWorkerYield() override;
     #pragma endregion
 
   private:
+    friend Worker;
+
     #pragma region Private Helpers
     enum class FutureEndState
     {
@@ -168,10 +196,90 @@ namespace myoddweb:: directorywatcher:: threads
     };
 
     /// <summary>
-    /// Safely add a container to the list.
+    /// A worker waiting to be added to our list of workers.
+    /// </summary>
+    struct PendingWorker final
+    {
+      Worker* _worker;
+      PendingWorker* _next;
+    };
+
+    /// <summary>
+    /// Add all the pending workers to our list in one go.
+    /// </summary>
+    void AddAllPendingWorkers();
+
+    /// <summary>
+    /// Wake our thread so it checks the workers now rather than when the next one is due.
+    /// </summary>
+    void Wake();
+
+    /// <summary>
+    /// Add a worker to the list of workers our thread needs to look at, and wake it.
+    /// The worker is not used, so it is safe to call this even if it is removed in the meantime.
+    /// </summary>
+    /// <param name="worker">The worker that is ready, due, or whose future completed.</param>
+    void AddReadyWorker(Worker& worker);
+
+    /// <summary>
+    /// Take all the workers that were added to the ready list since we last looked.
+    /// </summary>
+    /// <returns>The workers, a worker can be in the list more than once.</returns>
+    std::vector<Worker*> TakeReadyWorkers();
+
+    /// <summary>
+    /// Check if a started worker with no update running needs to be updated.
+    /// The workers that are not ready are flagged by their timer when they are due.
+    /// </summary>
+    /// <param name="worker">The worker we are checking.</param>
+    /// <returns>True if it needs to be updated at this tick.</returns>
+    static bool IsWorkerDue(const Worker& worker);
+
+    /// <summary>
+    /// Schedule the timer of a worker for the longest it can go without an update.
+    /// </summary>
+    /// <param name="worker">The worker that was started or updated.</param>
+    void ScheduleIdleTimer(Worker& worker);
+
+    /// <summary>
+    /// If we are called from one of the threads running the updates, run one of the pending updates.
+    /// </summary>
+    /// <returns>True if we ran an update.</returns>
+    bool RunPendingTask();
+
+    /// <summary>
+    /// Get the number of updates and ends that were completed so far.
+    /// </summary>
+    /// <returns>The number of completed tasks.</returns>
+    [[nodiscard]]
+    long long NumberOfCompletedTasks() const;
+
+    /// <summary>
+    /// Wait until one more update or end completes, until one is queued if we are one of the threads running them,
+    /// or until the timeout.
+    /// </summary>
+    /// <param name="numberOfCompletedTasks">The number of completed tasks we already know about.</param>
+    /// <param name="milliseconds">How long we want to wait for, -1 to wait until a task completes.</param>
+    void WaitForCompletedTask(long long numberOfCompletedTasks, long long milliseconds);
+
+    /// <summary>
+    /// Wake the threads waiting for an update or an end to complete, when a worker completed without one.
     /// </summary>
-    /// <param name="worker">The container to add.</param>
-    void AddWorker(Worker& worker);
+    void WakeCompletedTaskWaiters();
+
+    /// <summary>
+    /// Check if we are called from one of the threads running the updates.
+    /// </summary>
+    /// <returns>True if the calling thread runs our updates.</returns>
+    [[nodiscard]]
+    bool IsTaskThread() const;
+
+    /// <summary>
+    /// Keep the earliest of two update times where -1 means that no update is due.
+    /// </summary>
+    /// <param name="nextUpdateMilliseconds">The current earliest time that will be updated.</param>
+    /// <param name="milliseconds">The time we want to compare with.</param>
+    static void KeepEarliestUpdate(long long& nextUpdateMilliseconds, long long milliseconds);
 
     /// <summary>
     /// Get the current number of running workers
@@ -184,6 +292,12 @@ namespace myoddweb:: directorywatcher:: threads
     /// </summary>
     void StartWorkerThreadIfNeeded();
 
+    /// <summary>
+    /// Make sure that our thread will look at the workers that were just added.
+    /// If our thread already decided to end, we wait for it to complete and start a new one.
+    /// </summary>
+    void StartWorkerThreadForPendingWorkers();
+
     /// <summary>
     /// Delete the worker thread if the work is complete
     /// So that it can be re-used if needed.
@@ -257,20 +371,24 @@ namespace myoddweb:: directorywatcher:: threads
     WaitResult WaitForAllFuturesToComplete( const std::vector<Worker*>& workers, long long timeout);
 
     /// <summary>
-    /// Remove all the completed workers from the list and free the memories
+    /// Wait until a condition on our futures is true, or until the timeout.
+    /// Rather than spinning we sleep until one of the update or end tasks completes.
     /// </summary>
-    void RemoveAllCompletedWorkers();
+    /// <param name="isComplete">Returns true when the futures we are waiting for are complete.</param>
+    /// <param name="timeout">How long we want to wait, -1 to wait until they complete.</param>
+    /// <returns>True if the condition was met, false if we timed out.</returns>
+    bool WaitForFutures(const std::function<bool()>& isComplete, long long timeout);
 
     /// <summary>
-    /// Check if we still have some pending "Add" futures.
+    /// Remove all the completed workers from the list and free the memories
     /// </summary>
-    /// <returns></returns>
-    bool HasAddFuturesPending();
+    void RemoveAllCompletedWorkers();
 
     /// <summary>
-    /// Wait for all the add futures to complete.
+    /// Check if we still have some workers waiting to be added.
     /// </summary>
-    void WaitForAllAddFuturesPending();
+    /// <returns></returns>
+    bool HasPendingWorkers() const;
 
     /// <summary>
     /// Start all the workers that have yet to start
@@ -288,9 +406,52 @@ namespace myoddweb:: directorywatcher:: threads
     const float _throttleElapsedTimeMilliseconds;
 
     /// <summary>
-    /// This is our actual ellapsed time in ms.
+    /// When the next tick is due.
     /// </summary>
-    float _fElapsedTimeMilliseconds;
+    std::chrono::steady_clock::time_point _nextTick;
+
+    /// <summary>
+    /// How long our thread can sleep before one of the workers is due, -1 if none of them is.
+    /// </summary>
+    long long _nextUpdateMilliseconds;
+
+    /// <summary>
+    /// Used to wake our thread when a worker is ready, added, stopped or when a future completes.
+    /// </summary>
+    WorkerSignal _signal;
+
+    /// <summary>
+    /// The workers that were signaled, whose timer expired or whose future completed since we last looked.
+    /// They are the only workers our thread looks at, so the cost of an update does not depend on the number of workers.
+    /// It must outlive our threads as the tasks add their workers when they complete.
+    /// </summary>
+    std::vector<Worker*> _readyWorkers;
+
+    /// <summary>
+    /// The lock for the ready workers, it can be taken while the timer wheel is locked.
+    /// </summary>
+    MYODDWEB_MUTEX _readyWorkersLock;
+
+    /// <summary>
+    /// The ready workers that are waiting for the next tick, only used by our thread.
+    /// </summary>
+    std::vector<Worker*> _nextTickWorkers;
+
+    /// <summary>
+    /// The workers that were added and are not complete yet, we keep going for as long as we have some.
+    /// </summary>
+    std::set<Worker*> _activeWorkers;
+
+    /// <summary>
+    /// The deadlines of the workers that need to be updated even if they are not ready.
+    /// It must outlive our threads as the updates schedule the timers.
+    /// </summary>
+    TimerWheel _timers;
+
+    /// <summary>
+    /// The threads running the updates and the ends of our workers.
+    /// </summary>
+    TaskPool _tasks;
 
     /// <summary>
     /// Our worker thread.
@@ -303,9 +464,10 @@ namespace myoddweb:: directorywatcher:: threads
     std::map<Worker*, Futures*> _workerAndFutures;
 
     /// <summary>
-    /// All the futures to add workers.
+    /// The workers added since we last looked, newest first.
+    /// Adding is lock free so workers can be added from within our own updates.
     /// </summary>
-    std::vector<std::future<void>*> _addFutures;
+    std::atomic<PendingWorker*> _pendingWorkers;
 
     /// <summary>
     /// The lock to make sure that we do not update the list of workers
@@ -314,14 +476,15 @@ namespace myoddweb:: directorywatcher:: threads
     mutable MYODDWEB_MUTEX _workerAndFuturesLock;
 
     /// <summary>
-    /// Lock for our add futures so we can update the values as required.
+    /// Lock to prevent multiple threads from updating our own thread.
     /// </summary>
-    mutable MYODDWEB_MUTEX _addFuturesLock;
+    mutable MYODDWEB_MUTEX _threadLock;
 
     /// <summary>
-    /// Lock to prevent multiple threads from updating our own thread.
+    /// Set, with the thread lock, once our thread decided to end because it had no more workers.
+    /// The workers added from then on need a new thread.
     /// </summary>
-    mutable MYODDWEB_MUTEX _threadLock;
+    bool _isEnding;
     #pragma endregion
   };
 }
\ No newline at end of file
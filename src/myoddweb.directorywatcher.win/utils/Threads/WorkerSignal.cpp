@@ -0,0 +1,91 @@
+// Licensed to Florent Guelfucci under one or more agreements.
+// Florent Guelfucci licenses this file to you under the MIT license.
+// See the LICENSE file in the project root for more information.
+#include "WorkerSignal.h"
+#include <chrono>
+
+#if defined( _WIN32) || defined(_WIN64 )
+  #include <windows.h>
+#endif
+
+namespace myoddweb:: directorywatcher:: threads
+{
+#if defined( _WIN32) || defined(_WIN64 )
+  WorkerSignal::WorkerSignal() :
+    _event(::CreateEvent(nullptr, FALSE, FALSE, nullptr))
+  {
+  }
+
+  WorkerSignal::~WorkerSignal()
+  {
+    if (_event != nullptr)
+    {
+      ::CloseHandle(_event);
+    }
+  }
+
+  /// <summary>
+  /// Wake the waiting thread, or the next thread that will wait.
+  /// </summary>
+  void WorkerSignal::Notify()
+  {
+    ::SetEvent(_event);
+  }
+
+  /// <summary>
+  /// Wait until we are notified or until the timeout.
+  /// On windows the wait is alertable so the IO completion routines queued to this thread are still called.
+  /// </summary>
+  /// <param name="milliseconds">How long we want to wait for, -1 to wait until notified.</param>
+  /// <returns>True if we were notified, false otherwise.</returns>
+  bool WorkerSignal::Wait(const long long milliseconds)
+  {
+    // if an IO completion routine was called we come out as well
+    // as it might have given one of our workers something to do.
+    const auto wait = milliseconds < 0 ? INFINITE : static_cast<DWORD>(milliseconds);
+    return WAIT_OBJECT_0 == ::WaitForSingleObjectEx(_event, wait, TRUE);
+  }
+#else
+  WorkerSignal::WorkerSignal() :
+    _notified(false)
+  {
+  }
+
+  WorkerSignal::~WorkerSignal() = default;
+
+  /// <summary>
+  /// Wake the waiting thread, or the next thread that will wait.
+  /// </summary>
+  void WorkerSignal::Notify()
+  {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      _notified = true;
+    }
+    _conditionVariable.notify_one();
+  }
+
+  /// <summary>
+  /// Wait until we are notified or until the timeout.
+  /// </summary>
+  /// <param name="milliseconds">How long we want to wait for, -1 to wait until notified.</param>
+  /// <returns>True if we were notified, false otherwise.</returns>
+  bool WorkerSignal::Wait(const long long milliseconds)
+  {
+    std::unique_lock<std::mutex> lock(_mutex);
+    if (milliseconds < 0)
+    {
+      _conditionVariable.wait(lock, [this] { return _notified; });
+    }
+    else
+    {
+      _conditionVariable.wait_for(lock, std::chrono::milliseconds(milliseconds), [this] { return _notified; });
+    }
+
+    // the notification is used, the next wait will need a new one.
+    const auto notified = _notified;
+    _notified = false;
+    return notified;
+  }
+#endif
+}
@@ -0,0 +1,63 @@
+// Licensed to Florent Guelfucci under one or more agreements.
+// Florent Guelfucci licenses this file to you under the MIT license.
+// See the LICENSE file in the project root for more information.
+#pragma once
+#if !defined( _WIN32) && !defined(_WIN64 )
+  #include <condition_variable>
+  #include <mutex>
+#endif
+
+namespace myoddweb:: directorywatcher:: threads
+{
+  /// <summary>
+  /// Wake a sleeping thread when something needs to be done.
+  /// A notification made while nobody is waiting is kept until the next wait.
+  /// </summary>
+  class WorkerSignal final
+  {
+  public:
+    WorkerSignal();
+    ~WorkerSignal();
+
+    WorkerSignal(const WorkerSignal&) = delete;
+    WorkerSignal(WorkerSignal&&) = delete;
+    WorkerSignal& operator=(WorkerSignal&&) = delete;
+    WorkerSignal& operator=(const WorkerSignal&) = delete;
+
+    /// <summary>
+    /// Wake the waiting thread, or the next thread that will wait.
+    /// </summary>
+    void Notify();
+
+    /// <summary>
+    /// Wait until we are notified or until the timeout.
+    /// On windows the wait is alertable so the IO completion routines queued to this thread are still called.
+    /// </summary>
+    /// <param name="milliseconds">How long we want to wait for, -1 to wait until notified.</param>
+    /// <returns>True if we were notified, false otherwise.</returns>
+    bool Wait(long long milliseconds);
+
+  private:
+#if defined( _WIN32) || defined(_WIN64 )
+    /// <summary>
+    /// The auto reset event we are waiting on.
+    /// </summary>
+    void* _event;
+#else
+    /// <summary>
+    /// If we were notified since the last wait.
+    /// </summary>
+    bool _notified;
+
+    /// <summary>
+    /// The lock for the condition variable.
+    /// </summary>
+    std::mutex _mutex;
+
+    /// <summary>
+    /// The condition we are waiting on.
+    /// </summary>
+    std::condition_variable _conditionVariable;
+#endif
+  };
+}
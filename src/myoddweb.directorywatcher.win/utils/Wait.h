@@ -30,6 +30,8 @@ namespace myoddweb
 
       /**
       * \brief the number of ms we want to wait for.
+      *        the condition cannot tell us when it changes so it is checked at growing intervals,
+      *        this is only meant for the tests, the library waits on its own notifications.
       * \param condition if this returns true we will return.
       * \param milliseconds the number of milliseconds we want to wait for
       *        if the timeout is reached, we will simply get out.
@@ -76,18 +78,8 @@ namespace myoddweb
        */
       static bool SpinUntilInternal(std::function<bool()>& condition, long long milliseconds);
 
-      /**
-       * \brief the number of ms we want to spin for
-       *        this function does not do validations.
-       * \param milliseconds the number of milliseconds we want to wait for
-       *        if the timeout is reached, we will simply get out.
-       * \return if the code ran successfully or if there was an issue/error
-       */
-      static bool SpinUntilInternal( long long milliseconds);
-
       /**
        * \brief wait for the future to complete, if it does not complete in time we will get out.
-       *        note that even if the timeout if very large, we will not spin for ever.
        * \param milliseconds the max amount of time we are prepared to wait for.
        * \param future the future we will be waiting for.
        * \return true if the future completed or false if we timed out.
@@ -97,7 +89,6 @@ namespace myoddweb
 
       /**
        * \brief wait for a Thread to complete, if it does not complete we will get out.
-       *        note that even if the timeout if very large, we will not spin for ever.
        * \param milliseconds the max amount of time we are prepared to wait for.
        * \param thread the thread we will be waiting for.
        * \return true if the future completed or false if we timed out.
@@ -106,13 +97,11 @@ namespace myoddweb
 
       /**
        * \brief the main function that does all the waiting.
-       *        the promise will contain the result of the waiting
+       *        we sleep on our condition variable between the checks, until the deadline.
        *          - false = we timedout 
        *          - true = the condition returned true and we stopped waiting.
        * \param condition the condition we wan to run to return out of the function
-       *        if empty/null then we will never check the condition
-       * \param milliseconds the maximum amount of time we want to wait
-       *        if the condition is not set then we will always return false and wait for that number of ms.
+       * \param milliseconds the maximum amount of time we want to wait, -1 to wait until the condition is true.
        */
       bool Awaiter( std::function<bool()>&& condition, const long long milliseconds );
     };
@@ -51,6 +51,107 @@ namespace myoddweb:: directorywatcher
        * \brief the logger callback
        */
       LoggerCallback LoggerCallback;
+
+      /**
+       * \brief if we want to coalesce the events of a path into their net effect
+       *        before they are published, (added+removed cancel out and so on).
+       */
+      bool CoalesceEvents;
+
+      /**
+       * \brief the maximum number of events we will hold between two publish, 0 for no limit.
+       */
+      long long MaxNumberOfEvents;
+
+      /**
+       * \brief the maximum number of bytes the events we hold can use, 0 for no limit.
+       */
+      long long MaxNumberOfBytes;
+
+      /**
+       * \brief what we do when we reach one of the limits, (see OverflowPolicy)
+       */
+      int OverflowPolicy;
+
+      /**
+       * \brief the number of shards the events are collected in, 0 or 1 for a single one.
+       *        each producer thread adds its events to its own shard.
+       */
+      int CollectorShards;
+
+      /**
+       * \brief how long, in ms, we keep half of a rename waiting for the other half, 0 to not wait.
+       *        halves that are not paired in time are published as added/removed events.
+       */
+      long long RenamePairingMs;
+
+      /**
+       * \brief the callback we call with all the events of a publish interval at once.
+       *        if set, it is used instead of the EventsCallback, (see Callbacks.h).
+       */
+      EventsBatchCallback EventsBatchCallback;
+
+      /**
+       * \brief if we want to get the events ourselves with GetEvents( ... ) rather than with a callback.
+       *        the events we did not get are kept for EventsCallbackRateMs.
+       */
+      bool PullEvents;
+
+      /**
+       * \brief if we want to publish the events as soon as they arrive rather than every EventsCallbackRateMs.
+       *        the events are still batched as per MaxBatchDelayMs and MaxBatchSize.
+       */
+      bool LowLatencyEvents;
+
+      /**
+       * \brief in low latency mode, how long we wait for more events after the first one, 0 to publish right away.
+       */
+      long long MaxBatchDelayMs;
+
+      /**
+       * \brief in low latency mode, the number of events that will be published without waiting, 0 for no limit.
+       */
+      long long MaxBatchSize;
+
+      /**
+       * \brief the callback with the extended statistics, called every StatisticsCallbackRateMs.
+       */
+      StatisticsExCallback StatisticsExCallback;
+
+      /**
+       * \brief if not 0, the events are given to the callback by a dedicated thread
+       *        and this is the maximum number of batches waiting for that thread.
+       */
+      long long DispatchQueueSize;
+
+      /**
+       * \brief the number of threads giving the events to the callback.
+       *        the events are split by path so the events of a given path are always given in order
+       *        but the callback can be called by more than one thread at a time.
+       */
+      long long DispatchThreads;
+
+      /**
+       * \brief the '|' separated glob patterns the paths must match, null or empty to include everything.
+       */
+      wchar_t* IncludePatterns;
+
+      /**
+       * \brief the '|' separated glob patterns of the paths we do not want, (for example "*.tmp|.git|bin\**").
+       */
+      wchar_t* ExcludePatterns;
+
+      /**
+       * \brief the actions we want to be told about, (see ActionsMask), 0 for all of them.
+       *        the actions we do not want are not asked to the file system when possible.
+       */
+      int ActionsMask;
+
+      /**
+       * \brief the kind of changes that raise a touched event, (see ChangesMask), 0 for all of them.
+       *        for example, the last access time and the attributes changes can be ignored.
+       */
+      int ChangesMask;
     };
   }
 
@@ -77,4 +178,18 @@ namespace myoddweb:: directorywatcher
    * \return if it is ready or not.
    */
   extern "C" { __declspec(dllexport) bool Ready(); }
+
+  /**
+   * \brief copy the pending events of a monitor to the given buffers, (see Callbacks.h).
+   *        the monitor must have been started with PullEvents.
+   * \param id the id of the monitor.
+   * \param events where we will copy the events, from the oldest to the newest.
+   * \param eventsCapacity the number of events we can copy.
+   * \param names where we will copy the null terminated names of the events.
+   * \param namesCapacity the number of characters we can copy.
+   * \param numberOfEvents the number of events we copied.
+   * \param numberOfCharacters the number of characters we copied.
+   * \return the number of events that did not fit and are still pending or -ve if the monitor does not exist or does not pull its events.
+   */
+  extern "C" { __declspec(dllexport) long long GetEvents(long long id, sEvent* events, int eventsCapacity, wchar_t* names, int namesCapacity, int* numberOfEvents, int* numberOfCharacters); }
 }
\ No newline at end of file
@@ -17,6 +17,9 @@ namespace myoddweb.directorywatcher
     /// <inheritdoc />
     public IRates Rates { get; }
 
+    /// <inheritdoc />
+    public bool PullEvents { get; }
+
     /// <summary>
     /// Create the default requests
     /// </summary>
@@ -33,11 +36,24 @@ namespace myoddweb.directorywatcher
     /// <param name="path">The path we want to watch</param>
     /// <param name="recursive">Recursively watch or not.</param>
     /// <param name="rates">The various refresh rates</param>
-    public Request(string path, bool recursive, IRates rates )
+    public Request(string path, bool recursive, IRates rates ) :
+      this(path, recursive, rates, false)
+    {
+    }
+
+    /// <summary>
+    /// Create the default requests
+    /// </summary>
+    /// <param name="path">The path we want to watch</param>
+    /// <param name="recursive">Recursively watch or not.</param>
+    /// <param name="rates">The various refresh rates</param>
+    /// <param name="pullEvents">If we pull the events rather than being given them.</param>
+    public Request(string path, bool recursive, IRates rates, bool pullEvents )
     {
       Path = path ?? throw new ArgumentNullException(nameof(path));
       Recursive = recursive;
       Rates = rates ?? throw new ArgumentNullException(nameof(rates));
+      PullEvents = pullEvents;
     }
 
   }
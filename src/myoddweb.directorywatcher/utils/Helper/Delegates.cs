@@ -23,6 +23,150 @@ namespace myoddweb.directorywatcher.utils.Helper
       public long StatisticsCallbackIntervalMs;
 
       public LoggerCallback LoggerCallback;
+
+      [MarshalAs(UnmanagedType.I1)]
+      public bool CoalesceEvents;
+
+      [MarshalAs(UnmanagedType.I8)]
+      public long MaxNumberOfEvents;
+
+      [MarshalAs(UnmanagedType.I8)]
+      public long MaxNumberOfBytes;
+
+      [MarshalAs(UnmanagedType.I4)]
+      public int OverflowPolicy;
+
+      [MarshalAs(UnmanagedType.I4)]
+      public int CollectorShards;
+
+      [MarshalAs(UnmanagedType.I8)]
+      public long RenamePairingMs;
+
+      public EventsBatchCallback EventsBatchCallback;
+
+      [MarshalAs(UnmanagedType.I1)]
+      public bool PullEvents;
+
+      [MarshalAs(UnmanagedType.I1)]
+      public bool LowLatencyEvents;
+
+      [MarshalAs(UnmanagedType.I8)]
+      public long MaxBatchDelayMs;
+
+      [MarshalAs(UnmanagedType.I8)]
+      public long MaxBatchSize;
+
+      public StatisticsExCallback StatisticsExCallback;
+
+      [MarshalAs(UnmanagedType.I8)]
+      public long DispatchQueueSize;
+
+      [MarshalAs(UnmanagedType.I8)]
+      public long DispatchThreads;
+
+      [MarshalAs(UnmanagedType.LPWStr)]
+      public string IncludePatterns;
+
+      [MarshalAs(UnmanagedType.LPWStr)]
+      public string ExcludePatterns;
+
+      [MarshalAs(UnmanagedType.I4)]
+      public int ActionsMask;
+
+      [MarshalAs(UnmanagedType.I4)]
+      public int ChangesMask;
+    }
+
+    [StructLayout(LayoutKind.Sequential)]
+    public struct Event
+    {
+      [MarshalAs(UnmanagedType.I8)]
+      public long DateTimeUtc;
+
+      [MarshalAs(UnmanagedType.I4)]
+      public int Name;
+
+      [MarshalAs(UnmanagedType.I4)]
+      public int OldName;
+
+      [MarshalAs(UnmanagedType.I4)]
+      public int Action;
+
+      [MarshalAs(UnmanagedType.I4)]
+      public int Error;
+
+      [MarshalAs(UnmanagedType.I4)]
+      public int IsFile;
+    }
+
+    [StructLayout(LayoutKind.Sequential)]
+    public struct Statistics
+    {
+      [MarshalAs(UnmanagedType.R8)]
+      public double ElapsedTime;
+
+      [MarshalAs(UnmanagedType.I8)]
+      public long NumberOfEvents;
+
+      [MarshalAs(UnmanagedType.I8)]
+      public long NumberOfAdded;
+
+      [MarshalAs(UnmanagedType.I8)]
+      public long NumberOfRemoved;
+
+      [MarshalAs(UnmanagedType.I8)]
+      public long NumberOfTouched;
+
+      [MarshalAs(UnmanagedType.I8)]
+      public long NumberOfRenamed;
+
+      [MarshalAs(UnmanagedType.I8)]
+      public long NumberOfErrors;
+
+      [MarshalAs(UnmanagedType.I8)]
+      public long NumberOfOverflows;
+
+      [MarshalAs(UnmanagedType.I8)]
+      public long NumberOfDroppedEvents;
+
+      [MarshalAs(UnmanagedType.I8)]
+      public long EventAgeP50;
+
+      [MarshalAs(UnmanagedType.I8)]
+      public long EventAgeP90;
+
+      [MarshalAs(UnmanagedType.I8)]
+      public long EventAgeP99;
+
+      [MarshalAs(UnmanagedType.I8)]
+      public long EventAgeMax;
+
+      [MarshalAs(UnmanagedType.I8)]
+      public long CallbackDurationP50;
+
+      [MarshalAs(UnmanagedType.I8)]
+      public long CallbackDurationP90;
+
+      [MarshalAs(UnmanagedType.I8)]
+      public long CallbackDurationP99;
+
+      [MarshalAs(UnmanagedType.I8)]
+      public long CallbackDurationMax;
+
+      [MarshalAs(UnmanagedType.I8)]
+      public long DepthP50;
+
+      [MarshalAs(UnmanagedType.I8)]
+      public long DepthP90;
+
+      [MarshalAs(UnmanagedType.I8)]
+      public long DepthP99;
+
+      [MarshalAs(UnmanagedType.I8)]
+      public long DepthMax;
+
+      [MarshalAs(UnmanagedType.I8)]
+      public long DispatchBlockedTime;
     }
 
     // Delegate with function signature for the GetVersion function
@@ -38,6 +182,18 @@ namespace myoddweb.directorywatcher.utils.Helper
     [return: MarshalAs(UnmanagedType.Bool)]
     public delegate bool Ready();
 
+    [UnmanagedFunctionPointer(CallingConvention.Cdecl, CharSet = CharSet.Unicode)]
+    [return: MarshalAs(UnmanagedType.I8)]
+    public delegate long GetEvents(
+      [In, MarshalAs(UnmanagedType.I8)] long id,
+      [Out] Event[] events,
+      [MarshalAs(UnmanagedType.I4)] int eventsCapacity,
+      [Out] char[] names,
+      [MarshalAs(UnmanagedType.I4)] int namesCapacity,
+      [MarshalAs(UnmanagedType.I4)] out int numberOfEvents,
+      [MarshalAs(UnmanagedType.I4)] out int numberOfCharacters
+    );
+
     [UnmanagedFunctionPointer(CallingConvention.StdCall)]
     public delegate void EventsCallback(
       [MarshalAs(UnmanagedType.I8)] long id,
@@ -49,6 +205,15 @@ namespace myoddweb.directorywatcher.utils.Helper
       [MarshalAs(UnmanagedType.I8)] long dateTimeUtc
     );
 
+    [UnmanagedFunctionPointer(CallingConvention.StdCall)]
+    public delegate void EventsBatchCallback(
+      [MarshalAs(UnmanagedType.I8)] long id,
+      System.IntPtr events,
+      [MarshalAs(UnmanagedType.I4)] int numberOfEvents,
+      System.IntPtr names,
+      [MarshalAs(UnmanagedType.I4)] int numberOfCharacters
+    );
+
     [UnmanagedFunctionPointer(CallingConvention.StdCall)]
     public delegate void StatisticsCallback(
       [MarshalAs(UnmanagedType.I8)] long id,
@@ -56,6 +221,12 @@ namespace myoddweb.directorywatcher.utils.Helper
       [MarshalAs(UnmanagedType.I8)] long numberOfEvents
     );
 
+    [UnmanagedFunctionPointer(CallingConvention.StdCall)]
+    public delegate void StatisticsExCallback(
+      [MarshalAs(UnmanagedType.I8)] long id,
+      ref Statistics statistics
+    );
+
     [UnmanagedFunctionPointer(CallingConvention.StdCall)]
     public delegate void LoggerCallback(
       [MarshalAs(UnmanagedType.I8)] long id,
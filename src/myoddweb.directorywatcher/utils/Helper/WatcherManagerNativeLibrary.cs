@@ -1,5 +1,6 @@
 ﻿using myoddweb.directorywatcher.interfaces;
 using System;
+using System.Collections.Generic;
 using System.Runtime.InteropServices;
 
 namespace myoddweb.directorywatcher.utils.Helper
@@ -21,6 +22,37 @@ namespace myoddweb.directorywatcher.utils.Helper
     /// </summary>
     private Delegates.Stop _stop;
 
+    /// <summary>
+    /// Delegate to pull the events of a request.
+    /// </summary>
+    private Delegates.GetEvents _getEvents;
+
+    /// <summary>
+    /// The number of events we pull at a time.
+    /// </summary>
+    private const int PulledEventsCapacity = 1024;
+
+    /// <summary>
+    /// The number of characters the names of the pulled events can use.
+    /// This is enough for at least one event with the longest possible name and old name.
+    /// </summary>
+    private const int PulledNamesCapacity = 128 * 1024;
+
+    /// <summary>
+    /// The requests that pull their events rather than being given them.
+    /// </summary>
+    private readonly HashSet<long> _pulledRequests = new HashSet<long>();
+
+    /// <summary>
+    /// Where the pulled events are copied.
+    /// </summary>
+    private readonly Delegates.Event[] _pulledEvents = new Delegates.Event[PulledEventsCapacity];
+
+    /// <summary>
+    /// Where the null terminated names of the pulled events are copied.
+    /// </summary>
+    private readonly char[] _pulledNames = new char[PulledNamesCapacity];
+
     /// <summary>
     /// The callback function called from time to time when Events happen.
     /// </summary>
@@ -111,11 +143,20 @@ namespace myoddweb.directorywatcher.utils.Helper
         StatisticsCallback = _statisticsCallback,
         EventsCallbackIntervalMs = request.Rates.EventsMilliseconds,
         StatisticsCallbackIntervalMs = request.Rates.StatisticsMilliseconds,
-        LoggerCallback = _loggerCallback
+        LoggerCallback = _loggerCallback,
+        PullEvents = request.PullEvents
       };
 
       // start
-      return _start(ref requestDelegatedelegate);
+      var id = _start(ref requestDelegatedelegate);
+      if (id > 0 && request.PullEvents)
+      {
+        lock (_pulledRequests)
+        {
+          _pulledRequests.Add(id);
+        }
+      }
+      return id;
     }
 
     public bool Stop(long id)
@@ -124,9 +165,61 @@ namespace myoddweb.directorywatcher.utils.Helper
       {
         _stop = Get<Delegates.Stop>("Stop");
       }
+      lock (_pulledRequests)
+      {
+        _pulledRequests.Remove(id);
+      }
       return _stop(id);
     }
 
+    /// <summary>
+    /// Give the pending events of a request to the events callback
+    /// if the request is pulling its events, otherwise the callback is called at the events rate.
+    /// </summary>
+    /// <param name="id">The request we are pulling the events of.</param>
+    public void PullEvents(long id)
+    {
+      lock (_pulledRequests)
+      {
+        if (!_pulledRequests.Contains(id))
+        {
+          return;
+        }
+
+        if (_getEvents == null)
+        {
+          _getEvents = Get<Delegates.GetEvents>("GetEvents");
+        }
+
+        // the events that did not fit are given to us on the next call.
+        long pending;
+        int numberOfEvents;
+        do
+        {
+          pending = _getEvents(id, _pulledEvents, _pulledEvents.Length, _pulledNames, _pulledNames.Length, out numberOfEvents, out _);
+          for (var i = 0; i < numberOfEvents; ++i)
+          {
+            var e = _pulledEvents[i];
+            var oldName = GetName(_pulledNames, e.OldName);
+            _eventsCallback(id, e.IsFile != 0, GetName(_pulledNames, e.Name), oldName.Length == 0 ? null : oldName, e.Action, e.Error, e.DateTimeUtc);
+          }
+        }
+        while (pending > 0 && numberOfEvents > 0);
+      }
+    }
+
+    /// <summary>
+    /// Get a null terminated name from the names of the pulled events.
+    /// </summary>
+    /// <param name="names">The names of the events.</param>
+    /// <param name="offset">Where the name starts.</param>
+    /// <returns>The name, without the null terminator.</returns>
+    internal static string GetName(char[] names, int offset)
+    {
+      var end = Array.IndexOf(names, '\0', offset);
+      return new string(names, offset, (end < 0 ? names.Length : end) - offset);
+    }
+
     /// <summary>
     /// Return if the monitor manager is ready to accept requests.
     /// </summary>
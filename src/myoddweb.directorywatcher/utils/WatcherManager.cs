@@ -372,6 +372,9 @@ namespace myoddweb.directorywatcher.utils
 
     public IList<IEvent> GetEvents(long id )
     {
+      // the requests pulling their events add them now.
+      PullEvents(id);
+
       lock (_idAndEvents)
       {
         if (!_idAndEvents.ContainsKey(id))
@@ -397,6 +400,12 @@ namespace myoddweb.directorywatcher.utils
     public abstract long Start(IRequest request);
 
     public abstract bool Stop(long id);
+
+    /// <summary>
+    /// Give the pending events of a request to the events callback, if the request is pulling them.
+    /// </summary>
+    /// <param name="id">The request we are pulling the events of.</param>
+    protected abstract void PullEvents(long id);
     
     public abstract bool Ready();
     #endregion
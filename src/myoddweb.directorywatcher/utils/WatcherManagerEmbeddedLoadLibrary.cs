@@ -54,6 +54,11 @@ namespace myoddweb.directorywatcher.utils
     {
       return _helper.Ready();
     }
+
+    protected override void PullEvents(long id)
+    {
+      _helper.PullEvents(id);
+    }
     #endregion
   }
 }